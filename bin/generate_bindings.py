@@ -7,34 +7,81 @@ Parses C++-like IDL definitions and generates:
   2. C++ client wrapper for dynamic loading
   3. Emscripten WASM bindings
   4. JNI bindings for Java interop (optional)
+  5. Per-layer micro-benchmarks (optional)
+  6. Header-only C++ reflection tables (optional)
+  7. Compact binary wire codecs for structs and vectors (optional)
+  8. Out-of-process C++ client and server over shared memory (optional)
 
 Usage:
     python generate_bindings.py input.idl --output-dir generated/
     python generate_bindings.py input.idl --output-dir generated/ --java --java-package com.example
+    python generate_bindings.py input.idl --output-dir generated/ --bench
+    python generate_bindings.py --server /tmp/idlgen.sock &
+    python generate_bindings.py input.idl --output-dir generated/ --connect /tmp/idlgen.sock
+
+Only the standard library is imported up front: a --connect run that reaches a server
+never loads the generators.
 """
 
 import argparse
+import dataclasses
+import io
+import json
+import os
+import signal
+import socket
 import sys
 import time
+from contextlib import redirect_stderr, redirect_stdout
 from pathlib import Path
+from typing import Optional
 
 # Add parent directory to path so idlgen package can be found
 sys.path.insert(0, str(Path(__file__).parent.parent))
 
-from idlgen import (
-    IDLParser,
-    CAPIGenerator,
-    ClientGenerator,
-    WASMGenerator,
-    JNIGenerator,
-    PythonGenerator,
-)
 
+# Output groups selectable with --languages, in generation order
+LANGUAGES = ("c_api", "client", "wasm", "jni", "python", "pyext", "bench", "reflect", "wire", "ipc")
 
-def main():
-    start_time = time.perf_counter()
-    
-    parser = argparse.ArgumentParser(description="Generate bindings from IDL")
+# Mirrors ClientGenerator.RESOLVE_MODES; spelled out so building the parser imports nothing
+CLIENT_RESOLVE_MODES = ("eager", "lazy", "table")
+
+
+class UsageError(Exception):
+    """Bad command line; reported like argparse does, without exiting a server"""
+
+
+class _ArgumentParser(argparse.ArgumentParser):
+    def error(self, message):
+        raise UsageError(f"{self.prog}: error: {message}")
+
+
+@dataclasses.dataclass(frozen=True)
+class Options:
+    """Resolved generation settings; picklable for worker processes, hashable for the server"""
+    idl_path: Path
+    output_dir: Path
+    python_output: Path
+    java_output: Path
+    namespace: str
+    impl_header: str
+    api_macro: str
+    java_package: str
+    pool: bool
+    instrument: bool
+    client_resolve: str
+    split_classes: bool
+    python_ext: bool
+    generate_python: bool
+    generate_java: bool
+    languages: tuple[str, ...]
+    cache_dir: Optional[Path]
+    jobs: int = 1
+    list_outputs: bool = False
+
+
+def build_parser() -> argparse.ArgumentParser:
+    parser = _ArgumentParser(description="Generate bindings from IDL")
     parser.add_argument("idl_file", nargs="?", help="Path to IDL file (positional)")
     parser.add_argument("--idl", help="Path to IDL file (alternative)")
     parser.add_argument("--output-dir", "-o", default="generated", help="Output directory")
@@ -42,92 +89,490 @@ def main():
     parser.add_argument("--header", default="", help="Implementation header to include (alternative)")
     parser.add_argument("--impl-header", default="", help="Implementation header to include")
     parser.add_argument("--api-macro", default="", help="API export macro name")
+    parser.add_argument("--pool", action="store_true",
+                        help="Recycle C API handles and result objects through per-thread free lists")
+    parser.add_argument("--instrument", action="store_true",
+                        help="Count calls, time and marshalled bytes per C API entry point, read through "
+                             "<namespace>_stats_snapshot")
+    parser.add_argument("--client-resolve", choices=CLIENT_RESOLVE_MODES, default="eager",
+                        help="C++ client symbol lookup: all at initialize (eager), per class on first use "
+                             "(lazy), or one <namespace>_get_api table (table)")
     parser.add_argument("--java", action="store_true", help="Generate Java/JNI bindings")
     parser.add_argument("--java-package", default="", help="Java package name")
     parser.add_argument("--java-output-dir", default="", help="Java source output directory")
     parser.add_argument("--java-output", default="", help="Java source output directory (alternative)")
     parser.add_argument("--python", action="store_true", help="Generate Python bindings")
     parser.add_argument("--python-output", default="", help="Python bindings output directory")
-    args = parser.parse_args()
+    parser.add_argument("--python-ext", action="store_true",
+                        help="Also generate <namespace>_pyext.cpp, a CPython extension the Python bindings "
+                             "call instead of ctypes when it is built")
+    parser.add_argument("--bench", action="store_true",
+                        help="Also generate <namespace>_bench.cpp (Google Benchmark: direct C++ vs C API vs "
+                             "client) and, with --python, <namespace>_bench.py")
+    parser.add_argument("--reflect", action="store_true",
+                        help="Also generate <namespace>_reflect.hpp, header-only constexpr field, method and "
+                             "enum tables over the implementation types")
+    parser.add_argument("--wire", action="store_true",
+                        help="Also generate matching little-endian struct, array and frame codecs: "
+                             "<namespace>_wire.h and <namespace>_wire.js, plus <namespace>_wire.py with "
+                             "--python and Wire.java with --java")
+    parser.add_argument("--ipc", action="store_true",
+                        help="Also generate <namespace>_ipc.hpp/.cpp, a client with the C++ client's interface "
+                             "whose calls run in a separate <namespace>_ipc_server.cpp process over POSIX "
+                             "shared memory")
+    parser.add_argument("--languages", default="",
+                        help=f"Comma-separated subset of the enabled outputs to write ({','.join(LANGUAGES)}); "
+                             "default all")
+    parser.add_argument("--split-classes", action="store_true",
+                        help="Write the C API as one <namespace>_c_api_<Class>.h/.cpp pair per class, so "
+                             "editing a class recompiles only its own translation unit")
+    parser.add_argument("--cache-dir", default="",
+                        help="Directory for the parsed IDL cache (default .idlgen_cache in the working directory, "
+                             "the build directory when CMake runs the generator)")
+    parser.add_argument("--no-cache", action="store_true", help="Always parse the IDL")
+    parser.add_argument("--list-outputs", action="store_true",
+                        help="Print the paths that would be generated, one per line, and write nothing")
+    parser.add_argument("--jobs", "-j", type=int, default=1,
+                        help="Generate up to N languages at once in worker processes (0: one per CPU)")
+    parser.add_argument("--server", metavar="SOCKET",
+                        help="Serve generation requests on a Unix socket, keeping parsed IDLs and "
+                             "generated outputs in memory between requests")
+    parser.add_argument("--idle-timeout", type=float, default=600.0,
+                        help="Seconds without a request after which --server exits (0: never)")
+    parser.add_argument("--connect", metavar="SOCKET",
+                        help="Send this run to a --server; generate locally if none is listening")
+    return parser
+
 
+def resolve_options(args: argparse.Namespace, parser: argparse.ArgumentParser, cwd: Path) -> Options:
+    """Turn parsed flags into Options; relative paths are taken relative to cwd"""
     # Support both positional and --idl argument
     idl_file = args.idl_file or args.idl
     if not idl_file:
         parser.error("IDL file is required (positional or --idl)")
-    
-    idl_path = Path(idl_file)
+
+    idl_path = cwd / idl_file
     namespace = args.namespace or idl_path.stem.replace("-", "_")
     impl_header = args.impl_header or args.header or f"{namespace}.hpp"
-    
+
     # Extract just the filename from the header path
     impl_header = Path(impl_header).name
 
-    idl = IDLParser(idl_path.read_text()).parse()
+    output_dir = cwd / args.output_dir
+    cache_dir = None if args.no_cache else cwd / (args.cache_dir or ".idlgen_cache")
+    java_output_dir = args.java_output_dir or args.java_output
+    generate_java = args.java or args.java_package or java_output_dir
+    generate_python = bool(args.python or args.python_output)
+    java_package = args.java_package or namespace.replace("_", ".")
 
-    output_dir = Path(args.output_dir)
-    output_dir.mkdir(parents=True, exist_ok=True)
-    
-    api_macro = args.api_macro or f"{namespace.upper()}_API"
+    enabled = {"c_api", "client", "wasm"}
+    enabled |= {"jni"} if generate_java else set()
+    enabled |= {"python"} if generate_python else set()
+    enabled |= {"pyext"} if generate_python and args.python_ext else set()
+    enabled |= {"bench"} if args.bench else set()
+    enabled |= {"reflect"} if args.reflect else set()
+    enabled |= {"wire"} if args.wire else set()
+    enabled |= {"ipc"} if args.ipc else set()
+    if args.languages:
+        selected = {lang.strip() for lang in args.languages.split(",") if lang.strip()}
+        unknown = selected - set(LANGUAGES)
+        if unknown:
+            parser.error(f"unknown --languages entries: {', '.join(sorted(unknown))}")
+        enabled &= selected
+    if args.jobs < 0:
+        parser.error("--jobs must be 0 or more")
 
-    c_api = CAPIGenerator(idl, namespace, api_macro)
-    client = ClientGenerator(idl, namespace)
-    wasm = WASMGenerator(idl, namespace)
+    return Options(
+        idl_path=idl_path,
+        output_dir=output_dir,
+        python_output=cwd / args.python_output if args.python_output else output_dir,
+        # Java classes always go under the package path subdirectory
+        java_output=(cwd / java_output_dir if java_output_dir else output_dir / "java")
+                    / java_package.replace(".", "/"),
+        namespace=namespace,
+        impl_header=impl_header,
+        api_macro=args.api_macro or f"{namespace.upper()}_API",
+        java_package=java_package,
+        pool=args.pool,
+        instrument=args.instrument,
+        client_resolve=args.client_resolve,
+        split_classes=args.split_classes,
+        python_ext=args.python_ext,
+        generate_python=generate_python,
+        generate_java=bool(generate_java),
+        languages=tuple(lang for lang in LANGUAGES if lang in enabled),
+        cache_dir=cache_dir,
+        jobs=args.jobs or os.cpu_count() or 1,
+        list_outputs=args.list_outputs,
+    )
 
-    files = {
-        f"{namespace}_c_api.h": c_api.generate_header(),
-        f"{namespace}_c_api.cpp": c_api.generate_impl(impl_header),
-        f"{namespace}_client.hpp": client.generate_header(),
-        f"{namespace}_client.cpp": client.generate_impl(),
-        f"{namespace}_wasm_bindings.cpp": wasm.generate(impl_header),
-    }
 
-    # Generate JNI bindings if requested (or if java-package/java-output is provided)
-    java_output_dir = args.java_output_dir or args.java_output
-    generate_java = args.java or args.java_package or java_output_dir
-    
-    if generate_java:
-        java_package = args.java_package or namespace.replace("_", ".")
-        jni = JNIGenerator(idl, namespace, java_package)
-        
-        files[f"{namespace}_jni.h"] = jni.generate_jni_header()
-        files[f"{namespace}_jni.cpp"] = jni.generate_jni_impl(impl_header)
-        
-        # Generate Java classes
-        java_output = Path(java_output_dir) if java_output_dir else output_dir / "java"
-        # Always add the package path subdirectory
-        java_pkg_dir = java_output / java_package.replace(".", "/")
-        java_pkg_dir.mkdir(parents=True, exist_ok=True)
-        
-        # Generate shared types file (structs and callbacks)
+def emit_language(language: str, idl, options: Options) -> dict:
+    """Generated files of one language as {path: content}; runs in a worker process with --jobs"""
+    from idlgen import (
+        CAPIGenerator,
+        ClientGenerator,
+        WASMGenerator,
+        JNIGenerator,
+        PythonGenerator,
+        PythonExtGenerator,
+        BenchmarkGenerator,
+        ReflectGenerator,
+        WireGenerator,
+        IPCGenerator,
+    )
+
+    output_dir = options.output_dir
+    namespace = options.namespace
+    impl_header = options.impl_header
+    outputs = {}
+
+    if language == "c_api":
+        c_api = CAPIGenerator(idl, namespace, options.api_macro, pool=options.pool,
+                              instrument=options.instrument)
+        if options.split_classes:
+            for filename, content in c_api.generate_split(impl_header).items():
+                outputs[output_dir / filename] = content
+        else:
+            outputs[output_dir / f"{namespace}_c_api_types.h"] = c_api.generate_types_header()
+            outputs[output_dir / f"{namespace}_c_api.h"] = c_api.generate_header()
+            outputs[output_dir / f"{namespace}_c_api.cpp"] = c_api.generate_impl(impl_header)
+
+    elif language == "client":
+        client = ClientGenerator(idl, namespace, resolve=options.client_resolve)
+        outputs[output_dir / f"{namespace}_client.hpp"] = client.generate_header()
+        outputs[output_dir / f"{namespace}_client.cpp"] = client.generate_impl()
+
+    elif language == "wasm":
+        wasm = WASMGenerator(idl, namespace)
+        outputs[output_dir / f"{namespace}_wasm_bindings.cpp"] = wasm.generate(impl_header)
+        outputs[output_dir / f"{namespace}_wasm_views.js"] = wasm.generate_post_js()
+
+    elif language == "jni":
+        jni = JNIGenerator(idl, namespace, options.java_package)
+        outputs[output_dir / f"{namespace}_jni.h"] = jni.generate_jni_header()
+        outputs[output_dir / f"{namespace}_jni.cpp"] = jni.generate_jni_impl(impl_header)
+
+        # Shared types file (structs and callbacks)
         if idl.structs or idl.callbacks:
-            types_path = java_pkg_dir / "Types.java"
-            types_path.write_text(jni.generate_java_types())
-            print(f"Generated: {types_path}")
-        
+            outputs[options.java_output / "Types.java"] = jni.generate_java_types()
         for cls in idl.classes:
-            java_path = java_pkg_dir / f"{cls.name}.java"
-            java_path.write_text(jni.generate_java_class(cls))
-            print(f"Generated: {java_path}")
-
-    # Generate Python bindings if requested
-    generate_python = args.python or args.python_output
-    if generate_python:
-        python_gen = PythonGenerator(idl, namespace)
-        python_output = Path(args.python_output) if args.python_output else output_dir
-        python_output.mkdir(parents=True, exist_ok=True)
-        
-        python_path = python_output / f"{namespace}.py"
-        python_path.write_text(python_gen.generate())
-        print(f"Generated: {python_path}")
-
-    for filename, content in files.items():
-        path = output_dir / filename
-        path.write_text(content)
-        print(f"Generated: {path}")
+            outputs[options.java_output / f"{cls.name}.java"] = jni.generate_java_class(cls)
+        outputs[options.java_output / "NativeMemory.java"] = jni.generate_java_native_memory()
+        if any(idl.symbols.stream_types.values()):
+            outputs[options.java_output / "NativeStream.java"] = jni.generate_java_native_stream()
+
+    elif language == "python":
+        python_gen = PythonGenerator(idl, namespace, extension=options.python_ext)
+        outputs[options.python_output / f"{namespace}.py"] = python_gen.generate()
+
+    elif language == "pyext":
+        outputs[output_dir / f"{namespace}_pyext.cpp"] = PythonExtGenerator(idl, namespace).generate()
+
+    elif language == "bench":
+        bench = BenchmarkGenerator(idl, namespace)
+        outputs[output_dir / f"{namespace}_bench.cpp"] = bench.generate_cpp(impl_header)
+        if options.generate_python:
+            outputs[options.python_output / f"{namespace}_bench.py"] = bench.generate_python()
+
+    elif language == "reflect":
+        outputs[output_dir / f"{namespace}_reflect.hpp"] = ReflectGenerator(idl, namespace).generate(impl_header)
+
+    elif language == "wire":
+        wire = WireGenerator(idl, namespace)
+        outputs[output_dir / f"{namespace}_wire.h"] = wire.generate_c(f"{namespace}_c_api_types.h")
+        outputs[output_dir / f"{namespace}_wire.js"] = wire.generate_js()
+        if options.generate_python:
+            outputs[options.python_output / f"{namespace}_wire.py"] = wire.generate_python()
+        if options.generate_java:
+            outputs[options.java_output / "Wire.java"] = wire.generate_java(options.java_package)
+
+    elif language == "ipc":
+        ipc = IPCGenerator(idl, namespace)
+        outputs[output_dir / f"{namespace}_ipc.hpp"] = ipc.generate_header(f"{namespace}_c_api_types.h")
+        outputs[output_dir / f"{namespace}_ipc.cpp"] = ipc.generate_impl()
+        outputs[output_dir / f"{namespace}_ipc_server.cpp"] = ipc.generate_server()
+
+    return outputs
+
+
+def generate(idl, options: Options, executor=None) -> dict:
+    """Every enabled language's outputs, in LANGUAGES order. With an executor the languages
+    are generated concurrently; the parsed IDL is pickled to each worker."""
+    if executor is None or len(options.languages) < 2:
+        results = [emit_language(lang, idl, options) for lang in options.languages]
+    else:
+        futures = [executor.submit(emit_language, lang, idl, options) for lang in options.languages]
+        results = [f.result() for f in futures]
+    outputs = {}
+    for result in results:
+        outputs.update(result)
+    return outputs
+
+
+def write_if_changed(path: Path, content: str) -> bool:
+    """Write content unless path already holds it, so unchanged outputs keep their mtime
+    and the build does not recompile what depends on them"""
+    try:
+        if path.read_text() == content:
+            return False
+    except (FileNotFoundError, UnicodeDecodeError):
+        pass
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(content)
+    return True
+
+
+def write_outputs(outputs: dict, options: Options, start_time: float):
+    if options.list_outputs:
+        for path in outputs:
+            print(path)
+        return
+
+    written = 0
+    for path, content in outputs.items():
+        if write_if_changed(path, content):
+            written += 1
+            print(f"Generated: {path}")
+        else:
+            print(f"Unchanged: {path}")
 
     elapsed = time.perf_counter() - start_time
-    print(f"Generation completed in {elapsed*1000:.2f} ms")
+    print(f"Generation completed in {elapsed*1000:.2f} ms ({written} of {len(outputs)} files written)")
+
+
+def _executor(jobs: int, languages: int):
+    if jobs < 2 or languages < 2:
+        return None
+    from concurrent.futures import ProcessPoolExecutor
+    return ProcessPoolExecutor(max_workers=min(jobs, languages))
+
+
+def run_local(argv: list[str]) -> int:
+    start_time = time.perf_counter()
+    parser = build_parser()
+    try:
+        args = parser.parse_args(argv)
+        if args.server:
+            return serve(args.server, args.jobs or os.cpu_count() or 1, args.idle_timeout)
+        options = resolve_options(args, parser, Path())
+    except UsageError as e:
+        parser.print_usage(sys.stderr)
+        print(e, file=sys.stderr)
+        return 2
+
+    from idlgen import parse_idl_file
+    try:
+        idl = parse_idl_file(options.idl_path, options.cache_dir)
+    except (OSError, ValueError) as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 1
+
+    executor = _executor(options.jobs, len(options.languages))
+    try:
+        outputs = generate(idl, options, executor)
+    except ValueError as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 1
+    finally:
+        if executor:
+            executor.shutdown()
+    write_outputs(outputs, options, start_time)
+    return 0
+
+
+# ── Server ─────────────────────────────────────────────────────────
+#
+# Protocol: the client connects, sends one JSON line {"argv": [...], "cwd": "..."} and
+# reads one JSON line {"status": int, "stdout": str, "stderr": str}. Status "restart"
+# means the generator sources changed since the server started; the server exits and
+# the client generates locally.
+
+def _source_stamp() -> tuple:
+    """mtimes of this script and the idlgen package, to notice an edited generator"""
+    files = [Path(__file__).resolve(), *sorted((Path(__file__).resolve().parent.parent / "idlgen").glob("*.py"))]
+    return tuple((str(f), f.stat().st_mtime_ns) for f in files if f.exists())
+
+
+class GeneratorServer:
+    """Answers generation requests with parsed units, linked IDLs and generated outputs
+    kept in memory; each IDL file is re-parsed only when its text changes"""
+
+    def __init__(self, jobs: int):
+        self.jobs = jobs
+        self.stamp = _source_stamp()
+        self._units: dict[str, tuple] = {}     # path -> (text, unit)
+        self._linked: dict[str, tuple] = {}    # root path -> (root unit, [(path, unit)], linked IDL)
+        self._outputs: dict[Options, tuple] = {}  # options -> (IDL, outputs)
+        self._executor = _executor(jobs, len(LANGUAGES))
+
+    def close(self):
+        if self._executor:
+            self._executor.shutdown()
+
+    def _load_unit(self, path: Path):
+        from idlgen import IDLParser
+        key = str(path)
+        text = path.read_text()
+        hit = self._units.get(key)
+        if hit and hit[0] == text:
+            return hit[1]
+        unit = IDLParser(text, key).parse_unit()
+        self._units[key] = (text, unit)
+        return unit
+
+    def load(self, path: Path):
+        """Like parse_idl_file, but returns the same object while no file involved changed"""
+        from idlgen.parser import link_units
+        path = path.resolve()
+        root = self._load_unit(path)
+        if not root.imports:
+            return root
+        hit = self._linked.get(str(path))
+        if hit and hit[0] is root and all(self._load_unit(Path(p)) is unit for p, unit in hit[1]):
+            return hit[2]
+        linked = link_units(root, self._load_unit)
+        self._linked[str(path)] = (root, [(p, self._load_unit(Path(p))) for p in linked.imports], linked)
+        return linked
+
+    def handle(self, argv: list[str], cwd: Path) -> tuple[int, str, str]:
+        start_time = time.perf_counter()
+        stdout, stderr = io.StringIO(), io.StringIO()
+        with redirect_stdout(stdout), redirect_stderr(stderr):
+            status = self._run(argv, cwd, start_time)
+        return status, stdout.getvalue(), stderr.getvalue()
+
+    def _run(self, argv: list[str], cwd: Path, start_time: float) -> int:
+        parser = build_parser()
+        try:
+            args = parser.parse_args(argv)
+            if args.server:
+                parser.error("--server cannot be sent to a server")
+            options = resolve_options(args, parser, cwd)
+        except UsageError as e:
+            parser.print_usage(sys.stderr)
+            print(e, file=sys.stderr)
+            return 2
+        try:
+            idl = self.load(options.idl_path)
+        except (OSError, ValueError) as e:
+            print(f"error: {e}", file=sys.stderr)
+            return 1
+
+        key = dataclasses.replace(options, jobs=1, list_outputs=False)
+        hit = self._outputs.get(key)
+        if hit and hit[0] is idl:
+            outputs = hit[1]
+        else:
+            try:
+                outputs = generate(idl, options, self._executor)
+            except ValueError as e:
+                print(f"error: {e}", file=sys.stderr)
+                return 1
+            self._outputs[key] = (idl, outputs)
+        write_outputs(outputs, options, start_time)
+        return 0
+
+
+def serve(socket_path: str, jobs: int, idle_timeout: float) -> int:
+    if not hasattr(socket, "AF_UNIX"):
+        print("error: --server needs Unix domain sockets", file=sys.stderr)
+        return 1
+    path = Path(socket_path)
+    if path.exists():
+        if _request(socket_path, None) is not None:
+            print(f"error: a server is already listening on {path}", file=sys.stderr)
+            return 1
+        path.unlink()  # left behind by a server that did not shut down cleanly
+
+    # Build tools stop daemons with SIGTERM; exit through the finally below to remove the socket
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    server = GeneratorServer(jobs)
+    listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    listener.bind(str(path))
+    listener.listen(64)
+    listener.settimeout(idle_timeout or None)
+    print(f"Serving on {path} with {jobs} job(s)", flush=True)
+    try:
+        while True:
+            try:
+                conn, _ = listener.accept()
+            except socket.timeout:
+                print("Idle timeout, exiting", flush=True)
+                return 0
+            with conn:
+                conn.settimeout(30)
+                try:
+                    request = _read_line(conn)
+                    if not request:
+                        continue  # probe from a client checking whether the socket is live
+                    if _source_stamp() != server.stamp:
+                        conn.sendall(json.dumps({"status": "restart"}).encode() + b"\n")
+                        print("Generator sources changed, exiting", flush=True)
+                        return 0
+                    message = json.loads(request)
+                    status, out, err = server.handle(message["argv"], Path(message["cwd"]))
+                    conn.sendall(json.dumps({"status": status, "stdout": out, "stderr": err}).encode() + b"\n")
+                except (OSError, ValueError, KeyError, TypeError) as e:
+                    print(f"Dropped a request: {e}", file=sys.stderr, flush=True)
+    except KeyboardInterrupt:
+        return 0
+    finally:
+        listener.close()
+        path.unlink(missing_ok=True)
+        server.close()
+
+
+# ── Client ─────────────────────────────────────────────────────────
+
+def _read_line(conn: socket.socket) -> bytes:
+    chunks = []
+    while True:
+        chunk = conn.recv(65536)
+        if not chunk:
+            break
+        chunks.append(chunk)
+        if chunk.endswith(b"\n"):
+            break
+    return b"".join(chunks)
+
+
+def _request(socket_path: str, message: Optional[dict]) -> Optional[dict]:
+    """Send message to the server and return its reply; None when no server is listening.
+    A None message only probes the socket."""
+    if not hasattr(socket, "AF_UNIX"):
+        return None
+    try:
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+            conn.connect(socket_path)
+            if message is None:
+                return {}
+            conn.sendall(json.dumps(message).encode() + b"\n")
+            reply = _read_line(conn)
+    except OSError:
+        return None
+    return json.loads(reply) if reply else None
+
+
+def _connect_target(argv: list[str]) -> Optional[str]:
+    """--connect value, found without building the full parser"""
+    pre = argparse.ArgumentParser(add_help=False)
+    pre.add_argument("--connect")
+    known, _ = pre.parse_known_args(argv)
+    return known.connect
+
+
+def main() -> int:
+    argv = sys.argv[1:]
+    socket_path = _connect_target(argv)
+    if socket_path:
+        reply = _request(socket_path, {"argv": argv, "cwd": os.getcwd()})
+        if reply and reply.get("status") != "restart":
+            sys.stdout.write(reply["stdout"])
+            sys.stderr.write(reply["stderr"])
+            return reply["status"]
+    return run_local(argv)
 
 
 if __name__ == "__main__":
-    main()
+    sys.exit(main())
@@ -6,21 +6,32 @@ Parses C++-like IDL definitions and generates:
   2. C++ client wrapper for dynamic loading
   3. Emscripten WASM bindings
   4. JNI bindings for Java interop
-  5. Python bindings using ctypes
+  5. Python bindings using ctypes, with an optional CPython extension
+  6. Per-layer micro-benchmarks (Google Benchmark and a Python timing script)
+  7. Header-only C++ reflection tables
+  8. Compact binary wire codecs in C, Java, Python and JavaScript
+  9. An out-of-process C++ client and server over shared memory
 """
 
-from .types import Param, Member, Method, Class, Struct, Enum, EnumValue, ParsedIDL
-from .parser import IDLParser
+from .types import Param, Member, Method, Class, Struct, Enum, EnumValue, ParsedIDL, SymbolTable
+from .parser import IDLParser, IDLSyntaxError
+from .idl_cache import parse_idl_file
 from .type_mapper import TypeMapper
 from .c_api_generator import CAPIGenerator
 from .client_generator import ClientGenerator
 from .wasm_generator import WASMGenerator
 from .jni_generator import JNIGenerator
 from .python_generator import PythonGenerator
+from .python_ext_generator import PythonExtGenerator
+from .benchmark_generator import BenchmarkGenerator
+from .reflect_generator import ReflectGenerator
+from .wire_generator import WireGenerator
+from .ipc_generator import IPCGenerator
 
 __all__ = [
-    'Param', 'Member', 'Method', 'Class', 'Struct', 'ParsedIDL',
-    'IDLParser', 'TypeMapper',
+    'Param', 'Member', 'Method', 'Class', 'Struct', 'ParsedIDL', 'SymbolTable',
+    'IDLParser', 'IDLSyntaxError', 'TypeMapper', 'parse_idl_file',
     'CAPIGenerator', 'ClientGenerator', 'WASMGenerator', 'JNIGenerator',
-    'PythonGenerator',
+    'PythonGenerator', 'PythonExtGenerator', 'BenchmarkGenerator', 'ReflectGenerator',
+    'WireGenerator', 'IPCGenerator',
 ]
@@ -0,0 +1,411 @@
+"""Benchmark Generator - generates per-layer micro-benchmarks for every IDL method"""
+
+from typing import Optional
+from .types import ParsedIDL, Class, Method, Param, Callback
+from .type_mapper import TypeMapper
+
+
+class BenchmarkGenerator:
+    """Generates Google Benchmark cases (direct C++, C API, C++ client) and a Python timing script"""
+
+    # Bytes behind every byte-pointer argument; sample ints stay well inside it
+    BUFFER_SIZE = 4096
+    SAMPLE_INT = 3
+    SAMPLE_FLOAT = 1.5
+    SAMPLE_STRING = "bench"
+
+    def __init__(self, idl: ParsedIDL, namespace: str):
+        self.idl = idl
+        self.namespace = namespace
+
+    def supports(self, method: Method) -> bool:
+        """Class-typed arguments and results and owning pointer returns need setup the generator cannot
+        guess; a stream only does work when pulled, so its call alone measures nothing"""
+        ret = method.return_type
+        if ret.endswith("*") or self._is_class_type(ret) or TypeMapper.is_stream(ret):
+            return False
+        return not any(self._is_class_type(p.type) for p in method.params)
+
+    # ── C++ (Google Benchmark) ──────────────────────────────────────
+
+    def generate_cpp(self, impl_header: str) -> str:
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// Per-call cost of every {self.namespace} method through each layer:",
+            "//   direct - the C++ implementation, the baseline",
+            "//   c_api  - the exported C functions",
+            "//   client - the C++ client wrapper (statically linked)",
+            f'#include "{impl_header}"',
+            f'#include "{self.namespace}_c_api.h"',
+            f'#include "{self.namespace}_client.hpp"',
+            "",
+            "#include <benchmark/benchmark.h>",
+            "",
+            "#include <atomic>",
+            "#include <cstddef>",
+            "#include <cstdint>",
+            "#include <cstdlib>",
+            "#include <new>",
+            "#include <string>",
+            "",
+            "namespace {",
+            "",
+            "std::atomic<uint64_t> g_allocations{0};",
+            "",
+            "// Reports operator new calls per iteration as allocs/call",
+            "class AllocationCounter {",
+            "public:",
+            "    explicit AllocationCounter(benchmark::State& state)",
+            "        : state_(state), start_(g_allocations.load(std::memory_order_relaxed)) {}",
+            "    ~AllocationCounter() {",
+            "        const auto count = g_allocations.load(std::memory_order_relaxed) - start_;",
+            '        state_.counters["allocs/call"] = benchmark::Counter(static_cast<double>(count),',
+            "                                                            benchmark::Counter::kAvgIterations);",
+            "    }",
+            "    AllocationCounter(const AllocationCounter&) = delete;",
+            "    AllocationCounter& operator=(const AllocationCounter&) = delete;",
+            "private:",
+            "    benchmark::State& state_;",
+            "    uint64_t start_;",
+            "};",
+            "",
+            f"uint8_t g_bytes[{self.BUFFER_SIZE}];",
+            "",
+            "} // namespace",
+            "",
+            "// Counting replacements for the global allocation functions. Every form is replaced,",
+            "// so each new is paired with a delete that frees through the same allocator.",
+            "namespace {",
+            "",
+            "void* countedAlloc(std::size_t size, std::size_t alignment) noexcept {",
+            "    g_allocations.fetch_add(1, std::memory_order_relaxed);",
+            "    if (size == 0) size = 1;",
+            "    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);",
+            "    // aligned_alloc wants a multiple of the alignment",
+            "    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);",
+            "}",
+            "",
+            "void* countedNew(std::size_t size, std::size_t alignment) {",
+            "    if (void* p = countedAlloc(size, alignment)) return p;",
+            "    throw std::bad_alloc();",
+            "}",
+            "",
+            "} // namespace",
+            "",
+            "void* operator new(std::size_t size) { return countedNew(size, 0); }",
+            "void* operator new[](std::size_t size) { return countedNew(size, 0); }",
+            "void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }",
+            "void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }",
+            "void* operator new(std::size_t size, std::align_val_t al) {",
+            "    return countedNew(size, static_cast<std::size_t>(al));",
+            "}",
+            "void* operator new[](std::size_t size, std::align_val_t al) {",
+            "    return countedNew(size, static_cast<std::size_t>(al));",
+            "}",
+            "void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {",
+            "    return countedAlloc(size, static_cast<std::size_t>(al));",
+            "}",
+            "void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {",
+            "    return countedAlloc(size, static_cast<std::size_t>(al));",
+            "}",
+            "",
+            "void operator delete(void* p) noexcept { std::free(p); }",
+            "void operator delete[](void* p) noexcept { std::free(p); }",
+            "void operator delete(void* p, std::size_t) noexcept { std::free(p); }",
+            "void operator delete[](void* p, std::size_t) noexcept { std::free(p); }",
+            "void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }",
+            "void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }",
+            "void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }",
+            "void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }",
+            "void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }",
+            "void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }",
+            "void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }",
+            "void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }",
+            "",
+        ]
+        skipped = []
+        for cls in self.idl.classes:
+            lines.extend(self._constructor_benchmarks(cls))
+            for method in cls.methods:
+                if method.is_constructor:
+                    continue
+                if not self.supports(method):
+                    skipped.append(f"{cls.name}.{method.name}")
+                    continue
+                lines.extend(self._method_benchmarks(cls, method))
+        if skipped:
+            lines.append(f"// Not benchmarked (class-typed, owning pointer or stream signatures): {', '.join(skipped)}")
+            lines.append("")
+        lines.append("BENCHMARK_MAIN();")
+        lines.append("")
+        return "\n".join(lines)
+
+    def _constructor_benchmarks(self, cls: Class) -> list[str]:
+        ctor = self.idl.symbols.constructors[cls.name]
+        if ctor is None or ctor.params:
+            return []
+        name = cls.name
+        return [
+            f"void {name}_create_direct(benchmark::State& state) {{",
+            "    AllocationCounter allocations(state);",
+            "    for (auto _ : state) {",
+            f"        auto* obj = new {self.namespace}::{name}();",
+            "        benchmark::DoNotOptimize(obj);",
+            "        delete obj;",
+            "    }",
+            "}",
+            f"BENCHMARK({name}_create_direct);",
+            "",
+            f"void {name}_create_c_api(benchmark::State& state) {{",
+            "    AllocationCounter allocations(state);",
+            "    for (auto _ : state) {",
+            f"        auto* handle = {name}_create();",
+            "        benchmark::DoNotOptimize(handle);",
+            f"        {name}_destroy(handle);",
+            "    }",
+            "}",
+            f"BENCHMARK({name}_create_c_api);",
+            "",
+            f"void {name}_create_client(benchmark::State& state) {{",
+            "    AllocationCounter allocations(state);",
+            "    for (auto _ : state) {",
+            f"        {self.namespace}_client::{name} obj;",
+            "        benchmark::DoNotOptimize(obj.handle());",
+            "    }",
+            "}",
+            f"BENCHMARK({name}_create_client);",
+            "",
+        ]
+
+    def _method_benchmarks(self, cls: Class, method: Method) -> list[str]:
+        lines = []
+        for layer in ("direct", "c_api", "client"):
+            bench = f"{cls.name}_{method.name}_{layer}"
+            lines.append(f"void {bench}(benchmark::State& state) {{")
+            lines.extend(f"    {line}" for line in self._setup(cls, method, layer))
+            lines.append("    AllocationCounter allocations(state);")
+            lines.append("    for (auto _ : state) {")
+            lines.extend(f"        {line}" for line in self._call(cls, method, layer))
+            lines.append("    }")
+            lines.append("}")
+            lines.append(f"BENCHMARK({bench});")
+            lines.append("")
+        return lines
+
+    def _setup(self, cls: Class, method: Method, layer: str) -> list[str]:
+        """Object under test and argument locals, built outside the timed loop"""
+        if layer == "direct":
+            lines = [f"{self.namespace}::{cls.name} obj;"]
+        elif layer == "c_api":
+            lines = [
+                f"auto* handle = {cls.name}_create();",
+                "struct Destroy {",
+                f"    {cls.name}Handle* h;",
+                f"    ~Destroy() {{ {cls.name}_destroy(h); }}",
+                "} destroy{handle};",
+            ]
+        else:
+            lines = [f"{self.namespace}_client::{cls.name} obj;"]
+        for p in method.params:
+            if p.type == "string":
+                lines.append(f'const std::string {p.name} = "{self.SAMPLE_STRING}";')
+            elif self._is_struct_type(p.type):
+                lines.append(f"{p.type} {p.name}{{}};")
+        return lines
+
+    def _call(self, cls: Class, method: Method, layer: str) -> list[str]:
+        args = ", ".join(self._arg(p, layer) for p in method.params)
+        if layer == "c_api":
+            call = f"{cls.name}_{method.name}({', '.join(['handle'] + ([args] if args else []))})"
+        else:
+            call = f"obj.{method.name}({args})"
+        if method.return_type == "void":
+            return [f"{call};", "benchmark::ClobberMemory();"]
+        if layer == "c_api" and TypeMapper.is_vector(method.return_type):
+            inner = TypeMapper.vector_inner(method.return_type)
+            return [
+                f"auto* result = {call};",
+                "benchmark::DoNotOptimize(result);",
+                f"{cls.name}_{inner}_CResult_free(result);",
+            ]
+        return [f"benchmark::DoNotOptimize({call});"]
+
+    def _arg(self, p: Param, layer: str) -> str:
+        if self._is_callback_type(p.type):
+            return self._callback_arg(self._get_callback(p.type), layer)
+        if p.type == "string":
+            return f"{p.name}.c_str()" if layer == "c_api" else p.name
+        if self._is_struct_type(p.type):
+            return f"&{p.name}" if p.is_pointer else p.name
+        if p.is_pointer:
+            return "g_bytes"
+        if p.type == "bool":
+            return "1" if layer == "c_api" else "true"
+        if self._is_enum_type(p.type):
+            return f"{p.type}_{self._get_enum(p.type).values[0].name}"
+        if p.type in ("float", "double"):
+            return str(self.SAMPLE_FLOAT)
+        return str(self.SAMPLE_INT)
+
+    def _callback_arg(self, cb: Callback, layer: str) -> str:
+        """A callback that does no work, so only the crossing is measured"""
+        batch = cb.has_attribute("batch") and layer != "client"
+        if batch:
+            params = [f"const {self._batch_element_type(p.type)}*" for p in cb.params]
+            if cb.return_type != "void":
+                params.append(f"{self._batch_element_type(cb.return_type)}* result")
+            params.append("int count")
+            body = "" if cb.return_type == "void" else " for (int i = 0; i < count; ++i) result[i] = 0; "
+        else:
+            params = [self._callback_param(p, layer) for p in cb.params]
+            if cb.return_type == "void":
+                body = ""
+            else:
+                ret = self._batch_element_type(cb.return_type) if layer == "c_api" else TypeMapper.to_cpp(cb.return_type)
+                body = f" return {ret}{{}}; "
+        if layer == "c_api":
+            params.append("void*")
+            return f"[]({', '.join(params)}) {{{body}}}, nullptr"
+        return f"[]({', '.join(params)}) {{{body}}}"
+
+    def _callback_param(self, p: Param, layer: str) -> str:
+        if self._is_struct_type(p.type) and p.is_reference:
+            return f"const {p.type}*" if layer == "c_api" else f"const {p.type}&"
+        if layer == "c_api":
+            return self._batch_element_type(p.type)
+        return TypeMapper.to_cpp(p.type)
+
+    # ── Python ───────────────────────────────────────────────────────
+
+    def generate_python(self) -> str:
+        ns = self.namespace
+        lines = [
+            '"""',
+            f"AUTO-GENERATED micro-benchmarks for the {ns} Python bindings",
+            "DO NOT EDIT - Generated from IDL",
+            "",
+            "Times every method through the ctypes path and, when it is built, the",
+            f"compiled _{ns}_ext path. Prints ns/call and net allocated blocks per call.",
+            "",
+            f"    python {ns}_bench.py [--iterations N] [--filter SUBSTRING]",
+            '"""',
+            "",
+            "import argparse",
+            "import os",
+            "import sys",
+            "import time",
+            "",
+            "sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))",
+            "",
+            f"import {ns}",
+            "",
+            "",
+            f"_BYTES = bytes({self.BUFFER_SIZE})",
+            "",
+            "",
+            "def _measure(fn, iterations):",
+            '    """(ns/call, net allocated blocks/call) for fn()"""',
+            "    for _ in range(min(iterations, 1000)):",
+            "        fn()",
+            "    blocks = sys.getallocatedblocks()",
+            "    start = time.perf_counter_ns()",
+            "    for _ in range(iterations):",
+            "        fn()",
+            "    elapsed = time.perf_counter_ns() - start",
+            "    return elapsed / iterations, (sys.getallocatedblocks() - blocks) / iterations",
+            "",
+            "",
+            "def _cases():",
+            '    """(name, callable) per method; objects are created once, outside the timing"""',
+            "    cases = []",
+        ]
+        for cls in self.idl.classes:
+            methods = [m for m in cls.methods if not m.is_constructor and self.supports(m)]
+            if not methods:
+                continue
+            obj = f"_{cls.name[0].lower()}{cls.name[1:]}"
+            lines.append(f"    {obj} = {ns}.{cls.name}()")
+            for method in methods:
+                args = ", ".join(self._python_arg(p) for p in method.params)
+                lines.append(f"    cases.append(('{cls.name}.{method.name}', lambda: {obj}.{method.name}({args})))")
+        lines.extend([
+            "    return cases",
+            "",
+            "",
+            "def main():",
+            "    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])",
+            "    parser.add_argument('--iterations', type=int, default=20000)",
+            "    parser.add_argument('--filter', default='')",
+            "    args = parser.parse_args()",
+            "",
+            f"    ext = {ns}._ext",
+            "    backends = [('ctypes', None)] + ([('ext', ext)] if ext is not None else [])",
+            "    print(f\"{'method':<40} {'backend':<8} {'ns/call':>10} {'blocks/call':>12}\")",
+            "    for name, fn in _cases():",
+            "        if args.filter not in name:",
+            "            continue",
+            "        for backend, module in backends:",
+            f"            {ns}._ext = module",
+            "            ns_per_call, blocks = _measure(fn, args.iterations)",
+            "            print(f'{name:<40} {backend:<8} {ns_per_call:>10.1f} {blocks:>12.2f}')",
+            f"    {ns}._ext = ext",
+            "    return 0",
+            "",
+            "",
+            "if __name__ == '__main__':",
+            "    sys.exit(main())",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _python_arg(self, p: Param) -> str:
+        if self._is_callback_type(p.type):
+            cb = self._get_callback(p.type)
+            params = ", ".join(f"_{cp.name}" for cp in cb.params)
+            result = {"void": "None", "bool": "False"}.get(cb.return_type, "0")
+            return f"lambda {params}: {result}"
+        if p.type == "string":
+            return f"'{self.SAMPLE_STRING}'"
+        if self._is_struct_type(p.type):
+            return f"{self.namespace}.{p.type}()"
+        if p.is_pointer:
+            return "_BYTES"
+        if p.type == "bool":
+            return "True"
+        if self._is_enum_type(p.type):
+            return f"{self.namespace}.{p.type}.{self._get_enum(p.type).values[0].name}"
+        if p.type in ("float", "double"):
+            return str(self.SAMPLE_FLOAT)
+        return str(self.SAMPLE_INT)
+
+    # ── Type helpers ────────────────────────────────────────────────
+
+    def _batch_element_type(self, idl_type: str) -> str:
+        """C element type - matches the C API, so bool is int"""
+        if idl_type == "bool":
+            return "int"
+        return TypeMapper.to_c(idl_type)
+
+    def _is_callback_type(self, type_name: str) -> bool:
+        """Check if type is a callback"""
+        return type_name in self.idl.symbols.callbacks
+
+    def _is_class_type(self, type_name: str) -> bool:
+        """Check if type is an IDL class"""
+        return type_name in self.idl.symbols.classes
+
+    def _is_struct_type(self, type_name: str) -> bool:
+        """Check if type is a struct"""
+        return type_name in self.idl.symbols.structs
+
+    def _is_enum_type(self, type_name: str) -> bool:
+        """Check if type is an enum"""
+        return type_name in self.idl.symbols.enums
+
+    def _get_callback(self, type_name: str) -> Optional[Callback]:
+        """Get callback definition by name"""
+        return self.idl.symbols.callbacks.get(type_name)
+
+    def _get_enum(self, type_name: str):
+        """Get enum definition by name"""
+        return self.idl.symbols.enums.get(type_name)
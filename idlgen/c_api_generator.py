@@ -1,6 +1,7 @@
 """C API Generator - generates C header and implementation for shared library export"""
 
 from pathlib import Path
+from typing import Optional
 from .types import ParsedIDL, Class, Method, Member, Param
 from .type_mapper import TypeMapper
 
@@ -8,36 +9,799 @@ from .type_mapper import TypeMapper
 class CAPIGenerator:
     """Generates C API header and implementation"""
 
-    def __init__(self, idl: ParsedIDL, namespace: str, api_macro: str = ""):
+    # Objects kept per type and thread before _free/_destroy falls back to delete
+    POOL_MAX_CACHED = 64
+
+    # Integer parameters that give the byte length of the buffer pointer before them
+    BUFFER_LENGTH_NAMES = ("size", "length", "len", "count", "bytes")
+
+    def __init__(self, idl: ParsedIDL, namespace: str, api_macro: str = "", pool: bool = False,
+                 instrument: bool = False):
         self.idl = idl
         self.namespace = namespace
         self.api_macro = api_macro or f"{namespace.upper()}_API"
         self.export_macro = f"{namespace.upper()}_EXPORTS"
+        self.pool = pool
+        self.instrument = instrument
+        # Set while generating the split layout, whose helpers are shared by several translation units
+        self._shared_helpers = False
+        self._stats_slot_cache: Optional[dict[str, tuple[str, int, Optional[str]]]] = None
 
-    def generate_header(self) -> str:
-        lines = self._header_preamble()
+    def generate_types_header(self) -> str:
+        """<namespace>_c_api_types.h: structs, enums, callbacks and opaque handle types, without
+        entry points, for code that needs the types alone (the implementation header, wire, IPC)"""
+        guard = self._header_guard("_types")
+        lines = self._header_preamble(guard)
+        lines.extend(self._error_types())
         lines.extend(self._generate_enums())
         lines.extend(self._generate_structs())
         lines.extend(self._generate_callbacks())
-        lines.extend(self._generate_class_decls())
-        lines.extend(self._header_postamble())
+        for cls in self.idl.classes:
+            lines.extend(self._class_typedefs(cls))
+        lines.extend(self._header_postamble(guard))
+        return "\n".join(lines)
+
+    def generate_header(self) -> str:
+        guard = self._header_guard()
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"#ifndef {guard}",
+            f"#define {guard}",
+            "",
+            f'#include "{self.namespace}_c_api_types.h"',
+            "",
+            "#ifdef __cplusplus",
+            'extern "C" {',
+            "#endif",
+            "",
+        ]
+        for cls in self.idl.classes:
+            lines.extend(self._class_func_decls(cls))
+        lines.extend(self._error_decls())
+        lines.extend(self._live_decls())
+        if self.pool:
+            lines.extend(self._pool_decls())
+        if self.instrument:
+            lines.extend(self._stats_decls())
+        if self._async_methods():
+            lines.extend(self._async_decls())
+        lines.extend(self._api_table_decls())
+        lines.extend(self._header_postamble(guard))
         return "\n".join(lines)
 
     def generate_impl(self, impl_header: str) -> str:
+        lines = self._impl_preamble(impl_header)
+        for cls in self.idl.classes:
+            lines.extend(self._generate_class_types(cls))
+            lines.extend(self._class_functions(cls))
+        lines.extend(self._impl_postamble())
+        return "\n".join(lines)
+
+    def generate_split(self, impl_header: str) -> dict[str, str]:
+        """Header and implementation with one header and translation unit per class, keyed by file name.
+
+        <namespace>_c_api.h stays the header to include; it pulls in _c_api_types.h and every
+        _c_api_<Class>.h. A class's .cpp includes only the types, its own header and
+        _c_api_internal.hpp, so a change to one class recompiles that class alone."""
+        ns = self.namespace
+        types_header = f"{ns}_c_api_types.h"
+        internal = f"{ns}_c_api_internal.hpp"
+        files = {}
+
+        files[types_header] = self.generate_types_header()
+
+        for cls in self.idl.classes:
+            guard = self._header_guard(f"_{cls.name}")
+            lines = [
+                "// AUTO-GENERATED - DO NOT EDIT",
+                f"#ifndef {guard}",
+                f"#define {guard}",
+                "",
+                f'#include "{types_header}"',
+                "",
+                "#ifdef __cplusplus",
+                'extern "C" {',
+                "#endif",
+                "",
+            ]
+            lines.extend(self._class_func_decls(cls))
+            lines.extend(self._header_postamble(guard))
+            files[f"{ns}_c_api_{cls.name}.h"] = "\n".join(lines)
+
+        guard = self._header_guard()
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"#ifndef {guard}",
+            f"#define {guard}",
+            "",
+            f'#include "{types_header}"',
+        ]
+        lines.extend(f'#include "{ns}_c_api_{cls.name}.h"' for cls in self.idl.classes)
+        lines.extend(["", "#ifdef __cplusplus", 'extern "C" {', "#endif", ""])
+        lines.extend(self._error_decls())
+        lines.extend(self._live_decls())
+        if self.pool:
+            lines.extend(self._pool_decls())
+        if self.instrument:
+            lines.extend(self._stats_decls())
+        if self._async_methods():
+            lines.extend(self._async_decls())
+        lines.extend(self._api_table_decls())
+        lines.extend(self._header_postamble(guard))
+        files[f"{ns}_c_api.h"] = "\n".join(lines)
+
+        self._shared_helpers = True
+        try:
+            guard = f"{ns.upper()}_C_API_INTERNAL_HPP"
+            lines = [
+                "// AUTO-GENERATED - DO NOT EDIT",
+                "// Shared by the split C API translation units; not part of the public API",
+                f"#ifndef {guard}",
+                f"#define {guard}",
+                "",
+            ]
+            lines.extend(self._impl_preamble(impl_header, types_header)[1:])
+            for cls in self.idl.classes:
+                lines.extend(self._generate_class_types(cls))
+            lines.append(f"#endif // {guard}")
+            files[internal] = "\n".join(lines) + "\n"
+
+            for cls in self.idl.classes:
+                lines = [
+                    "// AUTO-GENERATED - DO NOT EDIT",
+                    f'#include "{internal}"',
+                    f'#include "{ns}_c_api_{cls.name}.h"',
+                    "",
+                    f"using namespace {self._helpers_namespace()};",
+                    "",
+                ]
+                files[f"{ns}_c_api_{cls.name}.cpp"] = "\n".join(lines + self._class_functions(cls))
+
+            lines = [
+                "// AUTO-GENERATED - DO NOT EDIT",
+                f'#include "{internal}"',
+                f'#include "{ns}_c_api.h"',
+                "",
+                f"using namespace {self._helpers_namespace()};",
+                "",
+            ]
+            files[f"{ns}_c_api.cpp"] = "\n".join(lines + self._impl_postamble())
+        finally:
+            self._shared_helpers = False
+        return files
+
+    def _impl_preamble(self, impl_header: str, c_header: str = "") -> list[str]:
+        """Includes and file-level helpers that precede the class implementations"""
+        has_async = bool(self._async_methods())
+        headers = ["algorithm", "atomic", "cstdio", "cstring", "memory", "new", "stdexcept", "string", "vector"]
+        if self.pool:
+            headers.append("optional")
+        if has_async:
+            headers += ["chrono", "condition_variable", "deque", "functional", "mutex", "thread"]
+        if self.instrument and not has_async:
+            headers.append("chrono")
         lines = [
             "// AUTO-GENERATED - DO NOT EDIT",
             f'#include "{Path(impl_header).name}"',
-            f'#include "{self.namespace}_c_api.h"',
+            f'#include "{c_header or self.namespace + "_c_api.h"}"',
+            "",
+        ]
+        lines.extend(f"#include <{h}>" for h in sorted(headers))
+        lines.append("")
+        lines.extend(self._error_helpers())
+        lines.extend(self._live_helpers())
+        if self.pool:
+            lines.extend(self._pool_helpers())
+        if self.instrument:
+            lines.extend(self._stats_helpers())
+        if has_async:
+            lines.extend(self._async_helpers())
+        return lines
+
+    def _class_functions(self, cls: Class) -> list[str]:
+        lines = self._generate_class_impl(cls)
+        if not self.instrument:
+            return lines
+        return self._class_stats(cls) + lines
+
+    def _impl_postamble(self) -> list[str]:
+        """Library-wide entry points that follow the class implementations"""
+        lines = self._error_impl()
+        lines.extend(self._live_impl())
+        if self.pool:
+            lines.extend(self._pool_trim_impl())
+        if self.instrument:
+            lines.extend(self._stats_impl())
+        if self._async_methods():
+            lines.extend(self._async_run_impl())
+        lines.extend(self._api_table_impl())
+        return lines
+
+    def _helpers_namespace(self) -> str:
+        return f"{self.namespace}_c_api_detail"
+
+    def _helpers_open(self) -> str:
+        return f"namespace {self._helpers_namespace()} {{" if self._shared_helpers else "namespace {"
+
+    def _helpers_close(self) -> str:
+        return f"}} // namespace {self._helpers_namespace()}" if self._shared_helpers else "} // namespace"
+
+    @property
+    def _inline(self) -> str:
+        """Specifier that keeps one definition of a helper across translation units"""
+        return "inline " if self._shared_helpers else ""
+
+    def _api_entries(self, cls: Optional[Class] = None) -> list[tuple[str, str, str]]:
+        """(return type, name, params) of every class entry point, or only cls's, in header order"""
+        prefix = f"{self.api_macro} "
+        entries = []
+        classes = [cls] if cls else self.idl.classes
+        for line in (decl for c in classes for decl in self._class_func_decls(c)):
+            if not line.startswith(prefix):
+                continue
+            head, params = line[len(prefix):].rstrip(";").split("(", 1)
+            ret, name = head.rsplit(" ", 1)
+            entries.append((ret, name, params[:-1]))
+        return entries
+
+    def _api_error_entries(self) -> list[tuple[str, str, str]]:
+        """The last-error accessors, appended after the class entries so older tables stay a prefix"""
+        ns = self.namespace
+        return [(f"{ns}_error_code", f"{ns}_last_error", "void"),
+                ("const char*", f"{ns}_last_error_message", "void")]
+
+    def _api_table_decls(self) -> list[str]:
+        table = f"{self.namespace}_api"
+        lines = [
+            "/* Every entry point above in one table, so a loader resolves a single symbol.",
+            f"   size is sizeof({table}) as built; reject a table smaller than you expect. */",
+            f"typedef struct {table} {{",
+            "    uint32_t size;",
+        ]
+        lines.extend(f"    {ret} (*{name})({params});"
+                     for ret, name, params in self._api_entries() + self._api_error_entries())
+        lines.extend([
+            f"}} {table};",
+            "",
+            f"{self.api_macro} const {table}* {self.namespace}_get_api(void);",
+            "",
+        ])
+        return lines
+
+    def _api_table_impl(self) -> list[str]:
+        table = f"{self.namespace}_api"
+        lines = [
+            'extern "C" {',
+            "",
+            f"const {table}* {self.namespace}_get_api(void) {{",
+            f"    static const {table} api = {{",
+            f"        static_cast<uint32_t>(sizeof({table})),",
+        ]
+        lines.extend(f"        &{name}," for _, name, _ in self._api_entries() + self._api_error_entries())
+        lines.extend([
+            "    };",
+            "    return &api;",
+            "}",
+            "",
+            '} // extern "C"',
+            "",
+        ])
+        return lines
+
+    def _new(self, type_name: str) -> str:
+        """Allocation expression for a handle or result object"""
+        return f"poolAcquire<{type_name}>()" if self.pool else f"new {type_name}()"
+
+    def _delete(self, var: str) -> str:
+        """Release statement matching _new"""
+        return f"poolRelease({var});" if self.pool else f"delete {var};"
+
+    def _is_refcounted(self, cls: Class) -> bool:
+        """Handles of classes with [async] methods outlive _destroy while a task holds them"""
+        return any(m.has_attribute("async") for m in cls.methods)
+
+    def _last_reference(self, var: str) -> str:
+        """Drops one reference to a counted handle; true for the last one, which frees it"""
+        return f"{var}->refs.fetch_sub(1, std::memory_order_acq_rel) == 1"
+
+    # (suffix, value, meaning) of the codes <namespace>_last_error reports
+    ERROR_CODES = (
+        ("OK", 0, "the last checked call succeeded"),
+        ("ERROR_NULL_ARGUMENT", 1, "a NULL handle, string or array"),
+        ("ERROR_INVALID_ARGUMENT", 2, "a negative size, or the implementation threw std::logic_error"),
+        ("ERROR_OUT_OF_MEMORY", 3, "std::bad_alloc"),
+        ("ERROR_EXCEPTION", 4, "any other exception"),
+    )
+
+    def _error_types(self) -> list[str]:
+        ns = self.namespace
+        lines = [f"typedef enum {ns}_error_code {{"]
+        for i, (suffix, value, meaning) in enumerate(self.ERROR_CODES):
+            comma = "," if i < len(self.ERROR_CODES) - 1 else ""
+            lines.append(f"    {ns.upper()}_{suffix} = {value}{comma}  /* {meaning} */")
+        lines.extend([f"}} {ns}_error_code;", ""])
+        return lines
+
+    def _error_decls(self) -> list[str]:
+        ns = self.namespace
+        return [
+            "/* Per-thread status of the last checked entry point. Methods, constructors and their",
+            "   _batch, _into, _soa, _submit and stream _next variants clear it on entry; on failure",
+            "   they still return the sentinel they always did (-1, 0, NULL or {}), so test the code",
+            "   only after a sentinel. [noexcept] methods, accessors, _free and _destroy leave it as is.",
+            "   The message is valid until this thread's next checked call, and \"\" after a success. */",
+            f"{self.api_macro} {ns}_error_code {ns}_last_error(void);",
+            f"{self.api_macro} const char* {ns}_last_error_message(void);",
+            "",
+        ]
+
+    def _error_helpers(self) -> list[str]:
+        ns = self.namespace.upper()
+        return [
+            self._helpers_open(),
+            "",
+            "struct LastError {",
+            f"    int code = {ns}_OK;",
+            "    char message[256] = {};",
+            "};",
             "",
-            "#include <memory>",
+            f"{self._inline}LastError& lastError() {{",
+            "    thread_local LastError error;",
+            "    return error;",
+            "}",
+            "",
+            f"{self._inline}void clearLastError() {{",
+            "    auto& error = lastError();",
+            f"    error.code = {ns}_OK;",
+            "    error.message[0] = '\\0';",
+            "}",
+            "",
+            f"{self._inline}void setLastError(int code, const char* message) {{",
+            "    auto& error = lastError();",
+            "    error.code = code;",
+            "    std::strncpy(error.message, message, sizeof(error.message) - 1);",
+            "    error.message[sizeof(error.message) - 1] = '\\0';",
+            "}",
+            "",
+            f"{self._inline}void setLastError(int code, const char* where, const char* what) {{",
+            "    auto& error = lastError();",
+            "    error.code = code;",
+            '    std::snprintf(error.message, sizeof(error.message), "%s: %s", where, what);',
+            "}",
+            "",
+            "// Only valid inside a catch block: maps the exception in flight to a code",
+            f"{self._inline}void setLastErrorFromException(const char* where) {{",
+            "    try {",
+            "        throw;",
+            "    } catch (const std::bad_alloc& e) {",
+            f"        setLastError({ns}_ERROR_OUT_OF_MEMORY, where, e.what());",
+            "    } catch (const std::logic_error& e) {",
+            f"        setLastError({ns}_ERROR_INVALID_ARGUMENT, where, e.what());",
+            "    } catch (const std::exception& e) {",
+            f"        setLastError({ns}_ERROR_EXCEPTION, where, e.what());",
+            "    } catch (...) {",
+            f'        setLastError({ns}_ERROR_EXCEPTION, where, "unknown exception");',
+            "    }",
+            "}",
+            "",
+            self._helpers_close(),
+            "",
+        ]
+
+    def _error_impl(self) -> list[str]:
+        ns = self.namespace
+        return [
+            'extern "C" {',
+            "",
+            f"{ns}_error_code {ns}_last_error(void) {{",
+            f"    return static_cast<{ns}_error_code>(lastError().code);",
+            "}",
+            "",
+            f"const char* {ns}_last_error_message(void) {{",
+            "    return lastError().message;",
+            "}",
+            "",
+            '} // extern "C"',
             "",
         ]
+
+    def _checked(self, name: str, fail: str, checks: list[tuple[str, str, str]], body: list[str],
+                 decls: tuple[str, ...] = (), cleanup: tuple[str, ...] = ()) -> list[str]:
+        """Body of an entry point that reports through the last error: clear it, run checks,
+        a list of (condition, ERROR_CODES suffix, message), then run body inside a try whose
+        catch runs cleanup, records the exception and returns fail. decls go before the try,
+        so cleanup can see them."""
+        ret = f"return {fail};" if fail else "return;"
+        ns = self.namespace.upper()
+        lines = ["    clearLastError();"]
+        for cond, code, message in checks:
+            lines.append(f'    if ({cond}) {{ setLastError({ns}_{code}, "{name}: {message}"); {ret} }}')
+        lines.extend(f"    {d}" for d in decls)
+        lines.append("    try {")
+        lines.extend(f"    {line}" for line in body)
+        lines.append("    } catch (...) {")
+        lines.extend(f"        {c}" for c in cleanup)
+        lines.append(f'        setLastErrorFromException("{name}");')
+        lines.append(f"        {ret}")
+        lines.append("    }")
+        return lines
+
+    def _null_checks(self, params: list[Param]) -> list[tuple[str, str, str]]:
+        """_checked checks for the handle and every string parameter"""
+        checks = [("!handle || !handle->impl", "ERROR_NULL_ARGUMENT", "null handle")]
+        checks += [(f"!{p.name}", "ERROR_NULL_ARGUMENT", f"null {p.name}")
+                   for p in params if TypeMapper.is_string(p.type)]
+        return checks
+
+    def _live_decls(self) -> list[str]:
+        ns = self.namespace
+        return [
+            "/* Handles, results and columns handed out and not yet destroyed or freed.",
+            "   bytes is their own storage and that of their arrays; memory the C++ objects",
+            "   allocate internally is not seen. A garbage-collected binding can compare it",
+            "   against a budget to decide when unreachable wrappers are worth collecting. */",
+            f"typedef struct {ns}_native_memory {{",
+            "    uint64_t objects;",
+            "    uint64_t bytes;",
+            f"}} {ns}_native_memory;",
+            "",
+            f"{self.api_macro} void {ns}_native_memory_usage({ns}_native_memory* out);",
+            "",
+        ]
+
+    def _live_helpers(self) -> list[str]:
+        return [
+            self._helpers_open(),
+            "",
+            "struct LiveMemory {",
+            "    std::atomic<uint64_t> objects{0};",
+            "    std::atomic<uint64_t> bytes{0};",
+            "};",
+            "",
+            f"{self._inline}LiveMemory& liveMemory() {{",
+            "    static LiveMemory memory;",
+            "    return memory;",
+            "}",
+            "",
+            "// Counts an object as it is handed to the caller. Its bytes() is taken again on",
+            "// release, so the object must not grow while the caller holds it.",
+            "template <typename T>",
+            "T* trackLive(T* p) {",
+            "    auto& memory = liveMemory();",
+            "    memory.objects.fetch_add(1, std::memory_order_relaxed);",
+            "    memory.bytes.fetch_add(p->bytes(), std::memory_order_relaxed);",
+            "    return p;",
+            "}",
+            "",
+            "template <typename T>",
+            "void untrackLive(const T* p) {",
+            "    if (!p) return;",
+            "    auto& memory = liveMemory();",
+            "    memory.objects.fetch_sub(1, std::memory_order_relaxed);",
+            "    memory.bytes.fetch_sub(p->bytes(), std::memory_order_relaxed);",
+            "}",
+            "",
+            self._helpers_close(),
+            "",
+        ]
+
+    def _live_impl(self) -> list[str]:
+        ns = self.namespace
+        return [
+            'extern "C" {',
+            "",
+            f"void {ns}_native_memory_usage({ns}_native_memory* out) {{",
+            "    if (!out) return;",
+            "    const auto& memory = liveMemory();",
+            "    out->objects = memory.objects.load(std::memory_order_relaxed);",
+            "    out->bytes = memory.bytes.load(std::memory_order_relaxed);",
+            "}",
+            "",
+            '} // extern "C"',
+            "",
+        ]
+
+    def _pooled_types(self) -> list[str]:
+        types = []
         for cls in self.idl.classes:
-            lines.extend(self._generate_class_impl(cls))
-        return "\n".join(lines)
+            types.append(f"{cls.name}Handle")
+            inners = {TypeMapper.vector_inner(m.return_type) for m in cls.methods
+                      if TypeMapper.is_vector(m.return_type)}
+            types.extend(self._result_struct_name(cls.name, inner) for inner in sorted(inners))
+            types.extend(self._columns_struct_name(cls.name, inner) for inner in self._class_soa_types(cls))
+            types.extend(self._stream_struct_name(cls.name, inner) for inner in self._class_stream_types(cls))
+        return types
+
+    def _pool_decls(self) -> list[str]:
+        return [
+            "/* Frees the handle and result objects cached by the calling thread. */",
+            f"{self.api_macro} void {self.namespace}_pool_trim(void);",
+            "",
+        ]
+
+    def _pool_helpers(self) -> list[str]:
+        return [
+            self._helpers_open(),
+            "",
+            "// Per-thread free list: released objects are reset and parked here, and the",
+            "// next acquire of the same type on the same thread reuses the object itself.",
+            "// A handle holds its object inline and a result keeps its vector's capacity, so",
+            "// a warm create/destroy or [fill] result allocates nothing.",
+            "template <typename T>",
+            "struct FreeList {",
+            "    std::vector<T*> items;",
+            "    // Set once this thread's list is destroyed. A bool has no destructor, so it stays",
+            "    // readable from thread_local destructors that release objects afterwards.",
+            "    static thread_local bool gone;",
+            "",
+            "    void trim() {",
+            "        for (T* p : items) delete p;",
+            "        items.clear();",
+            "    }",
+            "",
+            "    ~FreeList() { trim(); gone = true; }",
+            "};",
+            "",
+            "template <typename T>",
+            "thread_local bool FreeList<T>::gone = false;",
+            "",
+            "template <typename T>",
+            "FreeList<T>& freeList() {",
+            "    thread_local FreeList<T> list;",
+            "    return list;",
+            "}",
+            "",
+            "template <typename T>",
+            "T* poolAcquire() {",
+            "    if (FreeList<T>::gone) return new T();",
+            "    auto& list = freeList<T>();",
+            "    if (list.items.empty()) return new T();",
+            "    T* p = list.items.back();",
+            "    list.items.pop_back();",
+            "    return p;",
+            "}",
+            "",
+            "template <typename T>",
+            "void poolRelease(T* p) {",
+            "    if (!p) return;",
+            "    if (FreeList<T>::gone) {",
+            "        delete p;",
+            "        return;",
+            "    }",
+            "    p->reset();",
+            "    auto& list = freeList<T>();",
+            f"    if (list.items.size() >= {self.POOL_MAX_CACHED}) {{",
+            "        delete p;",
+            "        return;",
+            "    }",
+            "    list.items.push_back(p);",
+            "}",
+            "",
+            "template <typename T>",
+            "void poolTrim() {",
+            "    if (!FreeList<T>::gone) freeList<T>().trim();",
+            "}",
+            "",
+            self._helpers_close(),
+            "",
+        ]
+
+    def _pool_trim_impl(self) -> list[str]:
+        lines = ['extern "C" {', "", f"void {self.namespace}_pool_trim(void) {{"]
+        for t in self._pooled_types():
+            lines.append(f"    poolTrim<{t}>();")
+        lines.extend(["}", "", '} // extern "C"', ""])
+        return lines
+
+    def _stats_decls(self) -> list[str]:
+        ns = self.namespace
+        return [
+            "/* Per entry point counters, kept when the library is generated with --instrument.",
+            "   bytes counts strings, buffers, structs and arrays marshalled in or out; scalars are not counted. */",
+            f"typedef struct {ns}_method_stats {{",
+            '    const char* name;   /* entry point, e.g. "Calculator_add" */',
+            "    uint64_t calls;",
+            "    uint64_t total_ns;",
+            "    uint64_t bytes;",
+            f"}} {ns}_method_stats;",
+            "",
+            "/* Copies up to capacity entries into out and returns the number of entry points.",
+            "   out may be NULL with capacity 0 to query that number. Counters are read one by one,",
+            "   so an entry can be mid-update. Building the library with "
+            f"{ns.upper()}_NO_STATS compiles the hooks out. */",
+            f"{self.api_macro} int {ns}_stats_snapshot({ns}_method_stats* out, int capacity);",
+            f"{self.api_macro} void {ns}_stats_reset(void);",
+            "",
+        ]
+
+    def _stats_classes(self) -> list[Class]:
+        """Classes with at least one entry point, each owning a table of counters"""
+        return [cls for cls in self.idl.classes if self._api_entries(cls)]
+
+    def _stats_helpers(self) -> list[str]:
+        lines = [
+            self._helpers_open(),
+            "",
+            "struct EntryStats {",
+            "    std::atomic<uint64_t> calls{0};",
+            "    std::atomic<uint64_t> ns{0};",
+            "    std::atomic<uint64_t> bytes{0};",
+            "};",
+            "",
+            "// One per class, defined next to the class's entry points",
+            "struct StatsTable {",
+            "    const char* const* names;",
+            "    EntryStats* entries;",
+            "    int count;",
+            "};",
+            "",
+        ]
+        lines.extend(f"extern const StatsTable k{cls.name}Stats;" for cls in self._stats_classes())
+        lines.extend([
+            "",
+            f"#ifndef {self.namespace.upper()}_NO_STATS",
+            "// Adds one call, its duration and its marshalled bytes to an entry's counters on scope exit",
+            "class StatsScope {",
+            "public:",
+            "    explicit StatsScope(EntryStats& entry, uint64_t bytes = 0)",
+            "        : entry_(entry), bytes_(bytes), start_(std::chrono::steady_clock::now()) {}",
+            "    ~StatsScope() {",
+            "        const auto elapsed = std::chrono::steady_clock::now() - start_;",
+            "        entry_.calls.fetch_add(1, std::memory_order_relaxed);",
+            "        entry_.ns.fetch_add(static_cast<uint64_t>(",
+            "            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), std::memory_order_relaxed);",
+            "        entry_.bytes.fetch_add(bytes_, std::memory_order_relaxed);",
+            "    }",
+            "    StatsScope(const StatsScope&) = delete;",
+            "    StatsScope& operator=(const StatsScope&) = delete;",
+            "",
+            "    void add(uint64_t bytes) { bytes_ += bytes; }",
+            "",
+            "private:",
+            "    EntryStats& entry_;",
+            "    uint64_t bytes_;",
+            "    std::chrono::steady_clock::time_point start_;",
+            "};",
+            "#else",
+            "// Hooks compiled out: the snapshot still lists every entry point, with zero counters",
+            "struct StatsScope {",
+            "    explicit StatsScope(EntryStats&, uint64_t = 0) {}",
+            "    void add(uint64_t) {}",
+            "};",
+            "#endif",
+            "",
+            self._helpers_close(),
+            "",
+        ])
+        return lines
+
+    def _class_stats(self, cls: Class) -> list[str]:
+        """The class's counters and names, in the order of its header declarations"""
+        names = [name for _, name, _ in self._api_entries(cls)]
+        if not names:
+            return []
+        lines = [self._helpers_open(), "", f"const char* const k{cls.name}StatsNames[] = {{"]
+        lines.extend(f'    "{name}",' for name in names)
+        lines.extend([
+            "};",
+            f"EntryStats g{cls.name}Stats[{len(names)}];",
+            f"const StatsTable k{cls.name}Stats = {{k{cls.name}StatsNames, g{cls.name}Stats, {len(names)}}};",
+            "",
+            self._helpers_close(),
+            "",
+        ])
+        return lines
 
-    def _header_preamble(self) -> list[str]:
-        guard = f"{self.namespace.upper()}_C_API_H"
+    def _stats_impl(self) -> list[str]:
+        ns = self.namespace
+        lines = [self._helpers_open(), "", "const StatsTable* const kStatsTables[] = {"]
+        lines.extend(f"    &k{cls.name}Stats," for cls in self._stats_classes())
+        lines.extend([
+            "};",
+            "",
+            self._helpers_close(),
+            "",
+            'extern "C" {',
+            "",
+            f"int {ns}_stats_snapshot({ns}_method_stats* out, int capacity) {{",
+            "    if (capacity < 0 || (capacity > 0 && !out)) return -1;",
+            "    int total = 0;",
+            "    for (const StatsTable* table : kStatsTables) {",
+            "        for (int i = 0; i < table->count; ++i, ++total) {",
+            "            if (total >= capacity) continue;",
+            "            const EntryStats& entry = table->entries[i];",
+            "            out[total].name = table->names[i];",
+            "            out[total].calls = entry.calls.load(std::memory_order_relaxed);",
+            "            out[total].total_ns = entry.ns.load(std::memory_order_relaxed);",
+            "            out[total].bytes = entry.bytes.load(std::memory_order_relaxed);",
+            "        }",
+            "    }",
+            "    return total;",
+            "}",
+            "",
+            f"void {ns}_stats_reset(void) {{",
+            "    for (const StatsTable* table : kStatsTables) {",
+            "        for (int i = 0; i < table->count; ++i) {",
+            "            table->entries[i].calls.store(0, std::memory_order_relaxed);",
+            "            table->entries[i].ns.store(0, std::memory_order_relaxed);",
+            "            table->entries[i].bytes.store(0, std::memory_order_relaxed);",
+            "        }",
+            "    }",
+            "}",
+            "",
+            '} // extern "C"',
+            "",
+        ])
+        return lines
+
+    def _entry_open(self, signature: str) -> list[str]:
+        """First lines of an entry point definition; with --instrument they open its StatsScope"""
+        lines = [f"{signature} {{"]
+        if not self.instrument:
+            return lines
+        name = signature.split("(", 1)[0].rsplit(" ", 1)[-1]
+        slot = self._stats_slots().get(name)
+        if slot is not None:
+            cls_name, index, bytes_in = slot
+            args = [f"g{cls_name}Stats[{index}]"] + ([bytes_in] if bytes_in else [])
+            lines.append(f"    StatsScope stats_scope({', '.join(args)});")
+        return lines
+
+    def _stats_slots(self) -> dict[str, tuple[str, int, Optional[str]]]:
+        """Entry point name -> (class, index into its counters, bytes known on entry)"""
+        if self._stats_slot_cache is None:
+            bytes_in = self._stats_input_bytes()
+            self._stats_slot_cache = {name: (cls.name, i, bytes_in.get(name)) for cls in self._stats_classes()
+                                      for i, (_, name, _) in enumerate(self._api_entries(cls))}
+        return self._stats_slot_cache
+
+    def _stats_input_bytes(self) -> dict[str, str]:
+        """Entry point name -> expression for the bytes it marshals that are known on entry"""
+        exprs = {}
+        for cls in self.idl.classes:
+            for method in cls.methods:
+                if method.is_constructor:
+                    continue
+                terms = self._param_byte_terms(method.params)
+                if terms and self._has_into(method):
+                    exprs[f"{cls.name}_{method.name}_into"] = " + ".join(terms)
+                if terms and method.has_attribute("async"):
+                    exprs[f"{cls.name}_{method.name}_submit"] = " + ".join(terms)
+                if terms and method.has_attribute("soa"):
+                    exprs[f"{cls.name}_{method.name}_soa"] = " + ".join(terms)
+                ret = method.return_type.rstrip("*").strip()
+                if self._is_struct_type(ret):
+                    terms.append(f"sizeof(::{ret})")
+                if terms:
+                    exprs[f"{cls.name}_{method.name}"] = " + ".join(terms)
+                if method.has_attribute("batch"):
+                    sizes = [f"sizeof({self._batch_element_type(p.type)})" for p in method.params]
+                    if method.return_type != "void":
+                        sizes.append(f"sizeof({self._batch_element_type(method.return_type)})")
+                    if sizes:
+                        exprs[f"{cls.name}_{method.name}_batch"] = (
+                            f"(batch_size > 0 ? static_cast<uint64_t>(batch_size) * ({' + '.join(sizes)}) : 0)")
+        return exprs
+
+    def _param_byte_terms(self, params: list[Param]) -> list[str]:
+        """Byte counts of the strings, structs and sized buffers among params"""
+        terms = []
+        for i, p in enumerate(params):
+            if p.type == "string":
+                terms.append(f"({p.name} ? std::strlen({p.name}) : 0)")
+            elif self._is_struct_type(p.type):
+                terms.append(f"sizeof(::{p.type})")
+            elif p.is_pointer and p.type in ("uint8_t", "int8_t", "char"):
+                following = params[i + 1] if i + 1 < len(params) else None
+                if following and following.name.lower() in self.BUFFER_LENGTH_NAMES:
+                    terms.append(f"({following.name} > 0 ? static_cast<uint64_t>({following.name}) : 0)")
+        return terms
+
+    def _header_guard(self, suffix: str = "") -> str:
+        return f"{self.namespace.upper()}_C_API{suffix.upper()}_H"
+
+    def _header_preamble(self, guard: str = "") -> list[str]:
+        guard = guard or self._header_guard()
         return [
             "// AUTO-GENERATED - DO NOT EDIT",
             f"#ifndef {guard}",
@@ -61,13 +825,13 @@ class CAPIGenerator:
             "",
         ]
 
-    def _header_postamble(self) -> list[str]:
+    def _header_postamble(self, guard: str = "") -> list[str]:
         return [
             "#ifdef __cplusplus",
             "}",
             "#endif",
             "",
-            f"#endif // {self.namespace.upper()}_C_API_H",
+            f"#endif // {guard or self._header_guard()}",
         ]
 
     def _generate_enums(self) -> list[str]:
@@ -110,50 +874,84 @@ class CAPIGenerator:
         return base
 
     def _generate_callbacks(self) -> list[str]:
-        """Generate callback function pointer typedefs"""
+        """Generate callback function pointer typedefs; the trailing void* is the caller's user_data"""
         lines = []
         for cb in self.idl.callbacks:
-            params = ", ".join(self._callback_param_to_c(p) for p in cb.params) or "void"
+            if cb.has_attribute("batch"):
+                # One call per batch: parallel argument arrays, a result array, then the count
+                params = ", ".join(self._batch_callback_params(cb) + ["void*"])
+                lines.append(f"typedef void (*{cb.name})({params});")
+                continue
+            params = ", ".join([self._callback_param_to_c(p) for p in cb.params] + ["void*"])
             ret = TypeMapper.to_c(cb.return_type)
             lines.append(f"typedef {ret} (*{cb.name})({params});")
         if self.idl.callbacks:
             lines.append("")
         return lines
 
-    def _generate_class_decls(self) -> list[str]:
+    def _class_typedefs(self, cls: Class) -> list[str]:
+        handle = f"{cls.name}Handle"
+        lines = [f"typedef struct {handle} {handle};"]
+
+        # Create result struct typedef per unique vector return type
+        for inner in self._class_result_types(cls):
+            result_name = self._result_struct_name(cls.name, inner)
+            lines.append(f"typedef struct {result_name} {result_name};")
+        for inner in self._class_soa_types(cls):
+            columns_name = self._columns_struct_name(cls.name, inner)
+            lines.append(f"typedef struct {columns_name} {columns_name};")
+        for inner in self._class_stream_types(cls):
+            stream_name = self._stream_struct_name(cls.name, inner)
+            lines.append(f"typedef struct {stream_name} {stream_name};")
+
+        lines.append("")
+        return lines
+
+    def _class_func_decls(self, cls: Class) -> list[str]:
         lines = []
-        for cls in self.idl.classes:
-            handle = f"{cls.name}Handle"
-
-            lines.append(f"typedef struct {handle} {handle};")
-            
-            # Create result struct typedef per unique vector return type
-            vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-            result_types = set()
-            for m in vec_methods:
-                inner = TypeMapper.vector_inner(m.return_type)
-                result_types.add(inner)
-            
-            for inner in sorted(result_types):
-                result_name = self._result_struct_name(cls.name, inner)
-                lines.append(f"typedef struct {result_name} {result_name};")
-            
-            lines.append("")
+        for method in cls.methods:
+            lines.extend(self._method_decl(cls, method))
+            if method.has_attribute("batch"):
+                lines.append(f"{self.api_macro} {self._batch_signature(cls, method)};")
+            if self._has_into(method):
+                lines.append(f"{self.api_macro} {self._into_signature(cls, method)};")
+            if method.has_attribute("async"):
+                lines.append(self._async_done_typedef(cls, method))
+                lines.append(f"{self.api_macro} {self._submit_signature(cls, method)};")
+            if method.has_attribute("soa"):
+                lines.append(f"{self.api_macro} {self._soa_signature(cls, method)};")
 
-            for method in cls.methods:
-                lines.extend(self._method_decl(cls, method))
+        # Result accessors per unique vector element type
+        for inner in self._class_result_types(cls):
+            result_name = self._result_struct_name(cls.name, inner)
+            lines.append(f"{self.api_macro} int {result_name}_getCount(const {result_name}* result);")
+            lines.append(f"{self.api_macro} const {inner}* {result_name}_getData(const {result_name}* result);")
+            lines.append(f"{self.api_macro} void {result_name}_free({result_name}* result);")
 
-            # Result accessors per unique vector element type
-            for inner in sorted(result_types):
-                result_name = self._result_struct_name(cls.name, inner)
-                lines.append(f"{self.api_macro} int {result_name}_getCount(const {result_name}* result);")
-                lines.append(f"{self.api_macro} const {inner}* {result_name}_getData(const {result_name}* result);")
-                lines.append(f"{self.api_macro} void {result_name}_free({result_name}* result);")
+        # Column accessors per [soa] element type
+        for inner in self._class_soa_types(cls):
+            columns_name = self._columns_struct_name(cls.name, inner)
+            lines.append(f"{self.api_macro} int {columns_name}_getCount(const {columns_name}* columns);")
+            for m in self.idl.symbols.structs[inner].members:
+                lines.append(f"{self.api_macro} const {TypeMapper.to_c(m.type)}* "
+                             f"{columns_name}_{self._column_getter(m)}(const {columns_name}* columns);")
+            lines.append(f"{self.api_macro} void {columns_name}_free({columns_name}* columns);")
 
-            for member in cls.members:
-                lines.append(self._attr_getter_decl(cls, member))
+        # Pull functions per stream<T> element type
+        for inner in self._class_stream_types(cls):
+            stream_name = self._stream_struct_name(cls.name, inner)
+            c_inner = TypeMapper.to_c(inner)
+            lines.extend([
+                "/* Copies the next items, at most max (> 0), into out: returns how many, 0 once the",
+                "   stream is exhausted, -1 on a bad argument. Free the stream before its object. */",
+                f"{self.api_macro} int {stream_name}_next({stream_name}* stream, {c_inner}* out, int max);",
+                f"{self.api_macro} void {stream_name}_free({stream_name}* stream);",
+            ])
 
-            lines.append("")
+        for member in cls.members:
+            lines.append(self._attr_getter_decl(cls, member))
+
+        lines.append("")
         return lines
 
     def _result_struct_name(self, class_name: str, inner_type: str) -> str:
@@ -161,6 +959,25 @@ class CAPIGenerator:
         Uses underscores and _C suffix to avoid collisions with client wrapper classes."""
         return f"{class_name}_{inner_type}_CResult"
 
+    def _columns_struct_name(self, class_name: str, inner_type: str) -> str:
+        """Struct-of-arrays counterpart of _result_struct_name for [soa] methods"""
+        return f"{class_name}_{inner_type}_CColumns"
+
+    def _column_getter(self, member: Member) -> str:
+        return f"get{member.name[0].upper()}{member.name[1:]}Column"
+
+    def _class_soa_types(self, cls: Class) -> list[str]:
+        """Element types of the class's [soa] returns, one columns struct each"""
+        return self.idl.symbols.soa_types[cls.name]
+
+    def _stream_struct_name(self, class_name: str, inner_type: str) -> str:
+        """Pull iterator of a stream<T> method, named like _result_struct_name"""
+        return f"{class_name}_{inner_type}_CStream"
+
+    def _class_stream_types(self, cls: Class) -> list[str]:
+        """Element types of the class's stream<T> returns, one stream struct each"""
+        return self.idl.symbols.stream_types[cls.name]
+
     def _method_decl(self, cls: Class, method: Method) -> list[str]:
         h = f"{cls.name}Handle"
         prefix = cls.name
@@ -183,57 +1000,164 @@ class CAPIGenerator:
         getter = self._getter_name(member)
         return f"{self.api_macro} {ret} {cls.name}_{getter}({h}* handle);"
 
-    def _generate_class_impl(self, cls: Class) -> list[str]:
+    def _class_result_types(self, cls: Class) -> list[str]:
+        """Element types of the class's vector returns, one result struct each"""
+        return self.idl.symbols.result_types[cls.name]
+
+    def _generate_class_types(self, cls: Class) -> list[str]:
         h = f"{cls.name}Handle"
         cpp_class = f"{self.namespace}::{cls.name}"
         lines = []
 
-        # Check if any method returns string
-        has_string_return = any(m.return_type == "string" for m in cls.methods if not m.is_constructor)
-
         # Handle struct
+        counted = self._is_refcounted(cls)
         lines.append(f"struct {h} {{")
-        lines.append(f"    std::unique_ptr<{cpp_class}> impl;")
-        if has_string_return:
-            lines.append("    std::string last_string;")
+        if self.pool:
+            # Inline, so a recycled handle constructs its object without a heap allocation
+            lines.append(f"    std::optional<{cpp_class}> impl;")
+        else:
+            lines.append(f"    std::unique_ptr<{cpp_class}> impl;")
+        if counted:
+            lines.append("    // One reference for the caller, plus one per queued _submit task")
+            lines.append("    std::atomic<int> refs{1};")
+        if self.pool:
+            lines.append("    uint64_t bytes() const { return sizeof(*this); }")
+            reset = "impl.reset(); refs.store(1, std::memory_order_relaxed);" if counted else "impl.reset();"
+            lines.append(f"    void reset() {{ {reset} }}")
+        else:
+            lines.append("    uint64_t bytes() const { return sizeof(*this) + (impl ? sizeof(*impl) : 0); }")
         lines.append("};")
         lines.append("")
 
         # Result struct per unique vector element type
-        vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-        result_types = set()
-        for m in vec_methods:
-            inner = TypeMapper.vector_inner(m.return_type)
-            result_types.add(inner)
-        
-        for inner in sorted(result_types):
+        for inner in self._class_result_types(cls):
             result_name = self._result_struct_name(cls.name, inner)
             cpp_inner = TypeMapper.to_cpp(inner)
             lines.append(f"struct {result_name} {{")
             lines.append(f"    std::vector<{cpp_inner}> data;")
+            lines.append(f"    uint64_t bytes() const {{ return sizeof(*this) + data.capacity() * sizeof({cpp_inner}); }}")
+            if self.pool:
+                lines.append("    void reset() { data.clear(); }  // keeps the capacity for the next result")
             lines.append("};")
             lines.append("")
 
-        lines.append('extern "C" {')
-        lines.append("")
+        # Columns struct per [soa] element type: one contiguous array per member
+        for inner in self._class_soa_types(cls):
+            lines.append(f"struct {self._columns_struct_name(cls.name, inner)} {{")
+            lines.append("    int count = 0;")
+            members = self.idl.symbols.structs[inner].members
+            for m in members:
+                lines.append(f"    std::vector<{TypeMapper.to_c(m.type)}> {m.name};")
+            lines.append("    uint64_t bytes() const {")
+            lines.append("        return sizeof(*this)")
+            for m in members:
+                lines.append(f"            + {m.name}.capacity() * sizeof({TypeMapper.to_c(m.type)})")
+            lines[-1] += ";"
+            lines.append("    }")
+            if self.pool:
+                lines.append("    void reset() {")
+                lines.append("        count = 0;")
+                lines.extend(f"        {m.name}.clear();" for m in members)
+                lines.append("    }")
+            lines.append("};")
+            lines.append("")
+
+        # Stream struct per stream<T> element type: the implementation's pull source
+        for inner in self._class_stream_types(cls):
+            cpp_inner = TypeMapper.to_cpp(inner)
+            lines.append(f"struct {self._stream_struct_name(cls.name, inner)} {{")
+            lines.append(f"    {TypeMapper.to_cpp(f'stream<{inner}>')} source;")
+            lines.append("    uint64_t bytes() const { return sizeof(*this); }")
+            if self.pool:
+                lines.append("    void reset() { source = nullptr; }")
+            lines.append("};")
+            lines.append("")
+        return lines
+
+    def _generate_class_impl(self, cls: Class) -> list[str]:
+        cpp_class = f"{self.namespace}::{cls.name}"
+        lines = ['extern "C" {', ""]
 
         for method in cls.methods:
             lines.extend(self._method_impl(cls, method, cpp_class))
+            if method.has_attribute("batch"):
+                lines.extend(self._batch_impl(cls, method))
+            if self._has_into(method):
+                lines.extend(self._into_impl(cls, method))
+            if method.has_attribute("async"):
+                lines.extend(self._submit_impl(cls, method))
+            if method.has_attribute("soa"):
+                lines.extend(self._soa_impl(cls, method))
 
         # Result accessors per unique vector element type
-        for inner in sorted(result_types):
+        for inner in self._class_result_types(cls):
             result_name = self._result_struct_name(cls.name, inner)
             lines.extend([
-                f"int {result_name}_getCount(const {result_name}* result) {{",
+                *self._entry_open(f"int {result_name}_getCount(const {result_name}* result)"),
                 "    return result ? static_cast<int>(result->data.size()) : -1;",
                 "}",
                 "",
-                f"const {inner}* {result_name}_getData(const {result_name}* result) {{",
+                *self._entry_open(f"const {inner}* {result_name}_getData(const {result_name}* result)"),
                 "    return (result && !result->data.empty()) ? result->data.data() : nullptr;",
                 "}",
                 "",
-                f"void {result_name}_free({result_name}* result) {{",
-                "    delete result;",
+                *self._entry_open(f"void {result_name}_free({result_name}* result)"),
+                "    untrackLive(result);",
+                f"    {self._delete('result')}",
+                "}",
+                "",
+            ])
+
+        # Column accessors per [soa] element type
+        for inner in self._class_soa_types(cls):
+            columns_name = self._columns_struct_name(cls.name, inner)
+            lines.extend([
+                *self._entry_open(f"int {columns_name}_getCount(const {columns_name}* columns)"),
+                "    return columns ? columns->count : -1;",
+                "}",
+                "",
+            ])
+            for m in self.idl.symbols.structs[inner].members:
+                lines.extend([
+                    *self._entry_open(f"const {TypeMapper.to_c(m.type)}* {columns_name}_{self._column_getter(m)}(const {columns_name}* columns)"),
+                    f"    return (columns && columns->count > 0) ? columns->{m.name}.data() : nullptr;",
+                    "}",
+                    "",
+                ])
+            lines.extend([
+                *self._entry_open(f"void {columns_name}_free({columns_name}* columns)"),
+                "    untrackLive(columns);",
+                f"    {self._delete('columns')}",
+                "}",
+                "",
+            ])
+
+        # Pull functions per stream<T> element type
+        for inner in self._class_stream_types(cls):
+            stream_name = self._stream_struct_name(cls.name, inner)
+            lines.extend([
+                *self._entry_open(f"int {stream_name}_next({stream_name}* stream, {TypeMapper.to_c(inner)}* out, int max)"),
+            ])
+            body = [
+                "    if (!stream->source) return 0;",
+                "    const size_t n = std::min(stream->source(out, static_cast<size_t>(max)), static_cast<size_t>(max));",
+                "    // Exhausted: drop the source's captured state now rather than at _free",
+                "    if (n == 0) stream->source = nullptr;",
+            ]
+            if self.instrument:
+                body.append(f"    stats_scope.add(n * sizeof({TypeMapper.to_cpp(inner)}));")
+            body.append("    return static_cast<int>(n);")
+            checks = [
+                ("!stream || !out", "ERROR_NULL_ARGUMENT", "null stream or out"),
+                ("max <= 0", "ERROR_INVALID_ARGUMENT", "max must be positive"),
+            ]
+            lines.extend(self._checked(f"{stream_name}_next", "-1", checks, body))
+            lines.extend([
+                "}",
+                "",
+                *self._entry_open(f"void {stream_name}_free({stream_name}* stream)"),
+                "    untrackLive(stream);",
+                f"    {self._delete('stream')}",
                 "}",
                 "",
             ])
@@ -252,38 +1176,41 @@ class CAPIGenerator:
 
         if method.is_constructor:
             c_params = self._c_params_str(method.params)
-            lines.append(f"{h}* {prefix}_create({c_params}) {{")
+            lines.extend(self._entry_open(f"{h}* {prefix}_create({c_params})"))
 
-            for p in method.params:
-                if TypeMapper.is_string(p.type):
-                    lines.append(f"    if (!{p.name}) return nullptr;")
-
-            lines.append("    try {")
-            lines.append(f"        auto handle = new {h}();")
+            checks = [(f"!{p.name}", "ERROR_NULL_ARGUMENT", f"null {p.name}")
+                      for p in method.params if TypeMapper.is_string(p.type)]
             cpp_args = ", ".join(p.name for p in method.params)
-            lines.append(f"        handle->impl = std::make_unique<{cpp_class}>({cpp_args});")
-            lines.append("        return handle;")
-            lines.append("    } catch (...) { return nullptr; }")
+            body = [
+                f"    handle = {self._new(h)};",
+                (f"    handle->impl.emplace({cpp_args});" if self.pool
+                 else f"    handle->impl = std::make_unique<{cpp_class}>({cpp_args});"),
+                "    return trackLive(handle);",
+            ]
+            lines.extend(self._checked(f"{prefix}_create", "nullptr", checks, body,
+                                       decls=(f"{h}* handle = nullptr;",), cleanup=(self._delete("handle"),)))
             lines.append("}")
             lines.append("")
 
-            lines.append(f"void {prefix}_destroy({h}* handle) {{")
-            lines.append("    delete handle;")
+            lines.extend(self._entry_open(f"void {prefix}_destroy({h}* handle)"))
+            lines.append("    untrackLive(handle);")
+            if self._is_refcounted(cls):
+                # A queued _submit task may still hold the handle; it frees it once done returns
+                lines.append(f"    if (handle && {self._last_reference('handle')}) {self._delete('handle')}")
+            else:
+                lines.append(f"    {self._delete('handle')}")
             lines.append("}")
             lines.append("")
         else:
             ret = self._c_return_type_for_method(cls.name, method.return_type)
             params = [f"{h}* handle"] + [self._param_to_c(p) for p in method.params]
 
-            lines.append(f"{ret} {prefix}_{method.name}({', '.join(params)}) {{")
-
-            null_checks = ["!handle", "!handle->impl"]
-            for p in method.params:
-                if TypeMapper.is_string(p.type):
-                    null_checks.append(f"!{p.name}")
+            lines.extend(self._entry_open(f"{ret} {prefix}_{method.name}({', '.join(params)})"))
 
             # Determine appropriate null/error return value
-            if ret.endswith("*"):
+            if ret == "void":
+                null_ret = ""
+            elif ret.endswith("*"):
                 null_ret = "nullptr"
             elif ret == "int":
                 null_ret = "-1"
@@ -294,66 +1221,473 @@ class CAPIGenerator:
             else:
                 # Struct type - return empty struct
                 null_ret = "{}"
-            lines.append(f"    if ({' || '.join(null_checks)}) return {null_ret};")
 
             # Convert parameters for C++ call
             cpp_args = self._build_cpp_args(method.params)
-            
-            if TypeMapper.is_vector(method.return_type):
+            call = f"handle->impl->{method.name}({cpp_args})"
+            decls, cleanup = (), ()
+
+            if TypeMapper.is_stream(method.return_type):
+                stream_name = self._stream_struct_name(cls.name, TypeMapper.stream_inner(method.return_type))
+                decls, cleanup = (f"{stream_name}* stream = nullptr;",), (self._delete("stream"),)
+                body = [
+                    f"    stream = {self._new(stream_name)};",
+                    f"    stream->source = {call};",
+                    "    return trackLive(stream);",
+                ]
+            elif TypeMapper.is_vector(method.return_type):
                 inner = TypeMapper.vector_inner(method.return_type)
                 result_name = self._result_struct_name(cls.name, inner)
-                lines.append(f"    auto result = new {result_name}();")
-                lines.append(f"    result->data = handle->impl->{method.name}({cpp_args});")
-                lines.append("    return result;")
+                decls, cleanup = (f"{result_name}* result = nullptr;",), (self._delete("result"),)
+                if self.pool and method.has_attribute("fill"):
+                    # Fill the recycled result's buffer, growing it only when the result does not fit
+                    fill = f"handle->impl->{method.name}Fill({', '.join(a for a in (cpp_args, 'data.data()') if a)}"
+                    body = [
+                        f"    result = {self._new(result_name)};",
+                        "    auto& data = result->data;",
+                        "    data.resize(data.capacity());",
+                        f"    const int total = {fill}, static_cast<int>(data.size()));",
+                        "    if (total > static_cast<int>(data.size())) {",
+                        "        data.resize(total);",
+                        f"        {fill}, total);",
+                        "    }",
+                        "    data.resize(total);",
+                    ]
+                else:
+                    body = [
+                        f"    result = {self._new(result_name)};",
+                        f"    result->data = {call};",
+                    ]
+                if self.instrument:
+                    body.append(f"    stats_scope.add(result->data.size() * sizeof({TypeMapper.to_cpp(inner)}));")
+                body.append("    return trackLive(result);")
             elif method.return_type == "string":
-                # Store string in handle to keep it alive
-                lines.append(f"    handle->last_string = handle->impl->{method.name}({cpp_args});")
-                lines.append("    return handle->last_string.c_str();")
-            elif method.return_type.endswith('*'):
-                # Pointer return - check if it's a class type
+                # Per-thread, per-function storage: valid until this thread calls the function again
+                decls = ("thread_local std::string result;",)
+                body = [f"    result = {call};"]
+                if self.instrument:
+                    body.append("    stats_scope.add(result.size());")
+                body.append("    return result.c_str();")
+            elif method.return_type.endswith('*') and self._is_class_type(method.return_type.rstrip('*').strip()):
+                # Wrap the returned class pointer in a handle, owning it before the handle is allocated
                 base_type = method.return_type.rstrip('*').strip()
-                if self._is_class_type(base_type):
-                    # Wrap returned class pointer in a handle
-                    handle_type = f"{base_type}Handle"
-                    lines.append(f"    auto* obj = handle->impl->{method.name}({cpp_args});")
-                    lines.append(f"    if (!obj) return nullptr;")
-                    lines.append(f"    auto* result = new {handle_type}();")
-                    lines.append(f"    result->impl = std::unique_ptr<{self.namespace}::{base_type}>(obj);")
-                    lines.append("    return result;")
-                else:
-                    lines.append(f"    return handle->impl->{method.name}({cpp_args});")
+                body = [
+                    f"    std::unique_ptr<{self.namespace}::{base_type}> obj({call});",
+                    "    if (!obj) return nullptr;",
+                    f"    auto* result = {self._new(base_type + 'Handle')};",
+                    # Pooled handles hold the object inline, so the returned one is moved in
+                    "    result->impl.emplace(std::move(*obj));" if self.pool else "    result->impl = std::move(obj);",
+                    "    return trackLive(result);",
+                ]
+            else:
+                body = [f"    return {call};"]
+
+            if method.has_attribute("noexcept"):
+                # Known not to throw and called with valid arguments: no checks, no try
+                lines.extend(body)
             else:
-                lines.append(f"    return handle->impl->{method.name}({cpp_args});")
+                lines.extend(self._checked(f"{prefix}_{method.name}", null_ret, self._null_checks(method.params),
+                                           body, decls, cleanup))
 
             lines.append("}")
             lines.append("")
 
         return lines
 
-    def _get_callback(self, type_name: str):
-        """Get callback definition by name"""
-        return next((cb for cb in self.idl.callbacks if cb.name == type_name), None)
+    def _check_batchable(self, cls: Class, method: Method):
+        """Batch variants only support by-value scalars, enums and structs"""
+        where = f"{cls.name}.{method.name}"
+        if method.is_constructor:
+            raise ValueError(f"[batch] is not supported on constructors ({where})")
+        ret = method.return_type
+        if TypeMapper.is_vector(ret) or ret == "string" or ret.endswith("*") or self._is_class_type(ret):
+            raise ValueError(f"[batch] requires a scalar, enum, struct or void return type ({where})")
+        for p in method.params:
+            if (p.is_pointer or p.type == "string" or TypeMapper.is_vector(p.type)
+                    or self._is_callback_type(p.type) or self._is_class_type(p.type)):
+                raise ValueError(f"[batch] parameter '{p.name}' must be a scalar, enum or struct ({where})")
 
-    def _needs_callback_wrapper(self, cb) -> bool:
-        """Check if callback needs a wrapper (has struct reference params)"""
+    # Element types a [batch] callback can take and return
+    BATCH_CALLBACK_TYPES = ("int", "bool", "float", "double")
+
+    def _check_batch_callback(self, cb):
+        if not cb.params:
+            raise ValueError(f"[batch] callback needs at least one parameter ({cb.name})")
         for p in cb.params:
-            if self._is_struct_type(p.type) and p.is_reference:
-                return True
-        return False
+            if p.type not in self.BATCH_CALLBACK_TYPES or p.is_pointer or p.is_reference:
+                raise ValueError(f"[batch] callback parameter '{p.name}' must be int, bool, float or double ({cb.name})")
+        if cb.return_type != "void" and cb.return_type not in self.BATCH_CALLBACK_TYPES:
+            raise ValueError(f"[batch] callback must return void, int, bool, float or double ({cb.name})")
+
+    def _batch_callback_params(self, cb) -> list[str]:
+        """C parameter types of a [batch] callback, without the trailing user_data"""
+        self._check_batch_callback(cb)
+        params = [f"const {self._batch_element_type(p.type)}*" for p in cb.params]
+        if cb.return_type != "void":
+            params.append(f"{self._batch_element_type(cb.return_type)}*")
+        return params + ["int"]
+
+    def _batch_element_type(self, idl_type: str) -> str:
+        """C element type used for batch input/output arrays"""
+        if idl_type == "bool":
+            return "int"
+        return TypeMapper.to_c(idl_type)
+
+    def _batch_signature(self, cls: Class, method: Method) -> str:
+        """Signature of <Class>_<method>_batch: one input array per parameter plus an output array"""
+        self._check_batchable(cls, method)
+        params = [f"{cls.name}Handle* handle"]
+        params += [f"const {self._batch_element_type(p.type)}* {p.name}" for p in method.params]
+        if method.return_type != "void":
+            params.append(f"{self._batch_element_type(method.return_type)}* out")
+        params.append("int batch_size")
+        return f"int {cls.name}_{method.name}_batch({', '.join(params)})"
+
+    def _batch_impl(self, cls: Class, method: Method) -> list[str]:
+        """Batch entry point: validates once, then loops over the arrays on the native side"""
+        arrays = [p.name for p in method.params]
+        if method.return_type != "void":
+            arrays.append("out")
+
+        checks = [
+            ("!handle || !handle->impl", "ERROR_NULL_ARGUMENT", "null handle"),
+            ("batch_size < 0", "ERROR_INVALID_ARGUMENT", "negative batch_size"),
+        ]
+        if arrays:
+            missing = " || ".join(f"!{a}" for a in arrays)
+            checks.append((f"batch_size > 0 && ({missing})", "ERROR_NULL_ARGUMENT", "null array"))
+        if method.has_attribute("kernel"):
+            # The class supplies <method>Batch over the same arrays, e.g. a SIMD kernel
+            kernel_args = ", ".join(arrays + ["batch_size"])
+            body = [f"    handle->impl->{method.name}Batch({kernel_args});"]
+        else:
+            call = f"impl.{method.name}({', '.join(f'{p.name}[i]' for p in method.params)})"
+            if method.return_type == "void":
+                element = f"{call};"
+            elif method.return_type == "bool":
+                element = f"out[i] = {call} ? 1 : 0;"
+            else:
+                element = f"out[i] = {call};"
+            body = [
+                "    auto& impl = *handle->impl;",
+                "    for (int i = 0; i < batch_size; ++i) {",
+                f"        {element}",
+                "    }",
+            ]
+        body.append("    return batch_size;")
+        lines = self._entry_open(self._batch_signature(cls, method))
+        lines.extend(self._checked(f"{cls.name}_{method.name}_batch", "-1", checks, body))
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _soa_signature(self, cls: Class, method: Method) -> str:
+        """Signature of <Class>_<method>_soa: the vector<struct> result transposed into columns"""
+        columns_name = self._columns_struct_name(cls.name, TypeMapper.vector_inner(method.return_type))
+        params = [f"{cls.name}Handle* handle"] + [self._param_to_c(p) for p in method.params]
+        return f"{columns_name}* {cls.name}_{method.name}_soa({', '.join(params)})"
+
+    def _soa_impl(self, cls: Class, method: Method) -> list[str]:
+        """Transposes the C++ result once, so a scan over one member reads only that column"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        members = self.idl.symbols.structs[inner].members
+        columns_name = self._columns_struct_name(cls.name, inner)
+        body = [f"    const auto items = handle->impl->{method.name}({self._build_cpp_args(method.params)});"]
+        body.append(f"    columns = {self._new(columns_name)};")
+        body.append("    columns->count = static_cast<int>(items.size());")
+        for m in members:
+            body.append(f"    columns->{m.name}.resize(items.size());")
+        body.append("    for (size_t i = 0; i < items.size(); ++i) {")
+        for m in members:
+            value = f"items[i].{m.name}"
+            if m.type == "bool":
+                value = f"{value} ? 1 : 0"
+            body.append(f"        columns->{m.name}[i] = {value};")
+        body.append("    }")
+        if self.instrument:
+            body.append(f"    stats_scope.add(items.size() * sizeof({TypeMapper.to_cpp(inner)}));")
+        body.append("    return trackLive(columns);")
+        lines = self._entry_open(self._soa_signature(cls, method))
+        lines.extend(self._checked(f"{cls.name}_{method.name}_soa", "nullptr", self._null_checks(method.params), body,
+                                   decls=(f"{columns_name}* columns = nullptr;",), cleanup=(self._delete("columns"),)))
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _has_into(self, method: Method) -> bool:
+        """Vector and string returns get an _into variant writing to caller-owned memory"""
+        return TypeMapper.is_vector(method.return_type) or method.return_type == "string"
+
+    def _into_signature(self, cls: Class, method: Method) -> str:
+        """Signature of <Class>_<method>_into: fills a caller-owned buffer instead of allocating a result"""
+        if method.return_type == "string":
+            elem = "char"
+        else:
+            elem = TypeMapper.to_c(TypeMapper.vector_inner(method.return_type))
+        params = [f"{cls.name}Handle* handle"] + [self._param_to_c(p) for p in method.params]
+        params += [f"{elem}* out", "int capacity"]
+        return f"int {cls.name}_{method.name}_into({', '.join(params)})"
+
+    def _into_impl(self, cls: Class, method: Method) -> list[str]:
+        """Copy up to capacity elements into out and return the total element count.
+        A return value larger than capacity tells the caller to grow the buffer and retry;
+        out may be NULL with capacity 0 to query the size."""
+        checks = self._null_checks(method.params) + [
+            ("capacity < 0", "ERROR_INVALID_ARGUMENT", "negative capacity"),
+            ("capacity > 0 && !out", "ERROR_NULL_ARGUMENT", "null out"),
+        ]
+        name = f"{cls.name}_{method.name}_into"
+        cpp_args = self._build_cpp_args(method.params)
+        if method.return_type == "string":
+            # Strings report their length without the terminator and are always NUL-terminated
+            body = [
+                f"    auto text = handle->impl->{method.name}({cpp_args});",
+                "    const int total = static_cast<int>(text.size());",
+                "    if (capacity > 0) {",
+                "        const int written = total < capacity ? total : capacity - 1;",
+                "        std::copy_n(text.data(), written, out);",
+                "        out[written] = '\\0';",
+                *(["        stats_scope.add(static_cast<uint64_t>(written));"] if self.instrument else []),
+                "    }",
+                "    return total;",
+            ]
+        elif method.has_attribute("fill"):
+            # The class writes straight into out: no vector, no copy
+            fill_args = ", ".join(a for a in (cpp_args, "out", "capacity") if a)
+            body = [
+                f"    const int total = handle->impl->{method.name}Fill({fill_args});",
+                *([f"    stats_scope.add(static_cast<uint64_t>(total < capacity ? total : capacity) * sizeof(*out));"]
+                  if self.instrument else []),
+                "    return total;",
+            ]
+        else:
+            body = [
+                f"    auto items = handle->impl->{method.name}({cpp_args});",
+                "    const int total = static_cast<int>(items.size());",
+                "    std::copy_n(items.begin(), total < capacity ? total : capacity, out);",
+                *([f"    stats_scope.add(static_cast<uint64_t>(total < capacity ? total : capacity) * sizeof(*out));"]
+                  if self.instrument else []),
+                "    return total;",
+            ]
+        return [*self._entry_open(self._into_signature(cls, method)), *self._checked(name, "-1", checks, body), "}", ""]
+
+    def _async_methods(self) -> list[tuple[Class, Method]]:
+        return [(cls, m) for cls in self.idl.classes for m in cls.methods if m.has_attribute("async")]
+
+    def _async_decls(self) -> list[str]:
+        return [
+            "/* Runs task(arg) on the worker pool behind the *_submit entry points; 0 on success,",
+            "   -1 with the last error set if the task was not queued. */",
+            f"{self.api_macro} int {self.namespace}_run_async(void (*task)(void* arg), void* arg);",
+            "/* Runs every task queued so far, then stops the pool's threads. Later submits fail.",
+            "   Without it, tasks still queued when the process exits are dropped. */",
+            f"{self.api_macro} void {self.namespace}_async_shutdown(void);",
+            "",
+        ]
+
+    def _async_helpers(self) -> list[str]:
+        return [
+            self._helpers_open(),
+            "",
+            "// Fixed-size pool shared by every *_submit entry point, started on first use.",
+            "// shutdown() drains the queue and joins the threads.",
+            "class WorkerPool {",
+            "public:",
+            "    WorkerPool() {",
+            "        const unsigned count = std::max(2u, std::thread::hardware_concurrency());",
+            "        for (unsigned i = 0; i < count; ++i) {",
+            "            threads_.emplace_back([this] { run(); });",
+            "        }",
+            "    }",
+            "",
+            "    void shutdown() {",
+            "        {",
+            "            std::lock_guard<std::mutex> lock(mutex_);",
+            "            if (stopping_) return;",
+            "            stopping_ = true;",
+            "        }",
+            "        wake_.notify_all();",
+            "        for (auto& t : threads_) {",
+            "            // Called from a task: that worker leaves its loop once the queue is empty",
+            "            if (t.get_id() == std::this_thread::get_id()) t.detach();",
+            "            else t.join();",
+            "        }",
+            "    }",
+            "",
+            "    // False once shutdown() has started",
+            "    bool submit(std::function<void()> task) {",
+            "        {",
+            "            std::lock_guard<std::mutex> lock(mutex_);",
+            "            if (stopping_) return false;",
+            "            tasks_.push_back(std::move(task));",
+            "        }",
+            "        wake_.notify_one();",
+            "        return true;",
+            "    }",
+            "",
+            "private:",
+            "    void run() {",
+            "        for (;;) {",
+            "            std::function<void()> task;",
+            "            {",
+            "                std::unique_lock<std::mutex> lock(mutex_);",
+            "                // Not wait(): libstdc++ 12 exports it as condition_variable::wait@GLIBCXX_3.4.30,",
+            "                // which older runtimes (conda, a JVM's) lack. The timed form is header-only.",
+            "                const auto ready = [this] { return stopping_ || !tasks_.empty(); };",
+            "                while (!wake_.wait_for(lock, std::chrono::hours(1), ready)) {}",
+            "                if (tasks_.empty()) return;",
+            "                task = std::move(tasks_.front());",
+            "                tasks_.pop_front();",
+            "            }",
+            "            // A throwing task must not take the worker down",
+            "            try { task(); } catch (...) {}",
+            "        }",
+            "    }",
+            "",
+            "    std::mutex mutex_;",
+            "    std::condition_variable wake_;",
+            "    std::deque<std::function<void()>> tasks_;",
+            "    std::vector<std::thread> threads_;",
+            "    bool stopping_ = false;",
+            "};",
+            "",
+            "// Never destroyed: joining threads from a static destructor would race the other",
+            "// statics the tasks use, and hang if the library is unloaded with tasks queued.",
+            f"{self._inline}WorkerPool& workerPool() {{",
+            "    static WorkerPool* pool = new WorkerPool();",
+            "    return *pool;",
+            "}",
+            "",
+            "// 0 once the task is queued, else -1 with the last error set",
+            f"{self._inline}int runAsync(const char* where, std::function<void()> task) {{",
+            "    try {",
+            "        if (workerPool().submit(std::move(task))) return 0;",
+            f'        setLastError({self.namespace.upper()}_ERROR_EXCEPTION, where, "the worker pool is shut down");',
+            "    } catch (...) {",
+            "        setLastErrorFromException(where);",
+            "    }",
+            "    return -1;",
+            "}",
+            "",
+            self._helpers_close(),
+            "",
+        ]
+
+    def _async_run_impl(self) -> list[str]:
+        return [
+            'extern "C" {',
+            "",
+            f"int {self.namespace}_run_async(void (*task)(void* arg), void* arg) {{",
+            "    clearLastError();",
+            f'    if (!task) {{ setLastError({self.namespace.upper()}_ERROR_NULL_ARGUMENT, "{self.namespace}_run_async: null task"); return -1; }}',
+            f'    return runAsync("{self.namespace}_run_async", [task, arg] {{ task(arg); }});',
+            "}",
+            "",
+            f"void {self.namespace}_async_shutdown(void) {{",
+            "    workerPool().shutdown();",
+            "}",
+            "",
+            '} // extern "C"',
+            "",
+        ]
+
+    def _check_asyncable(self, cls: Class, method: Method):
+        """Async calls outlive the submitting call, so every argument must be copyable into the task"""
+        where = f"{cls.name}.{method.name}"
+        if method.is_constructor:
+            raise ValueError(f"[async] is not supported on constructors ({where})")
+        ret = method.return_type
+        if TypeMapper.is_vector(ret) or ret.endswith("*") or self._is_class_type(ret):
+            raise ValueError(f"[async] requires a scalar, enum, string, struct or void return type ({where})")
+        for p in method.params:
+            if p.is_pointer or TypeMapper.is_vector(p.type) or self._is_class_type(p.type):
+                raise ValueError(f"[async] parameter '{p.name}' must be a scalar, enum, string, struct or callback ({where})")
+
+    def _async_result_c_type(self, idl_type: str) -> str:
+        """Type of the result argument of a completion callback"""
+        if idl_type == "string":
+            return "const char*"
+        if self._is_struct_type(idl_type):
+            return f"const {idl_type}*"
+        return self._c_return_type_for_method("", idl_type)
+
+    def _async_done_typedef(self, cls: Class, method: Method) -> str:
+        """Completion callback: error is 0 on success, -1 if the call threw, with the last
+        error set on the calling thread. Pointer results are only valid until it returns."""
+        params = ["int error", "void* user_data"]
+        if method.return_type != "void":
+            params.insert(0, f"{self._async_result_c_type(method.return_type)} result")
+        return f"typedef void (*{cls.name}_{method.name}_Done)({', '.join(params)});"
+
+    def _submit_signature(self, cls: Class, method: Method) -> str:
+        """Signature of <Class>_<method>_submit: queues the call and returns at once"""
+        self._check_asyncable(cls, method)
+        params = [f"{cls.name}Handle* handle"] + [self._param_to_c(p) for p in method.params]
+        params += [f"{cls.name}_{method.name}_Done done", "void* done_user_data"]
+        return f"int {cls.name}_{method.name}_submit({', '.join(params)})"
+
+    def _submit_impl(self, cls: Class, method: Method) -> list[str]:
+        """Copy the arguments into a pool task; done runs on the worker thread.
+        The task holds a reference to the handle, so the caller may destroy it at any time;
+        callback user_data must stay valid until done has been called."""
+        checks = self._null_checks(method.params) + [("!done", "ERROR_NULL_ARGUMENT", "null done")]
+        captures = ["="]
+        for p in method.params:
+            if TypeMapper.is_string(p.type):
+                captures.append(f"{p.name} = std::string({p.name})")
+
+        ret = method.return_type
+        call = f"handle->impl->{method.name}({self._build_cpp_args(method.params)})"
+        lines = [*self._entry_open(self._submit_signature(cls, method)), "    clearLastError();"]
+        lines.extend(f'    if ({cond}) {{ setLastError({self.namespace.upper()}_{code}, '
+                     f'"{cls.name}_{method.name}_submit: {message}"); return -1; }}'
+                     for cond, code, message in checks)
+        lines.append("    handle->refs.fetch_add(1, std::memory_order_relaxed);")
+        lines.append(f"    const int queued = runAsync(\"{cls.name}_{method.name}_submit\", [{', '.join(captures)}] {{")
+        if ret == "void":
+            result_arg = None
+        elif ret == "string":
+            lines.append("        std::string result;")
+            result_arg = "result.c_str()"
+        elif self._is_struct_type(ret):
+            lines.append(f"        {ret} result{{}};")
+            result_arg = "&result"
+        else:
+            lines.append(f"        {self._c_return_type_for_method(cls.name, ret)} result{{}};")
+            result_arg = "result"
+        if ret == "bool":
+            call += " ? 1 : 0"
+        lines.append("        int error = 0;")
+        lines.append("        clearLastError();")
+        lines.append("        try {")
+        lines.append(f"            {call};" if ret == "void" else f"            result = {call};")
+        lines.append("        } catch (...) {")
+        # done runs on this thread, so it can read why in the last error
+        lines.append(f'            setLastErrorFromException("{cls.name}_{method.name}_submit");')
+        lines.append("            error = -1;")
+        lines.append("        }")
+        done_args = ([result_arg] if result_arg else []) + ["error", "done_user_data"]
+        lines.append(f"        done({', '.join(done_args)});")
+        lines.append(f"        if ({self._last_reference('handle')}) {self._delete('handle')}")
+        lines.append("    });")
+        # Not queued: the caller still holds its own reference, so this is never the last
+        lines.append("    if (queued != 0) handle->refs.fetch_sub(1, std::memory_order_relaxed);")
+        lines.append("    return queued;")
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _get_callback(self, type_name: str):
+        """Get callback definition by name"""
+        return self.idl.symbols.callbacks.get(type_name)
 
     def _build_cpp_args(self, params: list[Param]) -> str:
         """Build C++ argument list, converting handles to impl pointers"""
         args = []
         for p in params:
             if self._is_callback_type(p.type):
-                # Check if callback needs wrapper
-                cb = self._get_callback(p.type)
-                if cb and self._needs_callback_wrapper(cb):
-                    # Generate inline lambda wrapper
-                    wrapper = self._generate_callback_wrapper_inline(p.name, cb)
-                    args.append(wrapper)
-                else:
-                    args.append(p.name)
+                # Lambda carrying the function pointer and its user_data
+                args.append(self._generate_callback_wrapper_inline(p.name, self._get_callback(p.type)))
             elif self._is_class_type(p.type):
                 # Handle pointer -> impl pointer or reference
                 if p.is_reference:
@@ -361,7 +1695,7 @@ class CAPIGenerator:
                     args.append(f"*{p.name}->impl")
                 elif p.is_pointer:
                     # Pointer parameter - get raw impl pointer
-                    args.append(f"({p.name} && {p.name}->impl) ? {p.name}->impl.get() : nullptr")
+                    args.append(f"({p.name} && {p.name}->impl) ? &*{p.name}->impl : nullptr")
                 else:
                     # By value (unlikely for classes) - dereference
                     args.append(f"*{p.name}->impl")
@@ -373,7 +1707,14 @@ class CAPIGenerator:
         return ", ".join(args)
 
     def _generate_callback_wrapper_inline(self, name: str, cb) -> str:
-        """Generate an inline lambda wrapper for callbacks with struct references"""
+        """Generate an inline lambda that forwards to the C callback with its user_data"""
+        if cb.has_attribute("batch"):
+            # The implementation already passes C-layout arrays, so the batch goes through as is
+            arrays = self._batch_callback_params(cb)[:-1]
+            names = [p.name for p in cb.params] + (["result"] if cb.return_type != "void" else [])
+            cpp_params = ", ".join([f"{t} {n}" for t, n in zip(arrays, names)] + ["int count"])
+            c_args = ", ".join(names + ["count", f"{name}_user_data"])
+            return f"[{name}, {name}_user_data]({cpp_params}) {{ {name}({c_args}); }}"
         # Build parameter list for the C++ lambda
         cpp_params = []
         c_call_args = []
@@ -388,16 +1729,18 @@ class CAPIGenerator:
                 cpp_params.append(f"{TypeMapper.to_cpp(p.type)} {p.name}")
                 c_call_args.append(p.name)
         
+        c_call_args.append(f"{name}_user_data")
         cpp_params_str = ", ".join(cpp_params)
         c_call_args_str = ", ".join(c_call_args)
+        capture = f"{name}, {name}_user_data"
         
         # Return type handling
         if cb.return_type == "bool":
-            return f"[{name}]({cpp_params_str}) {{ return {name}({c_call_args_str}) != 0; }}"
+            return f"[{capture}]({cpp_params_str}) {{ return {name}({c_call_args_str}) != 0; }}"
         elif cb.return_type == "void":
-            return f"[{name}]({cpp_params_str}) {{ {name}({c_call_args_str}); }}"
+            return f"[{capture}]({cpp_params_str}) {{ {name}({c_call_args_str}); }}"
         else:
-            return f"[{name}]({cpp_params_str}) {{ return {name}({c_call_args_str}); }}"
+            return f"[{capture}]({cpp_params_str}) {{ return {name}({c_call_args_str}); }}"
 
     def _attr_getter_impl(self, cls: Class, member: Member) -> list[str]:
         h = f"{cls.name}Handle"
@@ -406,7 +1749,7 @@ class CAPIGenerator:
         cpp_getter = f"is{member.name[0].upper()}{member.name[1:]}" if member.type == "bool" else f"get{member.name[0].upper()}{member.name[1:]}"
 
         return [
-            f"{ret} {cls.name}_{getter}({h}* handle) {{",
+            *self._entry_open(f"{ret} {cls.name}_{getter}({h}* handle)"),
             f"    return (handle && handle->impl) ? handle->impl->{cpp_getter}() : 0;",
             "}",
             "",
@@ -414,30 +1757,30 @@ class CAPIGenerator:
 
     def _is_callback_type(self, type_name: str) -> bool:
         """Check if type is a callback"""
-        return any(cb.name == type_name for cb in self.idl.callbacks)
+        return type_name in self.idl.symbols.callbacks
 
     def _is_class_type(self, type_name: str) -> bool:
         """Check if type is a class defined in IDL"""
         # Strip pointer suffix if present
         clean_type = type_name.rstrip('*').strip()
-        return any(c.name == clean_type for c in self.idl.classes)
+        return clean_type in self.idl.symbols.classes
 
     def _is_struct_type(self, type_name: str) -> bool:
         """Check if type is a struct defined in IDL"""
-        return any(s.name == type_name for s in self.idl.structs)
+        return type_name in self.idl.symbols.structs
 
     def _is_enum_type(self, type_name: str) -> bool:
         """Check if type is an enum defined in IDL"""
-        return any(e.name == type_name for e in self.idl.enums)
+        return type_name in self.idl.symbols.enums
 
     def _param_to_c(self, param: Param) -> str:
         """Convert param to C declaration"""
         if param.type == 'string':
             return f'const char* {param.name}'
         
-        # Callback types are already function pointers
+        # Callback types are function pointers followed by their user_data
         if self._is_callback_type(param.type):
-            return f'{param.type} {param.name}'
+            return f'{param.type} {param.name}, void* {param.name}_user_data'
         
         # Class types use Handle pointers
         if self._is_class_type(param.type):
@@ -457,7 +1800,9 @@ class CAPIGenerator:
         return ", ".join(self._param_to_c(p) for p in params) or "void"
 
     def _c_return_type_for_method(self, iface_name: str, idl_type: str) -> str:
-        """Get C return type, using per-method result types for vectors"""
+        """Get C return type, using per-method result types for vectors and streams"""
+        if TypeMapper.is_stream(idl_type):
+            return f"{self._stream_struct_name(iface_name, TypeMapper.stream_inner(idl_type))}*"
         if TypeMapper.is_vector(idl_type):
             inner = TypeMapper.vector_inner(idl_type)
             result_name = self._result_struct_name(iface_name, inner)
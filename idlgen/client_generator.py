@@ -1,5 +1,6 @@
 """Client Generator - generates C++ wrapper for dynamic library loading"""
 
+from typing import Optional
 from .types import ParsedIDL, Class, Method, Member, Param, Callback
 from .type_mapper import TypeMapper
 
@@ -7,19 +8,28 @@ from .type_mapper import TypeMapper
 class ClientGenerator:
     """Generates C++ client wrapper for dynamic loading"""
 
-    def __init__(self, idl: ParsedIDL, namespace: str):
+    # Symbol resolution strategies for the dynamic (non static-link) client
+    RESOLVE_MODES = ("eager", "lazy", "table")
+
+    def __init__(self, idl: ParsedIDL, namespace: str, resolve: str = "eager"):
+        if resolve not in self.RESOLVE_MODES:
+            raise ValueError(f"Unknown client resolve mode '{resolve}'")
         self.idl = idl
         self.namespace = namespace
+        self.resolve = resolve
 
     def generate_header(self) -> str:
         lines = [
             "// AUTO-GENERATED - DO NOT EDIT",
             "#pragma once",
             "",
+            *(["#include <cstddef>", "#include <iterator>"] if self._has_streams() else []),
+            "#include <stdexcept>",
             "#include <string>",
             "#include <vector>",
             "#include <memory>",
             "#include <functional>",
+            *(["#include <future>"] if self._has_async() else []),
             f'#include "{self.namespace}_c_api.h"',
             "",
             f"namespace {self.namespace}_client {{",
@@ -27,6 +37,7 @@ class ClientGenerator:
             "bool initialize(const std::string& libraryPath);",
             "bool isInitialized();",
             "",
+            *self._error_class(),
         ]
 
         # Generate using declarations for enums
@@ -43,12 +54,64 @@ class ClientGenerator:
         # Generate std::function typedefs for callbacks
         lines.extend(self._generate_callback_typedefs())
 
+        lines.extend(self._deleter_decls())
+
         for cls in self.idl.classes:
             lines.extend(self._class_header(cls))
 
         lines.append(f"}} // namespace {self.namespace}_client")
         return "\n".join(lines)
 
+    def _error_class(self) -> list[str]:
+        ns = self.namespace
+        return [
+            f"// A checked C API call failed: the code and message {ns}_last_error() reported",
+            "class Error : public std::runtime_error {",
+            "public:",
+            f"    Error({ns}_error_code code, const std::string& message) : std::runtime_error(message), code_(code) {{}}",
+            f"    [[nodiscard]] {ns}_error_code code() const noexcept {{ return code_; }}",
+            "",
+            "private:",
+            f"    {ns}_error_code code_;",
+            "};",
+            "",
+        ]
+
+    def _error_symbols(self) -> list[str]:
+        return [f"{self.namespace}_last_error", f"{self.namespace}_last_error_message"]
+
+    def _error_sentinel(self, idl_type: str, var: str) -> Optional[str]:
+        """Condition under which var may be the C API's failure value, or None when any value may be"""
+        if idl_type == "void" or self._is_struct_type(idl_type):
+            return None
+        if idl_type == "int":
+            return f"{var} == -1"
+        if idl_type in TypeMapper.CPP_TYPES and idl_type not in ("bool", "string") or idl_type in self.idl.symbols.enums:
+            return f"{var} == 0"
+        # bool, strings, pointers, handles, results and streams
+        return f"!{var}"
+
+    def _check_helpers(self) -> list[str]:
+        ns = self.namespace
+        return [
+            "namespace {",
+            "",
+            f"// The Error the last checked call left in {ns}_last_error(), or nullptr after a success",
+            "std::exception_ptr lastError() {",
+            f"    const {ns}_error_code code = {self._call(f'{ns}_last_error')}();",
+            f"    if (code == {ns.upper()}_OK) return nullptr;",
+            f"    return std::make_exception_ptr(Error(code, {self._call(f'{ns}_last_error_message')}()));",
+            "}",
+            "",
+            "// Called after a sentinel result: throws when the call really failed",
+            "void checkLastError() {",
+            "    if (std::exception_ptr error = lastError()) std::rethrow_exception(error);",
+            "}",
+            "",
+            "} // namespace",
+            "",
+        ]
+
     def _generate_callback_typedefs(self) -> list[str]:
         """Generate std::function typedefs for callback types"""
         lines = []
@@ -60,55 +123,177 @@ class ClientGenerator:
             lines.append("")
         return lines
 
+    def _deleter_decls(self) -> list[str]:
+        """Stateless deleters: unique_ptr stays pointer-sized and destruction is a direct call"""
+        lines = []
+        for cls in self.idl.classes:
+            lines.extend([
+                f"struct {cls.name}HandleDeleter {{",
+                f"    void operator()(::{cls.name}Handle* p) const noexcept;",
+                "};",
+                "",
+            ])
+            for inner in self._result_types(cls):
+                lines.extend([
+                    f"struct {self._client_result_name(cls.name, inner)}Deleter {{",
+                    f"    void operator()(::{self._result_struct_name(cls.name, inner)}* p) const noexcept;",
+                    "};",
+                    "",
+                ])
+            for inner in self._soa_types(cls):
+                lines.extend([
+                    f"struct {self._client_columns_name(cls.name, inner)}Deleter {{",
+                    f"    void operator()(::{self._columns_struct_name(cls.name, inner)}* p) const noexcept;",
+                    "};",
+                    "",
+                ])
+            for inner in self._stream_types(cls):
+                lines.extend([
+                    f"struct {self._client_stream_name(cls.name, inner)}Deleter {{",
+                    f"    void operator()(::{self._stream_struct_name(cls.name, inner)}* p) const noexcept;",
+                    "};",
+                    "",
+                ])
+        return lines
+
+    def _result_types(self, cls: Class) -> list[str]:
+        """Unique vector element types returned by a class, sorted"""
+        return self.idl.symbols.result_types[cls.name]
+
+    def _soa_types(self, cls: Class) -> list[str]:
+        """Element types of the class's [soa] returns, sorted"""
+        return self.idl.symbols.soa_types[cls.name]
+
+    def _stream_types(self, cls: Class) -> list[str]:
+        """Element types of the class's stream<T> returns, sorted"""
+        return self.idl.symbols.stream_types[cls.name]
+
+    def _has_streams(self) -> bool:
+        return any(self._stream_types(cls) for cls in self.idl.classes)
+
+    def _static_link_macro(self) -> str:
+        return f"{self.namespace.upper()}_CLIENT_STATIC_LINK"
+
+    def _call(self, symbol: str) -> str:
+        """Callee expression for a C API function: table slot, or the symbol itself when statically linked"""
+        return f"{self.namespace.upper()}_CLIENT_CALL({symbol})"
+
+    def _symbols(self) -> list[str]:
+        """Every C API entry point the client calls, in generation order"""
+        return self._error_symbols() + [sym for cls in self.idl.classes for sym in self._class_symbols(cls)]
+
+    def _class_symbols(self, cls: Class) -> list[str]:
+        """Entry points used by one class and its result types"""
+        prefix = cls.name
+        symbols = []
+        if self.idl.symbols.constructors[cls.name] is not None:
+            symbols += [f"{prefix}_create", f"{prefix}_destroy"]
+        for method in cls.methods:
+            if method.is_constructor:
+                continue
+            symbols.append(f"{prefix}_{method.name}")
+            if method.has_attribute("batch"):
+                symbols.append(f"{prefix}_{method.name}_batch")
+            if self._has_into(method):
+                symbols.append(f"{prefix}_{method.name}_into")
+            if method.has_attribute("async"):
+                symbols.append(f"{prefix}_{method.name}_submit")
+            if method.has_attribute("soa"):
+                symbols.append(f"{prefix}_{method.name}_soa")
+        for inner in self._result_types(cls):
+            result_name = self._result_struct_name(cls.name, inner)
+            symbols += [f"{result_name}_getCount", f"{result_name}_getData", f"{result_name}_free"]
+        for inner in self._soa_types(cls):
+            columns_name = self._columns_struct_name(cls.name, inner)
+            symbols.append(f"{columns_name}_getCount")
+            symbols += [f"{columns_name}_{self._column_getter(m)}" for m in self.idl.symbols.structs[inner].members]
+            symbols.append(f"{columns_name}_free")
+        for inner in self._stream_types(cls):
+            stream_name = self._stream_struct_name(cls.name, inner)
+            symbols += [f"{stream_name}_next", f"{stream_name}_free"]
+        for member in cls.members:
+            symbols.append(f"{prefix}_{self._getter_name(member)}")
+        return symbols
+
     def generate_impl(self) -> str:
+        static = self._static_link_macro()
+        call = f"{self.namespace.upper()}_CLIENT_CALL"
         lines = [
             "// AUTO-GENERATED - DO NOT EDIT",
             f'#include "{self.namespace}_client.hpp"',
             "",
+            f"#ifndef {static}",
             "#ifdef _WIN32",
             "#include <windows.h>",
             "#else",
             "#include <dlfcn.h>",
             "#endif",
+            "#endif",
             "",
+            "#include <algorithm>",
+            "#include <exception>",
             "#include <stdexcept>",
+        ]
+        if self.resolve == "lazy":
+            lines.append("#include <mutex>")
+        lines.extend([
+            "",
+            f"// {static}: call the C API directly (link {self.namespace} statically, LTO can inline).",
+            f"// Otherwise every call goes through one table {self._table_source()}.",
+            f"#ifdef {static}",
+            f"#define {call}(fn) ::fn",
+            "#else",
+            f"#define {call}(fn) g_api.fn",
+            "#endif",
             "",
             f"namespace {self.namespace}_client {{",
             "",
+            f"#ifndef {static}",
             "namespace {",
             "",
             "void* g_library = nullptr;",
             "",
-        ]
-
-        for cls in self.idl.classes:
-            lines.extend(self._fn_pointer_types(cls))
-
-        lines.append("")
-
-        for cls in self.idl.classes:
-            lines.extend(self._fn_pointer_vars(cls))
-
+        ])
+        if self.resolve == "table":
+            lines.append(f"// Same layout as the library's own table, copied in with one lookup")
+            lines.append(f"using Dispatch = ::{self.namespace}_api;")
+        else:
+            lines.append("// All resolved entry points in one contiguous table")
+            lines.append("struct Dispatch {")
+            lines.extend(f"    decltype(&::{sym}) {sym};" for sym in self._symbols())
+            lines.append("};")
         lines.extend([
             "",
-            "void* loadSymbol(const char* name) {",
+            "Dispatch g_api{};",
+            "",
+            "template <typename Fn>",
+            "bool loadSymbol(Fn& fn, const char* name) {",
             "#ifdef _WIN32",
-            "    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(g_library), name));",
+            "    fn = reinterpret_cast<Fn>(GetProcAddress(static_cast<HMODULE>(g_library), name));",
             "#else",
-            "    return dlsym(g_library, name);",
+            "    fn = reinterpret_cast<Fn>(dlsym(g_library, name));",
             "#endif",
+            "    return fn != nullptr;",
             "}",
             "",
+        ])
+        if self.resolve == "lazy":
+            lines.extend(self._lazy_resolvers())
+        lines.extend([
             "} // namespace",
+            "#endif",
             "",
         ])
 
         lines.extend(self._initialize_fn())
+        lines.extend(self._check_helpers())
 
         for cls in self.idl.classes:
             lines.extend(self._class_impl(cls))
 
         lines.append(f"}} // namespace {self.namespace}_client")
+        lines.append("")
+        lines.append(f"#undef {call}")
         return "\n".join(lines)
 
     def _class_header(self, cls: Class) -> list[str]:
@@ -116,21 +301,15 @@ class ClientGenerator:
         lines = []
 
         # Result class - one per unique vector element type
-        vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-        result_types = set()
-        for m in vec_methods:
-            inner = TypeMapper.vector_inner(m.return_type)
-            result_types.add(inner)
-        
-        for inner in sorted(result_types):
+        for inner in self._result_types(cls):
             result_name = self._result_struct_name(cls.name, inner)
             c_result_name = f"::{result_name}"
             client_result = self._client_result_name(cls.name, inner)
             lines.extend([
                 f"class {client_result} {{",
                 "public:",
-                f"    {client_result}();",
-                f"    explicit {client_result}({c_result_name}* result);",
+                f"    {client_result}() = default;",
+                f"    explicit {client_result}({c_result_name}* result) noexcept;",
                 f"    ~{client_result}() = default;",
                 f"    {client_result}({client_result}&&) noexcept = default;",
                 f"    {client_result}& operator=({client_result}&&) noexcept = default;",
@@ -140,21 +319,52 @@ class ClientGenerator:
                 f"    [[nodiscard]] std::vector<{inner}> toVector() const;",
                 "",
                 "private:",
-                f"    std::unique_ptr<{c_result_name}, std::function<void({c_result_name}*)>> result_;",
+                f"    std::unique_ptr<{c_result_name}, {client_result}Deleter> result_;",
                 "};",
                 "",
             ])
 
+        # Columns class - one per [soa] element type, a pointer per member column
+        for inner in self._soa_types(cls):
+            c_columns_name = f"::{self._columns_struct_name(cls.name, inner)}"
+            client_columns = self._client_columns_name(cls.name, inner)
+            lines.extend([
+                f"class {client_columns} {{",
+                "public:",
+                f"    {client_columns}() = default;",
+                f"    explicit {client_columns}({c_columns_name}* columns) noexcept;",
+                f"    {client_columns}({client_columns}&&) noexcept = default;",
+                f"    {client_columns}& operator=({client_columns}&&) noexcept = default;",
+                "",
+                "    [[nodiscard]] int count() const;",
+            ])
+            for m in self.idl.symbols.structs[inner].members:
+                lines.append(f"    [[nodiscard]] const {TypeMapper.to_c(m.type)}* {m.name}() const;")
+            lines.extend([
+                "",
+                "private:",
+                f"    std::unique_ptr<{c_columns_name}, {client_columns}Deleter> columns_;",
+                "};",
+                "",
+            ])
+
+        # Stream class - one per stream<T> element type, an input range over the pull function
+        for inner in self._stream_types(cls):
+            lines.extend(self._stream_class_header(cls, inner))
+
         # Main class
         lines.append(f"class {cls.name} {{")
         lines.append("public:")
 
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             cpp_params = ", ".join(self._param_to_cpp_decl(p) for p in ctor.params)
             lines.append(f"    explicit {cls.name}({cpp_params});")
 
         lines.extend([
+            "    // Adopts an existing C API handle (e.g. one returned by another class)",
+            (f"    explicit {cls.name}(::{h}* handle);" if self.resolve == "lazy"
+             else f"    explicit {cls.name}(::{h}* handle) noexcept : handle_(handle) {{}}"),
             f"    ~{cls.name}() = default;",
             "",
             f"    {cls.name}(const {cls.name}&) = delete;",
@@ -162,6 +372,8 @@ class ClientGenerator:
             f"    {cls.name}({cls.name}&&) noexcept = default;",
             f"    {cls.name}& operator=({cls.name}&&) noexcept = default;",
             "",
+            f"    [[nodiscard]] ::{h}* handle() const noexcept {{ return handle_.get(); }}",
+            "",
         ])
 
         for member in cls.members:
@@ -176,177 +388,249 @@ class ClientGenerator:
             params = ", ".join(self._param_to_cpp_decl(p) for p in method.params)
             const_q = " const" if method.is_const else ""
             lines.append(f"    [[nodiscard]] {ret} {method.name}({params}){const_q};")
+            if method.has_attribute("batch"):
+                lines.append(f"    {self._batch_decl(method)}{const_q};")
+            if self._has_into(method):
+                for decl in self._into_decls(method):
+                    lines.append(f"    {decl};")
+            if method.has_attribute("async"):
+                lines.append(f"    [[nodiscard]] {self._async_decl(method)}{const_q};")
+            if method.has_attribute("soa"):
+                lines.append(f"    [[nodiscard]] {self._soa_decl(cls, method)}{const_q};")
 
         lines.extend([
             "",
             "private:",
-            f"    std::unique_ptr<::{h}, std::function<void(::{h}*)>> handle_;",
+            f"    std::unique_ptr<::{h}, {h}Deleter> handle_;",
             "};",
             "",
         ])
 
         return lines
 
-    def _fn_pointer_types(self, cls: Class) -> list[str]:
-        h = f"{cls.name}Handle"
-        prefix = cls.name
-        lines = []
-
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
-        if ctor:
-            c_params = ", ".join(self._param_to_c_type(p) for p in ctor.params) or "void"
-            lines.append(f"using {prefix}CreateFn = {h}*(*)({c_params});")
-            lines.append(f"using {prefix}DestroyFn = void(*)({h}*);")
-
-        for method in cls.methods:
-            if method.is_constructor:
-                continue
-            ret = self._c_return_type_for_method(cls.name, method.return_type)
-            params = [f"{h}*"] + [self._param_to_c_type(p) for p in method.params]
-            fn_name = method.name[0].upper() + method.name[1:]
-            lines.append(f"using {prefix}{fn_name}Fn = {ret}(*)({', '.join(params)});")
-
-        # Function pointers for result accessors per unique element type
-        vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-        result_types = set()
-        for m in vec_methods:
-            inner = TypeMapper.vector_inner(m.return_type)
-            result_types.add(inner)
-        
-        for inner in sorted(result_types):
-            result_name = self._result_struct_name(cls.name, inner)
-            lines.append(f"using {result_name}GetCountFn = int(*)(const {result_name}*);")
-            lines.append(f"using {result_name}GetDataFn = const {inner}*(*)(const {result_name}*);")
-            lines.append(f"using {result_name}FreeFn = void(*)({result_name}*);")
-
-        for member in cls.members:
-            ret = "int" if member.type == "bool" else TypeMapper.to_c(member.type)
-            getter = self._getter_name(member)
-            fn_name = getter[0].upper() + getter[1:]
-            lines.append(f"using {prefix}{fn_name}Fn = {ret}(*)({h}*);")
-
-        return lines
-
-    def _fn_pointer_vars(self, cls: Class) -> list[str]:
-        prefix = cls.name
-        lines = []
-
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
-        if ctor:
-            lines.append(f"{prefix}CreateFn g_{prefix}_create = nullptr;")
-            lines.append(f"{prefix}DestroyFn g_{prefix}_destroy = nullptr;")
-
-        for method in cls.methods:
-            if method.is_constructor:
-                continue
-            fn_name = method.name[0].upper() + method.name[1:]
-            lines.append(f"{prefix}{fn_name}Fn g_{prefix}_{method.name} = nullptr;")
-
-        # Variables for result accessors per unique element type
-        vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-        result_types = set()
-        for m in vec_methods:
-            inner = TypeMapper.vector_inner(m.return_type)
-            result_types.add(inner)
-        
-        for inner in sorted(result_types):
-            result_name = self._result_struct_name(cls.name, inner)
-            lines.append(f"{result_name}GetCountFn g_{result_name}_getCount = nullptr;")
-            lines.append(f"{result_name}GetDataFn g_{result_name}_getData = nullptr;")
-            lines.append(f"{result_name}FreeFn g_{result_name}_free = nullptr;")
-
-        for member in cls.members:
-            getter = self._getter_name(member)
-            fn_name = getter[0].upper() + getter[1:]
-            lines.append(f"{prefix}{fn_name}Fn g_{prefix}_{getter} = nullptr;")
+    def _stream_class_header(self, cls: Class, inner: str) -> list[str]:
+        c_stream_name = f"::{self._stream_struct_name(cls.name, inner)}"
+        client_stream = self._client_stream_name(cls.name, inner)
+        value = TypeMapper.to_c(inner)
+        return [
+            "// Single-pass range: pulls kChunk items per C call, so only one chunk is held at a time",
+            f"class {client_stream} {{",
+            "public:",
+            "    class iterator {",
+            "    public:",
+            "        using iterator_category = std::input_iterator_tag;",
+            f"        using value_type = {value};",
+            "        using difference_type = std::ptrdiff_t;",
+            f"        using pointer = const {value}*;",
+            f"        using reference = const {value}&;",
+            "",
+            "        iterator() = default;",
+            f"        explicit iterator({client_stream}* stream)",
+            "            : stream_(stream && (stream->pos_ < stream->count_ || stream->fill()) ? stream : nullptr) {}",
+            "",
+            "        reference operator*() const { return stream_->chunk_[stream_->pos_]; }",
+            "        pointer operator->() const { return &stream_->chunk_[stream_->pos_]; }",
+            "        iterator& operator++() {",
+            "            if (++stream_->pos_ == stream_->count_ && !stream_->fill()) stream_ = nullptr;",
+            "            return *this;",
+            "        }",
+            "        void operator++(int) { ++*this; }",
+            "        bool operator==(const iterator& other) const { return stream_ == other.stream_; }",
+            "        bool operator!=(const iterator& other) const { return stream_ != other.stream_; }",
+            "",
+            "    private:",
+            f"        {client_stream}* stream_ = nullptr;",
+            "    };",
+            "",
+            "    static constexpr int kChunk = 256;",
+            "",
+            f"    {client_stream}() = default;",
+            f"    explicit {client_stream}({c_stream_name}* stream) noexcept;",
+            f"    {client_stream}({client_stream}&&) noexcept = default;",
+            f"    {client_stream}& operator=({client_stream}&&) noexcept = default;",
+            "",
+            "    // begin() resumes where the last iteration stopped; the C stream is freed at the end",
+            "    [[nodiscard]] iterator begin() { return iterator(this); }",
+            "    [[nodiscard]] iterator end() { return iterator(); }",
+            "",
+            "    // Pulls straight into out, past any items an iteration has buffered: count, 0 at the end.",
+            "    // Throws Error when the source failed, as iterating does.",
+            f"    int next({value}* out, int max);",
+            "",
+            "private:",
+            "    bool fill();",
+            "",
+            f"    std::unique_ptr<{c_stream_name}, {client_stream}Deleter> stream_;",
+            f"    std::vector<{value}> chunk_;",
+            "    int pos_ = 0;",
+            "    int count_ = 0;",
+            "};",
+            "",
+        ]
 
-        return lines
+    def _stream_class_impl(self, cls: Class, inner: str) -> list[str]:
+        stream_name = self._stream_struct_name(cls.name, inner)
+        client_stream = self._client_stream_name(cls.name, inner)
+        value = TypeMapper.to_c(inner)
+        return [
+            f"void {client_stream}Deleter::operator()(::{stream_name}* p) const noexcept {{",
+            f"    if (p) {self._call(f'{stream_name}_free')}(p);",
+            "}",
+            "",
+            f"{client_stream}::{client_stream}(::{stream_name}* stream) noexcept : stream_(stream) {{}}",
+            "",
+            f"int {client_stream}::next({value}* out, int max) {{",
+            "    if (!stream_) return 0;",
+            f"    const int n = {self._call(f'{stream_name}_next')}(stream_.get(), out, max);",
+            "    if (n < 0) checkLastError();",
+            "    return n;",
+            "}",
+            "",
+            f"bool {client_stream}::fill() {{",
+            "    pos_ = count_ = 0;",
+            "    if (!stream_) return false;",
+            "    chunk_.resize(kChunk);",
+            f"    const int n = {self._call(f'{stream_name}_next')}(stream_.get(), chunk_.data(), kChunk);",
+            "    if (n <= 0) {",
+            "        stream_.reset();",
+            "        chunk_ = {};",
+            "        if (n < 0) checkLastError();",
+            "        return false;",
+            "    }",
+            "    count_ = n;",
+            "    return true;",
+            "}",
+            "",
+        ]
 
     def _initialize_fn(self) -> list[str]:
+        static = self._static_link_macro()
         lines = [
+            f"#ifdef {static}",
+            "bool initialize(const std::string&) { return true; }",
+            "",
+            "bool isInitialized() { return true; }",
+            "#else",
             "bool initialize(const std::string& libraryPath) {",
             "    if (g_library) return true;",
             "",
             "#ifdef _WIN32",
             "    g_library = LoadLibraryA(libraryPath.c_str());",
             "#else",
-            "    g_library = dlopen(libraryPath.c_str(), RTLD_NOW);",
+            f"    g_library = dlopen(libraryPath.c_str(), {'RTLD_NOW' if self.resolve == 'eager' else 'RTLD_LAZY'});",
             "#endif",
             "    if (!g_library) return false;",
             "",
         ]
-
-        for cls in self.idl.classes:
-            prefix = cls.name
-
-            ctor = next((m for m in cls.methods if m.is_constructor), None)
-            if ctor:
-                lines.append(f'    g_{prefix}_create = reinterpret_cast<{prefix}CreateFn>(loadSymbol("{prefix}_create"));')
-                lines.append(f'    g_{prefix}_destroy = reinterpret_cast<{prefix}DestroyFn>(loadSymbol("{prefix}_destroy"));')
-
-            for method in cls.methods:
-                if method.is_constructor:
-                    continue
-                fn_name = method.name[0].upper() + method.name[1:]
-                lines.append(f'    g_{prefix}_{method.name} = reinterpret_cast<{prefix}{fn_name}Fn>(loadSymbol("{prefix}_{method.name}"));')
-
-            # Load result accessors per unique element type
-            vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-            result_types = set()
-            for m in vec_methods:
-                inner = TypeMapper.vector_inner(m.return_type)
-                result_types.add(inner)
-            
-            for inner in sorted(result_types):
-                result_name = self._result_struct_name(cls.name, inner)
-                lines.append(f'    g_{result_name}_getCount = reinterpret_cast<{result_name}GetCountFn>(loadSymbol("{result_name}_getCount"));')
-                lines.append(f'    g_{result_name}_getData = reinterpret_cast<{result_name}GetDataFn>(loadSymbol("{result_name}_getData"));')
-                lines.append(f'    g_{result_name}_free = reinterpret_cast<{result_name}FreeFn>(loadSymbol("{result_name}_free"));')
-
-            for member in cls.members:
-                getter = self._getter_name(member)
-                fn_name = getter[0].upper() + getter[1:]
-                lines.append(f'    g_{prefix}_{getter} = reinterpret_cast<{prefix}{fn_name}Fn>(loadSymbol("{prefix}_{getter}"));')
-
+        if self.resolve == "lazy":
+            # Class entry points are resolved per class on first use, the error accessors now
+            lines.append("    bool ok = true;")
+            lines.extend(f'    ok &= loadSymbol(g_api.{sym}, "{sym}");' for sym in self._error_symbols())
+        elif self.resolve == "table":
+            table = f"{self.namespace}_api"
+            lines.extend([
+                f"    decltype(&::{self.namespace}_get_api) getApi = nullptr;",
+                f'    const ::{table}* table = loadSymbol(getApi, "{self.namespace}_get_api") ? getApi() : nullptr;',
+                f"    const bool ok = table && table->size >= sizeof(::{table});",
+            ])
+        else:
+            lines.append("    Dispatch api{};")
+            lines.append("    bool ok = true;")
+            lines.extend(f'    ok &= loadSymbol(api.{sym}, "{sym}");' for sym in self._symbols())
         lines.extend([
-            "",
+            "    if (!ok) {",
+            "        // A missing entry point means the library does not match this client",
+            "#ifdef _WIN32",
+            "        FreeLibrary(static_cast<HMODULE>(g_library));",
+            "#else",
+            "        dlclose(g_library);",
+            "#endif",
+            "        g_library = nullptr;",
+            "        return false;",
+            "    }",
+            *({"table": ["    g_api = *table;"], "eager": ["    g_api = api;"]}.get(self.resolve, [])),
             "    return true;",
             "}",
             "",
             "bool isInitialized() { return g_library != nullptr; }",
+            "#endif",
             "",
         ])
+        return lines
+
+    def _table_source(self) -> str:
+        return {
+            "eager": "filled by initialize()",
+            "lazy": "filled per class on first use",
+            "table": f"copied from {self.namespace}_get_api()",
+        }[self.resolve]
 
+    def _lazy_resolvers(self) -> list[str]:
+        """One call_once per class: its slots are written before any caller can read them"""
+        lines = []
+        for cls in self.idl.classes:
+            lines.extend([
+                f"std::once_flag g_{cls.name}Once;",
+                f"bool g_{cls.name}Resolved = false;",
+                "",
+                f"void resolve{cls.name}() {{",
+                f"    std::call_once(g_{cls.name}Once, [] {{",
+                "        if (!g_library) return;",
+                "        bool ok = true;",
+            ])
+            lines.extend(f'        ok &= loadSymbol(g_api.{sym}, "{sym}");' for sym in self._class_symbols(cls))
+            lines.extend([
+                f"        g_{cls.name}Resolved = ok;",
+                "    });",
+                f"    if (!g_{cls.name}Resolved) {{",
+                f'        throw std::runtime_error("{self.namespace}_client: cannot resolve {cls.name} entry points");',
+                "    }",
+                "}",
+                "",
+            ])
         return lines
 
+    def _resolve_call(self, cls: Class) -> list[str]:
+        """Lazy mode: make sure the class's slots are filled before the first call"""
+        if self.resolve != "lazy":
+            return []
+        return [
+            f"#ifndef {self._static_link_macro()}",
+            f"    resolve{cls.name}();",
+            "#endif",
+        ]
+
     def _class_impl(self, cls: Class) -> list[str]:
         prefix = cls.name
         h = f"{cls.name}Handle"
-        lines = []
+        has_ctor = self.idl.symbols.constructors[cls.name] is not None
+        lines = [
+            f"void {h}Deleter::operator()(::{h}* p) const noexcept {{",
+        ]
+        if has_ctor:
+            lines.append(f"    if (p) {self._call(f'{prefix}_destroy')}(p);")
+        else:
+            lines.append("    (void)p;  // No _destroy without a constructor")
+        lines.extend(["}", ""])
 
         # Result class impl - one per unique vector element type
-        vec_methods = [m for m in cls.methods if TypeMapper.is_vector(m.return_type)]
-        result_types = set()
-        for m in vec_methods:
-            inner = TypeMapper.vector_inner(m.return_type)
-            result_types.add(inner)
-        
-        for inner in sorted(result_types):
+        for inner in self._result_types(cls):
             result_name = self._result_struct_name(cls.name, inner)
             c_result_name = f"::{result_name}"
             client_result = self._client_result_name(cls.name, inner)
             lines.extend([
-                f"{client_result}::{client_result}() : result_(nullptr, nullptr) {{}}",
+                f"void {client_result}Deleter::operator()({c_result_name}* p) const noexcept {{",
+                f"    if (p) {self._call(f'{result_name}_free')}(p);",
+                "}",
                 "",
-                f"{client_result}::{client_result}({c_result_name}* result)",
-                f"    : result_(result, []({c_result_name}* r) {{ if (r && g_{result_name}_free) g_{result_name}_free(r); }}) {{}}",
+                f"{client_result}::{client_result}({c_result_name}* result) noexcept : result_(result) {{}}",
                 "",
                 f"int {client_result}::count() const {{",
-                f"    return result_ ? g_{result_name}_getCount(result_.get()) : 0;",
+                f"    return result_ ? {self._call(f'{result_name}_getCount')}(result_.get()) : 0;",
                 "}",
                 "",
                 f"const {inner}* {client_result}::data() const {{",
-                f"    return result_ ? g_{result_name}_getData(result_.get()) : nullptr;",
+                f"    return result_ ? {self._call(f'{result_name}_getData')}(result_.get()) : nullptr;",
                 "}",
                 "",
                 f"std::vector<{inner}> {client_result}::toVector() const {{",
@@ -359,19 +643,53 @@ class ClientGenerator:
                 "",
             ])
 
+        for inner in self._soa_types(cls):
+            columns_name = self._columns_struct_name(cls.name, inner)
+            c_columns_name = f"::{columns_name}"
+            client_columns = self._client_columns_name(cls.name, inner)
+            lines.extend([
+                f"void {client_columns}Deleter::operator()({c_columns_name}* p) const noexcept {{",
+                f"    if (p) {self._call(f'{columns_name}_free')}(p);",
+                "}",
+                "",
+                f"{client_columns}::{client_columns}({c_columns_name}* columns) noexcept : columns_(columns) {{}}",
+                "",
+                f"int {client_columns}::count() const {{",
+                f"    return columns_ ? {self._call(f'{columns_name}_getCount')}(columns_.get()) : 0;",
+                "}",
+                "",
+            ])
+            for m in self.idl.symbols.structs[inner].members:
+                getter = f"{columns_name}_{self._column_getter(m)}"
+                lines.extend([
+                    f"const {TypeMapper.to_c(m.type)}* {client_columns}::{m.name}() const {{",
+                    f"    return columns_ ? {self._call(getter)}(columns_.get()) : nullptr;",
+                    "}",
+                    "",
+                ])
+
+        for inner in self._stream_types(cls):
+            lines.extend(self._stream_class_impl(cls, inner))
+
         # Main class impl
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             cpp_params = ", ".join(self._param_to_cpp_decl(p) for p in ctor.params)
             c_args = ", ".join(self._to_c_arg(p) for p in ctor.params)
 
             lines.extend([
-                f"{cls.name}::{cls.name}({cpp_params})",
-                "    : handle_(nullptr, nullptr) {",
+                f"{cls.name}::{cls.name}({cpp_params}) {{",
                 '    if (!isInitialized()) throw std::runtime_error("Library not initialized");',
-                f"    auto* h = g_{prefix}_create({c_args});",
-                f"    handle_ = std::unique_ptr<::{h}, std::function<void(::{h}*)>>(h,",
-                f"        [](::{h}* p) {{ if (p && g_{prefix}_destroy) g_{prefix}_destroy(p); }});",
+                *self._resolve_call(cls),
+                f"    handle_.reset({self._call(f'{prefix}_create')}({c_args}));",
+                "    if (!handle_) checkLastError();",
+                "}",
+                "",
+            ])
+        if self.resolve == "lazy":
+            lines.extend([
+                f"{cls.name}::{cls.name}(::{h}* handle) : handle_(handle) {{",
+                *self._resolve_call(cls),
                 "}",
                 "",
             ])
@@ -380,9 +698,10 @@ class ClientGenerator:
             ret = TypeMapper.to_cpp(member.type)
             getter = self._getter_name(member)
             default = "false" if member.type == "bool" else "0"
+            getter_call = self._call(f"{prefix}_{getter}")
             lines.extend([
                 f"{ret} {cls.name}::{getter}() const noexcept {{",
-                f"    return handle_ && g_{prefix}_{getter} ? g_{prefix}_{getter}(handle_.get()) : {default};",
+                f"    return handle_ ? {getter_call}(handle_.get()) : {default};",
                 "}",
                 "",
             ])
@@ -391,9 +710,158 @@ class ClientGenerator:
             if method.is_constructor:
                 continue
             lines.extend(self._method_impl(cls, method, prefix))
+            if method.has_attribute("batch"):
+                lines.extend(self._batch_impl(cls, method, prefix))
+            if self._has_into(method):
+                lines.extend(self._into_impl(cls, method, prefix))
+            if method.has_attribute("async"):
+                lines.extend(self._async_impl(cls, method, prefix))
+            if method.has_attribute("soa"):
+                lines.extend(self._soa_impl(cls, method, prefix))
 
         return lines
 
+    def _soa_decl(self, cls: Class, method: Method, qualifier: str = "") -> str:
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = ", ".join(self._param_to_cpp_decl(p) for p in method.params)
+        return f"{self._client_columns_name(cls.name, inner)} {qualifier}{method.name}Columns({params})"
+
+    def _soa_impl(self, cls: Class, method: Method, prefix: str) -> list[str]:
+        """<method>Columns: the [soa] entry point, one contiguous array per struct member"""
+        ret = self._client_columns_name(cls.name, TypeMapper.vector_inner(method.return_type))
+        const_q = " const" if method.is_const else ""
+        c_args = ", ".join(["handle_.get()"] + [self._to_c_arg(p) for p in method.params])
+        return [
+            f"{self._soa_decl(cls, method, f'{cls.name}::')}{const_q} {{",
+            f"    if (!handle_) return {ret}();",
+            f"    auto* columns = {self._call(f'{prefix}_{method.name}_soa')}({c_args});",
+            "    if (!columns) checkLastError();",
+            f"    return {ret}(columns);",
+            "}",
+            "",
+        ]
+
+    def _has_into(self, method: Method) -> bool:
+        """Vector and string returns get caller-buffer overloads (callback methods keep the result-object path)"""
+        return ((TypeMapper.is_vector(method.return_type) or method.return_type == "string")
+                and not any(self._is_callback_type(p.type) for p in method.params))
+
+    def _into_decls(self, method: Method, qualifier: str = "") -> list[str]:
+        """Raw buffer overload plus a std::vector/std::string overload that reuses the container's capacity"""
+        params = [self._param_to_cpp_decl(p) for p in method.params]
+        if method.return_type == "string":
+            raw = ", ".join(params + ["char* out", "int capacity"])
+            vec = ", ".join(params + ["std::string& out"])
+        else:
+            inner = TypeMapper.vector_inner(method.return_type)
+            raw = ", ".join(params + [f"{inner}* out", "int capacity"])
+            vec = ", ".join(params + [f"std::vector<{inner}>& out"])
+        return [
+            f"int {qualifier}{method.name}Into({raw})",
+            f"int {qualifier}{method.name}Into({vec})",
+        ]
+
+    def _into_impl(self, cls: Class, method: Method, prefix: str) -> list[str]:
+        raw_decl, vec_decl = self._into_decls(method, f"{cls.name}::")
+        fn = self._call(f"{prefix}_{method.name}_into")
+        c_args = ", ".join(["handle_.get()"] + [self._to_c_arg(p) for p in method.params])
+        lines = [
+            f"{raw_decl} {{",
+            "    if (!handle_) return -1;",
+            f"    const int total = {fn}({c_args}, out, capacity);",
+            "    if (total < 0) checkLastError();",
+            "    return total;",
+            "}",
+            "",
+        ]
+        if method.return_type == "string":
+            # The C API always terminates, so pass size() + 1: std::string keeps room for the NUL
+            return lines + [
+                f"{vec_decl} {{",
+                "    if (!handle_) {",
+                "        out.clear();",
+                "        return -1;",
+                "    }",
+                "    out.resize(out.capacity());",
+                f"    int total = {fn}({c_args}, out.data(), static_cast<int>(out.size()) + 1);",
+                "    if (total > static_cast<int>(out.size())) {",
+                "        out.resize(total);",
+                f"        total = {fn}({c_args}, out.data(), total + 1);",
+                "    }",
+                "    if (total < 0) {",
+                "        out.clear();",
+                "        checkLastError();",
+                "    }",
+                "    out.resize(total > 0 ? std::min<size_t>(total, out.size()) : 0);",
+                "    return total;",
+                "}",
+                "",
+            ]
+        return lines + [
+            f"{vec_decl} {{",
+            "    if (!handle_) {",
+            "        out.clear();",
+            "        return -1;",
+            "    }",
+            "    out.resize(out.capacity());",
+            f"    int total = {fn}({c_args}, out.data(), static_cast<int>(out.size()));",
+            "    if (total > static_cast<int>(out.size())) {",
+            "        // Grow once; later calls of a similar size reuse this capacity",
+            "        out.resize(total);",
+            f"        total = {fn}({c_args}, out.data(), total);",
+            "    }",
+            "    if (total < 0) {",
+            "        out.clear();",
+            "        checkLastError();",
+            "    }",
+            "    out.resize(total > 0 ? std::min<size_t>(total, out.size()) : 0);",
+            "    return total;",
+            "}",
+            "",
+        ]
+
+    def _batch_element_type(self, idl_type: str) -> str:
+        """Element type of batch arrays - matches the C API, so bool results come back as int"""
+        if idl_type == "bool":
+            return "int"
+        return TypeMapper.to_c(idl_type)
+
+    def _batch_decl(self, method: Method, qualifier: str = "") -> str:
+        """Declaration of the vector-in/vector-out batch wrapper"""
+        params = ", ".join(f"const std::vector<{self._batch_element_type(p.type)}>& {p.name}" for p in method.params)
+        if method.return_type == "void":
+            ret = "void"
+        else:
+            ret = f"[[nodiscard]] std::vector<{self._batch_element_type(method.return_type)}>"
+        return f"{ret} {qualifier}{method.name}Batch({params})"
+
+    def _batch_impl(self, cls: Class, method: Method, prefix: str) -> list[str]:
+        """Forward a whole batch through a single <Class>_<method>_batch call"""
+        const_q = " const" if method.is_const else ""
+        decl = self._batch_decl(method, f"{cls.name}::").replace("[[nodiscard]] ", "")
+        has_out = method.return_type != "void"
+        first = method.params[0].name if method.params else None
+
+        lines = [f"{decl}{const_q} {{"]
+        lines.append(f"    const size_t batchSize = {first}.size();" if first else "    const size_t batchSize = 0;")
+        for p in method.params[1:]:
+            lines.append(f"    if ({p.name}.size() != batchSize) throw std::invalid_argument(\"{method.name}Batch: input sizes differ\");")
+        if has_out:
+            lines.append(f"    std::vector<{self._batch_element_type(method.return_type)}> out(batchSize);")
+            lines.append("    if (!handle_ || batchSize == 0) return out;")
+        else:
+            lines.append("    if (!handle_ || batchSize == 0) return;")
+        args = ["handle_.get()"] + [f"{p.name}.data()" for p in method.params]
+        if has_out:
+            args.append("out.data()")
+        args.append("static_cast<int>(batchSize)")
+        lines.append(f"    if ({self._call(f'{prefix}_{method.name}_batch')}({', '.join(args)}) < 0) checkLastError();")
+        if has_out:
+            lines.append("    return out;")
+        lines.append("}")
+        lines.append("")
+        return lines
+
     def _method_impl(self, cls: Class, method: Method, prefix: str) -> list[str]:
         """Generate method implementation, handling callbacks specially"""
         ret = self._cpp_return_type(cls.name, method.return_type)
@@ -401,41 +869,186 @@ class ClientGenerator:
         const_q = " const" if method.is_const else ""
         
         lines = [f"{ret} {cls.name}::{method.name}({params}){const_q} {{"]
-        lines.append(f"    if (!handle_) return {ret}();")
-        
-        # Check if we have callback parameters
-        callback_params = [p for p in method.params if self._is_callback_type(p.type)]
+        base_type = method.return_type.rstrip('*').strip()
+        returns_class = method.return_type.endswith('*') and self._is_class_type(base_type)
+        if returns_class:
+            # The returned handle is owned by the caller: adopt it into a client object
+            lines.append(f"    if (!handle_) return {ret}(static_cast<::{base_type}Handle*>(nullptr));")
+        elif method.return_type.endswith('*'):
+            lines.append("    if (!handle_) return nullptr;")
+        else:
+            lines.append(f"    if (!handle_) return {ret}();")
         
-        if callback_params:
-            # Generate wrappers for each callback
-            for p in callback_params:
-                cb = self._get_callback(p.type)
-                cb_params = ", ".join(f"{TypeMapper.to_c(cp.type)} {cp.name}" for cp in cb.params)
-                cb_args = ", ".join(cp.name for cp in cb.params)
-                ret_type = TypeMapper.to_c(cb.return_type)
-                
-                # Store callback in thread_local static, create wrapper
-                lines.append(f"    static thread_local {p.type} s_{p.name};")
-                lines.append(f"    s_{p.name} = {p.name};")
-                lines.append(f"    auto callback_wrapper_{p.name} = []({cb_params}) -> {ret_type} {{")
-                if cb.return_type == 'void':
-                    lines.append(f"        s_{p.name}({cb_args});")
-                else:
-                    lines.append(f"        return s_{p.name}({cb_args});")
-                lines.append("    };")
+        lines.extend(self._callback_trampolines(method))
         
-        c_args = ", ".join(self._to_c_arg(p) for p in method.params)
-        if c_args:
-            lines.append(f"    return {ret}(g_{prefix}_{method.name}(handle_.get(), {c_args}));")
+        c_args = ", ".join(["handle_.get()"] + [self._to_c_arg(p) for p in method.params])
+        c_call = f"{self._call(f'{prefix}_{method.name}')}({c_args})"
+        if method.has_attribute("noexcept"):
+            # Unchecked: the entry point leaves the last error as it was
+            sentinel = ""
         else:
-            lines.append(f"    return {ret}(g_{prefix}_{method.name}(handle_.get()));")
+            sentinel = self._error_sentinel(method.return_type, "result")
+            sentinel = f"    if ({sentinel}) checkLastError();" if sentinel else "    checkLastError();"
+        if method.return_type == "void":
+            lines.append(f"    {c_call};")
+            lines.extend([sentinel] if sentinel else [])
+        else:
+            lines.append(f"    auto result = {c_call};")
+            lines.extend([sentinel] if sentinel else [])
+            if method.return_type == "string":
+                lines.append(f"    return result ? {ret}(result) : {ret}();")
+            elif method.return_type.endswith('*') and not returns_class:
+                lines.append("    return result;")
+            else:
+                lines.append(f"    return {ret}(result);")
         lines.append("}")
         lines.append("")
         return lines
 
+    def _callback_trampolines(self, method: Method) -> list[str]:
+        """Captureless trampolines: the std::function travels as user_data"""
+        lines = []
+        for p in method.params:
+            if not self._is_callback_type(p.type):
+                continue
+            cb = self._get_callback(p.type)
+            if cb.has_attribute("batch"):
+                lines.extend(self._batch_trampoline(p, cb))
+                continue
+            cb_params = ", ".join([f"{self._callback_param_to_c(cp)} {cp.name}" for cp in cb.params] +
+                                  ["void* user_data"])
+            cb_args = ", ".join(f"*{cp.name}" if cp.is_reference and self._is_struct_type(cp.type) else cp.name
+                                for cp in cb.params)
+            ret_type = TypeMapper.to_c(cb.return_type)
+
+            lines.append(f"    auto callback_wrapper_{p.name} = []({cb_params}) -> {ret_type} {{")
+            call = f"(*static_cast<const {p.type}*>(user_data))({cb_args})"
+            if cb.return_type == 'void':
+                lines.append(f"        {call};")
+            else:
+                lines.append(f"        return {call};")
+            lines.append("    };")
+        return lines
+
+    def _batch_trampoline(self, param: Param, cb: Callback) -> list[str]:
+        """[batch] callbacks arrive as arrays; the per-element std::function runs over each one"""
+        cb_params = [f"const {self._batch_element_type(cp.type)}* {cp.name}" for cp in cb.params]
+        if cb.return_type != "void":
+            cb_params.append(f"{self._batch_element_type(cb.return_type)}* result")
+        cb_params += ["int count", "void* user_data"]
+        call = f"fn({', '.join(f'{cp.name}[i]' for cp in cb.params)})"
+        if cb.return_type == "bool":
+            call = f"result[i] = {call} ? 1 : 0"
+        elif cb.return_type != "void":
+            call = f"result[i] = {call}"
+        return [
+            f"    auto callback_wrapper_{param.name} = []({', '.join(cb_params)}) {{",
+            f"        const auto& fn = *static_cast<const {param.type}*>(user_data);",
+            "        for (int i = 0; i < count; ++i) {",
+            f"            {call};",
+            "        }",
+            "    };",
+        ]
+
+    def _has_async(self) -> bool:
+        return self.idl.symbols.has_async
+
+    def _async_decl(self, method: Method, qualifier: str = "") -> str:
+        params = ", ".join(self._param_to_cpp_decl(p) for p in method.params)
+        ret = TypeMapper.to_cpp(method.return_type)
+        return f"std::future<{ret}> {qualifier}{method.name}Async({params})"
+
+    def _async_result_c_type(self, idl_type: str) -> str:
+        """Result argument of the C API completion callback"""
+        if idl_type == "string":
+            return "const char*"
+        if self._is_struct_type(idl_type):
+            return f"const {idl_type}*"
+        if idl_type == "bool":
+            return "int"
+        return TypeMapper.to_c(idl_type)
+
+    def _async_impl(self, cls: Class, method: Method, prefix: str) -> list[str]:
+        """Submit through <Class>_<method>_submit; the completion callback fulfils a promise.
+        The pending state owns copies of the callbacks, so the caller's may go out of scope."""
+        const_q = " const" if method.is_const else ""
+        ret = method.return_type
+        cpp_ret = TypeMapper.to_cpp(ret)
+        callbacks = [p for p in method.params if self._is_callback_type(p.type)]
+        failure = (f'std::make_exception_ptr(Error({self.namespace.upper()}_ERROR_EXCEPTION, '
+                   f'"{cls.name}::{method.name}Async failed"))')
+
+        lines = [f"{self._async_decl(method, f'{cls.name}::')}{const_q} {{"]
+        lines.append("    struct Pending {")
+        lines.append(f"        std::promise<{cpp_ret}> promise;")
+        lines.extend(f"        {p.type} {p.name};" for p in callbacks)
+        lines.append("    };")
+        inits = ", ".join(["{}"] + [p.name for p in callbacks])
+        lines.append(f"    auto pending = std::unique_ptr<Pending>(new Pending{{{inits}}});")
+        lines.append(f"    std::future<{cpp_ret}> future = pending->promise.get_future();")
+        lines.extend(self._callback_trampolines(method))
+
+        done_params = ["int error", "void* user_data"]
+        if ret != "void":
+            done_params.insert(0, f"{self._async_result_c_type(ret)} result")
+        if ret == "void":
+            value = ""
+        elif ret == "bool":
+            value = "result != 0"
+        elif ret == "string":
+            value = "result ? std::string(result) : std::string()"
+        elif self._is_struct_type(ret):
+            value = "*result"
+        else:
+            value = "result"
+        lines.extend([
+            f"    ::{cls.name}_{method.name}_Done done = []({', '.join(done_params)}) {{",
+            "        std::unique_ptr<Pending> owned(static_cast<Pending*>(user_data));",
+            "        if (error) {",
+            "            // done runs on the worker thread, whose last error says why the call threw",
+            "            std::exception_ptr failed = lastError();",
+            f"            owned->promise.set_exception(failed ? failed : {failure});",
+            "        } else {",
+            f"            owned->promise.set_value({value});",
+            "        }",
+            "    };",
+        ])
+
+        c_args = ["handle_.get()"]
+        for p in method.params:
+            if self._is_callback_type(p.type):
+                c_args.append(f"callback_wrapper_{p.name}, &pending->{p.name}")
+            else:
+                c_args.append(self._to_c_arg(p))
+        c_args += ["done", "pending.get()"]
+        lines.extend([
+            "    if (!handle_) {",
+            f"        pending->promise.set_exception({failure});",
+            "        return future;",
+            "    }",
+            f"    if ({self._call(f'{prefix}_{method.name}_submit')}({', '.join(c_args)}) != 0) {{",
+            "        std::exception_ptr error = lastError();",
+            f"        pending->promise.set_exception(error ? error : {failure});",
+            "        return future;",
+            "    }",
+            "    pending.release();  // Freed by done",
+            "    return future;",
+            "}",
+            "",
+        ])
+        return lines
+
     def _is_callback_type(self, type_name: str) -> bool:
         """Check if type is a callback"""
-        return any(cb.name == type_name for cb in self.idl.callbacks)
+        return type_name in self.idl.symbols.callbacks
+
+    def _is_struct_type(self, type_name: str) -> bool:
+        """Check if type is a struct defined in IDL"""
+        return type_name in self.idl.symbols.structs
+
+    def _is_class_type(self, type_name: str) -> bool:
+        """Check if type is a class defined in IDL"""
+        return type_name in self.idl.symbols.classes
 
     def _param_to_cpp_decl(self, param: Param) -> str:
         """Convert param to C++ declaration for method signature"""
@@ -458,33 +1071,32 @@ class ClientGenerator:
                 return f'const std::string& {param.name}'
             return f'{base_type} {param.name}'
 
-    def _param_to_c_type(self, param: Param) -> str:
-        """Convert param type to C type (without name)"""
-        if param.type == 'string':
-            return 'const char*'
-        
-        # Callbacks are function pointers
-        if self._is_callback_type(param.type):
-            return f'::{param.type}'
-        
-        base = TypeMapper.to_c(param.type)
-        if param.is_const:
-            base = f'const {base}'
-        if param.is_pointer:
-            return f'{base}*'
-        return base
-
     def _to_c_arg(self, param: Param, method_name: str = "") -> str:
         if TypeMapper.is_string(param.type):
             return f"{param.name}.c_str()"
-        # Callbacks need a wrapper - the wrapper is generated as a static lambda
+        # Callbacks pass the trampoline plus a pointer to the std::function
         if self._is_callback_type(param.type):
-            return f"callback_wrapper_{param.name}"
+            return (f"callback_wrapper_{param.name}, "
+                    f"const_cast<void*>(static_cast<const void*>(&{param.name}))")
+        # Client objects cross the C API as their handles
+        if self._is_class_type(param.type):
+            if param.is_pointer:
+                return f"{param.name} ? {param.name}->handle() : nullptr"
+            return f"{param.name}.handle()"
         return param.name
 
+    def _callback_param_to_c(self, param: Param) -> str:
+        """C type of a callback parameter; struct references arrive as pointers"""
+        base = TypeMapper.to_c(param.type)
+        if param.is_reference and self._is_struct_type(param.type):
+            return f"const {base}*" if param.is_const else f"{base}*"
+        if param.is_const:
+            base = f"const {base}"
+        return f"{base}*" if param.is_pointer else base
+
     def _get_callback(self, type_name: str) -> Callback:
         """Get callback definition by name"""
-        return next((cb for cb in self.idl.callbacks if cb.name == type_name), None)
+        return self.idl.symbols.callbacks.get(type_name)
 
     def _getter_name(self, member: Member) -> str:
         prefix = "is" if member.type == "bool" else "get"
@@ -495,25 +1107,34 @@ class ClientGenerator:
         Must match the C API generator's naming convention."""
         return f"{iface_name}_{inner_type}_CResult"
 
+    def _columns_struct_name(self, iface_name: str, inner_type: str) -> str:
+        """C API columns struct of a [soa] method; matches the C API generator"""
+        return f"{iface_name}_{inner_type}_CColumns"
+
+    def _client_columns_name(self, iface_name: str, inner_type: str) -> str:
+        return f"{iface_name}{inner_type}Columns"
+
+    def _column_getter(self, member: Member) -> str:
+        return f"get{member.name[0].upper()}{member.name[1:]}Column"
+
+    def _stream_struct_name(self, iface_name: str, inner_type: str) -> str:
+        """C API pull iterator of a stream<T> method; matches the C API generator"""
+        return f"{iface_name}_{inner_type}_CStream"
+
+    def _client_stream_name(self, iface_name: str, inner_type: str) -> str:
+        return f"{iface_name}{inner_type}Stream"
+
     def _client_result_name(self, iface_name: str, inner_type: str) -> str:
         """Generate the client wrapper result class name for interface + element type"""
         return f"{iface_name}{inner_type}Result"
 
     def _cpp_return_type(self, iface_name: str, idl_type: str) -> str:
+        if TypeMapper.is_stream(idl_type):
+            return self._client_stream_name(iface_name, TypeMapper.stream_inner(idl_type))
         if TypeMapper.is_vector(idl_type):
             inner = TypeMapper.vector_inner(idl_type)
             return self._client_result_name(iface_name, inner)
+        base_type = idl_type.rstrip('*').strip()
+        if idl_type.endswith('*') and self._is_class_type(base_type):
+            return base_type  # Owning client object
         return TypeMapper.to_cpp(idl_type)
-
-    def _c_return_type_for_method(self, iface_name: str, idl_type: str) -> str:
-        """Get C return type using per-method result types for vectors"""
-        if TypeMapper.is_vector(idl_type):
-            inner = TypeMapper.vector_inner(idl_type)
-            result_name = self._result_struct_name(iface_name, inner)
-            return f"{result_name}*"
-        return TypeMapper.to_c(idl_type)
-
-    def _c_return_type(self, idl_type: str, result_type: str) -> str:
-        if TypeMapper.is_vector(idl_type):
-            return f"{result_type}*"
-        return TypeMapper.to_c(idl_type)
@@ -0,0 +1,65 @@
+"""Parsed IDL cache - skips re-parsing an IDL file whose content has not changed"""
+
+import hashlib
+import os
+import pickle
+import tempfile
+from pathlib import Path
+from typing import Optional
+
+from .parser import IDLParser, link_units
+from .types import ParsedIDL
+
+# Modules whose code shapes ParsedIDL; editing any of them invalidates every cache entry
+_PARSER_SOURCES = ("parser.py", "types.py")
+
+
+def _cache_key(text: str, path: Path) -> str:
+    digest = hashlib.sha256(text.encode())
+    digest.update(str(path).encode())
+    here = Path(__file__).parent
+    for name in _PARSER_SOURCES:
+        digest.update((here / name).read_bytes())
+    return digest.hexdigest()
+
+
+def _cached_unit(path: Path, cache_dir: Path) -> ParsedIDL:
+    """parse_unit() of one file, through <cache_dir>/<stem>.<path hash>.idlcache"""
+    path = path.resolve()
+    text = path.read_text()
+    key = _cache_key(text, path)
+    path_hash = hashlib.sha256(str(path).encode()).hexdigest()[:12]
+    cache_path = cache_dir / f"{path.stem}.{path_hash}.idlcache"
+    try:
+        with cache_path.open("rb") as f:
+            cached_key, unit = pickle.load(f)
+        if cached_key == key:
+            return unit
+    except Exception:
+        pass  # missing, unreadable or written by another idlgen version: parse again
+
+    unit = IDLParser(text, str(path)).parse_unit()
+    cache_dir.mkdir(parents=True, exist_ok=True)
+    fd, tmp = tempfile.mkstemp(dir=cache_dir, prefix=f".{path.stem}.", suffix=".tmp")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            pickle.dump((key, unit), f, protocol=pickle.HIGHEST_PROTOCOL)
+        os.replace(tmp, cache_path)
+    except OSError:
+        if os.path.exists(tmp):
+            os.unlink(tmp)
+    return unit
+
+
+def parse_idl_file(path: Path, cache_dir: Optional[Path] = None) -> ParsedIDL:
+    """Parse path and everything it imports, reusing one cache entry per file whose content
+    has not changed, so editing an imported file re-parses only that file.
+
+    Entries are replaced atomically, so generator runs sharing a cache directory in parallel
+    never read a partial file."""
+    if cache_dir is None:
+        return IDLParser(path.read_text(), str(path)).parse()
+    unit = _cached_unit(path, cache_dir)
+    if not unit.imports:
+        return unit
+    return link_units(unit, lambda imported: _cached_unit(imported, cache_dir))
@@ -0,0 +1,1642 @@
+"""IPC Generator - generates an out-of-process C++ client and server over shared memory"""
+
+from typing import Optional
+from .types import ParsedIDL, Class, Method, Param, size_param
+from .type_mapper import TypeMapper
+from .client_generator import ClientGenerator
+
+
+class IPCGenerator:
+    """Generates <namespace>_ipc.hpp/.cpp (client and transport) and <namespace>_ipc_server.cpp.
+
+    The client classes have the same methods as the in-process ClientGenerator classes, so
+    code can move between the two by switching namespace. Calls travel through a POSIX
+    shared-memory region: a lock-free single-producer single-consumer ring of requests, one
+    of responses, a per-call scratch area for arguments and results, and a shared heap.
+    Pointer arguments into the shared heap (Connection::allocate) cross by offset without
+    being copied; other pointers are staged in the scratch area when their length is known.
+    The server runs the C API, so a crash in the native code ends only the server process."""
+
+    def __init__(self, idl: ParsedIDL, namespace: str):
+        self.idl = idl
+        self.namespace = namespace
+        self.ipc_ns = f"{namespace}_ipc"
+        # Signatures come from the in-process client so the two interfaces cannot drift
+        self.client = ClientGenerator(idl, namespace)
+
+    # ── Call table ──────────────────────────────────────────────────
+
+    def unsupported_reason(self, method: Method) -> Optional[str]:
+        """Why a method cannot be called out of process, or None"""
+        if any(p.type in self.idl.symbols.callbacks for p in method.params):
+            return "callback parameters"
+        if any(TypeMapper.is_vector(p.type) for p in method.params):
+            return "vector parameters"
+        ret = method.return_type
+        base = ret.rstrip("*").strip()
+        if ret.endswith("*") and base not in self.idl.symbols.classes:
+            return "returns memory the caller must free"
+        if TypeMapper.is_vector(ret) and TypeMapper.vector_inner(ret) in self.idl.symbols.classes:
+            return "vector of class results"
+        if TypeMapper.is_stream(ret):
+            return "stream results, which pull from server-side state"
+        return None
+
+    def _methods(self, cls: Class) -> list[Method]:
+        return [m for m in cls.methods if not m.is_constructor and self.unsupported_reason(m) is None]
+
+    def _ops(self) -> list[tuple[str, str]]:
+        """(opcode name, signature) pairs in dispatch order; signatures feed the protocol fingerprint"""
+        ops = []
+        for cls in self.idl.classes:
+            ctor = self.idl.symbols.constructors[cls.name]
+            if ctor:
+                ops.append((f"{cls.name}_create", self._signature(cls.name, ctor.params, cls.name)))
+            ops.append((f"{cls.name}_destroy", f"{cls.name}_destroy()"))
+            for member in cls.members:
+                getter = self.client._getter_name(member)
+                ops.append((f"{cls.name}_{getter}", f"{cls.name}_{getter}()->{member.type}"))
+            for method in self._methods(cls):
+                ops.append((f"{cls.name}_{method.name}",
+                            self._signature(f"{cls.name}_{method.name}", method.params, method.return_type)))
+                if method.has_attribute("batch"):
+                    ops.append((f"{cls.name}_{method.name}_batch",
+                                self._signature(f"{cls.name}_{method.name}_batch", method.params,
+                                                f"vector<{method.return_type}>")))
+        return ops
+
+    @staticmethod
+    def _signature(name: str, params: list[Param], ret: str) -> str:
+        args = ",".join(("const " if p.is_const else "") + p.type + ("*" if p.is_pointer else "")
+                        + ("&" if p.is_reference else "") for p in params)
+        return f"{name}({args})->{ret}"
+
+    def protocol(self) -> int:
+        """FNV-1a of the call table: a client and server generated from different IDLs refuse to talk"""
+        value = 0x811C9DC5
+        for byte in "\n".join(sig for _, sig in self._ops()).encode():
+            value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+        return value
+
+    def _is_class(self, type_name: str) -> bool:
+        return type_name in self.idl.symbols.classes
+
+    def _c_type(self, idl_type: str) -> str:
+        return TypeMapper.to_c(idl_type)
+
+    def _result_inner(self, method: Method) -> str:
+        """Element type of a vector or string result"""
+        if method.return_type == "string":
+            return "char"
+        return self._c_type(TypeMapper.vector_inner(method.return_type))
+
+    # ── Header ──────────────────────────────────────────────────────
+
+    def generate_header(self, types_header: str) -> str:
+        ns = self.ipc_ns
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// Out-of-process client for the {self.namespace} library. The classes mirror",
+            f"// {self.namespace}_client.hpp; calls run in a {self.namespace}_ipc_server process over a",
+            "// POSIX shared-memory channel:",
+            "//   requests, responses  lock-free SPSC rings of fixed-size messages",
+            "//   scratch              arguments and results of the call in flight",
+            "//   heap                 Connection::allocate buffers, passed to the server by offset",
+            "// Limits:",
+            "//   results      vector and string results are copied back through the scratch area, and",
+            "//                one that does not fit fails; an *Into overload given a SharedBuffer has",
+            "//                the server write in place instead",
+            "//   concurrency  one call in flight per connection: threads take turns on a mutex, and each",
+            "//                ring has a single producer and a single consumer",
+            "//   unsupported  callback and vector parameters, stream<T> returns, [soa] columns and results",
+            "//                the caller must free; calling one fails to compile, naming the reason",
+            "#pragma once",
+            "",
+            "#include <atomic>",
+            "#include <chrono>",
+            "#include <cstddef>",
+            "#include <cstdint>",
+            "#include <cstring>",
+            "#include <future>",
+            "#include <map>",
+            "#include <memory>",
+            "#include <mutex>",
+            "#include <stdexcept>",
+            "#include <string>",
+            "#include <type_traits>",
+            "#include <vector>",
+            f'#include "{types_header}"',
+            "",
+            f"namespace {ns} {{",
+            "",
+        ]
+        for enum in self.idl.enums:
+            lines.append(f"using {enum.name} = ::{enum.name};")
+        if self.idl.enums:
+            lines.append("")
+        for struct in self.idl.structs:
+            lines.append(f"using {struct.name} = ::{struct.name};")
+        if self.idl.structs:
+            lines.append("")
+        lines.extend(self._runtime_decls())
+        for cls in self.idl.classes:
+            lines.append(f"class {cls.name};")
+        lines.append("")
+        for cls in self.idl.classes:
+            lines.extend(self._class_header(cls))
+        lines.extend([
+            "// Attaches the connection the classes' default constructors use; false if no server answered",
+            "bool initialize(const std::string& channel, std::chrono::milliseconds wait = std::chrono::seconds(5));",
+            "bool isInitialized();",
+            "// The default connection; throws TransportError before initialize()",
+            "std::shared_ptr<Connection> defaultConnection();",
+            "",
+            "// Creates the channel, waits for one client and runs its calls until it disconnects.",
+            "// Returns 0 after a clean disconnect and 1 when the client vanished or never came.",
+            "int serve(const std::string& channel, const ChannelOptions& options = {});",
+            "",
+            f"}} // namespace {ns}",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _runtime_decls(self) -> list[str]:
+        ops = self._ops()
+        lines = [
+            "// The server is unreachable, exited, or rejected a call",
+            "class TransportError : public std::runtime_error {",
+            "public:",
+            "    using std::runtime_error::runtime_error;",
+            "};",
+            "",
+            *self.client._error_class(),
+            "struct ChannelOptions {",
+            "    uint32_t scratch_bytes = 4u << 20;  // arguments and results of one call",
+            "    uint32_t heap_bytes = 16u << 20;    // memory for Connection::allocate",
+            "    std::chrono::milliseconds connect_timeout{0};  // serve(): how long to wait for a client (0: forever)",
+            "};",
+            "",
+            "namespace detail {",
+            "",
+            "constexpr uint32_t kMagic = 0x31435049;  // \"IPC1\"",
+            f"constexpr uint32_t kProtocol = 0x{self.protocol():08x}u;  // fingerprint of the call table",
+            "constexpr uint32_t kRingSlots = 64;",
+            "constexpr uint32_t kUnknownCount = 0xffffffffu;",
+            "",
+            "// False for every instantiation: an unsupported method's static_assert fires only when called",
+            "template <typename...>",
+            "struct UnsupportedOverIpc : std::false_type {};",
+            "",
+            "enum class Op : uint32_t {",
+            "    Close = 0,",
+        ]
+        for i, (name, _) in enumerate(ops, start=1):
+            lines.append(f"    {name} = {i},")
+        lines.extend([
+            "};",
+            "",
+            "enum Status : int32_t {",
+            "    kOk = 0,",
+            "    kBadObject = 1,       // unknown object id or wrong class",
+            "    kBadRequest = 2,      // malformed arguments or out-of-range offsets",
+            "    kResultTooLarge = 3,  // the result does not fit the scratch area",
+            "    kUnknownOp = 4,",
+            "    kFailed = 5,          // the server threw",
+            f"    kFailedWithError = 6, // a checked C API call failed: results are its {self.namespace}_error_code and message",
+            "};",
+            "",
+            "// How a pointer argument crosses: a {kind, offset, count} descriptor",
+            "enum PointerKind : uint32_t {",
+            "    kNull = 0,",
+            "    kShared = 1,       // offset into the shared heap: no copy",
+            "    kStaged = 2,       // offset into the scratch area: copied by the client",
+            "    kScratchTail = 3,  // output only: the server picks room after the arguments",
+            "};",
+            "",
+            "struct Message {",
+            "    uint32_t op;",
+            "    uint32_t object;    // target object id, 0 for none",
+            "    uint32_t sequence;",
+            "    int32_t status;     // response: Status",
+            "    uint32_t offset;    // request: start of the staged data; response: offset of the results",
+            "    uint32_t size;      // length of the arguments or results in bytes",
+            "};",
+            "",
+            "// Single-producer single-consumer queue of messages in shared memory",
+            "struct Ring {",
+            "    alignas(64) std::atomic<uint32_t> head;  // next slot the consumer reads",
+            "    alignas(64) std::atomic<uint32_t> tail;  // next slot the producer writes",
+            "    alignas(64) Message slots[kRingSlots];",
+            "",
+            "    bool push(const Message& message) noexcept;",
+            "    bool pop(Message& message) noexcept;",
+            "};",
+            "",
+            "static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,",
+            "              \"shared-memory rings need address-free atomics\");",
+            "",
+            "struct Header {",
+            "    std::atomic<uint32_t> magic;  // stored last: the region is ready",
+            "    uint32_t protocol;",
+            "    uint32_t scratch_bytes;",
+            "    uint32_t heap_bytes;",
+            "    std::atomic<int32_t> server_pid;",
+            "    std::atomic<int32_t> client_pid;",
+            "    Ring requests;",
+            "    Ring responses;",
+            "};",
+            "",
+            "constexpr size_t kArenaOffset = (sizeof(Header) + 63) / 64 * 64;",
+            "",
+            "// A mapped channel: header, then scratch_bytes of scratch, then heap_bytes of heap",
+            "class Region {",
+            "public:",
+            "    // Replaces a channel its server left behind; throws TransportError while that server runs",
+            "    static std::unique_ptr<Region> create(const std::string& channel, const ChannelOptions& options);",
+            "    // nullptr while no server has published the channel",
+            "    static std::unique_ptr<Region> open(const std::string& channel);",
+            "    ~Region();",
+            "",
+            "    Region(const Region&) = delete;",
+            "    Region& operator=(const Region&) = delete;",
+            "",
+            "    Header* header = nullptr;",
+            "    uint8_t* scratch = nullptr;",
+            "    uint8_t* heap = nullptr;",
+            "",
+            "private:",
+            "    Region() = default;",
+            "    void* base_ = nullptr;",
+            "    size_t size_ = 0;",
+            "    std::string unlink_;  // set for the creator",
+            "};",
+            "",
+            "// Spins briefly, then yields, then sleeps: waits stay cheap on a busy peer and idle ones sleep",
+            "class Backoff {",
+            "public:",
+            "    void pause();",
+            "    void reset() noexcept { rounds_ = 0; }",
+            "    [[nodiscard]] bool sleeping() const noexcept { return rounds_ >= 256; }",
+            "",
+            "private:",
+            "    uint32_t rounds_ = 0;",
+            "};",
+            "",
+            "bool processAlive(int32_t pid) noexcept;",
+            "",
+            "// Appends values to the scratch area from the bottom, and staged arrays from the top;",
+            "// offsets are relative to the scratch start",
+            "class Writer {",
+            "public:",
+            "    Writer() = default;",
+            "    Writer(uint8_t* base, uint32_t capacity, uint32_t used) noexcept",
+            "        : base_(base), capacity_(capacity), used_(used) {}",
+            "",
+            "    template <typename T>",
+            "    uint32_t put(const T& value) {",
+            "        const uint32_t at = reserve(sizeof(T), alignof(T));",
+            "        std::memcpy(base_ + at, &value, sizeof(T));",
+            "        return at;",
+            "    }",
+            "    // Offset of size bytes at the given alignment; throws TransportError when full",
+            "    uint32_t reserve(size_t size, size_t align);",
+            "    // Same, taken from the top: lowers capacity()",
+            "    uint32_t reserveTop(size_t size, size_t align);",
+            "    [[nodiscard]] uint8_t* at(uint32_t offset) const noexcept { return base_ + offset; }",
+            "    [[nodiscard]] uint32_t used() const noexcept { return used_; }",
+            "    [[nodiscard]] uint32_t capacity() const noexcept { return capacity_; }",
+            "",
+            "private:",
+            "    uint8_t* base_ = nullptr;",
+            "    uint32_t capacity_ = 0;",
+            "    uint32_t used_ = 0;",
+            "};",
+            "",
+            "// Reads values back in the order they were put; throws TransportError past the end",
+            "class Reader {",
+            "public:",
+            "    Reader(const uint8_t* base, uint32_t begin, uint32_t end) noexcept",
+            "        : base_(base), position_(begin), end_(end) {}",
+            "",
+            "    template <typename T>",
+            "    T get() {",
+            "        T value;",
+            "        std::memcpy(&value, bytes(sizeof(T), alignof(T)), sizeof(T));",
+            "        return value;",
+            "    }",
+            "    template <typename T>",
+            "    const T* array(size_t count) {",
+            "        return reinterpret_cast<const T*>(bytes(count * sizeof(T), alignof(T)));",
+            "    }",
+            "    const uint8_t* bytes(size_t size, size_t align);",
+            "    const char* string();",
+            "",
+            "private:",
+            "    const uint8_t* base_;",
+            "    uint32_t position_;",
+            "    uint32_t end_;",
+            "};",
+            "",
+            "} // namespace detail",
+            "",
+            "class Connection;",
+            "",
+            "// Memory in the channel's shared heap: pointer arguments into it are not copied",
+            "class SharedBuffer {",
+            "public:",
+            "    SharedBuffer() = default;",
+            "    ~SharedBuffer();",
+            "    SharedBuffer(SharedBuffer&& other) noexcept;",
+            "    SharedBuffer& operator=(SharedBuffer&& other) noexcept;",
+            "",
+            "    [[nodiscard]] uint8_t* data() const noexcept { return data_; }",
+            "    [[nodiscard]] size_t size() const noexcept { return size_; }",
+            "    template <typename T>",
+            "    [[nodiscard]] T* as() const noexcept { return reinterpret_cast<T*>(data_); }",
+            "",
+            "private:",
+            "    friend class Connection;",
+            "    SharedBuffer(std::shared_ptr<Connection> owner, uint8_t* data, size_t size, uint32_t offset) noexcept",
+            "        : owner_(std::move(owner)), data_(data), size_(size), offset_(offset) {}",
+            "",
+            "    std::shared_ptr<Connection> owner_;",
+            "    uint8_t* data_ = nullptr;",
+            "    size_t size_ = 0;",
+            "    uint32_t offset_ = 0;",
+            "};",
+            "",
+            "// Wraps the id of an object that lives in the server",
+            "struct RemoteId {",
+            "    uint32_t value = 0;",
+            "};",
+            "",
+            "// A client's attachment to a channel. Calls from several threads take turns.",
+            "class Connection : public std::enable_shared_from_this<Connection> {",
+            "public:",
+            "    // Attaches to the channel serve() created, retrying until wait elapses",
+            "    static std::shared_ptr<Connection> open(const std::string& channel,",
+            "                                            std::chrono::milliseconds wait = std::chrono::seconds(5));",
+            "    ~Connection();",
+            "",
+            "    Connection(const Connection&) = delete;",
+            "    Connection& operator=(const Connection&) = delete;",
+            "",
+            "    // size bytes of shared heap, 64-byte aligned; throws TransportError when the heap is full",
+            "    [[nodiscard]] SharedBuffer allocate(size_t size);",
+            "    // Whether [data, data + size) lies in the shared heap",
+            "    [[nodiscard]] bool isShared(const void* data, size_t size = 1) const noexcept;",
+            "    // Fail calls the server has not answered after timeout (0, the default: wait while it lives)",
+            "    void setCallTimeout(std::chrono::milliseconds timeout) noexcept { timeout_ = timeout; }",
+            "",
+            "    // One request and its response; holds the connection until destroyed",
+            "    class Call {",
+            "    public:",
+            "        // Pointer argument the server reads. Returns its scratch offset when staged, else 0.",
+            "        template <typename T>",
+            "        uint32_t input(const T* data, size_t count) {",
+            "            return pointer(data, sizeof(T), alignof(T), count, true);",
+            "        }",
+            "        // Pointer argument the server writes (and reads when copy_in); copy staged data back after invoke()",
+            "        template <typename T>",
+            "        uint32_t output(T* data, size_t count, bool copy_in = false) {",
+            "            return pointer(data, sizeof(T), alignof(T), count, copy_in);",
+            "        }",
+            "        // Output the server places after the arguments; its result is a count and the items",
+            "        void scratchTail();",
+            "        void string(const std::string& value);",
+            "        // Sends the call and waits for the response; throws TransportError on failure",
+            "        detail::Reader invoke();",
+            "        [[nodiscard]] const uint8_t* scratch(uint32_t offset) const noexcept;",
+            "",
+            "        detail::Writer args;",
+            "",
+            "    private:",
+            "        friend class Connection;",
+            "        Call(Connection& connection, detail::Op op, uint32_t object);",
+            "        uint32_t pointer(const void* data, size_t element, size_t align, size_t count, bool copy_in);",
+            "",
+            "        std::unique_lock<std::mutex> lock_;",
+            "        Connection& connection_;",
+            "        detail::Op op_;",
+            "        uint32_t object_;",
+            "    };",
+            "",
+            "    [[nodiscard]] Call call(detail::Op op, uint32_t object);",
+            "",
+            "private:",
+            "    friend class SharedBuffer;",
+            "    Connection() = default;",
+            "    void release(uint32_t offset) noexcept;",
+            "",
+            "    std::unique_ptr<detail::Region> region_;",
+            "    std::mutex mutex_;  // one call at a time",
+            "    uint32_t sequence_ = 0;",
+            "    bool broken_ = false;  // a timed-out call left the rings out of step",
+            "    std::chrono::milliseconds timeout_{0};",
+            "    std::mutex heap_mutex_;",
+            "    std::map<uint32_t, uint32_t> free_;  // heap offset -> bytes",
+            "    std::map<uint32_t, uint32_t> used_;",
+            "};",
+            "",
+        ])
+        return lines
+
+    def _class_header(self, cls: Class) -> list[str]:
+        lines = []
+        for inner in self.idl.symbols.result_types[cls.name]:
+            result = self.client._client_result_name(cls.name, inner)
+            lines.extend([
+                f"class {result} {{",
+                "public:",
+                f"    {result}() = default;",
+                f"    explicit {result}(std::vector<{inner}> items) noexcept : items_(std::move(items)) {{}}",
+                "",
+                "    [[nodiscard]] int count() const noexcept { return static_cast<int>(items_.size()); }",
+                f"    [[nodiscard]] const {inner}* data() const noexcept {{ return items_.data(); }}",
+                f"    [[nodiscard]] std::vector<{inner}> toVector() const {{ return items_; }}",
+                "",
+                "private:",
+                f"    std::vector<{inner}> items_;",
+                "};",
+                "",
+            ])
+
+        name = cls.name
+        lines.append(f"class {name} {{")
+        lines.append("public:")
+        ctor = self.idl.symbols.constructors[name]
+        if ctor:
+            params = [self.client._param_to_cpp_decl(p) for p in ctor.params]
+            lines.append("    // Creates the object in the server of defaultConnection()")
+            lines.append(f"    explicit {name}({', '.join(params)});")
+            lines.append(f"    explicit {name}({', '.join(['std::shared_ptr<Connection> connection'] + params)});")
+        lines.extend([
+            "    // Adopts an object that already lives in the server (e.g. one returned by another class)",
+            f"    {name}(std::shared_ptr<Connection> connection, RemoteId id) noexcept;",
+            f"    ~{name}();",
+            "",
+            f"    {name}(const {name}&) = delete;",
+            f"    {name}& operator=(const {name}&) = delete;",
+            f"    {name}({name}&& other) noexcept;",
+            f"    {name}& operator=({name}&& other) noexcept;",
+            "",
+            "    [[nodiscard]] uint32_t id() const noexcept { return id_; }",
+            "    [[nodiscard]] const std::shared_ptr<Connection>& connection() const noexcept { return connection_; }",
+            "",
+        ])
+        for member in cls.members:
+            lines.append(f"    [[nodiscard]] {TypeMapper.to_cpp(member.type)} {self.client._getter_name(member)}() const;")
+        for method in cls.methods:
+            if method.is_constructor:
+                continue
+            reason = self.unsupported_reason(method)
+            if reason:
+                lines.extend(self._unsupported_decls(cls, method, reason))
+                continue
+            ret = self.client._cpp_return_type(name, method.return_type)
+            params = ", ".join(self.client._param_to_cpp_decl(p) for p in method.params)
+            const_q = " const" if method.is_const else ""
+            lines.append(f"    [[nodiscard]] {ret} {method.name}({params}){const_q};")
+            if method.has_attribute("batch"):
+                lines.append(f"    {self.client._batch_decl(method)}{const_q};")
+            if self.client._has_into(method):
+                for decl in self.client._into_decls(method):
+                    lines.append(f"    {decl};")
+            if method.has_attribute("async"):
+                lines.append(f"    [[nodiscard]] {self.client._async_decl(method)}{const_q};")
+            if method.has_attribute("soa"):
+                lines.extend(self._unsupported_decls(cls, method, "struct-of-arrays columns", ["Columns"]))
+        lines.extend([
+            "",
+            "private:",
+            "    void reset() noexcept;",
+            "",
+            "    std::shared_ptr<Connection> connection_;",
+            "    uint32_t id_ = 0;",
+            "};",
+            "",
+        ])
+        return lines
+
+    def _unsupported_decls(self, cls: Class, method: Method, reason: str,
+                           suffixes: Optional[list[str]] = None) -> list[str]:
+        """Stand-ins for the in-process client's methods that cannot run out of process: any
+        call fails to compile with the reason rather than with an unknown member"""
+        if suffixes is None:
+            suffixes = [""]
+            if method.has_attribute("batch"):
+                suffixes.append("Batch")
+            if self.client._has_into(method):
+                suffixes.append("Into")
+            if method.has_attribute("async"):
+                suffixes.append("Async")
+            if method.has_attribute("soa"):
+                suffixes.append("Columns")
+        lines = []
+        for suffix in suffixes:
+            name = f"{method.name}{suffix}"
+            lines.extend([
+                "    template <typename... Args>",
+                f"    void {name}(Args&&...) const {{",
+                "        static_assert(detail::UnsupportedOverIpc<Args...>::value,",
+                f'                      "{cls.name}::{name} is unsupported over IPC: {reason}");',
+                "    }",
+            ])
+        return lines
+
+    # ── Client and transport ────────────────────────────────────────
+
+    def generate_impl(self) -> str:
+        ns = self.ipc_ns
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f'#include "{self.namespace}_ipc.hpp"',
+            "",
+            "#include <algorithm>",
+            "#include <cerrno>",
+            "#include <new>",
+            "#include <thread>",
+            "#include <utility>",
+            "",
+            "#include <fcntl.h>",
+            "#include <signal.h>",
+            "#include <sys/mman.h>",
+            "#include <sys/stat.h>",
+            "#include <unistd.h>",
+            "",
+            f"namespace {ns} {{",
+            "namespace detail {",
+            "",
+            *self._transport_impl(),
+            "} // namespace detail",
+            "",
+            *self._connection_impl(),
+        ]
+        for cls in self.idl.classes:
+            lines.extend(self._class_impl(cls))
+        lines.extend([
+            f"}} // namespace {ns}",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _transport_impl(self) -> list[str]:
+        return [
+            "bool Ring::push(const Message& message) noexcept {",
+            "    const uint32_t at = tail.load(std::memory_order_relaxed);",
+            "    if (at - head.load(std::memory_order_acquire) == kRingSlots) return false;",
+            "    slots[at % kRingSlots] = message;",
+            "    tail.store(at + 1, std::memory_order_release);",
+            "    return true;",
+            "}",
+            "",
+            "bool Ring::pop(Message& message) noexcept {",
+            "    const uint32_t at = head.load(std::memory_order_relaxed);",
+            "    if (at == tail.load(std::memory_order_acquire)) return false;",
+            "    message = slots[at % kRingSlots];",
+            "    head.store(at + 1, std::memory_order_release);",
+            "    return true;",
+            "}",
+            "",
+            "namespace {",
+            "",
+            "std::string shmPath(const std::string& channel) {",
+            "    return channel.empty() || channel[0] != '/' ? \"/\" + channel : channel;",
+            "}",
+            "",
+            "TransportError systemError(const std::string& what, const std::string& path) {",
+            "    return TransportError(what + \" \" + path + \": \" + std::strerror(errno));",
+            "}",
+            "",
+            "// Pid of the server that created the channel at path; 0 when it has not written one",
+            "int32_t channelOwner(const std::string& path) {",
+            "    const int fd = ::shm_open(path.c_str(), O_RDONLY, 0);",
+            "    if (fd < 0) return 0;",
+            "    int32_t pid = 0;",
+            "    struct stat st;",
+            "    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)) {",
+            "        void* base = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);",
+            "        if (base != MAP_FAILED) {",
+            "            pid = static_cast<const Header*>(base)->server_pid.load(std::memory_order_relaxed);",
+            "            ::munmap(base, sizeof(Header));",
+            "        }",
+            "    }",
+            "    ::close(fd);",
+            "    return pid;",
+            "}",
+            "",
+            "} // namespace",
+            "",
+            "std::unique_ptr<Region> Region::create(const std::string& channel, const ChannelOptions& options) {",
+            "    const std::string path = shmPath(channel);",
+            "    const size_t size = kArenaOffset + size_t(options.scratch_bytes) + options.heap_bytes;",
+            "    int fd = ::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);",
+            "    if (fd < 0 && errno == EEXIST) {",
+            "        // Left behind by a server that crashed, unless that server still runs",
+            "        const int32_t owner = channelOwner(path);",
+            "        if (processAlive(owner)) {",
+            "            throw TransportError(\"channel \" + channel + \" in use by process \" + std::to_string(owner));",
+            "        }",
+            "        ::shm_unlink(path.c_str());",
+            "        fd = ::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);",
+            "    }",
+            "    if (fd < 0) throw systemError(\"shm_open\", path);",
+            "    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {",
+            "        const TransportError error = systemError(\"ftruncate\", path);",
+            "        ::close(fd);",
+            "        ::shm_unlink(path.c_str());",
+            "        throw error;",
+            "    }",
+            "    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);",
+            "    ::close(fd);",
+            "    if (base == MAP_FAILED) {",
+            "        const TransportError error = systemError(\"mmap\", path);",
+            "        ::shm_unlink(path.c_str());",
+            "        throw error;",
+            "    }",
+            "",
+            "    std::unique_ptr<Region> region(new Region());",
+            "    region->base_ = base;",
+            "    region->size_ = size;",
+            "    region->unlink_ = path;",
+            "    region->header = new (base) Header();",
+            "    region->header->protocol = kProtocol;",
+            "    region->header->scratch_bytes = options.scratch_bytes;",
+            "    region->header->heap_bytes = options.heap_bytes;",
+            "    region->header->server_pid.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);",
+            "    region->scratch = static_cast<uint8_t*>(base) + kArenaOffset;",
+            "    region->heap = region->scratch + options.scratch_bytes;",
+            "    region->header->magic.store(kMagic, std::memory_order_release);",
+            "    return region;",
+            "}",
+            "",
+            "std::unique_ptr<Region> Region::open(const std::string& channel) {",
+            "    const std::string path = shmPath(channel);",
+            "    const int fd = ::shm_open(path.c_str(), O_RDWR, 0);",
+            "    if (fd < 0) {",
+            "        if (errno == ENOENT) return nullptr;",
+            "        throw systemError(\"shm_open\", path);",
+            "    }",
+            "    struct stat st;",
+            "    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kArenaOffset) {",
+            "        ::close(fd);",
+            "        return nullptr;  // still being sized",
+            "    }",
+            "    const size_t size = static_cast<size_t>(st.st_size);",
+            "    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);",
+            "    ::close(fd);",
+            "    if (base == MAP_FAILED) throw systemError(\"mmap\", path);",
+            "",
+            "    std::unique_ptr<Region> region(new Region());",
+            "    region->base_ = base;",
+            "    region->size_ = size;",
+            "    region->header = static_cast<Header*>(base);",
+            "    if (region->header->magic.load(std::memory_order_acquire) != kMagic) return nullptr;",
+            "    if (region->header->protocol != kProtocol) {",
+            "        throw TransportError(\"channel \" + channel + \" is served from a different IDL\");",
+            "    }",
+            "    // macOS rounds shared-memory objects up to whole pages",
+            "    if (kArenaOffset + size_t(region->header->scratch_bytes) + region->header->heap_bytes > size) {",
+            "        throw TransportError(\"channel \" + channel + \" has an inconsistent size\");",
+            "    }",
+            "    region->scratch = static_cast<uint8_t*>(base) + kArenaOffset;",
+            "    region->heap = region->scratch + region->header->scratch_bytes;",
+            "    return region;",
+            "}",
+            "",
+            "Region::~Region() {",
+            "    if (base_) ::munmap(base_, size_);",
+            "    if (!unlink_.empty()) ::shm_unlink(unlink_.c_str());",
+            "}",
+            "",
+            "void Backoff::pause() {",
+            "    ++rounds_;",
+            "    if (rounds_ < 64) return;",
+            "    if (rounds_ < 256) {",
+            "        std::this_thread::yield();",
+            "        return;",
+            "    }",
+            "    std::this_thread::sleep_for(std::chrono::microseconds(rounds_ < 1024 ? 50 : 1000));",
+            "}",
+            "",
+            "bool processAlive(int32_t pid) noexcept {",
+            "    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);",
+            "}",
+            "",
+            "uint32_t Writer::reserveTop(size_t size, size_t align) {",
+            "    if (size > capacity_ || (capacity_ - size) / align * align < used_) {",
+            "        throw TransportError(\"call data does not fit the channel's scratch area\");",
+            "    }",
+            "    capacity_ = static_cast<uint32_t>((capacity_ - size) / align * align);",
+            "    return capacity_;",
+            "}",
+            "",
+            "uint32_t Writer::reserve(size_t size, size_t align) {",
+            "    const size_t at = (size_t(used_) + align - 1) / align * align;",
+            "    if (at > capacity_ || size > capacity_ - at) {",
+            "        throw TransportError(\"call data does not fit the channel's scratch area\");",
+            "    }",
+            "    used_ = static_cast<uint32_t>(at + size);",
+            "    return static_cast<uint32_t>(at);",
+            "}",
+            "",
+            "const uint8_t* Reader::bytes(size_t size, size_t align) {",
+            "    const size_t at = (size_t(position_) + align - 1) / align * align;",
+            "    if (at > end_ || size > end_ - at) throw TransportError(\"truncated call data\");",
+            "    position_ = static_cast<uint32_t>(at + size);",
+            "    return base_ + at;",
+            "}",
+            "",
+            "const char* Reader::string() {",
+            "    const uint32_t length = get<uint32_t>();",
+            "    const char* text = reinterpret_cast<const char*>(bytes(size_t(length) + 1, 1));",
+            "    if (text[length] != '\\0') throw TransportError(\"unterminated string argument\");",
+            "    return text;",
+            "}",
+            "",
+        ]
+
+    def _connection_impl(self) -> list[str]:
+        return [
+            "// ── Shared heap ──",
+            "",
+            "SharedBuffer::~SharedBuffer() {",
+            "    if (owner_) owner_->release(offset_);",
+            "}",
+            "",
+            "SharedBuffer::SharedBuffer(SharedBuffer&& other) noexcept",
+            "    : owner_(std::move(other.owner_)), data_(other.data_), size_(other.size_), offset_(other.offset_) {",
+            "    other.data_ = nullptr;",
+            "    other.size_ = 0;",
+            "}",
+            "",
+            "SharedBuffer& SharedBuffer::operator=(SharedBuffer&& other) noexcept {",
+            "    if (this != &other) {",
+            "        if (owner_) owner_->release(offset_);",
+            "        owner_ = std::move(other.owner_);",
+            "        data_ = other.data_;",
+            "        size_ = other.size_;",
+            "        offset_ = other.offset_;",
+            "        other.data_ = nullptr;",
+            "        other.size_ = 0;",
+            "    }",
+            "    return *this;",
+            "}",
+            "",
+            "SharedBuffer Connection::allocate(size_t size) {",
+            "    const size_t rounded = std::max<size_t>(64, (size + 63) / 64 * 64);",
+            "    std::lock_guard<std::mutex> lock(heap_mutex_);",
+            "    for (auto it = free_.begin(); it != free_.end(); ++it) {",
+            "        if (it->second < rounded) continue;",
+            "        const uint32_t offset = it->first;",
+            "        const uint32_t rest = it->second - static_cast<uint32_t>(rounded);",
+            "        free_.erase(it);",
+            "        if (rest) free_[offset + static_cast<uint32_t>(rounded)] = rest;",
+            "        used_[offset] = static_cast<uint32_t>(rounded);",
+            "        return SharedBuffer(shared_from_this(), region_->heap + offset, size, offset);",
+            "    }",
+            "    throw TransportError(\"shared heap exhausted\");",
+            "}",
+            "",
+            "void Connection::release(uint32_t offset) noexcept {",
+            "    std::lock_guard<std::mutex> lock(heap_mutex_);",
+            "    auto used = used_.find(offset);",
+            "    if (used == used_.end()) return;",
+            "    uint32_t size = used->second;",
+            "    used_.erase(used);",
+            "    // Coalesce with the free neighbours",
+            "    auto next = free_.lower_bound(offset);",
+            "    if (next != free_.end() && offset + size == next->first) {",
+            "        size += next->second;",
+            "        next = free_.erase(next);",
+            "    }",
+            "    if (next != free_.begin()) {",
+            "        auto prev = std::prev(next);",
+            "        if (prev->first + prev->second == offset) {",
+            "            prev->second += size;",
+            "            return;",
+            "        }",
+            "    }",
+            "    free_[offset] = size;",
+            "}",
+            "",
+            "bool Connection::isShared(const void* data, size_t size) const noexcept {",
+            "    const auto begin = reinterpret_cast<uintptr_t>(region_->heap);",
+            "    const auto at = reinterpret_cast<uintptr_t>(data);",
+            "    return at >= begin && size <= region_->header->heap_bytes && at - begin <= region_->header->heap_bytes - size;",
+            "}",
+            "",
+            "// ── Calls ──",
+            "",
+            "std::shared_ptr<Connection> Connection::open(const std::string& channel, std::chrono::milliseconds wait) {",
+            "    const auto deadline = std::chrono::steady_clock::now() + wait;",
+            "    std::unique_ptr<detail::Region> region;",
+            "    detail::Backoff backoff;",
+            "    while (!(region = detail::Region::open(channel))) {",
+            "        if (std::chrono::steady_clock::now() >= deadline) {",
+            "            throw TransportError(\"no server on channel \" + channel);",
+            "        }",
+            "        backoff.pause();",
+            "    }",
+            "    int32_t nobody = 0;",
+            "    if (!region->header->client_pid.compare_exchange_strong(nobody, static_cast<int32_t>(::getpid()))) {",
+            "        throw TransportError(\"channel \" + channel + \" already has a client\");",
+            "    }",
+            "    std::shared_ptr<Connection> connection(new Connection());",
+            "    if (region->header->heap_bytes) connection->free_[0] = region->header->heap_bytes;",
+            "    connection->region_ = std::move(region);",
+            "    return connection;",
+            "}",
+            "",
+            "Connection::~Connection() {",
+            "    if (!region_) return;",
+            "    detail::Message close{};",
+            "    close.op = static_cast<uint32_t>(detail::Op::Close);",
+            "    region_->header->requests.push(close);",
+            "}",
+            "",
+            "Connection::Call Connection::call(detail::Op op, uint32_t object) {",
+            "    return Call(*this, op, object);",
+            "}",
+            "",
+            "Connection::Call::Call(Connection& connection, detail::Op op, uint32_t object)",
+            "    : lock_(connection.mutex_), connection_(connection), op_(op), object_(object) {",
+            "    if (connection.broken_) throw TransportError(\"connection lost after a timed-out call\");",
+            "    args = detail::Writer(connection.region_->scratch, connection.region_->header->scratch_bytes, 0);",
+            "}",
+            "",
+            "uint32_t Connection::Call::pointer(const void* data, size_t element, size_t align, size_t count, bool copy_in) {",
+            "    const bool known = count != detail::kUnknownCount;",
+            "    const size_t bytes = known ? element * count : 0;",
+            "    const uint32_t at = args.reserve(3 * sizeof(uint32_t), alignof(uint32_t));",
+            "    uint32_t descriptor[3] = {detail::kNull, 0, static_cast<uint32_t>(count)};",
+            "    uint32_t staged = 0;",
+            "    if (data && connection_.isShared(data, std::max<size_t>(bytes, 1))) {",
+            "        descriptor[0] = detail::kShared;",
+            "        descriptor[1] = static_cast<uint32_t>(static_cast<const uint8_t*>(data) - connection_.region_->heap);",
+            "    } else if (data) {",
+            "        if (!known) throw std::invalid_argument(\"a pointer of unknown length must point into a SharedBuffer\");",
+            "        // Staged bytes stay out of the argument stream, which the server reads in order",
+            "        staged = args.reserveTop(bytes, align);",
+            "        if (copy_in && bytes) std::memcpy(args.at(staged), data, bytes);",
+            "        descriptor[0] = detail::kStaged;",
+            "        descriptor[1] = staged;",
+            "    }",
+            "    std::memcpy(args.at(at), descriptor, sizeof(descriptor));",
+            "    return staged;",
+            "}",
+            "",
+            "void Connection::Call::scratchTail() {",
+            "    const uint32_t descriptor[3] = {detail::kScratchTail, 0, 0};",
+            "    for (uint32_t word : descriptor) args.put(word);",
+            "}",
+            "",
+            "void Connection::Call::string(const std::string& value) {",
+            "    args.put(static_cast<uint32_t>(value.size()));",
+            "    const uint32_t at = args.reserve(value.size() + 1, 1);",
+            "    std::memcpy(args.at(at), value.c_str(), value.size() + 1);",
+            "}",
+            "",
+            "const uint8_t* Connection::Call::scratch(uint32_t offset) const noexcept {",
+            "    return connection_.region_->scratch + offset;",
+            "}",
+            "",
+            "detail::Reader Connection::Call::invoke() {",
+            "    detail::Region& region = *connection_.region_;",
+            "    detail::Message request{};",
+            "    request.op = static_cast<uint32_t>(op_);",
+            "    request.object = object_;",
+            "    request.sequence = ++connection_.sequence_;",
+            "    request.offset = args.capacity();",
+            "    request.size = args.used();",
+            "    const int32_t server = region.header->server_pid.load(std::memory_order_relaxed);",
+            "    const auto started = std::chrono::steady_clock::now();",
+            "    detail::Backoff backoff;",
+            "    while (!region.header->requests.push(request)) backoff.pause();",
+            "",
+            "    detail::Message response{};",
+            "    backoff.reset();",
+            "    while (!region.header->responses.pop(response)) {",
+            "        if (backoff.sleeping()) {",
+            "            if (!detail::processAlive(server)) {",
+            "                connection_.broken_ = true;",
+            "                throw TransportError(\"server exited\");",
+            "            }",
+            "            if (connection_.timeout_.count() > 0 &&",
+            "                std::chrono::steady_clock::now() - started > connection_.timeout_) {",
+            "                connection_.broken_ = true;",
+            "                throw TransportError(\"call timed out\");",
+            "            }",
+            "        }",
+            "        backoff.pause();",
+            "    }",
+            "    if (response.sequence != request.sequence) {",
+            "        connection_.broken_ = true;",
+            "        throw TransportError(\"response out of sequence\");",
+            "    }",
+            "    switch (response.status) {",
+            "    case detail::kOk:",
+            "        break;",
+            "    case detail::kBadObject:",
+            "        throw TransportError(\"the server does not know the object\");",
+            "    case detail::kResultTooLarge:",
+            "        throw TransportError(\"result does not fit the channel's scratch area \"",
+            "                             \"(an *Into overload with a SharedBuffer avoids the copy)\");",
+            "    case detail::kUnknownOp:",
+            "        throw TransportError(\"the call is unsupported over IPC by this server\");",
+            "    case detail::kBadRequest:",
+            "        throw TransportError(\"the server rejected the arguments\");",
+            "    case detail::kFailedWithError: {",
+            "        detail::Reader error(region.scratch, response.offset, response.offset + response.size);",
+            f"        const auto code = static_cast<{self.namespace}_error_code>(error.get<int32_t>());",
+            "        throw Error(code, error.string());",
+            "    }",
+            "    default:",
+            "        throw TransportError(\"call failed in the server\");",
+            "    }",
+            "    return detail::Reader(region.scratch, response.offset, response.offset + response.size);",
+            "}",
+            "",
+            "// ── Default connection ──",
+            "",
+            "namespace {",
+            "std::mutex gDefaultMutex;",
+            "std::shared_ptr<Connection> gDefault;",
+            "",
+            "template <typename T>",
+            "uint32_t remoteId(const T* object, const std::shared_ptr<Connection>& connection) {",
+            "    if (!object) return 0;",
+            "    if (object->connection() != connection) {",
+            "        throw std::invalid_argument(\"object belongs to a different connection\");",
+            "    }",
+            "    return object->id();",
+            "}",
+            "} // namespace",
+            "",
+            "bool initialize(const std::string& channel, std::chrono::milliseconds wait) {",
+            "    try {",
+            "        auto connection = Connection::open(channel, wait);",
+            "        std::lock_guard<std::mutex> lock(gDefaultMutex);",
+            "        gDefault = std::move(connection);",
+            "        return true;",
+            "    } catch (const TransportError&) {",
+            "        return false;",
+            "    }",
+            "}",
+            "",
+            "bool isInitialized() {",
+            "    std::lock_guard<std::mutex> lock(gDefaultMutex);",
+            "    return gDefault != nullptr;",
+            "}",
+            "",
+            "std::shared_ptr<Connection> defaultConnection() {",
+            "    std::lock_guard<std::mutex> lock(gDefaultMutex);",
+            f'    if (!gDefault) throw TransportError("{self.ipc_ns}::initialize was not called");',
+            "    return gDefault;",
+            "}",
+            "",
+        ]
+
+    # ── Client classes ──────────────────────────────────────────────
+
+    def _class_impl(self, cls: Class) -> list[str]:
+        name = cls.name
+        op = f"detail::Op::{name}"
+        lines = [f"// ── {name} ──", ""]
+        ctor = self.idl.symbols.constructors[name]
+        if ctor:
+            params = [self.client._param_to_cpp_decl(p) for p in ctor.params]
+            names = [p.name for p in ctor.params]
+            lines.extend([
+                f"{name}::{name}({', '.join(params)})",
+                f"    : {name}({', '.join(['defaultConnection()'] + names)}) {{}}",
+                "",
+                f"{name}::{name}({', '.join(['std::shared_ptr<Connection> connection'] + params)})",
+                "    : connection_(std::move(connection)) {",
+                f"    if (!connection_) throw std::invalid_argument(\"{name}: null connection\");",
+                f"    auto call = connection_->call({op}_create, 0);",
+            ])
+            lines.extend(self._marshal_params(ctor.params, "    "))
+            lines.extend([
+                "    id_ = call.invoke().get<uint32_t>();",
+                "}",
+                "",
+            ])
+        lines.extend([
+            f"{name}::{name}(std::shared_ptr<Connection> connection, RemoteId id) noexcept",
+            "    : connection_(std::move(connection)), id_(connection_ ? id.value : 0) {}",
+            "",
+            f"{name}::~{name}() {{",
+            "    reset();",
+            "}",
+            "",
+            f"{name}::{name}({name}&& other) noexcept",
+            "    : connection_(std::move(other.connection_)), id_(std::exchange(other.id_, 0)) {}",
+            "",
+            f"{name}& {name}::operator=({name}&& other) noexcept {{",
+            "    if (this != &other) {",
+            "        reset();",
+            "        connection_ = std::move(other.connection_);",
+            "        id_ = std::exchange(other.id_, 0);",
+            "    }",
+            "    return *this;",
+            "}",
+            "",
+            f"void {name}::reset() noexcept {{",
+            "    if (!id_) return;",
+            "    try {",
+            f"        connection_->call({op}_destroy, id_).invoke();",
+            "    } catch (const std::exception&) {",
+            "        // The server is gone, and the object with it",
+            "    }",
+            "    id_ = 0;",
+            "}",
+            "",
+        ])
+        for member in cls.members:
+            getter = self.client._getter_name(member)
+            ret = TypeMapper.to_cpp(member.type)
+            lines.extend([
+                f"{ret} {name}::{getter}() const {{",
+                f"    if (!id_) return {ret}();",
+                f"    auto call = connection_->call({op}_{getter}, id_);",
+                f"    return {self._read_value(member.type, 'call.invoke()')};",
+                "}",
+                "",
+            ])
+        for method in self._methods(cls):
+            lines.extend(self._method_impl(cls, method))
+            if method.has_attribute("batch"):
+                lines.extend(self._batch_impl(cls, method))
+            if self.client._has_into(method):
+                lines.extend(self._into_impl(cls, method))
+            if method.has_attribute("async"):
+                lines.extend(self._async_impl(cls, method))
+        return lines
+
+    def _read_value(self, idl_type: str, reader: str) -> str:
+        if idl_type == "bool":
+            return f"{reader}.get<int>() != 0"
+        return f"{reader}.get<{self._c_type(idl_type)}>()"
+
+    def _marshal_params(self, params: list[Param], indent: str) -> list[str]:
+        """Client statements putting each argument; in/out pointers remember their staged offset"""
+        lines = []
+        for i, p in enumerate(params):
+            if self._is_class(p.type):
+                target = p.name if p.is_pointer else f"&{p.name}"
+                lines.append(f"{indent}call.args.put(remoteId({target}, connection_));")
+            elif TypeMapper.is_string(p.type):
+                lines.append(f"{indent}call.string({p.name});")
+            elif p.is_pointer:
+                size = size_param(params, i)
+                count = (f"{size} > 0 ? static_cast<size_t>({size}) : 0" if size
+                         else "1" if p.type in self.idl.symbols.structs else "detail::kUnknownCount")
+                if p.is_const:
+                    lines.append(f"{indent}call.input({p.name}, {count});")
+                else:
+                    lines.append(f"{indent}const uint32_t {p.name}_staged = call.output({p.name}, {count}, true);")
+            elif p.type == "bool":
+                lines.append(f"{indent}call.args.put<int>({p.name} ? 1 : 0);")
+            else:
+                lines.append(f"{indent}call.args.put<{self._c_type(p.type)}>({p.name});")
+        return lines
+
+    def _copy_back(self, params: list[Param], indent: str) -> list[str]:
+        """Copies staged in/out pointer arguments back into the caller's memory"""
+        lines = []
+        for i, p in enumerate(params):
+            if p.is_pointer and not p.is_const and not self._is_class(p.type) and not TypeMapper.is_string(p.type):
+                size = size_param(params, i)
+                count = f"static_cast<size_t>({size})" if size else "1"
+                lines.append(f"{indent}if ({p.name}_staged) std::memcpy({p.name}, call.scratch({p.name}_staged), "
+                             f"{count} * sizeof(*{p.name}));")
+        return lines
+
+    def _null_return(self, cls: Class, method: Method) -> str:
+        ret = self.client._cpp_return_type(cls.name, method.return_type)
+        base = method.return_type.rstrip("*").strip()
+        if method.return_type.endswith("*") and self._is_class(base):
+            return f"return {ret}(connection_, RemoteId{{}});"
+        if method.return_type == "void":
+            return "return;"
+        return f"return {ret}();"
+
+    def _method_impl(self, cls: Class, method: Method) -> list[str]:
+        ret = self.client._cpp_return_type(cls.name, method.return_type)
+        params = ", ".join(self.client._param_to_cpp_decl(p) for p in method.params)
+        const_q = " const" if method.is_const else ""
+        lines = [
+            f"{ret} {cls.name}::{method.name}({params}){const_q} {{",
+            f"    if (!id_) {self._null_return(cls, method)}",
+            f"    auto call = connection_->call(detail::Op::{cls.name}_{method.name}, id_);",
+        ]
+        lines.extend(self._marshal_params(method.params, "    "))
+        rt = method.return_type
+        base = rt.rstrip("*").strip()
+        if self.client._has_into(method) or TypeMapper.is_vector(rt) or rt == "string":
+            inner = self._result_inner(method)
+            lines.extend([
+                "    call.scratchTail();",
+                "    auto result = call.invoke();",
+                *self._copy_back(method.params, "    "),
+                "    const int total = result.get<int32_t>();",
+                f"    const {inner}* items = result.array<{inner}>(total);",
+            ])
+            if rt == "string":
+                lines.append("    return std::string(items, total);")
+            else:
+                lines.append(f"    return {ret}(std::vector<{inner}>(items, items + total));")
+        elif rt == "void":
+            lines.append("    call.invoke();")
+            lines.extend(self._copy_back(method.params, "    "))
+        else:
+            lines.append("    auto result = call.invoke();")
+            lines.extend(self._copy_back(method.params, "    "))
+            if rt.endswith("*") and self._is_class(base):
+                lines.append(f"    return {ret}(connection_, RemoteId{{result.get<uint32_t>()}});")
+            else:
+                lines.append(f"    return {self._read_value(rt, 'result')};")
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _into_impl(self, cls: Class, method: Method) -> list[str]:
+        raw_decl, vec_decl = self.client._into_decls(method, f"{cls.name}::")
+        inner = self._result_inner(method)
+        is_string = method.return_type == "string"
+        op = f"detail::Op::{cls.name}_{method.name}"
+        marshal = self._marshal_params(method.params, "    ")
+        copy_back = self._copy_back(method.params, "    ")
+        # A string result is NUL-terminated inside capacity
+        written = "std::min(total + 1, capacity)" if is_string else "std::min(total, capacity)"
+        lines = [
+            f"{raw_decl} {{",
+            "    if (!id_ || capacity < 0 || (capacity > 0 && !out)) return -1;",
+            f"    auto call = connection_->call({op}, id_);",
+            *marshal,
+            "    const uint32_t out_staged = call.output(out, static_cast<size_t>(capacity));",
+            "    auto result = call.invoke();",
+            *copy_back,
+            "    const int total = result.get<int32_t>();",
+            f"    if (out_staged && total > 0) std::memcpy(out, call.scratch(out_staged), {written} * sizeof(*out));",
+            "    return total;",
+            "}",
+            "",
+            f"{vec_decl} {{",
+            "    if (!id_) {",
+            "        out.clear();",
+            "        return -1;",
+            "    }",
+            f"    auto call = connection_->call({op}, id_);",
+            *marshal,
+            "    call.scratchTail();",
+            "    auto result = call.invoke();",
+            *copy_back,
+            "    const int total = result.get<int32_t>();",
+            f"    const {inner}* items = result.array<{inner}>(total);",
+            "    out.assign(items, items + total);",
+            "    return total;",
+            "}",
+            "",
+        ]
+        return lines
+
+    def _batch_impl(self, cls: Class, method: Method) -> list[str]:
+        const_q = " const" if method.is_const else ""
+        decl = self.client._batch_decl(method, f"{cls.name}::").replace("[[nodiscard]] ", "")
+        has_out = method.return_type != "void"
+        first = method.params[0].name if method.params else None
+        out_type = self.client._batch_element_type(method.return_type)
+        lines = [f"{decl}{const_q} {{"]
+        lines.append(f"    const size_t batchSize = {first}.size();" if first else "    const size_t batchSize = 0;")
+        for p in method.params[1:]:
+            lines.append(f"    if ({p.name}.size() != batchSize) throw std::invalid_argument(\"{method.name}Batch: input sizes differ\");")
+        if has_out:
+            lines.append(f"    std::vector<{out_type}> out(batchSize);")
+            lines.append("    if (!id_ || batchSize == 0) return out;")
+        else:
+            lines.append("    if (!id_ || batchSize == 0) return;")
+        lines.append(f"    auto call = connection_->call(detail::Op::{cls.name}_{method.name}_batch, id_);")
+        lines.append("    call.args.put(static_cast<uint32_t>(batchSize));")
+        for p in method.params:
+            lines.append(f"    call.input({p.name}.data(), batchSize);")
+        if has_out:
+            lines.extend([
+                "    const uint32_t out_staged = call.output(out.data(), batchSize);",
+                "    call.invoke();",
+                "    if (out_staged) std::memcpy(out.data(), call.scratch(out_staged), batchSize * sizeof(out[0]));",
+                "    return out;",
+            ])
+        else:
+            lines.append("    call.invoke();")
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _async_impl(self, cls: Class, method: Method) -> list[str]:
+        """Runs the synchronous call on another thread; the object must outlive the future"""
+        const_q = " const" if method.is_const else ""
+        captures = ", ".join(["this"] + [p.name for p in method.params])
+        args = ", ".join(p.name for p in method.params)
+        return [
+            f"{self.client._async_decl(method, f'{cls.name}::')}{const_q} {{",
+            f"    return std::async(std::launch::async, [{captures}] {{ return {method.name}({args}); }});",
+            "}",
+            "",
+        ]
+
+    # ── Server ──────────────────────────────────────────────────────
+
+    def generate_server(self) -> str:
+        ns = self.ipc_ns
+        NS = self.namespace.upper()
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// serve(): runs the {self.namespace} C API for one out-of-process client. Build with",
+            f"// {NS}_IPC_SERVER_MAIN for a `<program> <channel>` executable.",
+            f'#include "{self.namespace}_ipc.hpp"',
+            f'#include "{self.namespace}_c_api.h"',
+            "",
+            "#include <climits>",
+            "#include <cstdio>",
+            "",
+            f"namespace {ns} {{",
+            "namespace {",
+            "",
+            "using detail::Message;",
+            "using detail::Op;",
+            "using detail::Reader;",
+            "using detail::Writer;",
+            "",
+            "enum class ClassId : uint32_t {",
+        ]
+        for i, cls in enumerate(self.idl.classes, start=1):
+            lines.append(f"    {cls.name} = {i},")
+        lines.extend([
+            "};",
+            "",
+            "struct Rejected {",
+            "    int32_t status;",
+            "};",
+            "",
+            "// Output of a vector or string call: the caller's buffer, or room after the arguments",
+            "template <typename T>",
+            "struct Target {",
+            "    T* data;",
+            "    uint32_t capacity;",
+            "    uint32_t total_at;  // where the element count goes in the response",
+            "    bool tail;",
+            "};",
+            "",
+            "class Server {",
+            "public:",
+            "    explicit Server(detail::Region& region) : region_(region) {}",
+            "    ~Server();",
+            "",
+            "    int run(std::chrono::milliseconds connect_timeout);",
+            "",
+            "private:",
+            "    struct Object {",
+            "        ClassId klass;",
+            "        void* handle;",
+            "    };",
+            "",
+            "    uint32_t adopt(ClassId klass, void* handle);",
+            "    template <typename Handle>",
+            "    Handle* object(uint32_t id, ClassId klass, bool nullable = false) const;",
+            "    void* release(uint32_t id, ClassId klass);",
+            "    template <typename T>",
+            "    T* pointer(Reader& args, uint32_t* count = nullptr) const;",
+            "    template <typename T>",
+            "    T* array(Reader& args, uint32_t count) const;",
+            "    template <typename T>",
+            "    Target<T> output(Reader& args, Writer& out) const;",
+            "    template <typename T>",
+            "    void finish(Writer& out, const Target<T>& target, int total, bool terminated) const;",
+            "    // True when the op ran a checked C API entry point, whose outcome last_error holds",
+            "    bool dispatch(const Message& request, Reader& args, Writer& out);",
+            "    static void destroy(ClassId klass, void* handle);",
+            "",
+            "    detail::Region& region_;",
+            "    std::vector<Object> objects_;  // id - 1 -> object; a freed slot has a null handle",
+            "    std::vector<uint32_t> free_ids_;",
+            "};",
+            "",
+            *self._server_helpers(),
+            *self._server_dispatch(),
+            "} // namespace",
+            "",
+            "int serve(const std::string& channel, const ChannelOptions& options) {",
+            "    auto region = detail::Region::create(channel, options);",
+            "    Server server(*region);",
+            "    return server.run(options.connect_timeout);",
+            "}",
+            "",
+            f"}} // namespace {ns}",
+            "",
+            f"#ifdef {NS}_IPC_SERVER_MAIN",
+            "int main(int argc, char** argv) {",
+            "    if (argc != 2) {",
+            "        std::fprintf(stderr, \"usage: %s <channel>\\n\", argv[0]);",
+            "        return 2;",
+            "    }",
+            "    try {",
+            f"        return {ns}::serve(argv[1]);",
+            "    } catch (const std::exception& e) {",
+            "        std::fprintf(stderr, \"%s: %s\\n\", argv[0], e.what());",
+            "        return 1;",
+            "    }",
+            "}",
+            "#endif",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _server_helpers(self) -> list[str]:
+        ns = self.namespace
+        lines = [
+            "Server::~Server() {",
+            "    for (const Object& o : objects_) {",
+            "        if (o.handle) destroy(o.klass, o.handle);",
+            "    }",
+            "}",
+            "",
+            "void Server::destroy(ClassId klass, void* handle) {",
+            "    switch (klass) {",
+        ]
+        for cls in self.idl.classes:
+            lines.extend([
+                f"    case ClassId::{cls.name}:",
+                f"        ::{cls.name}_destroy(static_cast<::{cls.name}Handle*>(handle));",
+                "        break;",
+            ])
+        lines.extend([
+            "    }",
+            "}",
+            "",
+            "uint32_t Server::adopt(ClassId klass, void* handle) {",
+            "    if (!handle) return 0;",
+            "    if (!free_ids_.empty()) {",
+            "        const uint32_t id = free_ids_.back();",
+            "        free_ids_.pop_back();",
+            "        objects_[id - 1] = {klass, handle};",
+            "        return id;",
+            "    }",
+            "    objects_.push_back({klass, handle});",
+            "    return static_cast<uint32_t>(objects_.size());",
+            "}",
+            "",
+            "template <typename Handle>",
+            "Handle* Server::object(uint32_t id, ClassId klass, bool nullable) const {",
+            "    if (id == 0 && nullable) return nullptr;",
+            "    if (id == 0 || id > objects_.size() || !objects_[id - 1].handle || objects_[id - 1].klass != klass) {",
+            "        throw Rejected{detail::kBadObject};",
+            "    }",
+            "    return static_cast<Handle*>(objects_[id - 1].handle);",
+            "}",
+            "",
+            "void* Server::release(uint32_t id, ClassId klass) {",
+            "    void* handle = object<void>(id, klass);",
+            "    objects_[id - 1].handle = nullptr;",
+            "    free_ids_.push_back(id);",
+            "    return handle;",
+            "}",
+            "",
+            "// Resolves a {kind, offset, count} descriptor to memory in the heap or scratch area",
+            "template <typename T>",
+            "T* Server::pointer(Reader& args, uint32_t* count) const {",
+            "    const uint32_t kind = args.get<uint32_t>();",
+            "    const uint32_t offset = args.get<uint32_t>();",
+            "    const uint32_t n = args.get<uint32_t>();",
+            "    if (count) *count = n;",
+            "    uint8_t* base = nullptr;",
+            "    uint32_t limit = 0;",
+            "    switch (kind) {",
+            "    case detail::kNull:",
+            "        return nullptr;",
+            "    case detail::kShared:",
+            "        base = region_.heap;",
+            "        limit = region_.header->heap_bytes;",
+            "        break;",
+            "    case detail::kStaged:",
+            "        base = region_.scratch;",
+            "        limit = region_.header->scratch_bytes;",
+            "        break;",
+            "    default:",
+            "        throw Rejected{detail::kBadRequest};",
+            "    }",
+            "    // Unknown lengths are trusted past their first byte, as they are in process",
+            "    const uint64_t bytes = n == detail::kUnknownCount ? 1 : uint64_t(n) * sizeof(T);",
+            "    if (offset % alignof(T) != 0 || offset > limit || bytes > limit - offset) {",
+            "        throw Rejected{detail::kBadRequest};",
+            "    }",
+            "    return reinterpret_cast<T*>(base + offset);",
+            "}",
+            "",
+            "template <typename T>",
+            "T* Server::array(Reader& args, uint32_t count) const {",
+            "    uint32_t n = 0;",
+            "    T* data = pointer<T>(args, &n);",
+            "    if (n != count || (!data && count)) throw Rejected{detail::kBadRequest};",
+            "    return data;",
+            "}",
+            "",
+            "template <typename T>",
+            "Target<T> Server::output(Reader& args, Writer& out) const {",
+            "    Target<T> target{nullptr, 0, out.put<int32_t>(0), false};",
+            "    Reader peek = args;",
+            "    if (peek.get<uint32_t>() == detail::kScratchTail) {",
+            "        args.bytes(3 * sizeof(uint32_t), alignof(uint32_t));",
+            "        const uint32_t at = (out.used() + alignof(T) - 1) / alignof(T) * alignof(T);",
+            "        const uint32_t room = at < out.capacity() ? (out.capacity() - at) / sizeof(T) : 0;",
+            "        target.data = reinterpret_cast<T*>(out.at(at));",
+            "        target.capacity = room < INT_MAX ? room : INT_MAX;",
+            "        target.tail = true;",
+            "        return target;",
+            "    }",
+            "    target.data = pointer<T>(args, &target.capacity);",
+            "    if (target.capacity > INT_MAX) throw Rejected{detail::kBadRequest};",
+            "    return target;",
+            "}",
+            "",
+            "// Records the element count; a tail output is committed to the response",
+            "template <typename T>",
+            "void Server::finish(Writer& out, const Target<T>& target, int total, bool terminated) const {",
+            "    if (total < 0) throw Rejected{detail::kBadRequest};",
+            "    std::memcpy(out.at(target.total_at), &total, sizeof(total));",
+            "    if (!target.tail) return;",
+            "    if (static_cast<uint32_t>(total) + (terminated ? 1 : 0) > target.capacity) {",
+            "        throw Rejected{detail::kResultTooLarge};",
+            "    }",
+            "    out.reserve(size_t(total) * sizeof(T), alignof(T));",
+            "}",
+            "",
+            "int Server::run(std::chrono::milliseconds connect_timeout) {",
+            "    detail::Header& header = *region_.header;",
+            "    const auto deadline = std::chrono::steady_clock::now() + connect_timeout;",
+            "    detail::Backoff backoff;",
+            "    while (header.client_pid.load(std::memory_order_acquire) == 0) {",
+            "        if (connect_timeout.count() > 0 && std::chrono::steady_clock::now() >= deadline) return 1;",
+            "        backoff.pause();",
+            "    }",
+            "    const int32_t client = header.client_pid.load(std::memory_order_relaxed);",
+            "    const uint32_t scratch_bytes = header.scratch_bytes;",
+            "    backoff.reset();",
+            "    Message request{};",
+            "    for (;;) {",
+            "        if (!header.requests.pop(request)) {",
+            "            if (backoff.sleeping() && !detail::processAlive(client)) return 1;",
+            "            backoff.pause();",
+            "            continue;",
+            "        }",
+            "        backoff.reset();",
+            "        if (request.op == static_cast<uint32_t>(Op::Close)) return 0;",
+            "",
+            "        // Results go between the arguments and the staged arrays, which stay in place",
+            "        const uint32_t staged = request.offset < scratch_bytes ? request.offset : scratch_bytes;",
+            "        const uint32_t args_end = request.size < staged ? request.size : staged;",
+            "        const uint32_t results = (args_end + 15) / 16 * 16;",
+            "        Reader args(region_.scratch, 0, args_end);",
+            "        Writer out(region_.scratch, staged, results < staged ? results : staged);",
+            "        Message response{};",
+            "        response.op = request.op;",
+            "        response.object = request.object;",
+            "        response.sequence = request.sequence;",
+            "        try {",
+            f"            const bool failed = dispatch(request, args, out) && ::{ns}_last_error() != {ns.upper()}_OK;",
+            "            if (failed) {",
+            "                // The code and message replace whatever results were written",
+            "                out = Writer(region_.scratch, staged, results < staged ? results : staged);",
+            f"                out.put<int32_t>(::{ns}_last_error());",
+            f"                const char* message = ::{ns}_last_error_message();",
+            "                const uint32_t length = static_cast<uint32_t>(std::strlen(message));",
+            "                out.put(length);",
+            "                std::memcpy(out.at(out.reserve(size_t(length) + 1, 1)), message, size_t(length) + 1);",
+            "            }",
+            "            response.status = failed ? detail::kFailedWithError : detail::kOk;",
+            "            response.offset = results;",
+            "            response.size = out.used() - results;",
+            "        } catch (const Rejected& rejected) {",
+            "            response.status = rejected.status;",
+            "        } catch (const TransportError&) {",
+            "            response.status = detail::kBadRequest;",
+            "        } catch (...) {",
+            "            response.status = detail::kFailed;",
+            "        }",
+            "        while (!header.responses.push(response)) backoff.pause();",
+            "    }",
+            "}",
+            "",
+        ])
+        return lines
+
+    def _server_dispatch(self) -> list[str]:
+        lines = [
+            "bool Server::dispatch(const Message& request, Reader& args, Writer& out) {",
+            "    switch (static_cast<Op>(request.op)) {",
+        ]
+        for cls in self.idl.classes:
+            h = f"::{cls.name}Handle"
+            self_handle = f"    auto* self = object<{h}>(request.object, ClassId::{cls.name});"
+            ctor = self.idl.symbols.constructors[cls.name]
+            if ctor:
+                call = f"::{cls.name}_create({', '.join(p.name for p in ctor.params)})"
+                lines.extend([
+                    f"    case Op::{cls.name}_create: {{",
+                    *self._unmarshal_params(ctor.params, "        "),
+                    f"        out.put(adopt(ClassId::{cls.name}, {call}));",
+                    "        return true;",
+                    "    }",
+                ])
+            lines.extend([
+                f"    case Op::{cls.name}_destroy:",
+                f"        ::{cls.name}_destroy(static_cast<{h}*>(release(request.object, ClassId::{cls.name})));",
+                "        return false;",
+            ])
+            for member in cls.members:
+                getter = self.client._getter_name(member)
+                lines.extend([
+                    f"    case Op::{cls.name}_{getter}:",
+                    f"        out.put(::{cls.name}_{getter}(object<{h}>(request.object, ClassId::{cls.name})));",
+                    "        return false;",
+                ])
+            for method in self._methods(cls):
+                lines.extend(self._dispatch_method(cls, method, self_handle))
+                if method.has_attribute("batch"):
+                    lines.extend(self._dispatch_batch(cls, method, self_handle))
+        lines.extend([
+            "    default:",
+            "        throw Rejected{detail::kUnknownOp};",
+            "    }",
+            "}",
+            "",
+        ])
+        return lines
+
+    def _unmarshal_params(self, params: list[Param], indent: str) -> list[str]:
+        """Server statements reading each argument into a local named like the parameter"""
+        lines = []
+        for p in params:
+            if self._is_class(p.type):
+                nullable = "true" if p.is_pointer else "false"
+                lines.append(f"{indent}auto* {p.name} = object<::{p.type}Handle>(args.get<uint32_t>(), "
+                             f"ClassId::{p.type}, {nullable});")
+            elif TypeMapper.is_string(p.type):
+                lines.append(f"{indent}const char* {p.name} = args.string();")
+            elif p.is_pointer:
+                lines.append(f"{indent}auto* {p.name} = pointer<{self._c_type(p.type)}>(args);")
+            else:
+                lines.append(f"{indent}const auto {p.name} = args.get<{self._c_type(p.type)}>();")
+        return lines
+
+    def _dispatch_method(self, cls: Class, method: Method, self_handle: str) -> list[str]:
+        args = ", ".join(["self"] + [p.name for p in method.params])
+        fn = f"::{cls.name}_{method.name}"
+        rt = method.return_type
+        base = rt.rstrip("*").strip()
+        lines = [
+            f"    case Op::{cls.name}_{method.name}: {{",
+            f"    {self_handle}",
+            *self._unmarshal_params(method.params, "        "),
+        ]
+        if self.client._has_into(method) or TypeMapper.is_vector(rt) or rt == "string":
+            inner = self._result_inner(method)
+            terminated = "true" if rt == "string" else "false"
+            lines.extend([
+                f"        const auto target = output<{inner}>(args, out);",
+                f"        const int total = {fn}_into({args}, target.data, static_cast<int>(target.capacity));",
+                f"        finish(out, target, total, {terminated});",
+            ])
+        elif rt == "void":
+            lines.append(f"        {fn}({args});")
+        elif rt.endswith("*") and self._is_class(base):
+            lines.append(f"        out.put(adopt(ClassId::{base}, {fn}({args})));")
+        else:
+            lines.append(f"        out.put({fn}({args}));")
+        lines.extend([
+            f"        return {'false' if method.has_attribute('noexcept') else 'true'};",
+            "    }",
+        ])
+        return lines
+
+    def _dispatch_batch(self, cls: Class, method: Method, self_handle: str) -> list[str]:
+        lines = [
+            f"    case Op::{cls.name}_{method.name}_batch: {{",
+            f"    {self_handle}",
+            "        const uint32_t batch = args.get<uint32_t>();",
+        ]
+        names = []
+        for p in method.params:
+            lines.append(f"        const auto* {p.name} = array<{self.client._batch_element_type(p.type)}>(args, batch);")
+            names.append(p.name)
+        if method.return_type != "void":
+            lines.append(f"        auto* results = array<{self.client._batch_element_type(method.return_type)}>(args, batch);")
+            names.append("results")
+        call_args = ", ".join(["self"] + names + ["static_cast<int>(batch)"])
+        lines.extend([
+            f"        ::{cls.name}_{method.name}_batch({call_args});",
+            "        return true;",
+            "    }",
+        ])
+        return lines
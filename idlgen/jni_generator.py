@@ -1,6 +1,6 @@
 """JNI Generator - generates Java Native Interface bindings"""
 
-from .types import ParsedIDL, Class, Method, Member, Param
+from .types import ParsedIDL, Class, Method, Member, Param, size_param
 from .type_mapper import TypeMapper
 
 
@@ -28,6 +28,10 @@ class JNIGenerator:
             "",
         ]
 
+        native_memory = self._jni_class_name("NativeMemory")
+        lines.append(f"JNIEXPORT jlong JNICALL {native_memory}_liveObjects(JNIEnv*, jclass);")
+        lines.append(f"JNIEXPORT jlong JNICALL {native_memory}_liveBytes(JNIEnv*, jclass);")
+        lines.append("")
         for cls in self.idl.classes:
             lines.extend(self._jni_method_decls(cls))
 
@@ -47,16 +51,31 @@ class JNIGenerator:
             "// AUTO-GENERATED - DO NOT EDIT",
             f'#include "{self.namespace}_jni.h"',
             f'#include "{impl_header}"',
+            *([f'#include "{self.namespace}_c_api.h"'] if self._async_methods() else []),
             "",
+            *(["#include <algorithm>"] if self._has_streams() else []),
+            "#include <atomic>",
+            "#include <cstddef>",
+            "#include <cstring>",
+            *(["#include <functional>"] if self._async_methods() or self._has_streams() else []),
             "#include <memory>",
+            "#include <new>",
+            "#include <stdexcept>",
             "#include <string>",
+            "#include <type_traits>",
             "#include <vector>",
             "",
         ]
+        lines.extend(self._packed_layout_asserts())
 
-        # Helper functions
+        # ID cache, then helper functions
+        lines.append("namespace {")
+        lines.append("")
+        lines.extend(self._jni_cache_decls())
         lines.extend([
-            "namespace {",
+            "// Objects created through the Java classes and not yet closed or cleaned, for NativeMemory",
+            "std::atomic<jlong> g_liveObjects{0};",
+            "std::atomic<jlong> g_liveBytes{0};",
             "",
             "std::string jstringToString(JNIEnv* env, jstring jstr) {",
             "    if (!jstr) return {};",
@@ -75,9 +94,59 @@ class JNIGenerator:
             "    return reinterpret_cast<T*>(handle);",
             "}",
             "",
+            "// Env for the calling thread; native worker threads are attached on first use",
+            "JNIEnv* attachedEnv(JavaVM* vm) {",
+            "    JNIEnv* env = nullptr;",
+            "    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_EDETACHED) {",
+            "        vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), nullptr);",
+            "    }",
+            "    return env;",
+            "}",
+            "",
+            "// Global ref shared by every copy of a callback lambda, deleted with the last one",
+            "using SharedGlobalRef = std::shared_ptr<std::remove_pointer_t<jobject>>;",
+            "",
+            "SharedGlobalRef makeSharedGlobalRef(JNIEnv* env, jobject obj) {",
+            "    return SharedGlobalRef(env->NewGlobalRef(obj), [](jobject ref) {",
+            "        attachedEnv(g_jni.vm)->DeleteGlobalRef(ref);",
+            "    });",
+            "}",
+            "",
+            "// Turns the C++ exception in flight into a Java one, so none unwinds through a JNI frame.",
+            "// Only valid inside a catch block; an exception a Java callback left pending wins.",
+            "void throwNativeException(JNIEnv* env, const char* where) {",
+            "    if (env->ExceptionCheck()) return;",
+            '    const char* type = "java/lang/RuntimeException";',
+            '    std::string message = std::string(where) + ": ";',
+            "    try {",
+            "        throw;",
+            "    } catch (const std::bad_alloc&) {",
+            '        type = "java/lang/OutOfMemoryError";',
+            '        message += "out of memory";',
+            "    } catch (const std::logic_error& e) {",
+            '        type = "java/lang/IllegalArgumentException";',
+            "        message += e.what();",
+            "    } catch (const std::exception& e) {",
+            "        message += e.what();",
+            "    } catch (...) {",
+            '        message += "unknown exception";',
+            "    }",
+            "    env->ThrowNew(env->FindClass(type), message.c_str());",
+            "}",
+            "",
+        ])
+        if self._has_byte_pointers():
+            lines.extend(self._byte_extent_helper())
+        if self._batch_callbacks():
+            lines.extend(self._batch_callback_helpers())
+        if self._async_methods():
+            lines.extend(self._async_helpers())
+        lines.extend([
             "} // namespace",
             "",
         ])
+        lines.extend(self._jni_onload())
+        lines.extend(self._jni_native_memory_impls())
 
         for cls in self.idl.classes:
             lines.extend(self._jni_method_impls(cls))
@@ -104,8 +173,175 @@ class JNIGenerator:
         for struct in self.idl.structs:
             lines.extend(self._java_struct_class(struct))
 
+        # Flyweight views for structs returned by [packed] methods
+        packed = self._packed_structs()
+        if packed:
+            lines[3:3] = ["import java.nio.ByteBuffer;", "import java.nio.ByteOrder;", ""]
+        for struct in packed:
+            lines.extend(self._java_struct_view(struct))
+
+        # Primitive column arrays for structs returned by [soa] methods
+        for struct in self._soa_structs():
+            lines.extend(self._java_struct_columns(struct))
+
         return "\n".join(lines)
 
+    def generate_java_native_memory(self) -> str:
+        """Generate NativeMemory.java: the Cleaner shared by every class and the live object counters"""
+        return "\n".join([
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"package {self.java_package};",
+            "",
+            "import java.lang.ref.Cleaner;",
+            "",
+            "/**",
+            " * Native objects owned by the Java wrappers of this package.",
+            " *",
+            " * Wrappers are AutoCloseable; one that is never closed is released by a shared",
+            " * Cleaner after it becomes unreachable. The GC does not see the native side, so",
+            " * a caller holding many wrappers can compare liveBytes() against a budget and",
+            " * close objects or request a collection when it is exceeded.",
+            " */",
+            "public final class NativeMemory {",
+            "",
+            "    static {",
+            f'        System.loadLibrary("{self.namespace}_jni");',
+            "    }",
+            "",
+            "    static final Cleaner CLEANER = Cleaner.create();",
+            "",
+            "    private NativeMemory() {}",
+            "",
+            "    /** Objects created by wrapper constructors and not yet closed or cleaned */",
+            "    public static native long liveObjects();",
+            "",
+            "    /** Bytes of those objects' C++ instances; memory they allocate internally is not seen */",
+            "    public static native long liveBytes();",
+            "}",
+            "",
+        ])
+
+    def _jni_native_memory_impls(self) -> list[str]:
+        native_memory = self._jni_class_name("NativeMemory")
+        return [
+            f"JNIEXPORT jlong JNICALL {native_memory}_liveObjects(JNIEnv*, jclass) {{",
+            "    return g_liveObjects.load(std::memory_order_relaxed);",
+            "}",
+            "",
+            f"JNIEXPORT jlong JNICALL {native_memory}_liveBytes(JNIEnv*, jclass) {{",
+            "    return g_liveBytes.load(std::memory_order_relaxed);",
+            "}",
+            "",
+        ]
+
+    def generate_java_native_stream(self) -> str:
+        """Generate NativeStream.java: the iterator returned by stream<T> methods"""
+        return "\n".join([
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"package {self.java_package};",
+            "",
+            "import java.lang.ref.Cleaner;",
+            "import java.util.ArrayList;",
+            "import java.util.Collections;",
+            "import java.util.Iterator;",
+            "import java.util.List;",
+            "import java.util.NoSuchElementException;",
+            "import java.util.Spliterator;",
+            "import java.util.Spliterators;",
+            "import java.util.function.LongConsumer;",
+            "import java.util.stream.Stream;",
+            "import java.util.stream.StreamSupport;",
+            "",
+            "/**",
+            " * Items of a stream<T> result, copied out of native memory one chunk at a time.",
+            " *",
+            " * Nothing runs until the first item is requested. The native stream is released",
+            " * once it is exhausted or closed, or by the shared Cleaner when it becomes",
+            " * unreachable; close it before the object that returned it.",
+            " */",
+            "public final class NativeStream<T> implements Iterator<T>, AutoCloseable {",
+            "",
+            "    /** Copies the next items, at most max; an empty list once the stream is exhausted */",
+            "    interface Chunks<T> {",
+            "        List<T> next(long stream, int max);",
+            "    }",
+            "",
+            "    static final int CHUNK = 1024;",
+            "",
+            "    private final Chunks<T> chunks;",
+            "    private final Cleaner.Cleanable cleanable;",
+            "    private long stream;",
+            "    private List<T> chunk = Collections.emptyList();",
+            "    private int pos;",
+            "",
+            "    NativeStream(long handle, Chunks<T> chunks, LongConsumer free) {",
+            "        this.stream = handle;",
+            "        this.chunks = chunks;",
+            "        // Captures the handle and free function, not this, so the stream can become unreachable",
+            "        this.cleanable = NativeMemory.CLEANER.register(this, () -> free.accept(handle));",
+            "    }",
+            "",
+            "    @Override",
+            "    public boolean hasNext() {",
+            "        if (pos < chunk.size()) return true;",
+            "        if (stream == 0) return false;",
+            "        chunk = chunks.next(stream, CHUNK);",
+            "        pos = 0;",
+            "        if (chunk.isEmpty()) {",
+            "            close();",
+            "            return false;",
+            "        }",
+            "        return true;",
+            "    }",
+            "",
+            "    @Override",
+            "    public T next() {",
+            "        if (!hasNext()) throw new NoSuchElementException();",
+            "        return chunk.get(pos++);",
+            "    }",
+            "",
+            "    /** The remaining items as a sequential Stream; closing it closes this */",
+            "    public Stream<T> stream() {",
+            "        return StreamSupport.stream(Spliterators.spliteratorUnknownSize(this, Spliterator.ORDERED), false)",
+            "                .onClose(this::close);",
+            "    }",
+            "",
+            "    @Override",
+            "    public void close() {",
+            "        if (stream != 0) {",
+            "            stream = 0;",
+            "            chunk = Collections.emptyList();",
+            "            cleanable.clean();",
+            "        }",
+            "    }",
+            "",
+            "    static List<Integer> boxed(int[] values) {",
+            "        List<Integer> items = new ArrayList<>(values.length);",
+            "        for (int v : values) items.add(v);",
+            "        return items;",
+            "    }",
+            "",
+            "    static List<Long> boxed(long[] values) {",
+            "        List<Long> items = new ArrayList<>(values.length);",
+            "        for (long v : values) items.add(v);",
+            "        return items;",
+            "    }",
+            "",
+            "    static List<Float> boxed(float[] values) {",
+            "        List<Float> items = new ArrayList<>(values.length);",
+            "        for (float v : values) items.add(v);",
+            "        return items;",
+            "    }",
+            "",
+            "    static List<Double> boxed(double[] values) {",
+            "        List<Double> items = new ArrayList<>(values.length);",
+            "        for (double v : values) items.add(v);",
+            "        return items;",
+            "    }",
+            "}",
+            "",
+        ])
+
     def _java_enum_class(self, enum) -> list[str]:
         """Generate Java enum class (package-private to allow multiple in Types.java)"""
         lines = [
@@ -147,10 +383,15 @@ class JNIGenerator:
             "// AUTO-GENERATED - DO NOT EDIT",
             f"package {self.java_package};",
             "",
+            "import java.lang.ref.Cleaner;",
             "import java.util.ArrayList;",
             "import java.util.List;",
             "",
         ]
+        if any(m.has_attribute("async") for m in cls.methods):
+            lines[6:6] = ["import java.util.concurrent.CompletableFuture;"]
+        if any(s in self.idl.symbols.structs for s in self.idl.symbols.stream_types[cls.name]):
+            lines[5:5] = ["import java.util.Arrays;"]
 
         # Main class (no longer include shared types - they go in Types.java)
         lines.extend([
@@ -161,11 +402,26 @@ class JNIGenerator:
             "    }}",
             "",
             "    private long nativeHandle;",
+            "    private Cleaner.Cleanable cleanable;",
+            "",
+            "    // Holds the handle, not the wrapper, so the wrapper can become unreachable",
+            "    private static final class Release implements Runnable {",
+            "        private final long handle;",
+            "",
+            "        Release(long handle) {",
+            "            this.handle = handle;",
+            "        }",
+            "",
+            "        @Override",
+            "        public void run() {",
+            "            nativeDestroy(handle);",
+            "        }",
+            "    }",
             "",
         ])
 
         # Constructor
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             java_params = ", ".join(self._param_to_java(p) for p in ctor.params)
             native_args = ", ".join(p.name for p in ctor.params)
@@ -175,27 +431,46 @@ class JNIGenerator:
                 "        if (this.nativeHandle == 0) {",
                 f'            throw new RuntimeException("Failed to create {class_name}");',
                 "        }",
+                "        this.cleanable = NativeMemory.CLEANER.register(this, new Release(nativeHandle));",
                 "    }",
                 "",
             ])
 
-        # Close method
-        lines.extend([
-            "    @Override",
-            "    public void close() {",
-            "        if (nativeHandle != 0) {",
-            "            nativeDestroy(nativeHandle);",
-            "            nativeHandle = 0;",
-            "        }",
-            "    }",
-            "",
-        ])
+        # Close method: runs the Cleaner action now, which then never runs again
+        if any(m.has_attribute("async") for m in cls.methods):
+            lines.extend(self._java_async_close())
+        else:
+            lines.extend([
+                "    @Override",
+                "    public void close() {",
+                "        if (nativeHandle != 0) {",
+                "            nativeHandle = 0;",
+                "            cleanable.clean();",
+                "        }",
+                "    }",
+                "",
+            ])
 
         # Public methods
         for method in cls.methods:
             if method.is_constructor:
                 continue
+            if TypeMapper.is_stream(method.return_type):
+                lines.extend(self._java_stream_method(cls, method))
+                continue
             lines.extend(self._java_method(cls, method))
+            for mode in self._byte_modes(method):
+                lines.extend(self._java_method(cls, method, mode))
+            if method.has_attribute("batch"):
+                lines.extend(self._java_batch_method(method))
+            if self._has_into(method):
+                lines.extend(self._java_into_method(method))
+            if method.has_attribute("packed"):
+                lines.extend(self._java_packed_method(cls, method))
+            if method.has_attribute("soa"):
+                lines.extend(self._java_soa_method(method))
+            if method.has_attribute("async"):
+                lines.extend(self._java_async_method(cls, method))
 
         # Native method declarations
         lines.append("    // Native methods")
@@ -207,7 +482,22 @@ class JNIGenerator:
         for method in cls.methods:
             if method.is_constructor:
                 continue
+            if TypeMapper.is_stream(method.return_type):
+                lines.extend(self._native_stream_decls(method))
+                continue
             lines.append(self._native_method_decl(method))
+            for mode in self._byte_modes(method):
+                lines.append(self._native_method_decl(method, mode))
+            if method.has_attribute("batch"):
+                lines.append(self._native_batch_decl(method))
+            if self._has_into(method):
+                lines.append(self._native_into_decl(method))
+            if method.has_attribute("packed"):
+                lines.append(self._native_packed_decl(method))
+            if method.has_attribute("soa"):
+                lines.append(self._native_soa_decl(method))
+            if method.has_attribute("async"):
+                lines.append(self._native_async_decl(method))
 
         lines.extend([
             "}",
@@ -216,6 +506,148 @@ class JNIGenerator:
 
         return "\n".join(lines)
 
+    def _cache_member(self, type_name: str) -> str:
+        """Name of a type's entry in the generated JniCache"""
+        return type_name[0].lower() + type_name[1:]
+
+    def _struct_ctor_signature(self, struct) -> str:
+        return "(" + "".join(self._java_type_signature(m.type) for m in struct.members) + ")V"
+
+    def _jni_cache_decls(self) -> list[str]:
+        """Per-type ID structs and the JniCache filled once by JNI_OnLoad"""
+        lines = []
+        for struct in self.idl.structs:
+            lines.append(f"struct {struct.name}Ids {{")
+            lines.append("    jclass cls = nullptr;")
+            lines.append("    jmethodID ctor = nullptr;")
+            for m in struct.members:
+                lines.append(f"    jfieldID {m.name}_fid = nullptr;")
+            lines.append("};")
+            lines.append("")
+
+        lines.append("// Classes (as global refs), method and field IDs resolved once in JNI_OnLoad")
+        lines.append("struct JniCache {")
+        lines.append("    JavaVM* vm = nullptr;")
+        lines.append("    jclass arrayListClass = nullptr;")
+        lines.append("    jmethodID arrayListCtor = nullptr;")
+        lines.append("    jmethodID arrayListAdd = nullptr;")
+        if self._packed_structs():
+            lines.append("    jclass byteBufferClass = nullptr;")
+            lines.append("    jmethodID byteBufferAllocateDirect = nullptr;")
+            lines.append("    jmethodID bufferLimit = nullptr;")
+        for struct in self.idl.structs:
+            lines.append(f"    {struct.name}Ids {self._cache_member(struct.name)};")
+        for struct in self._soa_structs():
+            lines.append(f"    jclass {self._cache_member(struct.name)}ColumnsClass = nullptr;")
+            lines.append(f"    jmethodID {self._cache_member(struct.name)}ColumnsCtor = nullptr;")
+        for cb in self.idl.callbacks:
+            lines.append(f"    jmethodID {self._cache_member(cb.name)}Invoke = nullptr;")
+            if cb.has_attribute("batch"):
+                lines.append(f"    jmethodID {self._cache_member(cb.name)}InvokeBatch = nullptr;")
+        if self._async_methods():
+            lines.append("    jclass runtimeExceptionClass = nullptr;")
+            lines.append("    jmethodID runtimeExceptionCtor = nullptr;")
+            lines.append("    jmethodID futureComplete = nullptr;")
+            lines.append("    jmethodID futureCompleteExceptionally = nullptr;")
+            for box, _ in self._async_boxes():
+                lines.append(f"    jclass {self._cache_member(box)}Class = nullptr;")
+                lines.append(f"    jmethodID {self._cache_member(box)}ValueOf = nullptr;")
+        lines.append("};")
+        lines.append("")
+        lines.append("JniCache g_jni;")
+        lines.append("")
+        lines.append("jclass globalClass(JNIEnv* env, const char* name) {")
+        lines.append("    jclass local = env->FindClass(name);")
+        lines.append("    if (!local) return nullptr;")
+        lines.append("    auto global = static_cast<jclass>(env->NewGlobalRef(local));")
+        lines.append("    env->DeleteLocalRef(local);")
+        lines.append("    return global;")
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _jni_onload(self) -> list[str]:
+        """JNI_OnLoad resolving every ID into g_jni, and JNI_OnUnload dropping the class refs"""
+        pkg = self.java_package.replace(".", "/")
+        lines = [
+            'extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void*) {',
+            "    JNIEnv* env = nullptr;",
+            "    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) return JNI_ERR;",
+            "    g_jni.vm = vm;",
+            '    g_jni.arrayListClass = globalClass(env, "java/util/ArrayList");',
+            "    if (!g_jni.arrayListClass) return JNI_ERR;",
+            '    g_jni.arrayListCtor = env->GetMethodID(g_jni.arrayListClass, "<init>", "()V");',
+            '    g_jni.arrayListAdd = env->GetMethodID(g_jni.arrayListClass, "add", "(Ljava/lang/Object;)Z");',
+        ]
+        if self._packed_structs():
+            lines.extend([
+                '    g_jni.byteBufferClass = globalClass(env, "java/nio/ByteBuffer");',
+                "    if (!g_jni.byteBufferClass) return JNI_ERR;",
+                '    g_jni.byteBufferAllocateDirect = env->GetStaticMethodID(g_jni.byteBufferClass, "allocateDirect", "(I)Ljava/nio/ByteBuffer;");',
+                '    g_jni.bufferLimit = env->GetMethodID(g_jni.byteBufferClass, "limit", "(I)Ljava/nio/Buffer;");',
+            ])
+        for struct in self.idl.structs:
+            ids = f"g_jni.{self._cache_member(struct.name)}"
+            lines.append(f'    {ids}.cls = globalClass(env, "{pkg}/{struct.name}");')
+            lines.append(f"    if (!{ids}.cls) return JNI_ERR;")
+            lines.append(f'    {ids}.ctor = env->GetMethodID({ids}.cls, "<init>", "{self._struct_ctor_signature(struct)}");')
+            for m in struct.members:
+                lines.append(f'    {ids}.{m.name}_fid = env->GetFieldID({ids}.cls, "{m.name}", "{self._java_type_signature(m.type)}");')
+        for struct in self._soa_structs():
+            member = self._cache_member(struct.name)
+            lines.append(f'    g_jni.{member}ColumnsClass = globalClass(env, "{pkg}/{struct.name}Columns");')
+            lines.append(f"    if (!g_jni.{member}ColumnsClass) return JNI_ERR;")
+            lines.append(f'    g_jni.{member}ColumnsCtor = env->GetMethodID(g_jni.{member}ColumnsClass, "<init>", "{self._columns_ctor_signature(struct)}");')
+        for cb in self.idl.callbacks:
+            var = f"{self._cache_member(cb.name)}Class"
+            lines.append("    {")
+            lines.append(f'        jclass {var} = env->FindClass("{pkg}/{cb.name}");')
+            lines.append(f"        if (!{var}) return JNI_ERR;")
+            lines.append(f'        g_jni.{self._cache_member(cb.name)}Invoke = env->GetMethodID({var}, "invoke", "{self._build_callback_signature(cb)}");')
+            if cb.has_attribute("batch"):
+                lines.append(f'        g_jni.{self._cache_member(cb.name)}InvokeBatch = env->GetMethodID({var}, "invokeBatch", "{self._batch_callback_signature(cb)}");')
+            lines.append(f"        env->DeleteLocalRef({var});")
+            lines.append("    }")
+        if self._async_methods():
+            lines.extend([
+                '    g_jni.runtimeExceptionClass = globalClass(env, "java/lang/RuntimeException");',
+                "    if (!g_jni.runtimeExceptionClass) return JNI_ERR;",
+                '    g_jni.runtimeExceptionCtor = env->GetMethodID(g_jni.runtimeExceptionClass, "<init>", "(Ljava/lang/String;)V");',
+                "    {",
+                '        jclass futureClass = env->FindClass("java/util/concurrent/CompletableFuture");',
+                "        if (!futureClass) return JNI_ERR;",
+                '        g_jni.futureComplete = env->GetMethodID(futureClass, "complete", "(Ljava/lang/Object;)Z");',
+                '        g_jni.futureCompleteExceptionally = env->GetMethodID(futureClass, "completeExceptionally", "(Ljava/lang/Throwable;)Z");',
+                "        env->DeleteLocalRef(futureClass);",
+                "    }",
+            ])
+            for box, sig in self._async_boxes():
+                member = self._cache_member(box)
+                lines.append(f'    g_jni.{member}Class = globalClass(env, "java/lang/{box}");')
+                lines.append(f"    if (!g_jni.{member}Class) return JNI_ERR;")
+                lines.append(f'    g_jni.{member}ValueOf = env->GetStaticMethodID(g_jni.{member}Class, "valueOf", "({sig})Ljava/lang/{box};");')
+        lines.append("    return JNI_VERSION_1_6;")
+        lines.append("}")
+        lines.append("")
+        lines.append('extern "C" JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void*) {')
+        lines.append("    JNIEnv* env = nullptr;")
+        lines.append("    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) return;")
+        lines.append("    env->DeleteGlobalRef(g_jni.arrayListClass);")
+        if self._packed_structs():
+            lines.append("    env->DeleteGlobalRef(g_jni.byteBufferClass);")
+        for struct in self.idl.structs:
+            lines.append(f"    env->DeleteGlobalRef(g_jni.{self._cache_member(struct.name)}.cls);")
+        for struct in self._soa_structs():
+            lines.append(f"    env->DeleteGlobalRef(g_jni.{self._cache_member(struct.name)}ColumnsClass);")
+        if self._async_methods():
+            lines.append("    env->DeleteGlobalRef(g_jni.runtimeExceptionClass);")
+            for box, _ in self._async_boxes():
+                lines.append(f"    env->DeleteGlobalRef(g_jni.{self._cache_member(box)}Class);")
+        lines.append("    g_jni = JniCache();")
+        lines.append("}")
+        lines.append("")
+        return lines
+
     def _java_callback_interface(self, cb) -> list[str]:
         """Generate Java functional interface for a callback"""
         params = ", ".join(f"{self._idl_to_java_type(p.type)} {p.name}" for p in cb.params)
@@ -225,9 +657,26 @@ class JNIGenerator:
             "@FunctionalInterface",
             f"interface {cb.name} {{",
             f"    {ret_type} invoke({params});",
+        ]
+        if cb.has_attribute("batch"):
+            arrays = [f"{self._batch_java_array_type(p.type)} {p.name}" for p in cb.params]
+            call = f"invoke({', '.join(f'{p.name}[i]' for p in cb.params)})"
+            if cb.return_type != "void":
+                arrays.append(f"{self._batch_java_array_type(cb.return_type)} result")
+                call = f"result[i] = {call}"
+            lines.extend([
+                "",
+                "    /** Called by native code once per batch; override to handle the arrays directly. */",
+                f"    default void invokeBatch({', '.join(arrays)}) {{",
+                f"        for (int i = 0; i < {cb.params[0].name}.length; i++) {{",
+                f"            {call};",
+                "        }",
+                "    }",
+            ])
+        lines.extend([
             "}",
             "",
-        ]
+        ])
         return lines
 
     def _java_struct_class(self, struct) -> list[str]:
@@ -256,38 +705,98 @@ class JNIGenerator:
 
     def _is_callback_type(self, type_name: str) -> bool:
         """Check if type is a callback"""
-        return any(cb.name == type_name for cb in self.idl.callbacks)
+        return type_name in self.idl.symbols.callbacks
+
+    # uint8_t* access modes: (native name suffix, public Java method suffix, doc line)
+    BYTE_MODES = {
+        "array": ("", "", None),
+        "direct": ("Direct", "", "Reads a direct ByteBuffer in place, without copying."),
+        "critical": ("Critical", "Critical",
+                     "Pins the array with GetPrimitiveArrayCritical (usually no copy); keep calls short."),
+    }
+
+    def _is_byte_pointer(self, param: Param) -> bool:
+        return param.is_pointer and param.type == "uint8_t"
+
+    def _has_byte_pointers(self) -> bool:
+        return any(self._is_byte_pointer(p) for cls in self.idl.classes for m in cls.methods for p in m.params)
+
+    def _byte_extent_helper(self) -> list[str]:
+        return [
+            "// Throws std::invalid_argument, which throwNativeException reports as an",
+            "// IllegalArgumentException, unless a byte argument of extent bytes (-1: null, or not",
+            "// a direct buffer) holds count of them. Without a count parameter it must not be empty.",
+            "void requireBytes(jlong extent, const char* kind, const char* name, jlong count, const char* countName) {",
+            '    if (extent < 0) throw std::invalid_argument(std::string(name) + " must be a non-null " + kind);',
+            "    if (count < 0 || count > extent) {",
+            '        std::string message = std::string(name) + " holds " + std::to_string(extent) + " bytes";',
+            '        if (countName) message += std::string(" but ") + countName + " is " + std::to_string(count);',
+            "        throw std::invalid_argument(message);",
+            "    }",
+            "}",
+            "",
+        ]
+
+    def _byte_extent_checks(self, method: Method, byte_mode: str) -> list[str]:
+        """requireBytes for each uint8_t* argument, against the count parameter that follows it.
+        They run before any array is pinned, since no JNI call may run inside a critical region."""
+        lines = []
+        for i, p in enumerate(method.params):
+            if not self._is_byte_pointer(p):
+                continue
+            if byte_mode == "direct":
+                extent, kind = f"env->GetDirectBufferCapacity({p.name})", "direct ByteBuffer"
+            else:
+                extent, kind = f"env->GetArrayLength({p.name})", "byte[]"
+            count = size_param(method.params, i)
+            count_args = f"{count}, \"{count}\"" if count else "1, nullptr"
+            lines.append(f'    requireBytes({p.name} ? {extent} : -1, "{kind}", "{p.name}", {count_args});')
+        return lines
 
-    def _java_method(self, cls: Class, method: Method) -> list[str]:
+    def _byte_modes(self, method: Method) -> list[str]:
+        """Extra uint8_t* variants for a method: direct ByteBuffer always, critical when legal.
+        No JNI call may run inside a critical region, so any parameter needing conversion rules it out."""
+        if method.is_constructor or not any(self._is_byte_pointer(p) for p in method.params):
+            return []
+        modes = ["direct"]
+        if all(self._is_byte_pointer(p) or p.type in ("int", "bool", "float", "double")
+               or self._is_enum_type(p.type) or self._is_class_type(p.type) for p in method.params):
+            modes.append("critical")
+        return modes
+
+    def _java_method(self, cls: Class, method: Method, byte_mode: str = "array") -> list[str]:
         """Generate Java public method"""
+        native_suffix, public_suffix, doc = self.BYTE_MODES[byte_mode]
         ret_type = self._return_to_java_type(method.return_type)
-        params = ", ".join(self._param_to_java(p) for p in method.params)
+        params = ", ".join(self._param_to_java(p, byte_mode) for p in method.params)
         native_args = "nativeHandle"
         if method.params:
             native_args += ", " + ", ".join(p.name for p in method.params)
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}{native_suffix}"
 
         lines = []
+        if doc:
+            lines.append(f"    /** {doc} */")
         
         if TypeMapper.is_vector(method.return_type):
             inner = TypeMapper.vector_inner(method.return_type)
-            struct = next((s for s in self.idl.structs if s.name == inner), None)
             
-            lines.append(f"    public List<{inner}> {method.name}({params}) {{")
-            lines.append(f"        return native{method.name[0].upper()}{method.name[1:]}({native_args});")
+            lines.append(f"    public List<{inner}> {method.name}{public_suffix}({params}) {{")
+            lines.append(f"        return {native_name}({native_args});")
             lines.append("    }")
         else:
-            lines.append(f"    public {ret_type} {method.name}({params}) {{")
-            lines.append(f"        return native{method.name[0].upper()}{method.name[1:]}({native_args});")
+            lines.append(f"    public {ret_type} {method.name}{public_suffix}({params}) {{")
+            lines.append(f"        return {native_name}({native_args});")
             lines.append("    }")
         
         lines.append("")
         return lines
 
-    def _native_method_decl(self, method: Method) -> str:
+    def _native_method_decl(self, method: Method, byte_mode: str = "array") -> str:
         """Generate native method declaration"""
         ret_type = self._return_to_java_type(method.return_type)
-        native_name = f"native{method.name[0].upper()}{method.name[1:]}"
-        params = ["long handle"] + [self._param_to_java(p) for p in method.params]
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}{self.BYTE_MODES[byte_mode][0]}"
+        params = ["long handle"] + [self._param_to_java(p, byte_mode) for p in method.params]
         return f"    private static native {ret_type} {native_name}({', '.join(params)});"
 
     def _jni_method_decls(self, cls: Class) -> list[str]:
@@ -295,7 +804,7 @@ class JNIGenerator:
         jni_class = self._jni_class_name(cls.name)
         lines = []
 
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             params = ["JNIEnv*", "jclass"] + [self._param_to_jni_type(p) for p in ctor.params]
             lines.append(f"JNIEXPORT jlong JNICALL {jni_class}_nativeCreate({', '.join(params)});")
@@ -304,10 +813,40 @@ class JNIGenerator:
         for method in cls.methods:
             if method.is_constructor:
                 continue
-            ret = self._return_to_jni_type(method.return_type)
             native_name = f"native{method.name[0].upper()}{method.name[1:]}"
+            if TypeMapper.is_stream(method.return_type):
+                elem = self._stream_jni_array_type(TypeMapper.stream_inner(method.return_type))
+                params = ["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p) for p in method.params]
+                lines.append(f"JNIEXPORT jlong JNICALL {jni_class}_{native_name}({', '.join(params)});")
+                lines.append(f"JNIEXPORT {elem} JNICALL {jni_class}_{native_name}Next(JNIEnv*, jclass, jlong, jint);")
+                lines.append(f"JNIEXPORT void JNICALL {jni_class}_{native_name}Free(JNIEnv*, jclass, jlong);")
+                continue
+            ret = self._return_to_jni_type(method.return_type)
             params = ["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p) for p in method.params]
             lines.append(f"JNIEXPORT {ret} JNICALL {jni_class}_{native_name}({', '.join(params)});")
+            for mode in self._byte_modes(method):
+                params = ["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p, mode) for p in method.params]
+                lines.append(f"JNIEXPORT {ret} JNICALL {jni_class}_{native_name}{self.BYTE_MODES[mode][0]}({', '.join(params)});")
+            if method.has_attribute("batch"):
+                params = ["JNIEnv*", "jclass", "jlong"] + [self._batch_jni_array_type(p.type) for p in method.params]
+                ret = self._batch_jni_array_type(method.return_type) if method.return_type != "void" else "void"
+                lines.append(f"JNIEXPORT {ret} JNICALL {jni_class}_{native_name}Batch({', '.join(params)});")
+            if self._has_into(method):
+                inner = TypeMapper.vector_inner(method.return_type)
+                params = (["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p) for p in method.params]
+                          + [self._batch_jni_array_type(inner)])
+                lines.append(f"JNIEXPORT jint JNICALL {jni_class}_{native_name}Into({', '.join(params)});")
+            if method.has_attribute("packed"):
+                params = (["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p) for p in method.params]
+                          + ["jobject"])
+                lines.append(f"JNIEXPORT jobject JNICALL {jni_class}_{native_name}Packed({', '.join(params)});")
+            if method.has_attribute("soa"):
+                params = ["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p) for p in method.params]
+                lines.append(f"JNIEXPORT jobject JNICALL {jni_class}_{native_name}Columns({', '.join(params)});")
+            if method.has_attribute("async"):
+                params = (["JNIEnv*", "jclass", "jlong"] + [self._param_to_jni_type(p) for p in method.params]
+                          + ["jobject"])
+                lines.append(f"JNIEXPORT void JNICALL {jni_class}_{native_name}Async({', '.join(params)});")
 
         lines.append("")
         return lines
@@ -318,7 +857,7 @@ class JNIGenerator:
         cpp_class = f"{self.namespace}::{cls.name}"
         lines = []
 
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             jni_params = ", ".join(["JNIEnv* env", "jclass"] + 
                                    [f"{self._param_to_jni_type(p)} {p.name}" for p in ctor.params])
@@ -332,82 +871,986 @@ class JNIGenerator:
             
             cpp_args = ", ".join(f"cpp_{p.name}" if p.type == "string" else p.name for p in ctor.params)
             lines.append(f"        auto* obj = new {cpp_class}({cpp_args});")
+            lines.append("        g_liveObjects.fetch_add(1, std::memory_order_relaxed);")
+            lines.append(f"        g_liveBytes.fetch_add(sizeof({cpp_class}), std::memory_order_relaxed);")
             lines.append("        return ptrToJlong(obj);")
             lines.append("    } catch (...) {")
+            lines.append(f'        throwNativeException(env, "{cls.name}.<init>");')
             lines.append("        return 0;")
             lines.append("    }")
             lines.append("}")
             lines.append("")
 
             lines.append(f"JNIEXPORT void JNICALL {jni_class}_nativeDestroy(JNIEnv*, jclass, jlong handle) {{")
+            lines.append("    if (!handle) return;")
             lines.append(f"    delete jlongToPtr<{cpp_class}>(handle);")
+            lines.append("    g_liveObjects.fetch_sub(1, std::memory_order_relaxed);")
+            lines.append(f"    g_liveBytes.fetch_sub(sizeof({cpp_class}), std::memory_order_relaxed);")
             lines.append("}")
             lines.append("")
 
         for method in cls.methods:
             if method.is_constructor:
                 continue
+            if TypeMapper.is_stream(method.return_type):
+                lines.extend(self._jni_stream_impls(method, jni_class, cpp_class))
+                continue
             lines.extend(self._jni_method_impl(cls, method, jni_class, cpp_class))
+            for mode in self._byte_modes(method):
+                lines.extend(self._jni_method_impl(cls, method, jni_class, cpp_class, mode))
+            if method.has_attribute("batch"):
+                lines.extend(self._jni_batch_impl(method, jni_class, cpp_class))
+            if self._has_into(method):
+                lines.extend(self._jni_into_impl(method, jni_class, cpp_class))
+            if method.has_attribute("packed"):
+                lines.extend(self._jni_packed_impl(cls, method, jni_class, cpp_class))
+            if method.has_attribute("soa"):
+                lines.extend(self._jni_soa_impl(method, jni_class, cpp_class))
+            if method.has_attribute("async"):
+                lines.extend(self._jni_async_impl(method, jni_class, cpp_class))
+
+        return lines
+
+    def _has_into(self, method: Method) -> bool:
+        """Vector returns get an overload that fills a caller-owned array"""
+        return (TypeMapper.is_vector(method.return_type)
+                and not any(self._is_callback_type(p.type) for p in method.params))
+
+    def _java_into_method(self, method: Method) -> list[str]:
+        """Fill an existing array; struct elements that are already present are updated in place"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = ", ".join([self._param_to_java(p) for p in method.params] +
+                           [f"{self._batch_java_array_type(inner)} out"])
+        native_args = ", ".join(["nativeHandle"] + [p.name for p in method.params] + ["out"])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Into"
+        return [
+            "    /** Fills out and returns the total element count (which may exceed out.length). */",
+            f"    public int {method.name}Into({params}) {{",
+            f"        return {native_name}({native_args});",
+            "    }",
+            "",
+        ]
+
+    def _native_into_decl(self, method: Method) -> str:
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = (["long handle"] + [self._param_to_java(p) for p in method.params] +
+                  [f"{self._batch_java_array_type(inner)} out"])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Into"
+        return f"    private static native int {native_name}({', '.join(params)});"
+
+    def _jni_into_impl(self, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+        inner = TypeMapper.vector_inner(method.return_type)
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Into"
+        jni_params = ", ".join(
+            ["JNIEnv* env", "jclass", "jlong handle"] +
+            [f"{self._param_to_jni_type(p)} {p.name}" for p in method.params] +
+            [f"{self._batch_jni_array_type(inner)} out"]
+        )
+
+        lines = [f"JNIEXPORT jint JNICALL {jni_class}_{native_name}({jni_params}) {{"]
+        lines.append(f"    auto* obj = jlongToPtr<{cpp_class}>(handle);")
+        lines.append("    if (!obj || !out) return -1;")
+        param_lines, cpp_arg_names = self._jni_convert_params(method)
+        lines.extend(param_lines)
+        start = len(lines)
+        lines.append(f"    auto items = obj->{method.name}({', '.join(cpp_arg_names)});")
+        lines.extend(self._jni_release_params(method))
+        lines.append("    const jsize total = static_cast<jsize>(items.size());")
+        lines.append("    const jsize outLength = env->GetArrayLength(out);")
+        lines.append("    const jsize written = total < outLength ? total : outLength;")
+
+        prim = self._batch_primitive(inner)
+        if prim:
+            lines.append(f"    std::vector<{prim[1]}> values(items.begin(), items.begin() + written);")
+            lines.append(f"    env->Set{prim[2]}ArrayRegion(out, 0, written, values.data());")
+        else:
+            struct = self._get_struct(inner)
+            lines.append(f"    const auto& ids = g_jni.{self._cache_member(inner)};")
+            lines.append("    for (jsize i = 0; i < written; ++i) {")
+            lines.append("        const auto& item = items[i];")
+            lines.append("        jobject jitem = env->GetObjectArrayElement(out, i);")
+            lines.append("        if (jitem) {")
+            for m in struct.members:
+                lines.append(f"            env->{self._jni_field_setter(m.type)}(jitem, ids.{m.name}_fid, item.{m.name});")
+            lines.append("        } else {")
+            ctor_args = ", ".join(f"item.{m.name}" for m in struct.members)
+            lines.append(f"            jitem = env->NewObject(ids.cls, ids.ctor, {ctor_args});")
+            lines.append("            env->SetObjectArrayElement(out, i, jitem);")
+            lines.append("        }")
+            lines.append("        env->DeleteLocalRef(jitem);")
+            lines.append("    }")
+        lines.append("    return total;")
+        lines[start:] = self._guarded(lines[start:], f"{cpp_class.split('::')[-1]}.{method.name}Into", "return -1;",
+                                      self._jni_release_params(method))
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    # Packed field mapping: C-layout IDL type -> (size in bytes, Java type, ByteBuffer getter)
+    PACKED_FIELDS = {
+        "int": (4, "int", "getInt"),
+        "int32_t": (4, "int", "getInt"),
+        "bool": (4, "boolean", "getInt"),  # C API structs store bool as int
+        "float": (4, "float", "getFloat"),
+        "double": (8, "double", "getDouble"),
+        "int64_t": (8, "long", "getLong"),
+    }
+
+    def _packed_field(self, idl_type: str):
+        if self._is_enum_type(idl_type):
+            return self.PACKED_FIELDS["int"]
+        return self.PACKED_FIELDS.get(idl_type)
+
+    def _packed_layout(self, struct) -> tuple[list, int]:
+        """Natural-alignment C layout: ([(member, offset, field spec)], sizeof)"""
+        return self.idl.symbols.struct_layout(struct.name, self._packed_field, "[packed] struct")
+
+    def _packed_structs(self) -> list:
+        """Structs returned as vector<T> by a [packed] method, in IDL order"""
+        names = set()
+        for cls in self.idl.classes:
+            for method in cls.methods:
+                if not method.has_attribute("packed"):
+                    continue
+                inner = TypeMapper.vector_inner(method.return_type) if TypeMapper.is_vector(method.return_type) else None
+                if not inner or not self._is_struct_type(inner):
+                    raise ValueError(f"[packed] requires a vector<struct> return type ({cls.name}.{method.name})")
+                if any(self._is_callback_type(p.type) or self._is_byte_pointer(p) for p in method.params):
+                    raise ValueError(f"[packed] does not support callback or buffer parameters ({cls.name}.{method.name})")
+                names.add(inner)
+        return [s for s in self.idl.structs if s.name in names]
+
+    def _packed_layout_asserts(self) -> list[str]:
+        """Compile-time check that the generated Java views match the C++ layout"""
+        lines = []
+        for struct in self._packed_structs():
+            fields, size = self._packed_layout(struct)
+            view = f"{struct.name}View"
+            lines.append(f'static_assert(sizeof(::{struct.name}) == {size}, "{view} stride does not match {struct.name}");')
+            for m, offset, _ in fields:
+                lines.append(f'static_assert(offsetof(::{struct.name}, {m.name}) == {offset}, "{view} offset of {m.name} does not match");')
+        if lines:
+            lines.append("")
+        return lines
+
+    def _java_struct_view(self, struct) -> list[str]:
+        """Flyweight over a ByteBuffer of packed structs: field reads allocate nothing"""
+        fields, size = self._packed_layout(struct)
+        lines = [
+            f"/** Allocation-free view over {struct.name} elements packed in native layout */",
+            f"final class {struct.name}View {{",
+            f"    static final int STRIDE = {size};",
+            "",
+            "    private ByteBuffer buffer;",
+            "    private int count;",
+            "",
+            "    void reset(ByteBuffer buffer) {",
+            "        this.buffer = buffer == null ? null : buffer.order(ByteOrder.nativeOrder());",
+            "        this.count = buffer == null ? 0 : buffer.limit() / STRIDE;",
+            "    }",
+            "",
+            "    ByteBuffer buffer() {",
+            "        return buffer;",
+            "    }",
+            "",
+            "    public int size() {",
+            "        return count;",
+            "    }",
+        ]
+        for m, offset, (_, java_type, getter) in fields:
+            at = f"i * STRIDE + {offset}" if offset else "i * STRIDE"
+            read = f"buffer.{getter}({at})"
+            if m.type == "bool":
+                read = f"{read} != 0"
+            lines.extend([
+                "",
+                f"    public {java_type} {m.name}(int i) {{",
+                f"        return {read};",
+                "    }",
+            ])
+        ctor_args = ", ".join(f"{m.name}(i)" for m, _, _ in fields)
+        lines.extend([
+            "",
+            f"    /** Materializes element i as a {struct.name} */",
+            f"    public {struct.name} get(int i) {{",
+            f"        return new {struct.name}({ctor_args});",
+            "    }",
+            "}",
+            "",
+        ])
+        return lines
+
+    def _java_packed_method(self, cls: Class, method: Method) -> list[str]:
+        inner = TypeMapper.vector_inner(method.return_type)
+        view = f"{inner}View"
+        params = [self._param_to_java(p) for p in method.params]
+        names = [p.name for p in method.params]
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Packed"
+        native_args = ", ".join(["nativeHandle"] + names + ["view.buffer()"])
+        return [
+            f"    /** Results packed into one direct buffer; pass the previous view to reuse its memory. */",
+            f"    public {view} {method.name}Packed({', '.join(params + [f'{view} reuse'])}) {{",
+            f"        {view} view = reuse != null ? reuse : new {view}();",
+            f"        view.reset({native_name}({native_args}));",
+            "        return view;",
+            "    }",
+            "",
+            f"    public {view} {method.name}Packed({', '.join(params)}) {{",
+            f"        return {method.name}Packed({', '.join(names + ['null'])});",
+            "    }",
+            "",
+        ]
+
+    def _native_packed_decl(self, method: Method) -> str:
+        params = ["long handle"] + [self._param_to_java(p) for p in method.params] + ["java.nio.ByteBuffer reuse"]
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Packed"
+        return f"    private static native java.nio.ByteBuffer {native_name}({', '.join(params)});"
+
+    def _jni_packed_impl(self, cls: Class, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+        """memcpy the whole vector into a direct buffer, reusing the caller's when it is big enough"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Packed"
+        jni_params = ", ".join(
+            ["JNIEnv* env", "jclass", "jlong handle"] +
+            [f"{self._param_to_jni_type(p)} {p.name}" for p in method.params] +
+            ["jobject reuse"]
+        )
+        lines = [f"JNIEXPORT jobject JNICALL {jni_class}_{native_name}({jni_params}) {{"]
+        lines.append(f"    auto* obj = jlongToPtr<{cpp_class}>(handle);")
+        lines.append("    if (!obj) return nullptr;")
+        param_lines, cpp_arg_names = self._jni_convert_params(method)
+        lines.extend(param_lines)
+        start = len(lines)
+        lines.append(f"    auto items = obj->{method.name}({', '.join(cpp_arg_names)});")
+        lines.extend(self._jni_release_params(method))
+        lines.append(f"    const jlong bytes = static_cast<jlong>(items.size() * sizeof(::{inner}));")
+        lines.append("    jobject buffer = reuse;")
+        lines.append("    if (!buffer || env->GetDirectBufferCapacity(buffer) < bytes) {")
+        lines.append("        buffer = env->CallStaticObjectMethod(g_jni.byteBufferClass, g_jni.byteBufferAllocateDirect, static_cast<jint>(bytes));")
+        lines.append("        if (!buffer) return nullptr;")
+        lines.append("    }")
+        lines.append("    if (bytes > 0) std::memcpy(env->GetDirectBufferAddress(buffer), items.data(), static_cast<size_t>(bytes));")
+        lines.append("    env->DeleteLocalRef(env->CallObjectMethod(buffer, g_jni.bufferLimit, static_cast<jint>(bytes)));")
+        lines.append("    return buffer;")
+        lines[start:] = self._guarded(lines[start:], f"{cls.name}.{method.name}Packed", "return nullptr;",
+                                      self._jni_release_params(method))
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    def _soa_structs(self) -> list:
+        """Structs returned as vector<T> by a [soa] method, in IDL order"""
+        names = {inner for inners in self.idl.symbols.soa_types.values() for inner in inners}
+        return [s for s in self.idl.structs if s.name in names]
+
+    def _columns_ctor_signature(self, struct) -> str:
+        return "(" + "".join(f"[{self._java_type_signature(m.type)}" for m in struct.members) + ")V"
+
+    def _java_struct_columns(self, struct) -> list[str]:
+        """One primitive array per member, copied out of native memory in a single region write each"""
+        columns = [(m, self._batch_primitive(m.type)) for m in struct.members]
+        lines = [
+            f"/** {struct.name} results as one array per member (enums as their int values) */",
+            f"final class {struct.name}Columns {{",
+        ]
+        for m, prim in columns:
+            lines.append(f"    public final {prim[0]}[] {m.name};")
+        params = ", ".join(f"{prim[0]}[] {m.name}" for m, prim in columns)
+        lines.extend(["", f"    {struct.name}Columns({params}) {{"])
+        for m, _ in columns:
+            lines.append(f"        this.{m.name} = {m.name};")
+        first = struct.members[0].name
+        ctor_args = ", ".join(f"{m.type}.fromValue({m.name}[i])" if self._is_enum_type(m.type) else f"{m.name}[i]"
+                              for m in struct.members)
+        lines.extend([
+            "    }",
+            "",
+            "    public int size() {",
+            f"        return {first}.length;",
+            "    }",
+            "",
+            f"    /** Materializes row i as a {struct.name} */",
+            f"    public {struct.name} get(int i) {{",
+            f"        return new {struct.name}({ctor_args});",
+            "    }",
+            "}",
+            "",
+        ])
+        return lines
+
+    def _java_soa_method(self, method: Method) -> list[str]:
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = ", ".join(self._param_to_java(p) for p in method.params)
+        native_args = ", ".join(["nativeHandle"] + [p.name for p in method.params])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Columns"
+        return [
+            f"    /** Results as one primitive array per {inner} member. */",
+            f"    public {inner}Columns {method.name}Columns({params}) {{",
+            f"        return {native_name}({native_args});",
+            "    }",
+            "",
+        ]
+
+    def _native_soa_decl(self, method: Method) -> str:
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = ["long handle"] + [self._param_to_java(p) for p in method.params]
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Columns"
+        return f"    private static native {inner}Columns {native_name}({', '.join(params)});"
+
+    def _jni_soa_impl(self, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+        """Transpose the result into one Java array per member"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        struct = self._get_struct(inner)
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Columns"
+        jni_params = ", ".join(
+            ["JNIEnv* env", "jclass", "jlong handle"] +
+            [f"{self._param_to_jni_type(p)} {p.name}" for p in method.params]
+        )
+        lines = [f"JNIEXPORT jobject JNICALL {jni_class}_{native_name}({jni_params}) {{"]
+        lines.append(f"    auto* obj = jlongToPtr<{cpp_class}>(handle);")
+        lines.append("    if (!obj) return nullptr;")
+        param_lines, cpp_arg_names = self._jni_convert_params(method)
+        lines.extend(param_lines)
+        start = len(lines)
+        lines.append(f"    auto items = obj->{method.name}({', '.join(cpp_arg_names)});")
+        lines.extend(self._jni_release_params(method))
+        lines.append("    const jsize n = static_cast<jsize>(items.size());")
+        for m in struct.members:
+            _, elem, region = self._batch_primitive(m.type)
+            value = f"items[i].{m.name}"
+            if m.type == "bool":
+                value = f"{value} ? JNI_TRUE : JNI_FALSE"
+            elif self._is_enum_type(m.type):
+                value = f"static_cast<jint>({value})"
+            lines.extend([
+                f"    {elem}Array {m.name}Column = env->New{region}Array(n);",
+                f"    if (!{m.name}Column) return nullptr;",
+                "    {",
+                f"        std::vector<{elem}> values(static_cast<size_t>(n));",
+                f"        for (jsize i = 0; i < n; ++i) values[i] = {value};",
+                f"        env->Set{region}ArrayRegion({m.name}Column, 0, n, values.data());",
+                "    }",
+            ])
+        member = self._cache_member(inner)
+        ctor_args = ", ".join(f"{m.name}Column" for m in struct.members)
+        lines.append(f"    return env->NewObject(g_jni.{member}ColumnsClass, g_jni.{member}ColumnsCtor, {ctor_args});")
+        lines[start:] = self._guarded(lines[start:], f"{cpp_class.split('::')[-1]}.{method.name}Columns",
+                                      "return nullptr;", self._jni_release_params(method))
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    # Scalar stream element mapping: IDL type -> (Java type, boxed Java type, JNI element type, JNI region suffix)
+    STREAM_PRIMITIVES = {
+        "int": ("int", "Integer", "jint", "Int"),
+        "int32_t": ("int", "Integer", "jint", "Int"),
+        "int64_t": ("long", "Long", "jlong", "Long"),
+        "float": ("float", "Float", "jfloat", "Float"),
+        "double": ("double", "Double", "jdouble", "Double"),
+    }
+
+    def _has_streams(self) -> bool:
+        return any(self.idl.symbols.stream_types.values())
+
+    def _stream_java_item_type(self, inner: str) -> str:
+        prim = self.STREAM_PRIMITIVES.get(inner)
+        return prim[1] if prim else inner
+
+    def _stream_jni_array_type(self, inner: str) -> str:
+        prim = self.STREAM_PRIMITIVES.get(inner)
+        return f"{prim[2]}Array" if prim else "jobjectArray"
+
+    def _java_stream_method(self, cls: Class, method: Method) -> list[str]:
+        """Public wrapper for a stream<T> method: a NativeStream pulling chunks through the Next native"""
+        inner = TypeMapper.stream_inner(method.return_type)
+        item = self._stream_java_item_type(inner)
+        params = ", ".join(self._param_to_java(p) for p in method.params)
+        native_args = ", ".join(["nativeHandle"] + [p.name for p in method.params])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}"
+        chunk = f"{native_name}Next(s, max)"
+        chunk = f"NativeStream.boxed({chunk})" if inner in self.STREAM_PRIMITIVES else f"Arrays.asList({chunk})"
+        return [
+            "    /** Items pulled from native memory in chunks as the stream is iterated; close it before this object. */",
+            f"    public NativeStream<{item}> {method.name}({params}) {{",
+            f"        long stream = {native_name}({native_args});",
+            "        if (stream == 0) {",
+            f'            throw new IllegalStateException("{method.name} called on a closed object");',
+            "        }",
+            f"        return new NativeStream<>(stream, (s, max) -> {chunk}, {cls.name}::{native_name}Free);",
+            "    }",
+            "",
+        ]
+
+    def _native_stream_decls(self, method: Method) -> list[str]:
+        inner = TypeMapper.stream_inner(method.return_type)
+        prim = self.STREAM_PRIMITIVES.get(inner)
+        chunk = f"{prim[0]}[]" if prim else f"{inner}[]"
+        params = ["long handle"] + [self._param_to_java(p) for p in method.params]
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}"
+        return [
+            f"    private static native long {native_name}({', '.join(params)});",
+            f"    private static native {chunk} {native_name}Next(long stream, int max);",
+            f"    private static native void {native_name}Free(long stream);",
+        ]
+
+    def _jni_stream_impls(self, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+        """The stream's pull source lives on the heap behind a jlong until Free"""
+        inner = TypeMapper.stream_inner(method.return_type)
+        source = TypeMapper.to_cpp(method.return_type)
+        item = TypeMapper.to_cpp(inner)
+        prim = self.STREAM_PRIMITIVES.get(inner)
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}"
+        jni_params = ", ".join(
+            ["JNIEnv* env", "jclass", "jlong handle"] +
+            [f"{self._param_to_jni_type(p)} {p.name}" for p in method.params]
+        )
+        lines = [f"JNIEXPORT jlong JNICALL {jni_class}_{native_name}({jni_params}) {{"]
+        lines.append(f"    auto* obj = jlongToPtr<{cpp_class}>(handle);")
+        lines.append("    if (!obj) return 0;")
+        param_lines, cpp_arg_names = self._jni_convert_params(method)
+        lines.extend(param_lines)
+        where = f"{cpp_class.split('::')[-1]}.{method.name}"
+        body = [f"    auto* source = new {source}(obj->{method.name}({', '.join(cpp_arg_names)}));"]
+        body.extend(self._jni_release_params(method))
+        body.append("    g_liveObjects.fetch_add(1, std::memory_order_relaxed);")
+        body.append("    g_liveBytes.fetch_add(sizeof(*source), std::memory_order_relaxed);")
+        body.append("    return ptrToJlong(source);")
+        lines.extend(self._guarded(body, where, "return 0;", self._jni_release_params(method)))
+        lines.append("}")
+        lines.append("")
+
+        ret = self._stream_jni_array_type(inner)
+        lines.append(f"JNIEXPORT {ret} JNICALL {jni_class}_{native_name}Next(JNIEnv* env, jclass, jlong stream, jint max) {{")
+        lines.append(f"    auto* source = jlongToPtr<{source}>(stream);")
+        lines.append("    if (!source || max <= 0) return nullptr;")
+        start = len(lines)
+        lines.append(f"    std::vector<{item}> items(static_cast<size_t>(max));")
+        lines.append("    size_t n = *source ? std::min((*source)(items.data(), items.size()), items.size()) : 0;")
+        lines.append("    if (n == 0) *source = nullptr;  // drop the source's captured state at the end")
+        lines.append("    const jsize count = static_cast<jsize>(n);")
+        if prim:
+            _, _, elem, region = prim
+            lines.append(f"    {ret} chunk = env->New{region}Array(count);")
+            lines.append("    if (!chunk) return nullptr;")
+            lines.append(f"    std::vector<{elem}> values(items.begin(), items.begin() + count);")
+            lines.append(f"    env->Set{region}ArrayRegion(chunk, 0, count, values.data());")
+        else:
+            struct = self._get_struct(inner)
+            ids = f"g_jni.{self._cache_member(inner)}"
+            ctor_args = ", ".join(f"items[i].{m.name}" for m in struct.members)
+            lines.append(f"    jobjectArray chunk = env->NewObjectArray(count, {ids}.cls, nullptr);")
+            lines.append("    if (!chunk) return nullptr;")
+            lines.append("    for (jsize i = 0; i < count; ++i) {")
+            lines.append(f"        jobject jitem = env->NewObject({ids}.cls, {ids}.ctor, {ctor_args});")
+            lines.append("        env->SetObjectArrayElement(chunk, i, jitem);")
+            lines.append("        env->DeleteLocalRef(jitem);")
+            lines.append("    }")
+        lines.append("    return chunk;")
+        lines[start:] = self._guarded(lines[start:], where, "return nullptr;")
+        lines.append("}")
+        lines.append("")
+
+        lines.append(f"JNIEXPORT void JNICALL {jni_class}_{native_name}Free(JNIEnv*, jclass, jlong stream) {{")
+        lines.append("    if (!stream) return;")
+        lines.append(f"    delete jlongToPtr<{source}>(stream);")
+        lines.append("    g_liveObjects.fetch_sub(1, std::memory_order_relaxed);")
+        lines.append(f"    g_liveBytes.fetch_sub(sizeof({source}), std::memory_order_relaxed);")
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    # Primitive batch element mapping: IDL type -> (Java type, JNI element type, JNI region suffix)
+    BATCH_PRIMITIVES = {
+        "int": ("int", "jint", "Int"),
+        "bool": ("boolean", "jboolean", "Boolean"),
+        "float": ("float", "jfloat", "Float"),
+        "double": ("double", "jdouble", "Double"),
+    }
+
+    def _batch_primitive(self, idl_type: str):
+        """Primitive mapping for a batch element; enums travel as int"""
+        if self._is_enum_type(idl_type):
+            return self.BATCH_PRIMITIVES["int"]
+        return self.BATCH_PRIMITIVES.get(idl_type)
+
+    def _batch_java_array_type(self, idl_type: str) -> str:
+        prim = self._batch_primitive(idl_type)
+        return f"{prim[0]}[]" if prim else f"{idl_type}[]"
+
+    def _batch_jni_array_type(self, idl_type: str) -> str:
+        prim = self._batch_primitive(idl_type)
+        return f"{prim[1]}Array" if prim else "jobjectArray"
+
+    def _java_batch_method(self, method: Method) -> list[str]:
+        """Public Java wrapper for a [batch] method: one array per parameter"""
+        ret = self._batch_java_array_type(method.return_type) if method.return_type != "void" else "void"
+        params = ", ".join(f"{self._batch_java_array_type(p.type)} {p.name}" for p in method.params)
+        native_args = ", ".join(["nativeHandle"] + [p.name for p in method.params])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Batch"
+        call = f"{native_name}({native_args});"
+        return [
+            f"    public {ret} {method.name}Batch({params}) {{",
+            f"        {call}" if ret == "void" else f"        return {call}",
+            "    }",
+            "",
+        ]
+
+    def _native_batch_decl(self, method: Method) -> str:
+        ret = self._batch_java_array_type(method.return_type) if method.return_type != "void" else "void"
+        params = ["long handle"] + [f"{self._batch_java_array_type(p.type)} {p.name}" for p in method.params]
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Batch"
+        return f"    private static native {ret} {native_name}({', '.join(params)});"
+
+    def _jni_batch_impl(self, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+        """JNI side of a [batch] method: unpack arrays once, loop natively, pack one result array"""
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Batch"
+        has_out = method.return_type != "void"
+        ret = self._batch_jni_array_type(method.return_type) if has_out else "void"
+        fail = "return nullptr;" if has_out else "return;"
+        jni_params = ", ".join(
+            ["JNIEnv* env", "jclass", "jlong handle"] +
+            [f"{self._batch_jni_array_type(p.type)} {p.name}" for p in method.params]
+        )
+
+        lines = [f"JNIEXPORT {ret} JNICALL {jni_class}_{native_name}({jni_params}) {{"]
+        lines.append(f"    auto* obj = jlongToPtr<{cpp_class}>(handle);")
+        lines.append(f"    if (!obj) {fail}")
+        start = len(lines)
+        # Null or mismatched inputs throw IllegalArgumentException through the guard below
+        lines.extend(f'    if (!{p.name}) throw std::invalid_argument("null {p.name}");' for p in method.params)
+        if method.params:
+            first = method.params[0].name
+            lines.append(f"    const jsize batchSize = env->GetArrayLength({first});")
+            for p in method.params[1:]:
+                lines.append(f"    const jsize {p.name}Length = env->GetArrayLength({p.name});")
+                lines.append(f"    if ({p.name}Length != batchSize) {{")
+                lines.append(f'        throw std::invalid_argument("{p.name} has " + std::to_string({p.name}Length) + '
+                             f'" elements but {first} has " + std::to_string(batchSize));')
+                lines.append("    }")
+        else:
+            lines.append("    const jsize batchSize = 0;")
+
+        # Unpack inputs
+        call_args = []
+        for p in method.params:
+            prim = self._batch_primitive(p.type)
+            if prim:
+                lines.append(f"    std::vector<{prim[1]}> cpp_{p.name}(batchSize);")
+                lines.append(f"    env->Get{prim[2]}ArrayRegion({p.name}, 0, batchSize, cpp_{p.name}.data());")
+                if self._is_enum_type(p.type):
+                    call_args.append(f"static_cast<::{p.type}>(cpp_{p.name}[i])")
+                elif p.type == "bool":
+                    call_args.append(f"cpp_{p.name}[i] != JNI_FALSE")
+                else:
+                    call_args.append(f"cpp_{p.name}[i]")
+            else:
+                struct = self._get_struct(p.type)
+                ids = f"g_jni.{self._cache_member(p.type)}"
+                lines.append(f"    std::vector<::{p.type}> cpp_{p.name}(batchSize);")
+                lines.append("    for (jsize i = 0; i < batchSize; ++i) {")
+                lines.append(f"        jobject item = env->GetObjectArrayElement({p.name}, i);")
+                for m in struct.members:
+                    getter = self._jni_field_getter(m.type)
+                    lines.append(f"        cpp_{p.name}[i].{m.name} = env->{getter}(item, {ids}.{m.name}_fid);")
+                lines.append("        env->DeleteLocalRef(item);")
+                lines.append("    }")
+                call_args.append(f"cpp_{p.name}[i]")
+
+        call = f"obj->{method.name}({', '.join(call_args)})"
+        if method.has_attribute("kernel"):
+            # <method>Batch takes C element arrays; jboolean, jint and enum inputs are widened first
+            kernel_args = []
+            for p, arg in zip(method.params, call_args):
+                if p.type in ("float", "double") or not self._batch_primitive(p.type):
+                    kernel_args.append(f"cpp_{p.name}.data()")
+                    continue
+                c_elem = "int" if p.type == "bool" else TypeMapper.to_c(p.type)
+                lines.append(f"    std::vector<{c_elem}> kernel_{p.name}(batchSize);")
+                lines.append("    for (jsize i = 0; i < batchSize; ++i) {")
+                lines.append(f"        kernel_{p.name}[i] = {arg};")
+                lines.append("    }")
+                kernel_args.append(f"kernel_{p.name}.data()")
+            if has_out:
+                c_out = "int" if method.return_type == "bool" else TypeMapper.to_c(method.return_type)
+                lines.append(f"    std::vector<{c_out}> kernelOut(batchSize);")
+                kernel_args.append("kernelOut.data()")
+            kernel_args.append("static_cast<int>(batchSize)")
+            lines.append(f"    obj->{method.name}Batch({', '.join(kernel_args)});")
+            call = "kernelOut[i]"
+        prim = self._batch_primitive(method.return_type) if has_out else None
+        if not has_out:
+            if not method.has_attribute("kernel"):
+                lines.append("    for (jsize i = 0; i < batchSize; ++i) {")
+                lines.append(f"        {call};")
+                lines.append("    }")
+        elif prim:
+            lines.append(f"    std::vector<{prim[1]}> out(batchSize);")
+            lines.append("    for (jsize i = 0; i < batchSize; ++i) {")
+            if method.return_type == "bool":
+                lines.append(f"        out[i] = {call} ? JNI_TRUE : JNI_FALSE;")
+            elif self._is_enum_type(method.return_type):
+                lines.append(f"        out[i] = static_cast<jint>({call});")
+            else:
+                lines.append(f"        out[i] = {call};")
+            lines.append("    }")
+            lines.append(f"    {ret} result = env->New{prim[2]}Array(batchSize);")
+            lines.append(f"    env->Set{prim[2]}ArrayRegion(result, 0, batchSize, out.data());")
+            lines.append("    return result;")
+        else:
+            struct = self._get_struct(method.return_type)
+            lines.append(f"    const auto& ids = g_jni.{self._cache_member(method.return_type)};")
+            lines.append("    jobjectArray result = env->NewObjectArray(batchSize, ids.cls, nullptr);")
+            lines.append("    for (jsize i = 0; i < batchSize; ++i) {")
+            lines.append(f"        auto ret = {call};")
+            ctor_args = ", ".join(f"ret.{m.name}" for m in struct.members)
+            lines.append(f"        jobject jitem = env->NewObject(ids.cls, ids.ctor, {ctor_args});")
+            lines.append("        env->SetObjectArrayElement(result, i, jitem);")
+            lines.append("        env->DeleteLocalRef(jitem);")
+            lines.append("    }")
+            lines.append("    return result;")
+
+        lines[start:] = self._guarded(lines[start:], f"{cpp_class.split('::')[-1]}.{method.name}Batch", fail)
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    # Boxed Java types for async results: IDL type -> (java.lang class, valueOf argument signature)
+    ASYNC_BOXES = {
+        "int": ("Integer", "I"),
+        "bool": ("Boolean", "Z"),
+        "float": ("Float", "F"),
+        "double": ("Double", "D"),
+    }
+
+    def _async_methods(self) -> list[Method]:
+        return [m for cls in self.idl.classes for m in cls.methods if m.has_attribute("async")]
+
+    def _async_box(self, idl_type: str):
+        """Box for a scalar async result; enums complete with their int value like the sync methods"""
+        if self._is_enum_type(idl_type):
+            return self.ASYNC_BOXES["int"]
+        return self.ASYNC_BOXES.get(idl_type)
+
+    def _async_boxes(self) -> list[tuple[str, str]]:
+        """Boxes needed by the async methods, in a stable order"""
+        boxes = {self._async_box(m.return_type) for m in self._async_methods()} - {None}
+        return sorted(boxes)
+
+    def _async_java_type(self, idl_type: str) -> str:
+        if idl_type == "void":
+            return "Void"
+        box = self._async_box(idl_type)
+        return box[0] if box else self._return_to_java_type(idl_type)
+
+    def _java_async_close(self) -> list[str]:
+        """close() for classes with [async] methods: a call still on the pool keeps the object
+        alive, and the last one to finish destroys it"""
+        return [
+            "    // [async] calls on the pool; guarded by this",
+            "    private int pendingCalls;",
+            "",
+            "    /** Destroys the native object now, or when the last pending async call finishes. */",
+            "    @Override",
+            "    public void close() {",
+            "        synchronized (this) {",
+            "            if (nativeHandle == 0) {",
+            "                return;",
+            "            }",
+            "            nativeHandle = 0;",
+            "            if (pendingCalls > 0) {",
+            "                return;",
+            "            }",
+            "        }",
+            "        cleanable.clean();",
+            "    }",
+            "",
+            "    // The handle for an async call, which must releaseHandle() once done; 0 when closed",
+            "    private synchronized long retainHandle() {",
+            "        if (nativeHandle != 0) {",
+            "            ++pendingCalls;",
+            "        }",
+            "        return nativeHandle;",
+            "    }",
+            "",
+            "    private void releaseHandle() {",
+            "        boolean last;",
+            "        synchronized (this) {",
+            "            last = --pendingCalls == 0 && nativeHandle == 0;",
+            "        }",
+            "        if (last) {",
+            "            cleanable.clean();",
+            "        }",
+            "    }",
+            "",
+        ]
+
+    def _java_async_method(self, cls: Class, method: Method) -> list[str]:
+        """Runs on the native worker pool; callbacks and completion happen on a pool thread.
+        The completion action holds the wrapper, and the task holds the future, so neither
+        close() nor the Cleaner destroys the object under a running call."""
+        java_type = self._async_java_type(method.return_type)
+        params = ", ".join(self._param_to_java(p) for p in method.params)
+        native_args = ", ".join(["handle"] + [p.name for p in method.params] + ["future"])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Async"
+        return [
+            f"    /** Runs {method.name} on the native worker pool; callbacks fire on a pool thread. */",
+            f"    public CompletableFuture<{java_type}> {method.name}Async({params}) {{",
+            f"        CompletableFuture<{java_type}> future = new CompletableFuture<>();",
+            "        long handle = retainHandle();",
+            "        if (handle != 0) {",
+            "            future.whenComplete((value, error) -> releaseHandle());",
+            "        }",
+            f"        {native_name}({native_args});",
+            "        return future;",
+            "    }",
+            "",
+        ]
+
+    def _native_async_decl(self, method: Method) -> str:
+        java_type = self._async_java_type(method.return_type)
+        params = (["long handle"] + [self._param_to_java(p) for p in method.params]
+                  + [f"CompletableFuture<{java_type}> future"])
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Async"
+        return f"    private static native void {native_name}({', '.join(params)});"
 
+    def _async_helpers(self) -> list[str]:
+        return [
+            f"// Runs and frees a task handed to {self.namespace}_run_async",
+            "void runTask(void* arg) {",
+            "    std::unique_ptr<std::function<void()>> task(static_cast<std::function<void()>*>(arg));",
+            "    (*task)();",
+            "}",
+            "",
+            "void failFuture(JNIEnv* env, jobject future, const char* message) {",
+            "    jstring text = env->NewStringUTF(message);",
+            "    jobject error = env->NewObject(g_jni.runtimeExceptionClass, g_jni.runtimeExceptionCtor, text);",
+            "    env->CallBooleanMethod(future, g_jni.futureCompleteExceptionally, error);",
+            "    env->DeleteLocalRef(error);",
+            "    env->DeleteLocalRef(text);",
+            "}",
+            "",
+            "// Completes with a Java exception left pending by a callback; false if there was none",
+            "bool failFutureWithPending(JNIEnv* env, jobject future) {",
+            "    if (!env->ExceptionCheck()) return false;",
+            "    jthrowable error = env->ExceptionOccurred();",
+            "    env->ExceptionClear();",
+            "    env->CallBooleanMethod(future, g_jni.futureCompleteExceptionally, error);",
+            "    env->DeleteLocalRef(error);",
+            "    return true;",
+            "}",
+            "",
+        ]
+
+    def _async_result_to_java(self, idl_type: str) -> str:
+        """Expression boxing the C++ result `ret` for CompletableFuture.complete"""
+        if idl_type == "void":
+            return "nullptr"
+        if idl_type == "string":
+            return "taskEnv->NewStringUTF(ret.c_str())"
+        if self._is_struct_type(idl_type):
+            struct = self._get_struct(idl_type)
+            ids = f"g_jni.{self._cache_member(idl_type)}"
+            ctor_args = ", ".join(f"ret.{m.name}" for m in struct.members)
+            return f"taskEnv->NewObject({ids}.cls, {ids}.ctor, {ctor_args})"
+        box, _ = self._async_box(idl_type)
+        member = self._cache_member(box)
+        if idl_type == "bool":
+            value = "ret ? JNI_TRUE : JNI_FALSE"
+        elif self._is_enum_type(idl_type):
+            value = "static_cast<jint>(ret)"
+        else:
+            value = "ret"
+        return f"taskEnv->CallStaticObjectMethod(g_jni.{member}Class, g_jni.{member}ValueOf, {value})"
+
+    def _jni_async_impl(self, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+        """Convert the arguments on the calling thread, then run the call as a pool task that
+        completes the future. Callback wrappers already hold global refs and attach the worker."""
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}Async"
+        jni_params = ", ".join(
+            ["JNIEnv* env", "jclass", "jlong handle"] +
+            [f"{self._param_to_jni_type(p)} {p.name}" for p in method.params] +
+            ["jobject future"]
+        )
+        lines = [f"JNIEXPORT void JNICALL {jni_class}_{native_name}({jni_params}) {{"]
+        lines.append(f"    auto* obj = jlongToPtr<{cpp_class}>(handle);")
+        lines.append("    if (!obj) {")
+        lines.append('        failFuture(env, future, "object is closed");')
+        lines.append("        return;")
+        lines.append("    }")
+        start = len(lines)
+        param_lines, cpp_arg_names = self._jni_convert_params(method)
+        lines.extend(param_lines)
+        lines.append("    SharedGlobalRef futureRef = makeSharedGlobalRef(env, future);")
+        call = f"obj->{method.name}({', '.join(cpp_arg_names)})"
+        lines.append("    auto task = std::make_unique<std::function<void()>>([=] {")
+        lines.append("        JNIEnv* taskEnv = attachedEnv(g_jni.vm);")
+        lines.append("        try {")
+        if method.return_type == "void":
+            lines.append(f"            {call};")
+        else:
+            lines.append(f"            auto ret = {call};")
+        lines.append("            if (failFutureWithPending(taskEnv, futureRef.get())) return;")
+        lines.append(f"            jobject value = {self._async_result_to_java(method.return_type)};")
+        lines.append("            taskEnv->CallBooleanMethod(futureRef.get(), g_jni.futureComplete, value);")
+        if method.return_type != "void":
+            lines.append("            taskEnv->DeleteLocalRef(value);")
+        lines.append("        } catch (const std::exception& e) {")
+        lines.append("            if (!failFutureWithPending(taskEnv, futureRef.get())) failFuture(taskEnv, futureRef.get(), e.what());")
+        lines.append("        } catch (...) {")
+        lines.append(f'            if (!failFutureWithPending(taskEnv, futureRef.get())) failFuture(taskEnv, futureRef.get(), "{method.name} failed");')
+        lines.append("        }")
+        lines.append("    });")
+        lines.append(f"    if ({self.namespace}_run_async(runTask, task.get()) != 0) {{")
+        lines.append(f"        failFuture(env, future, {self.namespace}_last_error_message());")
+        lines.append("        return;")
+        lines.append("    }")
+        lines.append("    task.release();  // Freed by runTask")
+        # Setting up the task may throw too: the future still completes, releasing its handle
+        body = [f"    {line}" if line else line for line in lines[start:]]
+        lines[start:] = ["    try {", *body, "    } catch (...) {",
+                         f'        failFuture(env, future, "{method.name}Async: cannot start");', "    }"]
+        lines.append("}")
+        lines.append("")
         return lines
 
     def _is_struct_type(self, type_name: str) -> bool:
         """Check if a type is a struct defined in IDL"""
-        return any(s.name == type_name for s in self.idl.structs)
+        return type_name in self.idl.symbols.structs
 
     def _is_class_type(self, type_name: str) -> bool:
         """Check if a type is a class defined in IDL"""
-        return any(c.name == type_name for c in self.idl.classes)
+        return type_name in self.idl.symbols.classes
 
     def _is_enum_type(self, type_name: str) -> bool:
         """Check if a type is an enum defined in IDL"""
-        return any(e.name == type_name for e in self.idl.enums)
+        return type_name in self.idl.symbols.enums
 
     def _get_struct(self, type_name: str):
         """Get struct definition by name"""
-        return next((s for s in self.idl.structs if s.name == type_name), None)
+        return self.idl.symbols.structs.get(type_name)
 
     def _get_callback(self, type_name: str):
         """Get callback definition by name"""
-        return next((cb for cb in self.idl.callbacks if cb.name == type_name), None)
+        return self.idl.symbols.callbacks.get(type_name)
+
+    def _batch_callbacks(self) -> list:
+        return [cb for cb in self.idl.callbacks if cb.has_attribute("batch")]
+
+    def _batch_callback_helpers(self) -> list[str]:
+        return [
+            "// [batch] callback arrays: C elements copied into and out of Java primitive arrays",
+            "template <typename J, typename T>",
+            "void writeJavaArray(JNIEnv* env, jarray array, const T* src, int count) {",
+            "    if (!array || env->ExceptionCheck()) return;",
+            "    auto* dst = static_cast<J*>(env->GetPrimitiveArrayCritical(array, nullptr));",
+            "    if (!dst) return;",
+            "    for (int i = 0; i < count; ++i) dst[i] = static_cast<J>(src[i]);",
+            "    env->ReleasePrimitiveArrayCritical(array, dst, 0);",
+            "}",
+            "",
+            "// Zero-fills dst when the callback threw, so the implementation never reads stale results",
+            "template <typename J, typename T>",
+            "void readJavaArray(JNIEnv* env, jarray array, T* dst, int count) {",
+            "    J* src = nullptr;",
+            "    if (array && !env->ExceptionCheck()) src = static_cast<J*>(env->GetPrimitiveArrayCritical(array, nullptr));",
+            "    for (int i = 0; i < count; ++i) dst[i] = src ? static_cast<T>(src[i]) : T{};",
+            "    if (src) env->ReleasePrimitiveArrayCritical(array, src, JNI_ABORT);",
+            "}",
+            "",
+        ]
+
+    def _batch_callback_signature(self, cb) -> str:
+        """JNI signature of invokeBatch: one primitive array per parameter, then the results"""
+        types = [p.type for p in cb.params] + ([cb.return_type] if cb.return_type != "void" else [])
+        return f"({''.join('[' + self._java_type_signature(t) for t in types)})V"
+
+    def _generate_jni_batch_callback_wrapper(self, param: Param, cb) -> list[str]:
+        """One invokeBatch call per batch instead of one JNI transition per element"""
+        name = param.name
+        arrays = [(p.name, p.type, True) for p in cb.params]
+        if cb.return_type != "void":
+            arrays.append(("result", cb.return_type, False))
+        c_params = [f"{'const ' if is_input else ''}{'int' if t == 'bool' else TypeMapper.to_c(t)}* {n}"
+                    for n, t, is_input in arrays]
+        lines = [
+            f"    // Create wrapper for Java callback {name}, batched through invokeBatch",
+            f"    SharedGlobalRef {name}Ref = makeSharedGlobalRef(env, {name});",
+            f"    auto cpp_{name} = [{name}Ref]({', '.join(c_params + ['int count'])}) {{",
+            "        JNIEnv* cbEnv = attachedEnv(g_jni.vm);",
+        ]
+        lines.extend([
+            "        // While an exception is pending (an earlier batch threw, or an allocation failed)",
+            "        // only ExceptionCheck/DeleteLocalRef are allowed: skip the call, results read as 0",
+        ])
+        for n, t, _ in arrays:
+            _, jtype, region = self._batch_primitive(t)
+            lines.append(f"        {jtype}Array j_{n} = cbEnv->ExceptionCheck() ? nullptr : cbEnv->New{region}Array(count);")
+        for n, t, is_input in arrays:
+            if is_input:
+                lines.append(f"        writeJavaArray<{self._batch_primitive(t)[1]}>(cbEnv, j_{n}, {n}, count);")
+        ready = " && ".join(f"j_{n}" for n, _, _ in arrays)
+        invoke = f"g_jni.{self._cache_member(cb.name)}InvokeBatch"
+        call_args = ", ".join([f"{name}Ref.get()", invoke] + [f"j_{n}" for n, _, _ in arrays])
+        lines.append(f"        if ({ready} && !cbEnv->ExceptionCheck()) cbEnv->CallVoidMethod({call_args});")
+        if cb.return_type != "void":
+            lines.append(f"        readJavaArray<{self._batch_primitive(cb.return_type)[1]}>(cbEnv, j_result, result, count);")
+        for n, _, _ in arrays:
+            lines.append(f"        cbEnv->DeleteLocalRef(j_{n});")
+        lines.append("    };")
+        return lines
 
     def _generate_jni_callback_wrapper(self, param: Param, cb) -> list[str]:
         """Generate JNI code to wrap a Java callback into a C++ callback"""
+        if cb.has_attribute("batch"):
+            return self._generate_jni_batch_callback_wrapper(param, cb)
         lines = []
+        name = param.name
         
-        # Store the JNI env and callback object for use in the wrapper
-        lines.append(f"    // Create wrapper for Java callback {param.name}")
-        lines.append(f"    jobject g_{param.name} = env->NewGlobalRef({param.name});")
-        lines.append(f"    jclass {param.name}Class = env->GetObjectClass({param.name});")
-        
-        # Build method signature
-        jni_sig = self._build_callback_signature(cb)
-        lines.append(f'    jmethodID {param.name}Method = env->GetMethodID({param.name}Class, "invoke", "{jni_sig}");')
-        
-        # Generate the C callback wrapper
-        c_params = ", ".join(f"{TypeMapper.to_c(p.type)} {p.name}" for p in cb.params)
-        c_ret = TypeMapper.to_c(cb.return_type)
+        # Everything the lambda needs is captured by value, so it is re-entrant
+        # and may be invoked from any native thread
+        lines.append(f"    // Create wrapper for Java callback {name}")
+        lines.append(f"    SharedGlobalRef {name}Ref = makeSharedGlobalRef(env, {name});")
+        captures = [f"{name}Ref"]
         
-        # Create a capturing lambda that calls the Java method
-        # Note: For simplicity, we use a static variable approach
-        lines.append(f"    static thread_local JNIEnv* s_env_{param.name} = nullptr;")
-        lines.append(f"    static thread_local jobject s_callback_{param.name} = nullptr;")
-        lines.append(f"    static thread_local jmethodID s_method_{param.name} = nullptr;")
-        lines.append(f"    s_env_{param.name} = env;")
-        lines.append(f"    s_callback_{param.name} = g_{param.name};")
-        lines.append(f"    s_method_{param.name} = {param.name}Method;")
+        cpp_params = []
+        for p in cb.params:
+            if self._is_struct_type(p.type) and p.is_reference:
+                const = "const " if p.is_const else ""
+                cpp_params.append(f"{const}::{p.type}& {p.name}")
+            elif self._is_struct_type(p.type):
+                cpp_params.append(f"::{p.type} {p.name}")
+            else:
+                cpp_params.append(f"{TypeMapper.to_cpp(p.type)} {p.name}")
+        cpp_ret = TypeMapper.to_cpp(cb.return_type)
         
-        # Create the wrapper lambda
-        lines.append(f"    auto cpp_{param.name} = []({c_params}) -> {c_ret} {{")
+        lines.append(f"    auto cpp_{name} = [{', '.join(captures)}]({', '.join(cpp_params)}) -> {cpp_ret} {{")
+        lines.append("        JNIEnv* cbEnv = attachedEnv(g_jni.vm);")
+        call_args = []
+        for p in cb.params:
+            if self._is_struct_type(p.type):
+                struct = self._get_struct(p.type)
+                ctor_args = ", ".join(f"{p.name}.{m.name}" for m in struct.members)
+                ids = f"g_jni.{self._cache_member(p.type)}"
+                lines.append(f"        jobject j_{p.name} = cbEnv->NewObject({ids}.cls, {ids}.ctor, {ctor_args});")
+                call_args.append(f"j_{p.name}")
+            else:
+                call_args.append(p.name)
         
-        # Call the Java method
-        call_args = ", ".join(p.name for p in cb.params)
         jni_call_method = self._get_jni_call_method(cb.return_type)
+        invoke = f"g_jni.{self._cache_member(cb.name)}Invoke"
+        call = f"cbEnv->{jni_call_method}({', '.join([f'{name}Ref.get()', invoke] + call_args)})"
+        struct_args = [f"j_{p.name}" for p in cb.params if self._is_struct_type(p.type)]
         
         if cb.return_type == 'void':
-            lines.append(f"        s_env_{param.name}->{jni_call_method}(s_callback_{param.name}, s_method_{param.name}, {call_args});")
+            lines.append(f"        {call};")
         else:
-            lines.append(f"        return s_env_{param.name}->{jni_call_method}(s_callback_{param.name}, s_method_{param.name}, {call_args});")
+            if cb.return_type == 'bool':
+                call = f"{call} != JNI_FALSE"
+            lines.append(f"        {cpp_ret} ret = {call};")
+        for arg in struct_args:
+            lines.append(f"        cbEnv->DeleteLocalRef({arg});")
+        if cb.return_type != 'void':
+            lines.append("        return ret;")
         
         lines.append("    };")
         
@@ -415,10 +1858,16 @@ class JNIGenerator:
 
     def _build_callback_signature(self, cb) -> str:
         """Build JNI method signature for callback"""
-        param_sigs = "".join(self._java_type_signature(p.type) for p in cb.params)
+        param_sigs = "".join(self._java_param_signature(p.type) for p in cb.params)
         ret_sig = self._java_type_signature(cb.return_type) if cb.return_type != 'void' else 'V'
         return f"({param_sigs}){ret_sig}"
 
+    def _java_param_signature(self, idl_type: str) -> str:
+        """JNI signature of a callback parameter; structs are passed as their Java class"""
+        if self._is_struct_type(idl_type):
+            return "L" + self.java_package.replace(".", "/") + "/" + idl_type + ";"
+        return self._java_type_signature(idl_type)
+
     def _get_jni_call_method(self, return_type: str) -> str:
         """Get the JNI CallXxxMethod name for return type"""
         mapping = {
@@ -430,14 +1879,15 @@ class JNIGenerator:
         }
         return mapping.get(return_type, 'CallIntMethod')
 
-    def _jni_method_impl(self, cls: Class, method: Method, jni_class: str, cpp_class: str) -> list[str]:
+    def _jni_method_impl(self, cls: Class, method: Method, jni_class: str, cpp_class: str,
+                         byte_mode: str = "array") -> list[str]:
         """Generate single JNI method implementation"""
         ret = self._return_to_jni_type(method.return_type)
-        native_name = f"native{method.name[0].upper()}{method.name[1:]}"
+        native_name = f"native{method.name[0].upper()}{method.name[1:]}{self.BYTE_MODES[byte_mode][0]}"
         
         jni_params = ", ".join(
             ["JNIEnv* env", "jclass", "jlong handle"] +
-            [f"{self._param_to_jni_type(p)} {p.name}" for p in method.params]
+            [f"{self._param_to_jni_type(p, byte_mode)} {p.name}" for p in method.params]
         )
         
         lines = [f"JNIEXPORT {ret} JNICALL {jni_class}_{native_name}({jni_params}) {{"]
@@ -445,101 +1895,48 @@ class JNIGenerator:
         lines.append("    if (!obj) {")
         
         # Determine null return value
-        if TypeMapper.is_vector(method.return_type) or self._is_struct_type(method.return_type):
-            lines.append("        return nullptr;")
+        if ret == "void":
+            fail = "return;"
+        elif TypeMapper.is_vector(method.return_type) or self._is_struct_type(method.return_type):
+            fail = "return nullptr;"
         elif method.return_type == "bool":
-            lines.append("        return JNI_FALSE;")
+            fail = "return JNI_FALSE;"
         else:
-            lines.append("        return 0;")
+            fail = "return 0;"
+        lines.append(f"        {fail}")
         
         lines.append("    }")
         
-        # Convert parameters
-        cpp_arg_names = []
-        for p in method.params:
-            if p.type == "string":
-                lines.append(f"    std::string cpp_{p.name} = jstringToString(env, {p.name});")
-                cpp_arg_names.append(f"cpp_{p.name}")
-            elif p.type == "uint8_t" and p.is_pointer:
-                # Convert jbyteArray to uint8_t*
-                lines.append(f"    jbyte* cpp_{p.name}_ptr = env->GetByteArrayElements({p.name}, nullptr);")
-                lines.append(f"    const uint8_t* cpp_{p.name} = reinterpret_cast<const uint8_t*>(cpp_{p.name}_ptr);")
-                cpp_arg_names.append(f"cpp_{p.name}")
-            elif self._is_callback_type(p.type):
-                # Convert Java callback to C++ callback wrapper
-                cb = self._get_callback(p.type)
-                lines.extend(self._generate_jni_callback_wrapper(p, cb))
-                cpp_arg_names.append(f"cpp_{p.name}")
-            elif self._is_class_type(p.type):
-                # Class object parameter - convert jlong handle to C++ pointer
-                lines.append(f"    auto* cpp_{p.name} = jlongToPtr<{self.namespace}::{p.type}>({p.name});")
-                if p.is_reference:
-                    # Reference parameter - dereference
-                    cpp_arg_names.append(f"*cpp_{p.name}")
-                else:
-                    # Pointer parameter
-                    cpp_arg_names.append(f"cpp_{p.name}")
-            elif self._is_enum_type(p.type):
-                # Enum parameter - cast jint to enum type
-                cpp_arg_names.append(f"static_cast<::{p.type}>({p.name})")
-            elif self._is_struct_type(p.type):
-                # Convert Java object to C++ struct
-                # Structs are defined at global scope in C API header (not in namespace)
-                struct = self._get_struct(p.type)
-                java_class_path = self.java_package.replace(".", "/") + "/" + p.type
-                lines.append(f'    jclass {p.name}Class = env->GetObjectClass({p.name});')
-                lines.append(f"    ::{p.type} cpp_{p.name};")  # Use global scope
-                for m in struct.members:
-                    field_id = f"{p.name}_{m.name}_fid"
-                    jni_sig = self._java_type_signature(m.type)
-                    getter = self._jni_field_getter(m.type)
-                    lines.append(f'    jfieldID {field_id} = env->GetFieldID({p.name}Class, "{m.name}", "{jni_sig}");')
-                    lines.append(f"    cpp_{p.name}.{m.name} = env->{getter}({p.name}, {field_id});")
-                # Pass pointer or reference based on parameter type
-                if p.is_pointer:
-                    cpp_arg_names.append(f"&cpp_{p.name}")
-                else:
-                    cpp_arg_names.append(f"cpp_{p.name}")
-            else:
-                cpp_arg_names.append(p.name)
+        # Bounds-check byte arguments, then convert parameters
+        extent_checks = self._byte_extent_checks(method, byte_mode)
+        if extent_checks:
+            lines.extend(self._guarded(extent_checks, f"{cls.name}.{method.name}", fail))
+        param_lines, cpp_arg_names = self._jni_convert_params(method, byte_mode)
+        lines.extend(param_lines)
         
         cpp_args = ", ".join(cpp_arg_names)
+        start = len(lines)
         
         if TypeMapper.is_vector(method.return_type):
             inner = TypeMapper.vector_inner(method.return_type)
-            struct = next((s for s in self.idl.structs if s.name == inner), None)
+            struct = self.idl.symbols.structs.get(inner)
             
             lines.append(f"    auto result = obj->{method.name}({cpp_args});")
             
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             
             lines.append("")
-            lines.append(f'    jclass listClass = env->FindClass("java/util/ArrayList");')
-            lines.append('    jmethodID listCtor = env->GetMethodID(listClass, "<init>", "()V");')
-            lines.append('    jmethodID listAdd = env->GetMethodID(listClass, "add", "(Ljava/lang/Object;)Z");')
-            lines.append("    jobject list = env->NewObject(listClass, listCtor);")
+            lines.append("    jobject list = env->NewObject(g_jni.arrayListClass, g_jni.arrayListCtor);")
             lines.append("")
             
             if struct:
-                java_class_path = self.java_package.replace(".", "/") + "/" + inner
-                lines.append(f'    jclass itemClass = env->FindClass("{java_class_path}");')
-                
-                # Build constructor signature
-                sig_parts = []
-                for m in struct.members:
-                    sig_parts.append(self._java_type_signature(m.type))
-                sig = "(" + "".join(sig_parts) + ")V"
-                
-                lines.append(f'    jmethodID itemCtor = env->GetMethodID(itemClass, "<init>", "{sig}");')
-                lines.append("")
+                ids = f"g_jni.{self._cache_member(inner)}"
                 lines.append("    for (const auto& item : result) {")
                 
                 ctor_args = ", ".join(f"item.{m.name}" for m in struct.members)
-                lines.append(f"        jobject jitem = env->NewObject(itemClass, itemCtor, {ctor_args});")
-                lines.append("        env->CallBooleanMethod(list, listAdd, jitem);")
+                lines.append(f"        jobject jitem = env->NewObject({ids}.cls, {ids}.ctor, {ctor_args});")
+                lines.append("        env->CallBooleanMethod(list, g_jni.arrayListAdd, jitem);")
+                lines.append("        env->DeleteLocalRef(jitem);")
                 lines.append("    }")
             
             lines.append("    return list;")
@@ -547,72 +1944,126 @@ class JNIGenerator:
             # Return struct - convert C++ struct to Java object
             struct = self._get_struct(method.return_type)
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             
-            java_class_path = self.java_package.replace(".", "/") + "/" + method.return_type
-            lines.append(f'    jclass retClass = env->FindClass("{java_class_path}");')
-            
-            # Build constructor signature
-            sig_parts = []
-            for m in struct.members:
-                sig_parts.append(self._java_type_signature(m.type))
-            sig = "(" + "".join(sig_parts) + ")V"
-            
-            lines.append(f'    jmethodID retCtor = env->GetMethodID(retClass, "<init>", "{sig}");')
+            ids = f"g_jni.{self._cache_member(method.return_type)}"
             ctor_args = ", ".join(f"ret.{m.name}" for m in struct.members)
-            lines.append(f"    return env->NewObject(retClass, retCtor, {ctor_args});")
+            lines.append(f"    return env->NewObject({ids}.cls, {ids}.ctor, {ctor_args});")
         elif method.return_type.endswith('*') and self._is_class_type(method.return_type.rstrip('*').strip()):
             # Return class pointer - convert to jlong handle
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             lines.append("    return ptrToJlong(ret);")
         elif method.return_type.endswith('*') and self._is_struct_type(method.return_type.rstrip('*').strip()):
             # Return struct pointer - convert to jlong
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             lines.append("    return ptrToJlong(ret);")
         elif method.return_type == "bool":
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             lines.append("    return ret ? JNI_TRUE : JNI_FALSE;")
         elif method.return_type == "string":
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             lines.append("    return env->NewStringUTF(ret.c_str());")
         elif self._is_enum_type(method.return_type):
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             lines.append("    return static_cast<jint>(ret);")
         else:
             lines.append(f"    auto ret = obj->{method.name}({cpp_args});")
-            # Release byte arrays
-            for p in method.params:
-                if p.type == "uint8_t" and p.is_pointer:
-                    lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, JNI_ABORT);")
+            lines.extend(self._jni_release_params(method, byte_mode))
             lines.append("    return ret;")
-        
+
+        lines[start:] = self._guarded(lines[start:], f"{cls.name}.{method.name}", fail,
+                                      self._jni_release_params(method, byte_mode))
         lines.append("}")
         lines.append("")
         return lines
 
+    def _guarded(self, body: list[str], where: str, fail: str, cleanup: list[str] = ()) -> list[str]:
+        """Function-level body lines inside a try; the catch runs cleanup (such as releasing pinned
+        arrays, which must happen before a Java exception is thrown) and throws the Java exception"""
+        lines = ["    try {"]
+        lines.extend(f"    {line}" if line else line for line in body)
+        lines.append("    } catch (...) {")
+        lines.extend(f"    {line}" for line in cleanup)
+        lines.append(f'        throwNativeException(env, "{where}");')
+        lines.append(f"        {fail}")
+        lines.append("    }")
+        return lines
+
+    def _jni_convert_params(self, method: Method, byte_mode: str = "array") -> tuple[list[str], list[str]]:
+        """Convert JNI arguments to C++ values; returns (code lines, C++ argument expressions)"""
+        lines = []
+        cpp_arg_names = []
+        for p in method.params:
+            if p.type == "string":
+                lines.append(f"    std::string cpp_{p.name} = jstringToString(env, {p.name});")
+                cpp_arg_names.append(f"cpp_{p.name}")
+            elif self._is_byte_pointer(p):
+                ptr_type = "const uint8_t*" if p.is_const else "uint8_t*"
+                if byte_mode == "direct":
+                    # Direct ByteBuffer: the native address, no copy and nothing to release
+                    lines.append(f"    auto* cpp_{p.name} = static_cast<{ptr_type}>(env->GetDirectBufferAddress({p.name}));")
+                elif byte_mode == "critical":
+                    lines.append(f"    void* cpp_{p.name}_ptr = env->GetPrimitiveArrayCritical({p.name}, nullptr);")
+                    lines.append(f"    auto* cpp_{p.name} = static_cast<{ptr_type}>(cpp_{p.name}_ptr);")
+                else:
+                    # Convert jbyteArray to uint8_t* (the VM may copy)
+                    lines.append(f"    jbyte* cpp_{p.name}_ptr = env->GetByteArrayElements({p.name}, nullptr);")
+                    lines.append(f"    auto* cpp_{p.name} = reinterpret_cast<{ptr_type}>(cpp_{p.name}_ptr);")
+                cpp_arg_names.append(f"cpp_{p.name}")
+            elif self._is_callback_type(p.type):
+                # Convert Java callback to C++ callback wrapper
+                cb = self._get_callback(p.type)
+                lines.extend(self._generate_jni_callback_wrapper(p, cb))
+                cpp_arg_names.append(f"cpp_{p.name}")
+            elif self._is_class_type(p.type):
+                # Class object parameter - convert jlong handle to C++ pointer
+                lines.append(f"    auto* cpp_{p.name} = jlongToPtr<{self.namespace}::{p.type}>({p.name});")
+                if p.is_reference:
+                    # Reference parameter - dereference
+                    cpp_arg_names.append(f"*cpp_{p.name}")
+                else:
+                    # Pointer parameter
+                    cpp_arg_names.append(f"cpp_{p.name}")
+            elif self._is_enum_type(p.type):
+                # Enum parameter - cast jint to enum type
+                cpp_arg_names.append(f"static_cast<::{p.type}>({p.name})")
+            elif self._is_struct_type(p.type):
+                # Convert Java object to C++ struct
+                # Structs are defined at global scope in C API header (not in namespace)
+                struct = self._get_struct(p.type)
+                ids = f"g_jni.{self._cache_member(p.type)}"
+                lines.append(f"    ::{p.type} cpp_{p.name};")  # Use global scope
+                for m in struct.members:
+                    getter = self._jni_field_getter(m.type)
+                    lines.append(f"    cpp_{p.name}.{m.name} = env->{getter}({p.name}, {ids}.{m.name}_fid);")
+                # Pass pointer or reference based on parameter type
+                if p.is_pointer:
+                    cpp_arg_names.append(f"&cpp_{p.name}")
+                else:
+                    cpp_arg_names.append(f"cpp_{p.name}")
+            else:
+                cpp_arg_names.append(p.name)
+        return lines, cpp_arg_names
+
+    def _jni_release_params(self, method: Method, byte_mode: str = "array") -> list[str]:
+        """Release pinned byte arrays after the C++ call.
+        Const data is released with JNI_ABORT (no copy back); mutable data is committed with 0."""
+        lines = []
+        for p in reversed(method.params):
+            if not self._is_byte_pointer(p) or byte_mode == "direct":
+                continue
+            release_mode = "JNI_ABORT" if p.is_const else "0"
+            if byte_mode == "critical":
+                lines.append(f"    env->ReleasePrimitiveArrayCritical({p.name}, cpp_{p.name}_ptr, {release_mode});")
+            else:
+                lines.append(f"    env->ReleaseByteArrayElements({p.name}, cpp_{p.name}_ptr, {release_mode});")
+        return lines
+
     def _jni_class_name(self, class_name: str) -> str:
         """Convert to JNI class name format.
         
@@ -625,7 +2076,7 @@ class JNIGenerator:
         escaped_class = class_name.replace("_", "_1")
         return f"Java_{pkg}_{escaped_class}"
 
-    def _param_to_java(self, param: Param) -> str:
+    def _param_to_java(self, param: Param, byte_mode: str = "array") -> str:
         """Convert param to Java declaration"""
         # Callbacks use their interface type
         if self._is_callback_type(param.type):
@@ -637,11 +2088,11 @@ class JNIGenerator:
         if self._is_enum_type(param.type):
             return f"int {param.name}"
         java_type = self._idl_to_java_type(param.type)
-        if param.is_pointer and param.type == "uint8_t":
-            java_type = "byte[]"
+        if self._is_byte_pointer(param):
+            java_type = "java.nio.ByteBuffer" if byte_mode == "direct" else "byte[]"
         return f"{java_type} {param.name}"
 
-    def _param_to_jni_type(self, param: Param) -> str:
+    def _param_to_jni_type(self, param: Param, byte_mode: str = "array") -> str:
         """Convert param to JNI type"""
         if param.type == "string":
             return "jstring"
@@ -653,8 +2104,8 @@ class JNIGenerator:
             return "jdouble"
         if param.type == "float":
             return "jfloat"
-        if param.is_pointer and param.type == "uint8_t":
-            return "jbyteArray"
+        if self._is_byte_pointer(param):
+            return "jobject" if byte_mode == "direct" else "jbyteArray"
         # Check if it's a callback type
         if self._is_callback_type(param.type):
             return "jobject"
@@ -665,7 +2116,7 @@ class JNIGenerator:
         if self._is_enum_type(param.type):
             return "jint"
         # Check if it's a struct type
-        if any(s.name == param.type for s in self.idl.structs):
+        if param.type in self.idl.symbols.structs:
             return "jobject"
         return "jint"
 
@@ -717,13 +2168,13 @@ class JNIGenerator:
         if idl_type == "float":
             return "jfloat"
         # Check if it's an enum type - use jint
-        if any(e.name == base_type for e in self.idl.enums):
+        if base_type in self.idl.symbols.enums:
             return "jint"
         # Check if it's a class type - use jlong handle
-        if any(c.name == base_type for c in self.idl.classes):
+        if base_type in self.idl.symbols.classes:
             return "jlong"
         # Check if it's a struct type
-        if any(s.name == base_type for s in self.idl.structs):
+        if base_type in self.idl.symbols.structs:
             # Struct pointer returns jlong, struct value returns jobject
             return "jlong" if is_pointer else "jobject"
         return "jint"
@@ -739,6 +2190,16 @@ class JNIGenerator:
         }
         return mapping.get(idl_type, "I")
 
+    def _jni_field_setter(self, idl_type: str) -> str:
+        """Get JNI field setter method name for a type"""
+        mapping = {
+            "int": "SetIntField",
+            "bool": "SetBooleanField",
+            "float": "SetFloatField",
+            "double": "SetDoubleField",
+        }
+        return mapping.get(idl_type, "SetIntField")
+
     def _jni_field_getter(self, idl_type: str) -> str:
         """Get JNI field getter method name for a type"""
         mapping = {
@@ -1,152 +1,361 @@
-"""C++-like IDL parser"""
+"""C++-like IDL parser: one tokenizing pass, then recursive descent over the tokens"""
 
 import re
+from pathlib import Path
+from typing import Callable, Optional
 from .types import Param, Member, Method, Class, Struct, Callback, Enum, EnumValue, ParsedIDL
 
 
+class IDLSyntaxError(ValueError):
+    """Parse error pointing at file:line:column"""
+
+    def __init__(self, message: str, filename: str, line: int, column: int):
+        super().__init__(f"{filename}:{line}:{column}: {message}")
+        self.filename = filename
+        self.line = line
+        self.column = column
+
+
+# Whitespace and comments, then one token: an identifier, a number, a string, a
+# two-character operator or any other single character (rejected by the parser)
+_TOKEN_RE = re.compile(r"""
+    \s*(?:(?://[^\n]*|/\*.*?\*/)\s*)*
+    ([A-Za-z_]\w*|-?(?:0[xX][0-9a-fA-F]+|\d+)|"[^"\n]*"|->|::|\S)
+""", re.VERBOSE | re.DOTALL)
+
+# End-of-input sentinel; never equal to a real token
+_EOF = ""
+
+
+def tokenize(content: str) -> list[str]:
+    """Token texts of content, in one regex pass; positions are recovered only when needed"""
+    tokens = _TOKEN_RE.findall(content)
+    tokens.append(_EOF)
+    return tokens
+
+
+def token_offsets(content: str) -> list[int]:
+    """Start offset of every token returned by tokenize(), plus the end of content"""
+    offsets = [m.start(1) for m in _TOKEN_RE.finditer(content)]
+    offsets.append(len(content))
+    return offsets
+
+
 class IDLParser:
-    """Parses C++-like IDL syntax"""
-
-    def __init__(self, content: str):
-        self.content = self._strip_comments(content)
-
-    def _strip_comments(self, content: str) -> str:
-        content = re.sub(r'//.*$', '', content, flags=re.MULTILINE)
-        content = re.sub(r'/\*.*?\*/', '', content, flags=re.DOTALL)
-        return content
-
-    def parse(self) -> ParsedIDL:
-        result = ParsedIDL()
-        result.enums = self._parse_enums()
-        result.structs = self._parse_structs()
-        result.callbacks = self._parse_callbacks()
-        result.classes = self._parse_classes()
+    """Parses C++-like IDL syntax.
+
+    parse() returns the file's declarations preceded by those of everything it imports,
+    each imported file included once. parse_unit() returns only the file's own
+    declarations, with the resolved import paths in ParsedIDL.imports."""
+
+    def __init__(self, content: str, filename: str = "<idl>"):
+        self.content = content
+        self.filename = filename
+        self._tokens: list[str] = []
+        self._pos = 0
+        # (declaration, token index) pairs whose location is filled in after parsing
+        self._located: list = []
+
+    def parse(self, load_unit: Optional[Callable[[Path], ParsedIDL]] = None) -> ParsedIDL:
+        """load_unit(path) returns an imported file's parse_unit() result; defaults to parsing it"""
+        unit = self.parse_unit()
+        if not unit.imports:
+            return unit
+        return link_units(unit, load_unit or _parse_unit_file)
+
+    def parse_unit(self) -> ParsedIDL:
+        self._tokens = tokenize(self.content)
+        self._pos = 0
+        self._located = []
+        result = ParsedIDL(source=self._source())
+        tokens = self._tokens
+        while tokens[self._pos] != _EOF:
+            tok = tokens[self._pos]
+            if tok == ";":
+                self._pos += 1
+            elif tok == "import":
+                result.imports.append(self._parse_import())
+            elif tok == "namespace":
+                # The generated namespace comes from --namespace; the declaration is informational
+                self._pos += 1
+                self._expect_ident()
+                self._expect(";")
+            elif tok == "enum":
+                result.enums.append(self._parse_enum())
+            elif tok == "struct":
+                result.structs.append(self._parse_struct())
+            elif tok == "callback":
+                result.callbacks.append(self._parse_callback())
+            elif tok == "class":
+                result.classes.append(self._parse_class())
+            else:
+                self._error("expected a declaration")
+        self._resolve_locations()
+        check_duplicates(result)
         return result
 
-    def _parse_enums(self) -> list[Enum]:
-        """Parse enum declarations like: enum Color { Red, Green = 5, Blue };"""
-        enums = []
-        pattern = r'enum\s+(\w+)\s*\{([^}]*)\}'
-        for match in re.finditer(pattern, self.content):
-            name, body = match.groups()
-            values = []
-            current_value = 0
-            for item in body.split(','):
-                item = item.strip()
-                if not item:
-                    continue
-                # Check for explicit value: Name = value
-                if '=' in item:
-                    parts = item.split('=')
-                    val_name = parts[0].strip()
-                    val_value = int(parts[1].strip())
-                    values.append(EnumValue(name=val_name, value=val_value))
-                    current_value = val_value + 1
-                else:
-                    values.append(EnumValue(name=item, value=current_value))
-                    current_value += 1
-            enums.append(Enum(name=name, values=values))
-        return enums
-
-    def _parse_structs(self) -> list[Struct]:
-        structs = []
-        pattern = r'struct\s+(\w+)\s*\{([^}]*)\}'
-        for match in re.finditer(pattern, self.content):
-            name, body = match.groups()
-            members = []
-            for m in re.finditer(r'(\w+)\s+(\w+)\s*;', body):
-                members.append(Member(name=m.group(2), type=m.group(1)))
-            structs.append(Struct(name=name, members=members))
-        return structs
-
-    def _parse_callbacks(self) -> list[Callback]:
-        """Parse callback declarations like: callback ProgressCallback(int current, int total) -> void;"""
-        callbacks = []
-        # Match: callback Name(params) -> returnType;
-        pattern = r'callback\s+(\w+)\s*\(([^)]*)\)\s*->\s*(\w+)\s*;'
-        for match in re.finditer(pattern, self.content):
-            name = match.group(1)
-            params_str = match.group(2)
-            return_type = match.group(3)
-            params = self._parse_params(params_str)
-            callbacks.append(Callback(name=name, return_type=return_type, params=params))
-        return callbacks
-
-    def _parse_classes(self) -> list[Class]:
-        classes = []
-        pattern = r'class\s+(\w+)\s*\{([^}]*)\}'
-        for match in re.finditer(pattern, self.content):
-            name, body = match.groups()
-            cls = Class(name=name)
-            self._parse_class_body(body, cls)
-            classes.append(cls)
-        return classes
-
-    def _parse_class_body(self, body: str, cls: Class):
-        for line in body.strip().split(';'):
-            line = line.strip()
-            if not line:
-                continue
+    # ── Declarations ────────────────────────────────────────────────
+
+    def _parse_import(self) -> str:
+        """import "other.idl"; - resolved against the importing file's directory"""
+        self._pos += 1
+        tok = self._tokens[self._pos]
+        if not tok.startswith('"'):
+            self._error("expected a quoted file name")
+        path = (Path(self._source()).parent / tok[1:-1]).resolve()
+        if not path.is_file():
+            self._error(f"imported file not found: {path}")
+        self._pos += 1
+        self._expect(";")
+        return str(path)
+
+    def _parse_enum(self) -> Enum:
+        """enum Color { Red, Green = 5, Blue };"""
+        enum = Enum(name="")
+        self._locate(enum)
+        self._pos += 1
+        enum.name = self._expect_ident()
+        self._expect("{")
+        current_value = 0
+        while not self._accept("}"):
+            val_name = self._expect_ident()
+            if self._accept("="):
+                tok = self._tokens[self._pos]
+                try:
+                    current_value = int(tok, 0)
+                except ValueError:
+                    self._error("expected an integer")
+                self._pos += 1
+            enum.values.append(EnumValue(name=val_name, value=current_value))
+            current_value += 1
+            if not self._accept(","):
+                self._expect("}")
+                break
+        return enum
+
+    def _parse_struct(self) -> Struct:
+        """struct Point { int x; int y; };"""
+        struct = Struct(name="")
+        self._locate(struct)
+        self._pos += 1
+        struct.name = self._expect_ident()
+        self._expect("{")
+        while not self._accept("}"):
+            member_type = self._parse_type()
+            struct.members.append(Member(name=self._expect_ident(), type=member_type))
+            self._expect(";")
+        return struct
+
+    def _parse_callback(self) -> Callback:
+        """callback ProgressCallback(int current, int total) [-> void] [attributes];"""
+        cb = Callback(name="", return_type="void")
+        self._locate(cb)
+        self._pos += 1
+        cb.name = self._expect_ident()
+        cb.params = self._parse_params()
+        if self._accept("->"):
+            cb.return_type = self._parse_type()
+        cb.attributes = self._parse_attributes()
+        self._expect(";")
+        return cb
+
+    def _parse_class(self) -> Class:
+        cls = Class(name="")
+        self._locate(cls)
+        self._pos += 1
+        cls.name = self._expect_ident()
+        self._expect("{")
+        while not self._accept("}"):
+            if not self._accept(";"):
+                cls.methods.append(self._parse_method(cls))
+        return cls
+
+    def _parse_method(self, cls: Class) -> Method:
+        """[attributes] ClassName(params); or [attributes] type name(params) [const];"""
+        attributes = self._parse_attributes() if self._tokens[self._pos] == "[" else []
+        tokens = self._tokens
+        if tokens[self._pos] == cls.name and tokens[self._pos + 1] == "(":
+            method = Method(name="constructor", return_type="void", is_constructor=True)
+            self._locate(method)
+            self._pos += 1
+            method.params = self._parse_params()
+            self._expect(";")
+            return method
+        return_type = self._parse_type()
+        method = Method(name="", return_type=return_type, attributes=attributes)
+        self._locate(method)
+        method.name = self._expect_ident()
+        method.params = self._parse_params()
+        method.is_const = self._accept("const")
+        self._expect(";")
+        return method
 
-            # Check for constructor: ClassName(params)
-            if m := re.match(rf'{cls.name}\s*\(([^)]*)\)', line):
-                params = self._parse_params(m.group(1))
-                cls.methods.append(Method(
-                    name="constructor",
-                    return_type="void",
-                    params=params,
-                    is_constructor=True
-                ))
-            # Check for method: type name(params) [const]
-            elif m := re.match(r'(.+?)\s+(\w+)\s*\(([^)]*)\)\s*(const)?', line):
-                return_type = m.group(1).strip()
-                method_name = m.group(2)
-                params = self._parse_params(m.group(3))
-                is_const = m.group(4) is not None
-                cls.methods.append(Method(
-                    name=method_name,
-                    return_type=return_type,
-                    params=params,
-                    is_const=is_const
-                ))
-
-    def _parse_params(self, params_str: str) -> list[Param]:
+    def _parse_attributes(self) -> list[str]:
+        """Zero or more [a, b] lists, concatenated"""
+        attributes = []
+        while self._accept("["):
+            while not self._accept("]"):
+                attributes.append(self._expect_ident())
+                if not self._accept(","):
+                    self._expect("]")
+                    break
+        return attributes
+
+    def _parse_params(self) -> list[Param]:
+        self._expect("(")
         params = []
-        if not params_str.strip():
+        tokens = self._tokens
+        if tokens[self._pos] == ")":
+            self._pos += 1
             return params
-            
-        for p in params_str.split(','):
-            p = p.strip()
-            if not p:
+        while True:
+            is_const = self._accept("const")
+            base = self._parse_type_name()
+            is_pointer = is_reference = False
+            while True:
+                tok = tokens[self._pos]
+                if tok == "*":
+                    is_pointer = True
+                elif tok == "&":
+                    is_reference = True
+                else:
+                    break
+                self._pos += 1
+            params.append(Param(type=base, name=self._expect_ident(), is_const=is_const,
+                                is_pointer=is_pointer, is_reference=is_reference))
+            tok = tokens[self._pos]
+            self._pos += 1
+            if tok == ")":
+                return params
+            if tok != ",":
+                self._pos -= 1
+                self._error("expected ',' or ')'")
+
+    def _parse_type(self) -> str:
+        """[const] name[<args>] followed by any * or &, as normalized text such as "vector<Point>" """
+        prefix = "const " if self._accept("const") else ""
+        text = self._parse_type_name()
+        tokens = self._tokens
+        while tokens[self._pos] in ("*", "&"):
+            text += tokens[self._pos]
+            self._pos += 1
+        return prefix + text
+
+    def _parse_type_name(self) -> str:
+        text = self._expect_ident("a type")
+        tokens = self._tokens
+        while tokens[self._pos] == "::":
+            self._pos += 1
+            text += "::" + self._expect_ident("a type")
+        if tokens[self._pos] == "<":
+            self._pos += 1
+            args = [self._parse_type()]
+            while self._accept(","):
+                args.append(self._parse_type())
+            self._expect(">")
+            text += f"<{', '.join(args)}>"
+        return text
+
+    # ── Token helpers ───────────────────────────────────────────────
+
+    def _accept(self, tok: str) -> bool:
+        if self._tokens[self._pos] == tok:
+            self._pos += 1
+            return True
+        return False
+
+    def _expect(self, tok: str):
+        if self._tokens[self._pos] != tok:
+            self._error(f"expected '{tok}'")
+        self._pos += 1
+
+    def _expect_ident(self, what: str = "a name") -> str:
+        tok = self._tokens[self._pos]
+        if not tok.isidentifier():
+            self._error(f"expected {what}")
+        self._pos += 1
+        return tok
+
+    def _source(self) -> str:
+        """Resolved path of the file; an in-memory IDL resolves its imports against the cwd"""
+        return str(Path(self.filename).resolve()) if self.filename != "<idl>" else str(Path.cwd() / "<idl>")
+
+    def _locate(self, decl):
+        """Record that decl starts at the current token"""
+        self._located.append((decl, self._pos))
+
+    def _line_columns(self, indices: list[int]) -> list[tuple[int, int]]:
+        """1-based (line, column) of the given ascending token indices, from one scan of the content"""
+        offsets = token_offsets(self.content)
+        result = []
+        line, line_start, scanned = 1, 0, 0
+        for index in indices:
+            offset = offsets[min(index, len(offsets) - 1)]
+            newlines = self.content.count("\n", scanned, offset)
+            if newlines:
+                line += newlines
+                line_start = self.content.rindex("\n", scanned, offset) + 1
+            scanned = offset
+            result.append((line, offset - line_start + 1))
+        return result
+
+    def _resolve_locations(self):
+        if not self._located:
+            return
+        positions = self._line_columns([index for _, index in self._located])
+        for (decl, _), (line, column) in zip(self._located, positions):
+            decl.location = f"{self.filename}:{line}:{column}"
+        self._located = []
+
+    def _error(self, message: str):
+        """Raise at the current token"""
+        tok = self._tokens[self._pos]
+        found = "end of file" if tok == _EOF else f"'{tok}'"
+        if tok == "/" and self._tokens[self._pos + 1] == "*":
+            message, found = "unterminated comment", ""
+        line, column = self._line_columns([self._pos])[0]
+        raise IDLSyntaxError(f"{message}, found {found}" if found else message, self.filename, line, column)
+
+
+def check_duplicates(idl: ParsedIDL):
+    """Type names must be unique across enums, structs, callbacks and classes"""
+    seen = {}
+    for decl in [*idl.enums, *idl.structs, *idl.callbacks, *idl.classes]:
+        if decl.name in seen:
+            raise ValueError(f"{decl.location}: duplicate declaration of '{decl.name}' "
+                             f"(first declared at {seen[decl.name]})")
+        seen[decl.name] = decl.location
+
+
+def _parse_unit_file(path: Path) -> ParsedIDL:
+    return IDLParser(path.read_text(), str(path)).parse_unit()
+
+
+def link_units(root: ParsedIDL, load_unit: Callable[[Path], ParsedIDL]) -> ParsedIDL:
+    """Merge root with its imports, depth first so dependencies come first; each file once"""
+    result = ParsedIDL(source=root.source)
+    done: set[str] = set()
+    loaded: dict[str, ParsedIDL] = {}
+
+    def visit(unit: ParsedIDL, chain: list[str]):
+        for path in unit.imports:
+            if path in chain:
+                raise ValueError(f"import cycle: {' -> '.join(chain[chain.index(path):] + [path])}")
+            if path in done:
                 continue
-            
-            is_const = False
-            is_pointer = False
-            is_reference = False
-            
-            # Check for const
-            if p.startswith('const '):
-                is_const = True
-                p = p[6:].strip()
-            
-            # Check for pointer or reference
-            if '*' in p:
-                is_pointer = True
-                p = p.replace('*', ' ').strip()
-            elif '&' in p:
-                is_reference = True
-                p = p.replace('&', ' ').strip()
-            
-            # Split type and name
-            parts = p.rsplit(None, 1)
-            if len(parts) == 2:
-                param_type, param_name = parts
-                params.append(Param(
-                    type=param_type.strip(),
-                    name=param_name.strip(),
-                    is_const=is_const,
-                    is_pointer=is_pointer,
-                    is_reference=is_reference
-                ))
-        
-        return params
+            if path not in loaded:
+                try:
+                    loaded[path] = load_unit(Path(path))
+                except FileNotFoundError:
+                    raise ValueError(f"{chain[-1]}: imported file not found: {path}") from None
+            visit(loaded[path], chain + [path])
+            done.add(path)
+        result.enums.extend(unit.enums)
+        result.structs.extend(unit.structs)
+        result.callbacks.extend(unit.callbacks)
+        result.classes.extend(unit.classes)
+
+    visit(root, [root.source])
+    result.imports = sorted(done)
+    check_duplicates(result)
+    return result
@@ -0,0 +1,446 @@
+"""Python Extension Generator - generates a CPython extension module that calls the C API directly"""
+
+import re
+from typing import Optional
+from .types import ParsedIDL, Class, Method, Param, Callback
+from .type_mapper import TypeMapper
+
+
+class PythonExtGenerator:
+    """Generates the optional compiled backend (_<namespace>_ext) for the ctypes bindings"""
+
+    INTEGER_TYPES = {'int', 'int8_t', 'uint8_t', 'int16_t', 'uint16_t',
+                     'int32_t', 'uint32_t', 'int64_t', 'uint64_t', 'char'}
+    FLOAT_TYPES = {'float', 'double'}
+
+    def __init__(self, idl: ParsedIDL, namespace: str):
+        self.idl = idl
+        self.namespace = namespace
+        self.module_name = f"_{namespace}_ext"
+
+    def supports(self, method: Method) -> bool:
+        """Whether the extension exports this method; the ctypes path handles everything else"""
+        if method.is_constructor:
+            return False
+        if self._return_kind(method.return_type) is None:
+            return False
+        return all(self._param_kind(p) is not None for p in method.params)
+
+    def generate(self) -> str:
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// CPython extension {self.module_name}: compiled entry points for the {self.namespace} Python bindings",
+            "#define PY_SSIZE_T_CLEAN",
+            "#include <Python.h>",
+            "",
+            f'#include "{self.namespace}_c_api.h"',
+            "",
+            "#include <cstring>",
+            "",
+            "#if PY_VERSION_HEX < 0x03090000",
+            "#define PyObject_Vectorcall _PyObject_Vectorcall",
+            "#endif",
+            "",
+            "namespace {",
+            "",
+        ]
+        body = []
+        for cb in self._used_callbacks():
+            body.extend(self._trampoline(cb))
+        entries = []
+        for cls in self.idl.classes:
+            for method in cls.methods:
+                if self.supports(method):
+                    body.extend(self._method_impl(cls, method))
+                    entries.append(f"{cls.name}_{method.name}")
+        body.extend(self._module_def(entries))
+        lines.extend(self._used_helpers("\n".join(body)))
+        lines.extend(body)
+        return "\n".join(lines)
+
+    def _used_helpers(self, body: str) -> list[str]:
+        """The helpers body refers to: everything here is in an anonymous namespace, so an
+        unused one would warn. Each helper ends with a closing brace at column 0 and a blank
+        line, and is named by its first declaration."""
+        blocks, block = [], []
+        for line in self._helpers():
+            if not line and block and block[-1] in ("}", "};"):
+                blocks.append(block + [line])
+                block = []
+            else:
+                block.append(line)
+        lines = []
+        for block in blocks:
+            decl = next(l for l in block if l and not l.startswith("//"))
+            name = re.match(r"(?:struct|class) (\w+)|[\w:<>*& ]+?(\w+)\(", decl)
+            if re.search(rf"\b{name.group(1) or name.group(2)}\b", body):
+                lines.extend(block)
+        return lines
+
+    def _helpers(self) -> list[str]:
+        return [
+            "// A Python callable passed to the C API as a callback's user_data",
+            "struct CallbackState {",
+            "    PyObject* fn;",
+            "    bool gilReleased;  // the call runs without the GIL, so each invocation takes it",
+            "    bool failed;       // a Python exception is pending; later invocations are skipped",
+            "};",
+            "",
+            "class CallbackGil {",
+            "public:",
+            "    explicit CallbackGil(bool needed) : needed_(needed) {",
+            "        if (needed_) state_ = PyGILState_Ensure();",
+            "    }",
+            "    ~CallbackGil() {",
+            "        if (needed_) PyGILState_Release(state_);",
+            "    }",
+            "    CallbackGil(const CallbackGil&) = delete;",
+            "    CallbackGil& operator=(const CallbackGil&) = delete;",
+            "private:",
+            "    bool needed_;",
+            "    PyGILState_STATE state_{};",
+            "};",
+            "",
+            "// Calls the callable with new references in args (released here); null marks the state failed",
+            "PyObject* invoke(CallbackState* state, PyObject** args, size_t nargs) {",
+            "    PyObject* result = nullptr;",
+            "    bool converted = true;",
+            "    for (size_t i = 0; i < nargs; ++i) converted = converted && args[i] != nullptr;",
+            "    if (converted) result = PyObject_Vectorcall(state->fn, args, nargs, nullptr);",
+            "    for (size_t i = 0; i < nargs; ++i) Py_XDECREF(args[i]);",
+            "    if (!result) state->failed = true;",
+            "    return result;",
+            "}",
+            "",
+            "bool checkArgs(const char* name, Py_ssize_t nargs, Py_ssize_t expected) {",
+            "    if (nargs == expected) return true;",
+            '    PyErr_Format(PyExc_TypeError, "%s() takes %zd arguments (%zd given)", name, expected, nargs);',
+            "    return false;",
+            "}",
+            "",
+            "bool argHandle(PyObject* obj, void** out) {",
+            "    *out = obj == Py_None ? nullptr : PyLong_AsVoidPtr(obj);",
+            "    return !PyErr_Occurred();",
+            "}",
+            "",
+            "bool argLong(PyObject* obj, long long* out) {",
+            "    *out = PyLong_AsLongLong(obj);",
+            "    return !(*out == -1 && PyErr_Occurred());",
+            "}",
+            "",
+            "bool argULong(PyObject* obj, unsigned long long* out) {",
+            "    *out = PyLong_AsUnsignedLongLongMask(obj);",
+            "    return !(*out == static_cast<unsigned long long>(-1) && PyErr_Occurred());",
+            "}",
+            "",
+            "bool argTruth(PyObject* obj, int* out) {",
+            "    *out = PyObject_IsTrue(obj);",
+            "    return *out >= 0;",
+            "}",
+            "",
+            "bool argDouble(PyObject* obj, double* out) {",
+            "    *out = PyFloat_AsDouble(obj);",
+            "    return !(*out == -1.0 && PyErr_Occurred());",
+            "}",
+            "",
+            "bool argString(PyObject* obj, const char** out) {",
+            "    *out = PyUnicode_AsUTF8(obj);",
+            "    return *out != nullptr;",
+            "}",
+            "",
+            "bool argCallable(PyObject* obj) {",
+            "    if (PyCallable_Check(obj)) return true;",
+            '    PyErr_SetString(PyExc_TypeError, "callback argument must be callable");',
+            "    return false;",
+            "}",
+            "",
+            "// Borrowed view of a buffer-protocol argument (bytes, bytearray, memoryview, numpy, ctypes)",
+            "class BufferArg {",
+            "public:",
+            "    BufferArg() { view_.obj = nullptr; }",
+            "    ~BufferArg() {",
+            "        if (view_.obj) PyBuffer_Release(&view_);",
+            "    }",
+            "    BufferArg(const BufferArg&) = delete;",
+            "    BufferArg& operator=(const BufferArg&) = delete;",
+            "",
+            "    // size < 0 accepts any length and None; otherwise the buffer must hold exactly size bytes",
+            "    bool acquire(PyObject* obj, bool writable, Py_ssize_t size) {",
+            "        if (obj == Py_None && size < 0) return true;",
+            "        int flags = PyBUF_C_CONTIGUOUS | (writable ? PyBUF_WRITABLE : 0);",
+            "        if (PyObject_GetBuffer(obj, &view_, flags) != 0) return false;",
+            "        if (size >= 0 && view_.len != size) {",
+            '            PyErr_Format(PyExc_ValueError, "expected a %zd-byte struct buffer, got %zd bytes", size, view_.len);',
+            "            return false;",
+            "        }",
+            "        return true;",
+            "    }",
+            "",
+            "    void* data() const { return view_.obj ? view_.buf : nullptr; }",
+            "",
+            "    template <typename T>",
+            "    T value() const {",
+            "        T v;",
+            "        std::memcpy(&v, view_.buf, sizeof(T));",
+            "        return v;",
+            "    }",
+            "",
+            "private:",
+            "    Py_buffer view_;",
+            "};",
+            "",
+        ]
+
+    def _used_callbacks(self) -> list[Callback]:
+        names = {p.type for cls in self.idl.classes for m in cls.methods if self.supports(m)
+                 for p in m.params if self._is_callback_type(p.type)}
+        return [cb for cb in self.idl.callbacks if cb.name in names]
+
+    def _batch_trampoline(self, cb: Callback) -> list[str]:
+        """[batch] callbacks: the callable runs per element with the GIL held across the batch"""
+        params = [f"const {self._batch_element_type(p.type)}* {p.name}" for p in cb.params]
+        has_result = cb.return_type != "void"
+        if has_result:
+            params.append(f"{self._batch_element_type(cb.return_type)}* result")
+        params += ["int count", "void* user_data"]
+        args = [self._to_python(p.type, f"{p.name}[i]") for p in cb.params]
+        lines = [
+            f"void call_{cb.name}({', '.join(params)}) {{",
+            "    auto* state = static_cast<CallbackState*>(user_data);",
+            "    CallbackGil gil(state->gilReleased);",
+            "    int i = 0;",
+            "    for (; i < count && !state->failed; ++i) {",
+            f"        PyObject* args[] = {{{', '.join(args)}}};",
+            f"        PyObject* out = invoke(state, args, {len(args)});",
+        ]
+        if has_result:
+            temp, helper = self._arg_helper(cb.return_type)
+            lines.extend([
+                "        if (!out) break;",
+                f"        {temp} converted;",
+                f"        bool ok = {helper}(out, &converted);",
+                "        Py_DECREF(out);",
+                "        if (!ok) {",
+                "            state->failed = true;",
+                "            break;",
+                "        }",
+                f"        result[i] = static_cast<{self._batch_element_type(cb.return_type)}>(converted);",
+                "    }",
+                "    // Elements after a Python exception are left zeroed",
+                "    for (; i < count; ++i) result[i] = {};",
+            ])
+        else:
+            lines.extend([
+                "        Py_XDECREF(out);",
+                "    }",
+            ])
+        lines.extend(["}", ""])
+        return lines
+
+    def _trampoline(self, cb: Callback) -> list[str]:
+        if cb.has_attribute("batch"):
+            return self._batch_trampoline(cb)
+        ret = TypeMapper.to_c(cb.return_type)
+        params = [f"{TypeMapper.to_c(p.type)} {p.name}" for p in cb.params] + ["void* user_data"]
+        lines = [
+            f"{ret} call_{cb.name}({', '.join(params)}) {{",
+            "    auto* state = static_cast<CallbackState*>(user_data);",
+            "    CallbackGil gil(state->gilReleased);",
+        ]
+        default = "" if cb.return_type == "void" else f"{ret}{{}}"
+        lines.append(f"    if (state->failed) return{' ' + default if default else ''};")
+        args = [self._to_python(p.type, p.name) for p in cb.params]
+        if args:
+            lines.append(f"    PyObject* args[] = {{{', '.join(args)}}};")
+            lines.append(f"    PyObject* result = invoke(state, args, {len(args)});")
+        else:
+            lines.append("    PyObject* result = invoke(state, nullptr, 0);")
+        if cb.return_type == "void":
+            lines.append("    Py_XDECREF(result);")
+        else:
+            temp, helper = self._arg_helper(cb.return_type)
+            lines.extend([
+                f"    if (!result) return {default};",
+                f"    {temp} ret;",
+                f"    bool ok = {helper}(result, &ret);",
+                "    Py_DECREF(result);",
+                "    if (!ok) {",
+                "        state->failed = true;",
+                f"        return {default};",
+                "    }",
+                f"    return static_cast<{ret}>(ret);",
+            ])
+        lines.extend(["}", ""])
+        return lines
+
+    def _method_impl(self, cls: Class, method: Method) -> list[str]:
+        name = f"{cls.name}_{method.name}"
+        nogil = method.has_attribute("nogil")
+        lines = [
+            f"PyObject* py_{name}(PyObject*, PyObject* const* args, Py_ssize_t nargs) {{",
+            f'    if (!checkArgs("{name}", nargs, {len(method.params) + 1})) return nullptr;',
+            "    void* handle;",
+        ]
+        checks = ["argHandle(args[0], &handle)"]
+        call_args = [f"static_cast<{cls.name}Handle*>(handle)"]
+        states = []
+        for i, p in enumerate(method.params, start=1):
+            kind = self._param_kind(p)
+            arg = f"args[{i}]"
+            if kind == "callback":
+                checks.append(f"argCallable({arg})")
+                states.append(f"    CallbackState {p.name}{{{arg}, {'true' if nogil else 'false'}, false}};")
+                call_args.extend([f"call_{p.type}", f"&{p.name}"])
+            elif kind in ("buffer", "struct", "struct_ptr"):
+                writable = "true" if kind != "struct" and not p.is_const else "false"
+                size = f"sizeof({p.type})" if kind != "buffer" else "-1"
+                lines.append(f"    BufferArg {p.name};")
+                checks.append(f"{p.name}.acquire({arg}, {writable}, {size})")
+                c_type = TypeMapper.to_c(p.type)
+                if kind == "struct":
+                    call_args.append(f"{p.name}.value<{c_type}>()")
+                else:
+                    const = "const " if p.is_const else ""
+                    call_args.append(f"static_cast<{const}{c_type}*>({p.name}.data())")
+            else:
+                temp, helper = self._arg_helper(p.type)
+                lines.append(f"    {temp} {p.name};")
+                checks.append(f"{helper}({arg}, &{p.name})")
+                call_args.append(p.name if kind == "string" else f"static_cast<{TypeMapper.to_c(p.type)}>({p.name})")
+        lines.append(f"    if (!{' || !'.join(checks)}) return nullptr;")
+        lines.extend(states)
+
+        call = f"::{name}({', '.join(call_args)})"
+        has_result = method.return_type != "void"
+        result_type = TypeMapper.to_c(method.return_type)
+        if nogil:
+            if has_result:
+                lines.append(f"    {result_type} result;")
+                call = f"result = {call}"
+            lines.append("    Py_BEGIN_ALLOW_THREADS")
+            lines.append(f"    {call};")
+            lines.append("    Py_END_ALLOW_THREADS")
+        elif has_result:
+            lines.append(f"    {result_type} result = {call};")
+        else:
+            lines.append(f"    {call};")
+        for p in method.params:
+            if self._is_callback_type(p.type):
+                lines.append(f"    if ({p.name}.failed) return nullptr;")
+        if has_result:
+            lines.append(f"    return {self._to_python(method.return_type, 'result')};")
+        else:
+            lines.append("    Py_RETURN_NONE;")
+        lines.extend(["}", ""])
+        return lines
+
+    def _module_def(self, entries: list[str]) -> list[str]:
+        lines = ["PyMethodDef methods[] = {"]
+        for name in entries:
+            lines.append(f'    {{"{name}", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(py_{name})), '
+                         "METH_FASTCALL, nullptr},")
+        lines.extend([
+            "    {nullptr, nullptr, 0, nullptr},",
+            "};",
+            "",
+            "PyModuleDef moduleDef = {",
+            "    PyModuleDef_HEAD_INIT,",
+            f'    "{self.module_name}",',
+            f'    "Compiled entry points for the {self.namespace} Python bindings",',
+            "    -1,",
+            "    methods,",
+            "    nullptr,  // m_slots",
+            "    nullptr,  // m_traverse",
+            "    nullptr,  // m_clear",
+            "    nullptr,  // m_free",
+            "};",
+            "",
+            "} // namespace",
+            "",
+            f"PyMODINIT_FUNC PyInit_{self.module_name}(void) {{",
+            "    return PyModule_Create(&moduleDef);",
+            "}",
+            "",
+        ])
+        return lines
+
+    def _param_kind(self, param: Param) -> Optional[str]:
+        """How a parameter crosses from Python; None if the extension does not handle it"""
+        if self._is_callback_type(param.type):
+            cb = self._get_callback_def(param.type)
+            ok = (all(self._scalar_kind(p.type) and not (p.is_pointer or p.is_reference) for p in cb.params)
+                  and (cb.return_type == "void" or self._scalar_kind(cb.return_type)))
+            return "callback" if ok else None
+        if self._is_struct_type(param.type):
+            return "struct_ptr" if param.is_pointer else "struct"
+        if param.type == "string":
+            return None if param.is_pointer else "string"
+        if param.is_pointer:
+            return "buffer" if param.type in self.INTEGER_TYPES else None
+        if param.is_reference and not param.is_const:
+            return None
+        return self._scalar_kind(param.type)
+
+    def _return_kind(self, idl_type: str) -> Optional[str]:
+        if idl_type in ("void", "string"):
+            return idl_type
+        return self._scalar_kind(idl_type)
+
+    def _scalar_kind(self, idl_type: str) -> Optional[str]:
+        if idl_type == "bool":
+            return "bool"
+        if idl_type in self.INTEGER_TYPES:
+            return "integer"
+        if idl_type in self.FLOAT_TYPES:
+            return "float"
+        if self._is_enum_type(idl_type):
+            return "enum"
+        return None
+
+    def _arg_helper(self, idl_type: str) -> tuple[str, str]:
+        """(temporary type, converter) for a Python object to C value"""
+        if idl_type == "string":
+            return "const char*", "argString"
+        kind = self._scalar_kind(idl_type)
+        if kind == "bool":
+            return "int", "argTruth"
+        if kind == "float":
+            return "double", "argDouble"
+        if idl_type.startswith("uint"):
+            return "unsigned long long", "argULong"
+        return "long long", "argLong"
+
+    def _batch_element_type(self, idl_type: str) -> str:
+        """Element type of [batch] callback arrays - matches the C API, so bool is int"""
+        if idl_type == "bool":
+            return "int"
+        return TypeMapper.to_c(idl_type)
+
+    def _to_python(self, idl_type: str, expr: str) -> str:
+        """New reference for a C value"""
+        if idl_type == "string":
+            return f'PyUnicode_FromString({expr} ? {expr} : "")'
+        kind = self._scalar_kind(idl_type)
+        if kind == "bool":
+            return f"PyBool_FromLong({expr})"
+        if kind == "float":
+            return f"PyFloat_FromDouble({expr})"
+        if idl_type.startswith("uint"):
+            return f"PyLong_FromUnsignedLongLong({expr})"
+        return f"PyLong_FromLongLong({expr})"
+
+    def _is_callback_type(self, type_name: str) -> bool:
+        """Check if type is a callback"""
+        return type_name in self.idl.symbols.callbacks
+
+    def _is_struct_type(self, type_name: str) -> bool:
+        """Check if type is a struct"""
+        return type_name in self.idl.symbols.structs
+
+    def _is_enum_type(self, type_name: str) -> bool:
+        """Check if type is an enum"""
+        return type_name in self.idl.symbols.enums
+
+    def _get_callback_def(self, type_name: str) -> Optional[Callback]:
+        """Get callback definition by name"""
+        return self.idl.symbols.callbacks.get(type_name)
@@ -4,14 +4,18 @@ from typing import Optional
 from pathlib import Path
 from .types import ParsedIDL, Class, Method, Member, Param, Struct, Callback
 from .type_mapper import TypeMapper
+from .python_ext_generator import PythonExtGenerator
+from .c_api_generator import CAPIGenerator
 
 
 class PythonGenerator:
     """Generates Python bindings using ctypes"""
 
-    def __init__(self, idl: ParsedIDL, namespace: str):
+    def __init__(self, idl: ParsedIDL, namespace: str, extension: bool = False):
         self.idl = idl
         self.namespace = namespace
+        # Route supported methods through the compiled _<namespace>_ext module when it loads
+        self.ext = PythonExtGenerator(idl, namespace) if extension else None
 
     def generate(self) -> str:
         """Generate complete Python module"""
@@ -21,16 +25,24 @@ class PythonGenerator:
             "DO NOT EDIT - Generated from IDL",
             '"""',
             "",
+            *(["import concurrent.futures"] if self._has_async() else []),
             "import ctypes",
+            *(["import importlib.machinery", "import importlib.util"] if self.ext else []),
+            *(["import itertools"] if self._has_async() else []),
             "import os",
             "import sys",
+            "import weakref",
             "from ctypes import (",
             "    POINTER, Structure, CFUNCTYPE,",
             "    c_void_p, c_int, c_double, c_float, c_char_p,",
             "    c_int8, c_uint8, c_int16, c_uint16,",
             "    c_int32, c_uint32, c_int64, c_uint64,",
             ")",
-            "from typing import Callable, List, Optional",
+            "from enum import IntEnum",
+            "from typing import Callable, Iterator, List, Optional, Sequence, Union",
+            "",
+            "# Anything exposing a C-contiguous buffer: bytes, bytearray, memoryview, numpy arrays",
+            "_BufferLike = Union[bytes, bytearray, memoryview, ctypes.Array]",
             "",
             "",
             "# ══════════════════════════════════════════════════════════════",
@@ -70,6 +82,32 @@ class PythonGenerator:
             "",
             "_lib = _load_library()",
             "",
+            "",
+            *self._generate_extension_loader(),
+            "def _as_buffer(obj):",
+            '    """Pass a buffer-protocol object (bytes, bytearray, memoryview, numpy array,',
+            "    ctypes array) to a pointer parameter without copying it.",
+            "",
+            "    The returned object references the caller's memory, so it only has to",
+            "    live for the duration of the native call.",
+            '    """',
+            "    if obj is None or isinstance(obj, (bytes, ctypes.Array)):",
+            "        return obj",
+            "    iface = getattr(obj, '__array_interface__', None)",
+            "    if iface is not None:",
+            "        if iface.get('strides') is not None:",
+            '            raise ValueError("array argument must be C-contiguous")',
+            "        return iface['data'][0]",
+            "    view = memoryview(obj)",
+            "    if not view.c_contiguous:",
+            '        raise ValueError("buffer argument must be C-contiguous")',
+            "    if not view.readonly:",
+            "        return (c_uint8 * view.nbytes).from_buffer(view)",
+            "    if isinstance(view.obj, bytes) and view.nbytes == len(view.obj):",
+            "        return view.obj",
+            "    # ctypes cannot take the address of other read-only exporters",
+            "    return view.tobytes()",
+            "",
         ]
 
         # Generate enum definitions
@@ -87,12 +125,57 @@ class PythonGenerator:
         # Generate function declarations
         lines.extend(self._generate_function_decls())
 
+        # Per-thread last error of the C API
+        lines.extend(self._generate_errors())
+
+        # Live native object and byte counts
+        lines.extend(self._generate_native_memory())
+
+        # Column views for [soa] returns
+        lines.extend(self._generate_columns_classes())
+
+        # Completion callbacks for [async] methods
+        if self._has_async():
+            lines.extend(self._generate_async_completions())
+
         # Generate wrapper classes
         for cls in self.idl.classes:
             lines.extend(self._generate_class(cls))
 
         return "\n".join(lines)
 
+    def _generate_extension_loader(self) -> list[str]:
+        """Optional compiled backend; it sits next to the native library it links"""
+        if not self.ext:
+            return []
+        name = self.ext.module_name
+        return [
+            "def _load_extension():",
+            f'    """Load {name}, or None to stay on ctypes.',
+            "",
+            f"    Set {self.namespace.upper()}_PYTHON_BACKEND=ctypes to skip it.",
+            '    """',
+            f"    if os.environ.get('{self.namespace.upper()}_PYTHON_BACKEND') == 'ctypes':",
+            "        return None",
+            "    lib_dir = os.path.dirname(_lib._name)",
+            "    for suffix in importlib.machinery.EXTENSION_SUFFIXES:",
+            f"        path = os.path.join(lib_dir, '{name}' + suffix)",
+            "        if os.path.exists(path):",
+            f"            spec = importlib.util.spec_from_file_location('{name}', path)",
+            "            module = importlib.util.module_from_spec(spec)",
+            "            spec.loader.exec_module(module)",
+            "            return module",
+            "    try:",
+            f"        return importlib.import_module('{name}')",
+            "    except ImportError:",
+            "        return None",
+            "",
+            "",
+            "_ext = _load_extension()",
+            "",
+            "",
+        ]
+
     def _generate_enums(self) -> list[str]:
         """Generate Python enum classes for IDL enums"""
         if not self.idl.enums:
@@ -103,8 +186,6 @@ class PythonGenerator:
             "# Enum Definitions",
             "# ══════════════════════════════════════════════════════════════",
             "",
-            "from enum import IntEnum",
-            "",
         ]
         
         for enum in self.idl.enums:
@@ -156,26 +237,81 @@ class PythonGenerator:
         ]
 
         for cb in self.idl.callbacks:
+            if cb.has_attribute("batch"):
+                lines.extend(self._generate_batch_callback(cb))
+                continue
             ret_type = self._to_ctypes(cb.return_type)
-            param_types = ", ".join(self._to_ctypes(p.type) for p in cb.params)
-            if param_types:
-                lines.append(f"{cb.name} = CFUNCTYPE({ret_type}, {param_types})")
-            else:
-                lines.append(f"{cb.name} = CFUNCTYPE({ret_type})")
+            param_types = []
+            for p in cb.params:
+                # Struct references arrive as pointers
+                if self._is_struct_type(p.type) and p.is_reference:
+                    param_types.append(f"POINTER({p.type})")
+                else:
+                    param_types.append(self._to_ctypes(p.type))
+            # Trailing user_data pointer
+            param_types.append("c_void_p")
+            lines.append(f"{cb.name} = CFUNCTYPE({ret_type}, {', '.join(param_types)})")
             lines.append("")
 
         return lines
 
+    def _generate_batch_callback(self, cb: Callback) -> list[str]:
+        """[batch] callback: C arrays in, results written back, one ctypes crossing per batch"""
+        arrays = [(p.name, self._to_ctypes(p.type)) for p in cb.params]
+        if cb.return_type != "void":
+            arrays.append(("result", self._to_ctypes(cb.return_type)))
+        names = [n for n, _ in arrays]
+        pointer_types = ", ".join(f"POINTER({t})" for _, t in arrays)
+        inputs = [p.name for p in cb.params]
+        if len(inputs) == 1:
+            loop = f"for {inputs[0]}_i in {inputs[0]}"
+            call = f"fn({inputs[0]}_i)"
+        else:
+            loop = f"for {', '.join(f'{n}_i' for n in inputs)} in zip({', '.join(inputs)})"
+            call = f"fn({', '.join(f'{n}_i' for n in inputs)})"
+        lines = [
+            f"{cb.name} = CFUNCTYPE(None, {pointer_types}, c_int, c_void_p)",
+            "",
+            "",
+            f"def _{cb.name}_batch(fn):",
+            f'    """Adapt a per-element {cb.name} to one call per native batch.',
+            "",
+            f"    An object with invokeBatch({', '.join(names)}) receives the ctypes arrays",
+            "    instead; they are only valid during that call.",
+            '    """',
+            "    batch = getattr(fn, 'invokeBatch', None)",
+            "",
+            f"    def invoke({', '.join(names)}, count, _user_data):",
+            "        if count <= 0:",
+            "            return",
+        ]
+        for n, t in arrays:
+            lines.append(f"        {n} = ctypes.cast({n}, POINTER({t} * count)).contents")
+        lines.append("        if batch is not None:")
+        lines.append(f"            batch({', '.join(names)})")
+        if cb.return_type == "void":
+            lines.append("        else:")
+            lines.append(f"            {loop}:")
+            lines.append(f"                {call}")
+        elif cb.return_type == "bool":
+            lines.append("        else:")
+            lines.append(f"            result[:] = [1 if {call} else 0 {loop}]")
+        else:
+            lines.append("        else:")
+            lines.append(f"            result[:] = [{call} {loop}]")
+        lines.extend([
+            "",
+            f"    return {cb.name}(invoke)",
+            "",
+            "",
+        ])
+        return lines
+
     def _generate_result_structs(self) -> list[str]:
         """Generate result struct classes for vector returns"""
         lines = []
-        result_types = set()
-
-        for cls in self.idl.classes:
-            for method in cls.methods:
-                if TypeMapper.is_vector(method.return_type):
-                    inner = TypeMapper.vector_inner(method.return_type)
-                    result_types.add((cls.name, inner))
+        result_types = {(name, inner) for name, inners in self.idl.symbols.result_types.items()
+                        for inner in inners}
 
         if result_types:
             lines.extend([
@@ -194,6 +330,101 @@ class PythonGenerator:
 
         return lines
 
+    def _generate_errors(self) -> list[str]:
+        """ErrorCode, Error and the check run after a C API call returns its failure sentinel"""
+        ns = self.namespace
+        lines = [
+            "# ══════════════════════════════════════════════════════════════",
+            "# Errors",
+            "# ══════════════════════════════════════════════════════════════",
+            "",
+            "class ErrorCode(IntEnum):",
+            f'    """Codes reported by {ns}_last_error"""',
+        ]
+        lines.extend(f"    {suffix.replace('ERROR_', '')} = {value}"
+                     for suffix, value, _ in CAPIGenerator.ERROR_CODES)
+        lines.extend([
+            "",
+            "",
+            "class Error(RuntimeError):",
+            '    """A native call failed: code is an ErrorCode, message names the entry point"""',
+            "",
+            "    def __init__(self, code: ErrorCode, message: str):",
+            "        super().__init__(message)",
+            "        self.code = code",
+            "        self.message = message",
+            "",
+            "",
+            f"_lib.{ns}_last_error.restype = c_int",
+            f"_lib.{ns}_last_error.argtypes = []",
+            f"_lib.{ns}_last_error_message.restype = c_char_p",
+            f"_lib.{ns}_last_error_message.argtypes = []",
+            "",
+            "",
+            "def last_error() -> Optional[Error]:",
+            '    """The failure reported by this thread\'s last checked native call, or None"""',
+            f"    code = _lib.{ns}_last_error()",
+            "    if code == ErrorCode.OK:",
+            "        return None",
+            f"    return Error(ErrorCode(code), _lib.{ns}_last_error_message().decode('utf-8', 'replace'))",
+            "",
+            "",
+            "def _check_last_error() -> None:",
+            '    """Raise the last error, if any; called once a result equals its failure sentinel"""',
+            "    error = last_error()",
+            "    if error is not None:",
+            "        raise error",
+            "",
+            "",
+        ])
+        return lines
+
+    def _error_sentinel(self, idl_type: str, var: str) -> Optional[str]:
+        """Condition under which var may be the C API's failure value, or None when any value may be"""
+        if idl_type == "void" or self._is_struct_type(idl_type):
+            return None
+        if idl_type == "int":
+            return f"{var} == -1"
+        if idl_type == "string":
+            return f"{var} is None"
+        if idl_type in TypeMapper.CPP_TYPES and idl_type != "bool" or idl_type in self.idl.symbols.enums:
+            return f"{var} == 0"
+        # bool, pointers and handles
+        return f"not {var}"
+
+    def _generate_native_memory(self) -> list[str]:
+        """native_memory(): the C API's count of live handles, results and columns"""
+        fn = f"{self.namespace}_native_memory_usage"
+        return [
+            "# ══════════════════════════════════════════════════════════════",
+            "# Native Memory",
+            "# ══════════════════════════════════════════════════════════════",
+            "",
+            "class NativeMemoryUsage(Structure):",
+            '    """Native objects handed out and not yet destroyed or freed, and their bytes"""',
+            '    _fields_ = [("objects", c_uint64), ("bytes", c_uint64)]',
+            "",
+            "    def __repr__(self):",
+            '        return f"NativeMemoryUsage(objects={self.objects}, bytes={self.bytes})"',
+            "",
+            "",
+            f"_lib.{fn}.restype = None",
+            f"_lib.{fn}.argtypes = [POINTER(NativeMemoryUsage)]",
+            "",
+            "",
+            "def native_memory() -> NativeMemoryUsage:",
+            '    """Native memory held by objects that are still open.',
+            "",
+            "    The garbage collector only sees the small Python wrappers: compare bytes",
+            "    against a budget and close objects or call gc.collect() when it is exceeded.",
+            '    """',
+            "    usage = NativeMemoryUsage()",
+            f"    _lib.{fn}(ctypes.byref(usage))",
+            "    return usage",
+            "",
+            "",
+        ]
+
     def _generate_function_decls(self) -> list[str]:
         """Generate ctypes function declarations"""
         lines = [
@@ -208,9 +439,9 @@ class PythonGenerator:
             handle = f"{cls.name}Handle"
 
             # Create/destroy
-            has_ctor = any(m.is_constructor for m in cls.methods)
+            has_ctor = self.idl.symbols.constructors[cls.name] is not None
             if has_ctor:
-                ctor = next(m for m in cls.methods if m.is_constructor)
+                ctor = self.idl.symbols.constructors[cls.name]
                 ctor_params = [self._to_ctypes(p.type) for p in ctor.params]
                 
                 lines.append(f"_lib.{prefix}_create.restype = c_void_p")
@@ -236,16 +467,45 @@ class PythonGenerator:
                 for p in method.params:
                     if self._is_callback_type(p.type):
                         param_types.append(p.type)  # Callback type name
-                    elif self._is_struct_type(p.type):
-                        # Structs are passed by value in C API
-                        param_types.append(p.type)
+                        param_types.append("c_void_p")  # user_data
                     else:
-                        param_types.append(self._to_ctypes(p.type))
+                        param_types.append(self._param_ctypes(p))
 
                 lines.append(f"_lib.{func_name}.restype = {ret_type}")
                 lines.append(f"_lib.{func_name}.argtypes = [{', '.join(param_types)}]")
                 lines.append("")
 
+                if method.has_attribute("batch"):
+                    batch_types = ["c_void_p"] + [f"POINTER({self._to_ctypes(p.type)})" for p in method.params]
+                    if method.return_type != "void":
+                        batch_types.append(f"POINTER({self._to_ctypes(method.return_type)})")
+                    batch_types.append("c_int")
+                    lines.append(f"_lib.{func_name}_batch.restype = c_int")
+                    lines.append(f"_lib.{func_name}_batch.argtypes = [{', '.join(batch_types)}]")
+                    lines.append("")
+
+                if self._has_into(method):
+                    inner_ctype = self._to_ctypes(TypeMapper.vector_inner(method.return_type))
+                    into_types = param_types + [f"POINTER({inner_ctype})", "c_int"]
+                    lines.append(f"_lib.{func_name}_into.restype = c_int")
+                    lines.append(f"_lib.{func_name}_into.argtypes = [{', '.join(into_types)}]")
+                    lines.append("")
+
+                if method.has_attribute("async"):
+                    done_types = ["c_int", "c_void_p"]
+                    if method.return_type != "void":
+                        done_types.insert(0, self._async_result_ctypes(method.return_type))
+                    lines.append(f"_{func_name}_Done = CFUNCTYPE(None, {', '.join(done_types)})")
+                    lines.append(f"_lib.{func_name}_submit.restype = c_int")
+                    submit_types = param_types + [f"_{func_name}_Done", "c_void_p"]
+                    lines.append(f"_lib.{func_name}_submit.argtypes = [{', '.join(submit_types)}]")
+                    lines.append("")
+
+                if method.has_attribute("soa"):
+                    lines.append(f"_lib.{func_name}_soa.restype = c_void_p")
+                    lines.append(f"_lib.{func_name}_soa.argtypes = [{', '.join(param_types)}]")
+                    lines.append("")
+
             # Result accessors for vector returns
             for method in cls.methods:
                 if TypeMapper.is_vector(method.return_type):
@@ -263,6 +523,31 @@ class PythonGenerator:
                     lines.append(f"_lib.{result_name}_free.argtypes = [c_void_p]")
                     lines.append("")
 
+            # Column accessors for [soa] returns
+            for inner in self.idl.symbols.soa_types[cls.name]:
+                columns_name = f"{cls.name}_{inner}_CColumns"
+                lines.append(f"_lib.{columns_name}_getCount.restype = c_int")
+                lines.append(f"_lib.{columns_name}_getCount.argtypes = [c_void_p]")
+                lines.append("")
+                for m in self.idl.symbols.structs[inner].members:
+                    getter = f"{columns_name}_{self._column_getter(m)}"
+                    lines.append(f"_lib.{getter}.restype = c_void_p")
+                    lines.append(f"_lib.{getter}.argtypes = [c_void_p]")
+                    lines.append("")
+                lines.append(f"_lib.{columns_name}_free.restype = None")
+                lines.append(f"_lib.{columns_name}_free.argtypes = [c_void_p]")
+                lines.append("")
+
+            # Pull functions for stream<T> returns
+            for inner in self.idl.symbols.stream_types[cls.name]:
+                stream_name = f"{cls.name}_{inner}_CStream"
+                lines.append(f"_lib.{stream_name}_next.restype = c_int")
+                lines.append(f"_lib.{stream_name}_next.argtypes = [c_void_p, POINTER({self._to_ctypes(inner)}), c_int]")
+                lines.append("")
+                lines.append(f"_lib.{stream_name}_free.restype = None")
+                lines.append(f"_lib.{stream_name}_free.argtypes = [c_void_p]")
+                lines.append("")
+
             # Attribute getters
             for member in cls.members:
                 func_name = f"{prefix}_get{member.name[0].upper()}{member.name[1:]}"
@@ -286,7 +571,7 @@ class PythonGenerator:
         ]
 
         # Constructor
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             params = ", ".join(f"{p.name}: {self._to_python_type(p.type)}" for p in ctor.params)
             if params:
@@ -300,23 +585,26 @@ class PythonGenerator:
             else:
                 lines.append(f"        self._handle = _lib.{cls.name}_create()")
             lines.append("        if not self._handle:")
+            lines.append("            _check_last_error()")
             lines.append(f'            raise RuntimeError("Failed to create {cls.name}")')
-            lines.append("        # Store callback references to prevent GC")
-            lines.append("        self._callbacks = []")
+            lines.append("        # Destroys the handle once: on close(), or when the wrapper is collected")
+            lines.append(f"        self._finalizer = weakref.finalize(self, _lib.{cls.name}_destroy, self._handle)")
             lines.append("")
 
-        # Destructor
+        # Deterministic release
         lines.extend([
-            "    def __del__(self):",
-            "        if hasattr(self, '_handle') and self._handle:",
-            f"            _lib.{cls.name}_destroy(self._handle)",
-            "            self._handle = None",
+            "    def close(self) -> None:",
+            f'        """Destroy the native {cls.name} now instead of when the wrapper is collected"""',
+            "        finalizer = getattr(self, '_finalizer', None)",
+            "        if finalizer is not None:",
+            "            finalizer()",
+            "        self._handle = None",
             "",
             "    def __enter__(self):",
             "        return self",
             "",
             "    def __exit__(self, exc_type, exc_val, exc_tb):",
-            "        self.__del__()",
+            "        self.close()",
             "        return False",
             "",
         ])
@@ -325,7 +613,19 @@ class PythonGenerator:
         for method in cls.methods:
             if method.is_constructor:
                 continue
+            if TypeMapper.is_stream(method.return_type):
+                lines.extend(self._generate_stream_method(cls, method))
+                continue
             lines.extend(self._generate_method(cls, method))
+            if method.has_attribute("batch"):
+                lines.extend(self._generate_batch_method(cls, method))
+            if self._has_into(method):
+                lines.extend(self._generate_into_method(cls, method))
+                lines.extend(self._generate_array_method(cls, method))
+            if method.has_attribute("async"):
+                lines.extend(self._generate_async_method(cls, method))
+            if method.has_attribute("soa"):
+                lines.extend(self._generate_columns_method(cls, method))
 
         # Attribute getters
         for member in cls.members:
@@ -335,37 +635,46 @@ class PythonGenerator:
 
     def _generate_method(self, cls: Class, method: Method) -> list[str]:
         """Generate method wrapper"""
-        # Build parameter list with type hints
-        params = []
-        for p in method.params:
-            if self._is_callback_type(p.type):
-                cb = self._get_callback_def(p.type)
-                if cb:
-                    cb_params = ", ".join(self._to_python_type(cp.type) for cp in cb.params)
-                    cb_ret = self._to_python_type(cb.return_type)
-                    params.append(f"{p.name}: Callable[[{cb_params}], {cb_ret}]")
-                else:
-                    params.append(f"{p.name}: Callable")
-            else:
-                params.append(f"{p.name}: {self._to_python_type(p.type)}")
-
-        params_str = ", ".join(params)
+        params_str = self._method_params(method)
         ret_type = self._to_python_return_type(method.return_type)
 
         lines = [f"    def {method.name}(self, {params_str}) -> {ret_type}:"]
         lines.append(f'        """Call {cls.name}.{method.name}"""')
+        checked = not method.has_attribute("noexcept")
+        if not checked:
+            # The entry point does not check its handle
+            lines.append("        if not self._handle:")
+            lines.append(f'            raise ValueError("{cls.name}.{method.name} on a closed {cls.name}")')
+        if self.ext and self.ext.supports(method):
+            ext_args = ", ".join(["self._handle"] + [p.name for p in method.params])
+            # invokeBatch objects need the ctypes arrays, so they take the ctypes path
+            guards = ["_ext is not None"] + [f"not hasattr({p.name}, 'invokeBatch')" for p in method.params
+                                             if self._is_batch_callback(p.type)]
+            lines.append(f"        if {' and '.join(guards)}:")
+            call = f"_ext.{cls.name}_{method.name}({ext_args})"
+            # The extension returns Python values, so a NULL string has become ''
+            sentinel = (self._error_sentinel(method.return_type, "result") if method.return_type != "string"
+                        else "not result")
+            if not checked:
+                lines.append(f"            return {call}")
+            elif sentinel:
+                lines.append(f"            result = {call}")
+                lines.append(f"            if {sentinel}:")
+                lines.append("                _check_last_error()")
+                lines.append("            return result")
+            else:
+                lines.append(f"            result = {call}")
+                lines.append("            _check_last_error()")
+                lines.append("            return result")
 
         # Build argument list
         args = ["self._handle"]
         for p in method.params:
             if self._is_callback_type(p.type):
-                # Wrap callback in CFUNCTYPE
-                lines.append(f"        _{p.name}_c = {p.type}({p.name})")
-                lines.append(f"        self._callbacks.append(_{p.name}_c)  # Prevent GC")
+                # Only invoked during the call, so the local keeps the wrapper alive long enough
+                lines.append(f"        _{p.name}_c = {self._callback_wrapper(p)}")
                 args.append(f"_{p.name}_c")
-            elif self._is_struct_type(p.type):
-                # Structs are passed by value in C API
-                args.append(p.name)
+                args.append("None")
             else:
                 args.append(self._python_to_c_arg(p))
 
@@ -377,20 +686,331 @@ class PythonGenerator:
             
             lines.append(f"        result_ptr = _lib.{cls.name}_{method.name}({args_str})")
             lines.append("        if not result_ptr:")
+            lines.append("            _check_last_error()")
             lines.append("            return []")
             lines.append(f"        count = _lib.{result_name}_getCount(result_ptr)")
-            lines.append(f"        data = _lib.{result_name}_getData(result_ptr)")
-            lines.append("        items = [data[i] for i in range(count)]")
+            lines.append(f"        items = ({self._to_ctypes(inner)} * count)()")
+            lines.append("        if count > 0:")
+            lines.append(f"            ctypes.memmove(items, _lib.{result_name}_getData(result_ptr), ctypes.sizeof(items))")
             lines.append(f"        _lib.{result_name}_free(result_ptr)")
-            lines.append("        return items")
-        elif self._is_struct_type(method.return_type):
+            lines.append("        return list(items)")
+        elif method.return_type == "string":
+            # The C API returns per-thread storage; ctypes has already copied it into bytes
+            lines.append(f"        result = _lib.{cls.name}_{method.name}({args_str})")
+            lines.append("        if result is None:")
+            lines.append("            _check_last_error()")
+            lines.append("            return ''")
+            lines.append("        return result.decode('utf-8')")
+        elif not checked:
             lines.append(f"        return _lib.{cls.name}_{method.name}({args_str})")
         else:
-            lines.append(f"        return _lib.{cls.name}_{method.name}({args_str})")
+            lines.append(f"        result = _lib.{cls.name}_{method.name}({args_str})")
+            sentinel = self._error_sentinel(method.return_type, "result")
+            if sentinel:
+                lines.append(f"        if {sentinel}:")
+                lines.append("            _check_last_error()")
+            else:
+                lines.append("        _check_last_error()")
+            lines.append("        return result")
 
         lines.append("")
         return lines
 
+    def _generate_stream_method(self, cls: Class, method: Method) -> list[str]:
+        """Generator over a stream<T> return, holding at most one chunk of items"""
+        inner = TypeMapper.stream_inner(method.return_type)
+        stream_name = f"{cls.name}_{inner}_CStream"
+        params = ", ".join(filter(None, [self._method_params(method), "chunk: int = 1024"]))
+        args = ", ".join(["self._handle"] + [self._python_to_c_arg(p) for p in method.params])
+        item = f"{inner}.from_buffer_copy(item)" if self._is_struct_type(inner) else "item"
+        return [
+            f"    def {method.name}(self, {params}) -> Iterator[{self._to_python_type(inner)}]:",
+            f'        """Yield the items of {cls.name}.{method.name}, pulling a chunk at a time from native code.',
+            "",
+            "        Nothing runs until the first item is requested. The native stream is freed when the",
+            "        generator is exhausted, closed or collected; finish with it before calling close().",
+            '        """',
+            f"        stream = _lib.{cls.name}_{method.name}({args})",
+            "        if not stream:",
+            "            _check_last_error()",
+            f'            raise RuntimeError("{cls.name}.{method.name} failed")',
+            "        try:",
+            f"            items = ({self._to_ctypes(inner)} * chunk)()",
+            "            while True:",
+            f"                n = _lib.{stream_name}_next(stream, items, chunk)",
+            "                if n < 0:",
+            f'                    raise ValueError("{cls.name}.{method.name}: chunk must be positive")',
+            "                if n == 0:",
+            "                    return",
+            "                for item in items[:n]:",
+            f"                    yield {item}",
+            "        finally:",
+            f"            _lib.{stream_name}_free(stream)",
+            "",
+        ]
+
+    def _method_params(self, method: Method) -> str:
+        """Parameter list with type hints"""
+        params = []
+        for p in method.params:
+            if self._is_callback_type(p.type):
+                cb = self._get_callback_def(p.type)
+                if cb:
+                    cb_params = ", ".join(self._to_python_type(cp.type) for cp in cb.params)
+                    cb_ret = self._to_python_type(cb.return_type)
+                    params.append(f"{p.name}: Callable[[{cb_params}], {cb_ret}]")
+                else:
+                    params.append(f"{p.name}: Callable")
+            else:
+                params.append(f"{p.name}: {self._param_python_type(p)}")
+        return ", ".join(params)
+
+    def _callback_wrapper(self, param: Param) -> str:
+        """Wrap a Python callable in the callback's CFUNCTYPE; the closure replaces user_data"""
+        cb = self._get_callback_def(param.type)
+        if cb.has_attribute("batch"):
+            return f"_{param.type}_batch({param.name})"
+        cb_names = [cp.name for cp in cb.params]
+        cb_args = [f"{cp.name}[0]" if self._is_struct_type(cp.type) and cp.is_reference else cp.name
+                   for cp in cb.params]
+        lambda_params = ", ".join(cb_names + ["_user_data"])
+        return f"{param.type}(lambda {lambda_params}: {param.name}({', '.join(cb_args)}))"
+
+    def _has_async(self) -> bool:
+        return self.idl.symbols.has_async
+
+    def _async_result_ctypes(self, idl_type: str) -> str:
+        """ctypes type of the result argument of a completion callback"""
+        if self._is_struct_type(idl_type):
+            return f"POINTER({idl_type})"
+        return self._to_ctypes(idl_type)
+
+    def _generate_async_completions(self) -> list[str]:
+        """One module-level completion callback per [async] method.
+
+        They live as long as the module, so a callback is never freed while it runs;
+        user_data is a key into _async_calls, which keeps each call's future, object
+        and callback wrappers alive until it completes.
+        """
+        lines = [
+            "# ══════════════════════════════════════════════════════════════",
+            "# Async Completion",
+            "# ══════════════════════════════════════════════════════════════",
+            "",
+            "_async_calls = {}",
+            "_async_ids = itertools.count(1)",
+            "",
+            "",
+            "def _async_begin(future, *keep_alive) -> int:",
+            "    key = next(_async_ids)",
+            "    _async_calls[key] = (future, keep_alive)",
+            "    return key",
+            "",
+            "",
+        ]
+        for cls in self.idl.classes:
+            for method in cls.methods:
+                if not method.has_attribute("async"):
+                    continue
+                func_name = f"{cls.name}_{method.name}"
+                ret = method.return_type
+                if ret == "void":
+                    value = "None"
+                elif ret == "bool":
+                    value = "bool(result)"
+                elif ret == "string":
+                    value = "result.decode('utf-8') if result is not None else ''"
+                elif self._is_struct_type(ret):
+                    value = f"{ret}.from_buffer_copy(result.contents)"
+                else:
+                    value = "result"
+                params = "error, key" if ret == "void" else "result, error, key"
+                lines.extend([
+                    f"@_{func_name}_Done",
+                    f"def _{func_name}_done({params}):",
+                    "    future = _async_calls.pop(key)[0]",
+                    "    if error:",
+                    "        # Runs on the worker thread, whose last error says why the call threw",
+                    f'        future.set_exception(last_error() or Error(ErrorCode.EXCEPTION, "{cls.name}.{method.name} failed"))',
+                    "    else:",
+                    f"        future.set_result({value})",
+                    "",
+                    "",
+                ])
+        return lines
+
+    def _generate_async_method(self, cls: Class, method: Method) -> list[str]:
+        """Generate <method>Async wrapper returning a concurrent.futures.Future"""
+        func_name = f"{cls.name}_{method.name}"
+        lines = [
+            f"    def {method.name}Async(self, {self._method_params(method)}) -> concurrent.futures.Future:",
+            f'        """Run {cls.name}.{method.name} on the native worker pool.',
+            "",
+            "        Callbacks run on a pool thread, and the future is completed there too.",
+            '        """',
+        ]
+        args = ["self._handle"]
+        keep = ["self"]
+        for p in method.params:
+            if self._is_callback_type(p.type):
+                lines.append(f"        _{p.name}_c = {self._callback_wrapper(p)}")
+                args += [f"_{p.name}_c", "None"]
+                keep.append(f"_{p.name}_c")
+            else:
+                args.append(self._python_to_c_arg(p))
+        args += [f"_{func_name}_done", "key"]
+        lines.extend([
+            "        future = concurrent.futures.Future()",
+            f"        key = _async_begin(future, {', '.join(keep)})",
+            f"        if _lib.{func_name}_submit({', '.join(args)}) != 0:",
+            "            _async_calls.pop(key)",
+            f'            future.set_exception(last_error() or Error(ErrorCode.EXCEPTION, "{cls.name}.{method.name}Async could not be submitted"))',
+            "        return future",
+            "",
+        ])
+        return lines
+
+    def _generate_batch_method(self, cls: Class, method: Method) -> list[str]:
+        """Generate <method>Batch wrapper: sequences in, list out, one native call"""
+        params = ", ".join(f"{p.name}: Sequence[{self._to_python_type(p.type)}]" for p in method.params)
+        has_out = method.return_type != "void"
+        ret_type = f"List[{self._to_python_type(method.return_type)}]" if has_out else "None"
+
+        lines = [f"    def {method.name}Batch(self, {params}) -> {ret_type}:"]
+        lines.append(f'        """Call {cls.name}.{method.name} once per element in a single native call"""')
+        if method.params:
+            lines.append(f"        batch_size = len({method.params[0].name})")
+            for p in method.params[1:]:
+                lines.append(f"        if len({p.name}) != batch_size:")
+                lines.append(f'            raise ValueError("{method.name}Batch: input sizes differ")')
+        else:
+            lines.append("        batch_size = 0")
+
+        args = ["self._handle"]
+        for p in method.params:
+            lines.append(f"        _{p.name}_arr = ({self._to_ctypes(p.type)} * batch_size)(*{p.name})")
+            args.append(f"_{p.name}_arr")
+        if has_out:
+            lines.append(f"        _out = ({self._to_ctypes(method.return_type)} * batch_size)()")
+            args.append("_out")
+        args.append("batch_size")
+
+        lines.append(f"        if _lib.{cls.name}_{method.name}_batch({', '.join(args)}) < 0:")
+        lines.append("            _check_last_error()")
+        lines.append(f'            raise RuntimeError("{cls.name}.{method.name}Batch failed")')
+        if method.return_type == "bool":
+            lines.append("        return [bool(v) for v in _out]")
+        elif has_out:
+            lines.append("        return list(_out)")
+        lines.append("")
+        return lines
+
+    def _has_into(self, method: Method) -> bool:
+        """Vector returns get a variant that fills a caller-owned ctypes array"""
+        return (TypeMapper.is_vector(method.return_type)
+                and not any(self._is_callback_type(p.type) for p in method.params))
+
+    def _generate_into_method(self, cls: Class, method: Method) -> list[str]:
+        """Generate <method>Into wrapper writing into a reusable buffer"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = ", ".join([f"{p.name}: {self._param_python_type(p)}" for p in method.params] + ["out"])
+        args = ", ".join(["self._handle"] + [self._python_to_c_arg(p) for p in method.params] + ["out", "len(out)"])
+        return [
+            f"    def {method.name}Into(self, {params}) -> int:",
+            f'        """Fill a caller-owned array such as ({self._to_ctypes(inner)} * n)().',
+            "",
+            "        Returns the total element count; when it exceeds len(out) only the",
+            "        first len(out) elements were written.",
+            '        """',
+            f"        return _lib.{cls.name}_{method.name}_into({args})",
+            "",
+        ]
+
+    def _generate_array_method(self, cls: Class, method: Method) -> list[str]:
+        """Generate <method>Array wrapper returning the native result buffer itself"""
+        inner_ctype = self._to_ctypes(TypeMapper.vector_inner(method.return_type))
+        result_name = f"{cls.name}_{TypeMapper.vector_inner(method.return_type)}_CResult"
+        params = ", ".join(f"{p.name}: {self._param_python_type(p)}" for p in method.params)
+        args = ", ".join(["self._handle"] + [self._python_to_c_arg(p) for p in method.params])
+        return [
+            f"    def {method.name}Array(self, {params}) -> ctypes.Array:",
+            f'        """Call {cls.name}.{method.name} without copying the result.',
+            "",
+            f"        Returns a ({inner_ctype} * n) array over the native buffer, freed when the",
+            "        array is garbage-collected. It supports the buffer protocol, so",
+            "        numpy.ctypeslib.as_array() or memoryview() wrap it without a copy.",
+            '        """',
+            f"        result_ptr = _lib.{cls.name}_{method.name}({args})",
+            "        if not result_ptr:",
+            f"            return ({inner_ctype} * 0)()",
+            f"        count = _lib.{result_name}_getCount(result_ptr)",
+            "        if count <= 0:",
+            f"            _lib.{result_name}_free(result_ptr)",
+            f"            return ({inner_ctype} * 0)()",
+            f"        data = ctypes.cast(_lib.{result_name}_getData(result_ptr), c_void_p).value",
+            f"        items = ({inner_ctype} * count).from_address(data)",
+            f"        weakref.finalize(items, _lib.{result_name}_free, result_ptr)",
+            "        return items",
+            "",
+        ]
+
+    def _column_getter(self, member: Member) -> str:
+        return f"get{member.name[0].upper()}{member.name[1:]}Column"
+
+    def _generate_columns_classes(self) -> list[str]:
+        """One class per [soa] result: its members are ctypes arrays over the native columns"""
+        lines = []
+        for cls in self.idl.classes:
+            for inner in self.idl.symbols.soa_types[cls.name]:
+                columns_name = f"{cls.name}_{inner}_CColumns"
+                lines.extend([
+                    f"class {cls.name}{inner}Columns:",
+                    f'    """Struct-of-arrays {inner} results: one native array per member.',
+                    "",
+                    "    Each member property is a ctypes array over its column, without a copy;",
+                    "    numpy.ctypeslib.as_array() or memoryview() map it directly. The columns",
+                    "    are freed once this object and every array taken from it are collected.",
+                    '    """',
+                    "",
+                    "    def __init__(self, columns_ptr):",
+                    "        self._ptr = columns_ptr",
+                    f"        self._count = max(_lib.{columns_name}_getCount(columns_ptr), 0) if columns_ptr else 0",
+                    "        if columns_ptr:",
+                    f"            weakref.finalize(self, _lib.{columns_name}_free, columns_ptr)",
+                    "",
+                    "    def __len__(self) -> int:",
+                    "        return self._count",
+                    "",
+                    "    def _column(self, getter, ctype) -> ctypes.Array:",
+                    "        if not self._count:",
+                    "            return (ctype * 0)()",
+                    "        column = (ctype * self._count).from_address(getter(self._ptr))",
+                    "        column._owner = self  # the native columns outlive every array",
+                    "        return column",
+                    "",
+                ])
+                for m in self.idl.symbols.structs[inner].members:
+                    lines.extend([
+                        "    @property",
+                        f"    def {m.name}(self) -> ctypes.Array:",
+                        f"        return self._column(_lib.{columns_name}_{self._column_getter(m)}, {self._to_ctypes(m.type)})",
+                        "",
+                    ])
+                lines.append("")
+        return lines
+
+    def _generate_columns_method(self, cls: Class, method: Method) -> list[str]:
+        """Generate <method>Columns wrapper for a [soa] method"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        params = ", ".join(f"{p.name}: {self._param_python_type(p)}" for p in method.params)
+        args = ", ".join(["self._handle"] + [self._python_to_c_arg(p) for p in method.params])
+        return [
+            f"    def {method.name}Columns(self, {params}) -> {cls.name}{inner}Columns:",
+            f'        """Call {cls.name}.{method.name}, returning one column per {inner} member"""',
+            f"        return {cls.name}{inner}Columns(_lib.{cls.name}_{method.name}_soa({args}))",
+            "",
+        ]
+
     def _generate_attribute(self, cls: Class, member: Member) -> list[str]:
         """Generate property for attribute"""
         getter_name = f"get{member.name[0].upper()}{member.name[1:]}"
@@ -425,8 +1045,12 @@ class PythonGenerator:
         }
         
         # Check if it's a struct
-        if any(s.name == idl_type for s in self.idl.structs):
+        if idl_type in self.idl.symbols.structs:
             return idl_type
+
+        # Enums cross the C API as plain ints
+        if idl_type in self.idl.symbols.enums:
+            return 'c_int'
         
         return mapping.get(idl_type, 'c_void_p')
 
@@ -451,11 +1075,17 @@ class PythonGenerator:
         }
         
         # Check if it's a struct
-        if any(s.name == idl_type for s in self.idl.structs):
+        if idl_type in self.idl.symbols.structs:
             return idl_type
         
         return mapping.get(idl_type, 'object')
 
+    def _param_python_type(self, param: Param) -> str:
+        """Type hint for a non-callback parameter"""
+        if param.is_pointer and not self._is_struct_type(param.type):
+            return "_BufferLike"
+        return self._to_python_type(param.type)
+
     def _to_python_return_type(self, idl_type: str) -> str:
         """Convert IDL return type to Python type hint"""
         if TypeMapper.is_vector(idl_type):
@@ -466,24 +1096,41 @@ class PythonGenerator:
 
     def _c_return_type(self, iface_name: str, idl_type: str) -> str:
         """Get ctypes return type for C function"""
-        if TypeMapper.is_vector(idl_type):
-            return "c_void_p"  # Returns pointer to result struct
+        if TypeMapper.is_vector(idl_type) or TypeMapper.is_stream(idl_type):
+            return "c_void_p"  # Returns pointer to result or stream struct
         return self._to_ctypes(idl_type)
 
+    def _param_ctypes(self, param: Param) -> str:
+        """ctypes argtype for a non-callback parameter"""
+        if self._is_struct_type(param.type):
+            # Structs are passed by value in C API, pointers stay pointers
+            return f"POINTER({param.type})" if param.is_pointer else param.type
+        if param.is_pointer:
+            return "c_void_p"  # Filled by _as_buffer
+        return self._to_ctypes(param.type)
+
     def _python_to_c_arg(self, param: Param) -> str:
         """Convert Python parameter to C argument"""
         if param.type == 'string':
             return f"{param.name}.encode('utf-8')"
+        if self._is_struct_type(param.type) and param.is_pointer:
+            return f"ctypes.byref({param.name})"
+        if param.is_pointer:
+            return f"_as_buffer({param.name})"
         return param.name
 
     def _is_callback_type(self, type_name: str) -> bool:
         """Check if type is a callback"""
-        return any(cb.name == type_name for cb in self.idl.callbacks)
+        return type_name in self.idl.symbols.callbacks
+
+    def _is_batch_callback(self, type_name: str) -> bool:
+        cb = self._get_callback_def(type_name)
+        return cb is not None and cb.has_attribute("batch")
 
     def _is_struct_type(self, type_name: str) -> bool:
         """Check if type is a struct"""
-        return any(s.name == type_name for s in self.idl.structs)
+        return type_name in self.idl.symbols.structs
 
     def _get_callback_def(self, type_name: str) -> Optional[Callback]:
         """Get callback definition by name"""
-        return next((cb for cb in self.idl.callbacks if cb.name == type_name), None)
+        return self.idl.symbols.callbacks.get(type_name)
@@ -0,0 +1,238 @@
+"""Reflection Generator - generates a header-only C++17 facade with constexpr type tables"""
+
+from .types import ParsedIDL, Class, Struct, Enum
+
+
+class ReflectGenerator:
+    """Generates <namespace>_reflect.hpp: compile-time tables of struct fields, class methods
+    and enum values over the implementation types.
+
+    A C++ consumer that links the implementation statically can write serialization and
+    marshalling templates against the tables; every lookup resolves at compile time and
+    calls go straight to the implementation, with no C API or function pointer between."""
+
+    def __init__(self, idl: ParsedIDL, namespace: str):
+        self.idl = idl
+        self.namespace = namespace
+
+    def generate(self, impl_header: str) -> str:
+        ns = self.namespace
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// Header-only compile-time reflection over the {ns} types:",
+            "//   TypeInfo<T>  - name, fields (name, member pointer, offset) and methods",
+            "//                  (name, member function pointer) of every IDL struct and class",
+            "//   EnumInfo<E>  - name and values of every IDL enum",
+            "#pragma once",
+            "",
+            f'#include "{impl_header}"',
+            "",
+            "#include <array>",
+            "#include <cstddef>",
+            "#include <string_view>",
+            "#include <tuple>",
+            "#include <type_traits>",
+            "#include <utility>",
+            "",
+            f"namespace {ns}::reflect {{",
+            "",
+            *self._generate_core(),
+            *self._generate_algorithms(),
+        ]
+        for enum in self.idl.enums:
+            lines.extend(self._generate_enum(enum))
+        for struct in self.idl.structs:
+            lines.extend(self._generate_struct(struct))
+        for cls in self.idl.classes:
+            lines.extend(self._generate_class(cls))
+        lines.append(f"}}  // namespace {ns}::reflect")
+        lines.append("")
+        return "\n".join(lines)
+
+    # ── Shared templates ────────────────────────────────────────────
+
+    def _generate_core(self) -> list[str]:
+        return [
+            "template <typename Owner, typename T>",
+            "struct Field {",
+            "    using owner_type = Owner;",
+            "    using value_type = T;",
+            "",
+            "    std::string_view name;",
+            "    T Owner::*pointer;",
+            "    std::size_t offset;",
+            "",
+            "    constexpr T& get(Owner& object) const { return object.*pointer; }",
+            "    constexpr const T& get(const Owner& object) const { return object.*pointer; }",
+            "};",
+            "",
+            "template <typename Owner, typename Pointer>",
+            "struct Method {",
+            "    using owner_type = Owner;",
+            "    using pointer_type = Pointer;",
+            "",
+            "    std::string_view name;",
+            "    Pointer pointer;",
+            "",
+            "    template <typename Object, typename... Args>",
+            "    decltype(auto) operator()(Object&& object, Args&&... args) const {",
+            "        return (std::forward<Object>(object).*pointer)(std::forward<Args>(args)...);",
+            "    }",
+            "};",
+            "",
+            "template <typename E>",
+            "struct EnumValue {",
+            "    std::string_view name;",
+            "    E value;",
+            "};",
+            "",
+            "// Specialised below for every IDL struct and class",
+            "template <typename T>",
+            "struct TypeInfo;",
+            "",
+            "// Specialised below for every IDL enum",
+            "template <typename E>",
+            "struct EnumInfo;",
+            "",
+            "template <typename T, typename = void>",
+            "struct is_reflected : std::false_type {};",
+            "template <typename T>",
+            "struct is_reflected<T, std::void_t<decltype(TypeInfo<T>::name)>> : std::true_type {};",
+            "template <typename T>",
+            "inline constexpr bool is_reflected_v = is_reflected<T>::value;",
+            "",
+            "template <typename E, typename = void>",
+            "struct is_reflected_enum : std::false_type {};",
+            "template <typename E>",
+            "struct is_reflected_enum<E, std::void_t<decltype(EnumInfo<E>::name)>> : std::true_type {};",
+            "template <typename E>",
+            "inline constexpr bool is_reflected_enum_v = is_reflected_enum<E>::value;",
+            "",
+        ]
+
+    def _generate_algorithms(self) -> list[str]:
+        return [
+            "// f(field) for every field of T, in IDL order",
+            "template <typename T, typename F>",
+            "constexpr void for_each_field(F&& f) {",
+            "    std::apply([&](const auto&... field) { (f(field), ...); }, TypeInfo<T>::fields);",
+            "}",
+            "",
+            "// f(name, value) for every field of object, in IDL order",
+            "template <typename T, typename F>",
+            "constexpr void for_each_field(T& object, F&& f) {",
+            "    using Info = TypeInfo<std::remove_const_t<T>>;",
+            "    std::apply([&](const auto&... field) { (f(field.name, field.get(object)), ...); }, Info::fields);",
+            "}",
+            "",
+            "// f(method) for every non-constructor method of T, in IDL order",
+            "template <typename T, typename F>",
+            "constexpr void for_each_method(F&& f) {",
+            "    std::apply([&](const auto&... method) { (f(method), ...); }, TypeInfo<T>::methods);",
+            "}",
+            "",
+            "// Position of the field called name, or TypeInfo<T>::field_count if there is none",
+            "template <typename T>",
+            "constexpr std::size_t field_index(std::string_view name) {",
+            "    std::size_t index = 0;",
+            "    std::size_t found = TypeInfo<T>::field_count;",
+            "    for_each_field<T>([&](const auto& field) {",
+            "        if (found == TypeInfo<T>::field_count && field.name == name) {",
+            "            found = index;",
+            "        }",
+            "        ++index;",
+            "    });",
+            "    return found;",
+            "}",
+            "",
+            "// Name of an enum value, or an empty view for a value outside the IDL",
+            "template <typename E>",
+            "constexpr std::string_view enum_name(E value) {",
+            "    for (const auto& entry : EnumInfo<E>::values) {",
+            "        if (entry.value == value) {",
+            "            return entry.name;",
+            "        }",
+            "    }",
+            "    return {};",
+            "}",
+            "",
+            "// Parses an IDL enum value name; out is left unchanged when name is unknown",
+            "template <typename E>",
+            "constexpr bool enum_from_name(std::string_view name, E& out) {",
+            "    for (const auto& entry : EnumInfo<E>::values) {",
+            "        if (entry.name == name) {",
+            "            out = entry.value;",
+            "            return true;",
+            "        }",
+            "    }",
+            "    return false;",
+            "}",
+            "",
+        ]
+
+    # ── Per-type tables ─────────────────────────────────────────────
+
+    def _generate_enum(self, enum: Enum) -> list[str]:
+        t = f"::{enum.name}"
+        lines = [
+            "template <>",
+            f"struct EnumInfo<{t}> {{",
+            f'    static constexpr std::string_view name = "{enum.name}";',
+            f"    static constexpr std::array<EnumValue<{t}>, {len(enum.values)}> values{{{{",
+        ]
+        for v in enum.values:
+            lines.append(f'        {{"{v.name}", ::{enum.name}_{v.name}}},')
+        lines.extend([
+            "    }};",
+            "};",
+            "",
+        ])
+        return lines
+
+    def _generate_struct(self, struct: Struct) -> list[str]:
+        t = f"::{struct.name}"
+        lines = [
+            f'static_assert(std::is_standard_layout_v<{t}>, "offsetof needs a standard-layout {struct.name}");',
+            "",
+            "template <>",
+            f"struct TypeInfo<{t}> {{",
+            f'    static constexpr std::string_view name = "{struct.name}";',
+            f"    static constexpr std::size_t size = sizeof({t});",
+        ]
+        lines.extend(self._tuple("fields", [
+            f'Field<{t}, decltype({t}::{m.name})>{{"{m.name}", &{t}::{m.name}, offsetof({t}, {m.name})}}'
+            for m in struct.members
+        ]))
+        lines.append("    static constexpr std::size_t field_count = std::tuple_size_v<decltype(fields)>;")
+        lines.append("    static constexpr auto methods = std::tuple<>{};")
+        lines.append("    static constexpr std::size_t method_count = 0;")
+        lines.append("};")
+        lines.append("")
+        return lines
+
+    def _generate_class(self, cls: Class) -> list[str]:
+        t = f"{self.namespace}::{cls.name}"
+        methods = [m for m in cls.methods if not m.is_constructor]
+        lines = [
+            "template <>",
+            f"struct TypeInfo<{t}> {{",
+            f'    static constexpr std::string_view name = "{cls.name}";',
+            "    static constexpr auto fields = std::tuple<>{};",
+            "    static constexpr std::size_t field_count = 0;",
+        ]
+        lines.extend(self._tuple("methods", [
+            f'Method<{t}, decltype(&{t}::{m.name})>{{"{m.name}", &{t}::{m.name}}}'
+            for m in methods
+        ]))
+        lines.append("    static constexpr std::size_t method_count = std::tuple_size_v<decltype(methods)>;")
+        lines.append("};")
+        lines.append("")
+        return lines
+
+    def _tuple(self, name: str, items: list[str]) -> list[str]:
+        if not items:
+            return [f"    static constexpr auto {name} = std::tuple<>{{}};"]
+        lines = [f"    static constexpr auto {name} = std::make_tuple("]
+        for i, item in enumerate(items):
+            lines.append(f"        {item}{',' if i + 1 < len(items) else ');'}")
+        return lines
@@ -53,6 +53,10 @@ class TypeMapper:
         if m := re.match(r'vector<(.+)>', idl_type):
             inner = m.group(1)
             return f'std::vector<{cls.to_cpp(inner)}>'
+
+        # stream<T>: a pull source that fills up to max items and returns how many, 0 at the end
+        if m := re.match(r'stream<(.+)>', idl_type):
+            return f'std::function<size_t({cls.to_cpp(m.group(1))}* out, size_t max)>'
         
         return cls.CPP_TYPES.get(idl_type, idl_type)
 
@@ -127,6 +131,18 @@ class TypeMapper:
             return m.group(1)
         return None
 
+    @classmethod
+    def is_stream(cls, idl_type: str) -> bool:
+        """Check if type is a stream<T> return"""
+        return idl_type.startswith('stream<') and idl_type.endswith('>')
+
+    @classmethod
+    def stream_inner(cls, idl_type: str) -> Optional[str]:
+        """Get element type of stream<T>"""
+        if m := re.match(r'stream<(.+)>', idl_type):
+            return m.group(1)
+        return None
+
     @classmethod
     def is_primitive(cls, idl_type: str) -> bool:
         """Check if type is a primitive (not struct/class)"""
@@ -1,6 +1,7 @@
 """Data types for IDL parsing"""
 
 from dataclasses import dataclass, field
+from typing import Callable, Optional
 
 
 @dataclass
@@ -13,6 +14,20 @@ class Param:
     is_reference: bool = False
 
 
+# A pointer parameter's element count is taken from the parameter right after it when
+# that parameter is an int with one of these names
+SIZE_PARAMS = ("size", "count", "length", "len", "n", "numBytes", "byteCount", "capacity")
+
+
+def size_param(params: list[Param], index: int) -> Optional[str]:
+    """Name of the element count that follows pointer parameter index, if any"""
+    if index + 1 < len(params):
+        nxt = params[index + 1]
+        if nxt.type == "int" and not nxt.is_pointer and nxt.name in SIZE_PARAMS:
+            return nxt.name
+    return None
+
+
 @dataclass
 class Member:
     """Interface or struct member"""
@@ -29,6 +44,12 @@ class Method:
     params: list[Param] = field(default_factory=list)
     is_constructor: bool = False
     is_const: bool = False
+    attributes: list[str] = field(default_factory=list)
+    location: str = field(default="", compare=False)  # file:line:column of the declaration
+
+    def has_attribute(self, name: str) -> bool:
+        """Check for an IDL annotation such as [batch]"""
+        return name in self.attributes
 
 
 @dataclass
@@ -37,6 +58,12 @@ class Callback:
     name: str
     return_type: str
     params: list[Param] = field(default_factory=list)
+    attributes: list[str] = field(default_factory=list)
+    location: str = field(default="", compare=False)  # file:line:column of the declaration
+
+    def has_attribute(self, name: str) -> bool:
+        """Check for a trailing annotation such as [batch]"""
+        return name in self.attributes
 
 
 @dataclass
@@ -45,6 +72,7 @@ class Class:
     name: str
     members: list[Member] = field(default_factory=list)
     methods: list[Method] = field(default_factory=list)
+    location: str = field(default="", compare=False)  # file:line:column of the declaration
 
 
 @dataclass
@@ -52,6 +80,7 @@ class Struct:
     """IDL struct definition"""
     name: str
     members: list[Member] = field(default_factory=list)
+    location: str = field(default="", compare=False)  # file:line:column of the declaration
 
 
 @dataclass
@@ -66,6 +95,7 @@ class Enum:
     """IDL enum definition"""
     name: str
     values: list[EnumValue] = field(default_factory=list)
+    location: str = field(default="", compare=False)  # file:line:column of the declaration
 
 
 @dataclass
@@ -75,3 +105,154 @@ class ParsedIDL:
     structs: list[Struct] = field(default_factory=list)
     classes: list[Class] = field(default_factory=list)
     callbacks: list[Callback] = field(default_factory=list)
+    # Resolved paths of imported files: direct imports for one file, all of them once linked
+    imports: list[str] = field(default_factory=list)
+    source: str = field(default="", compare=False)  # resolved path of the parsed file
+    _symbols: Optional["SymbolTable"] = field(default=None, init=False, repr=False, compare=False)
+
+    @property
+    def symbols(self) -> "SymbolTable":
+        """Name lookups shared by every generator, built on first use.
+        The declaration lists must not change afterwards."""
+        if self._symbols is None:
+            self._symbols = SymbolTable(self)
+        return self._symbols
+
+
+class SymbolTable:
+    """Declarations indexed by name, plus per-class facts the generators need repeatedly.
+
+    Built in one pass over a ParsedIDL so resolving a parameter type is a dict lookup
+    rather than a scan of every declaration list."""
+
+    ENUM, STRUCT, CLASS, CALLBACK = "enum", "struct", "class", "callback"
+
+    # Member types a [soa] struct may have (enums too): one typed column each in every binding
+    SOA_COLUMN_TYPES = ("int", "bool", "float", "double")
+
+    # Scalar stream<T> element types; structs of any POD members are allowed too
+    STREAM_SCALAR_TYPES = ("int", "int32_t", "int64_t", "float", "double")
+
+    # Annotations that produce an alternative whole-result entry point, which a stream does not have
+    STREAM_EXCLUSIVE = ("batch", "async", "soa", "packed", "kernel")
+
+    # Return types a [noexcept] entry point can hand back without allocating
+    NOEXCEPT_RETURN_TYPES = ("void", "bool", "int", "int8_t", "uint8_t", "int16_t", "uint16_t",
+                             "int32_t", "uint32_t", "int64_t", "uint64_t", "float", "double")
+
+    def __init__(self, idl: ParsedIDL):
+        self.enums = {e.name: e for e in idl.enums}
+        self.structs = {s.name: s for s in idl.structs}
+        self.classes = {c.name: c for c in idl.classes}
+        self.callbacks = {cb.name: cb for cb in idl.callbacks}
+        self.kinds: dict[str, str] = {}
+        for kind, decls in ((self.ENUM, idl.enums), (self.STRUCT, idl.structs),
+                            (self.CLASS, idl.classes), (self.CALLBACK, idl.callbacks)):
+            for decl in decls:
+                self.kinds.setdefault(decl.name, kind)
+
+        # Per class: sorted element types of its vector returns (one result struct each),
+        # of its [soa] returns (one columns struct each), of its stream returns (one
+        # stream struct each) and its constructor, if any
+        self.result_types: dict[str, list[str]] = {}
+        self.soa_types: dict[str, list[str]] = {}
+        self.stream_types: dict[str, list[str]] = {}
+        self.constructors: dict[str, Optional[Method]] = {}
+        self.has_async = False
+        for cls in idl.classes:
+            self.result_types[cls.name] = sorted({
+                m.return_type[len("vector<"):-1] for m in cls.methods if _is_vector(m.return_type)})
+            self.soa_types[cls.name] = sorted({
+                self._soa_struct(cls, m) for m in cls.methods if m.has_attribute("soa")})
+            self.stream_types[cls.name] = sorted({
+                self._stream_element(cls, m) for m in cls.methods if _is_stream(m.return_type)})
+            self.constructors[cls.name] = next((m for m in cls.methods if m.is_constructor), None)
+            self.has_async = self.has_async or any(m.has_attribute("async") for m in cls.methods)
+            for m in cls.methods:
+                if m.has_attribute("kernel") and not m.has_attribute("batch"):
+                    raise ValueError(f"[kernel] requires [batch] ({cls.name}.{m.name})")
+                if m.has_attribute("fill") and not _is_vector(m.return_type):
+                    raise ValueError(f"[fill] requires a vector<T> return ({cls.name}.{m.name})")
+                if any(_is_stream(p.type) for p in m.params):
+                    raise ValueError(f"stream<T> is only valid as a return type ({cls.name}.{m.name})")
+                if m.has_attribute("noexcept"):
+                    self._check_noexcept(cls, m)
+        self._layouts: dict[tuple, tuple[list, int]] = {}
+
+    def _soa_struct(self, cls: Class, method: Method) -> str:
+        """Element struct of a [soa] method, which must return vector<struct of scalars>"""
+        where = f"{cls.name}.{method.name}"
+        inner = method.return_type[len("vector<"):-1] if _is_vector(method.return_type) else None
+        if inner not in self.structs:
+            raise ValueError(f"[soa] requires a vector<struct> return type ({where})")
+        for m in self.structs[inner].members:
+            if m.type not in self.SOA_COLUMN_TYPES and m.type not in self.enums:
+                raise ValueError(f"[soa] struct {inner} member '{m.name}' must be int, bool, float, double "
+                                 f"or an enum ({where})")
+        if any(p.type in self.callbacks for p in method.params):
+            raise ValueError(f"[soa] does not support callback parameters ({where})")
+        return inner
+
+    def _stream_element(self, cls: Class, method: Method) -> str:
+        """Element type of a stream<T> method: a numeric scalar or a struct, copied out chunk by chunk"""
+        where = f"{cls.name}.{method.name}"
+        inner = method.return_type[len("stream<"):-1]
+        if inner not in self.STREAM_SCALAR_TYPES and inner not in self.structs:
+            raise ValueError(f"stream<{inner}> element must be a struct or one of "
+                             f"{', '.join(self.STREAM_SCALAR_TYPES)} ({where})")
+        for attr in self.STREAM_EXCLUSIVE:
+            if method.has_attribute(attr):
+                raise ValueError(f"[{attr}] does not apply to a stream<T> return ({where})")
+        # The source runs after the call returns, so it must not hold on to caller memory
+        if any(p.type in self.callbacks or p.is_pointer for p in method.params):
+            raise ValueError(f"stream<T> methods do not support callback or buffer parameters ({where})")
+        return inner
+
+    def _check_noexcept(self, cls: Class, method: Method):
+        """[noexcept] drops the C API's checks and try/catch, so the entry point itself must not
+        allocate: only scalar, enum and struct returns, and no string or callback parameters"""
+        where = f"{cls.name}.{method.name}"
+        if method.is_constructor:
+            raise ValueError(f"[noexcept] does not apply to constructors ({where})")
+        ret = method.return_type
+        if ret not in self.NOEXCEPT_RETURN_TYPES and ret not in self.enums and ret not in self.structs:
+            raise ValueError(f"[noexcept] requires a scalar, enum or struct return, not {ret} ({where})")
+        if any(p.type == "string" or p.type in self.callbacks for p in method.params):
+            raise ValueError(f"[noexcept] does not support string or callback parameters ({where})")
+
+    def kind(self, type_name: str) -> Optional[str]:
+        """ENUM, STRUCT, CLASS or CALLBACK for a declared name, else None"""
+        return self.kinds.get(type_name)
+
+    def struct_layout(self, name: str, field_spec: Callable[[str], Optional[tuple]],
+                      what: str = "struct") -> tuple[list, int]:
+        """Natural-alignment layout of a struct: ([(member, offset, spec)], sizeof).
+
+        field_spec(type) returns a tuple whose first item is the member size, or None for a
+        member that cannot be laid out, which raises ValueError naming what. The result is
+        memoized per struct and field_spec, since bindings disagree on sizes (e.g. bool)."""
+        key = (name, getattr(field_spec, "__qualname__", id(field_spec)))
+        if key not in self._layouts:
+            struct = self.structs[name]
+            fields = []
+            offset = 0
+            align = 1
+            for m in struct.members:
+                spec = field_spec(m.type)
+                if spec is None:
+                    raise ValueError(f"{what} {struct.name} has non-POD member '{m.name}' ({m.type})")
+                size = spec[0]
+                offset = (offset + size - 1) // size * size
+                fields.append((m, offset, spec))
+                offset += size
+                align = max(align, size)
+            self._layouts[key] = (fields, (offset + align - 1) // align * align)
+        return self._layouts[key]
+
+
+def _is_vector(idl_type: str) -> bool:
+    return idl_type.startswith("vector<") and idl_type.endswith(">")
+
+
+def _is_stream(idl_type: str) -> bool:
+    return idl_type.startswith("stream<") and idl_type.endswith(">")
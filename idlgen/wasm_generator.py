@@ -18,15 +18,31 @@ class WASMGenerator:
             "#include <emscripten/val.h>",
             f'#include "{impl_header}"',
             "#include <vector>",
+            *(["#include <algorithm>", "#include <functional>"] if self._has_streams() else []),
             "#include <memory>",
             "#include <string>",
+            "#include <cstddef>",
             "#include <cstdint>",
             "",
             "using namespace emscripten;",
             "",
+            "namespace {",
+            "",
+            "// Raises a JS Error; called once the C++ catch block has exited, so the exception is finished",
+            "[[noreturn]] void throwJsError(const char* where, const std::string& what) {",
+            '    val::global("Error").new_(std::string(where) + ": " + what).throw_();',
+            "}",
+            "",
+            "} // namespace",
+            "",
         ]
+        if self.idl.symbols.has_async:
+            lines.extend(self._async_support())
+        lines.extend(self._packed_layout_asserts())
 
         for cls in self.idl.classes:
+            for inner in self.idl.symbols.stream_types[cls.name]:
+                lines.extend(self._stream_reader(cls, inner))
             lines.extend(self._class_wrapper(cls))
             lines.extend(self._class_bindings(cls))
 
@@ -74,6 +90,25 @@ class WASMGenerator:
         lines.append("")
         return lines
 
+    @staticmethod
+    def _guard_js(lines: list[str], where: str) -> list[str]:
+        """Wraps a wrapper method's body so a C++ exception reaches JS as an Error rather than
+        aborting the module (needs -fexceptions)"""
+        body = [f"    {line}" if line else line for line in lines[1:-2]]
+        return [
+            lines[0],
+            "        std::string error;",
+            "        try {",
+            *body,
+            "        } catch (const std::exception& e) {",
+            "            error = e.what();",
+            "        } catch (...) {",
+            '            error = "unknown exception";',
+            "        }",
+            f'        throwJsError("{where}", error);',
+            *lines[-2:],
+        ]
+
     def _class_wrapper(self, cls: Class) -> list[str]:
         cpp_class = f"{self.namespace}::{cls.name}"
         wasm_class = f"Wasm{cls.name}"
@@ -85,7 +120,7 @@ class WASMGenerator:
         ]
 
         # Constructor
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             lines.extend(self._wasm_constructor(cls, ctor, cpp_class))
 
@@ -100,11 +135,47 @@ class WASMGenerator:
             # Skip methods returning class pointers (not supported in Emscripten)
             if self._returns_class_pointer(method):
                 continue
-            lines.extend(self._wasm_method(cls, method))
+            where = f"{cls.name}.{method.name}"
+            if TypeMapper.is_stream(method.return_type):
+                lines.extend(self._guard_js(self._wasm_stream_method(cls, method), where))
+                continue
+            variants = [(self._wasm_method(cls, method), where)]
+            if method.has_attribute("batch"):
+                variants.append((self._wasm_batch_method(method), f"{where}Batch"))
+            if self._has_ptr_variant(method):
+                variants.append((self._wasm_ptr_method(method), f"{where}Ptr"))
+            if method.has_attribute("packed"):
+                variants.append((self._wasm_packed_method(method), f"{where}Packed"))
+            if method.has_attribute("soa"):
+                variants.append((self._wasm_soa_method(method), f"{where}Columns"))
+            for variant, name in variants:
+                lines.extend(self._guard_js(variant, name))
+            # [async] already settles its promise with the error
+            if method.has_attribute("async"):
+                lines.extend(self._wasm_async_method(cls, method))
 
+        lines.append("private:")
+        if self._has_async_methods(cls):
+            # Queued [async] tasks hold a reference, so deleting the wrapper cannot free it under them
+            lines.append(f"    std::shared_ptr<{cpp_class}> impl_;")
+        else:
+            lines.append(f"    std::unique_ptr<{cpp_class}> impl_;")
+        # Backing storage for [packed] views: kept alive until the next call
+        for method in cls.methods:
+            if method.has_attribute("packed"):
+                inner = TypeMapper.vector_inner(method.return_type)
+                lines.append(f"    std::vector<{inner}> {method.name}Packed_;")
+        # Column storage for [soa] views: one vector per member, kept alive until the next call
+        for inner in self.idl.symbols.soa_types[cls.name]:
+            lines.append(f"    struct {inner}Columns {{")
+            for m in self.idl.symbols.structs[inner].members:
+                lines.append(f"        std::vector<{self._column_element(m.type)}> {m.name};")
+            lines.append("    };")
+        for method in cls.methods:
+            if method.has_attribute("soa"):
+                inner = TypeMapper.vector_inner(method.return_type)
+                lines.append(f"    {inner}Columns {method.name}Columns_;")
         lines.extend([
-            "private:",
-            f"    std::unique_ptr<{cpp_class}> impl_;",
             "};",
             "",
         ])
@@ -117,14 +188,18 @@ class WASMGenerator:
             base_type = method.return_type.rstrip('*').strip()
             return self._is_class_type(base_type)
         return False
+    def _has_async_methods(self, cls: Class) -> bool:
+        return any(m.has_attribute("async") for m in cls.methods)
+
     def _wasm_constructor(self, cls: Class, ctor: Method, cpp_class: str) -> list[str]:
         params = ", ".join(f"{self._wasm_param_type(p)} {p.name}" for p in ctor.params)
         args = ", ".join(p.name for p in ctor.params)
-        
+        make = "std::make_shared" if self._has_async_methods(cls) else "std::make_unique"
+
         lines = [
             f"    bool create({params}) {{",
             "        try {",
-            f"            impl_ = std::make_unique<{cpp_class}>({args});",
+            f"            impl_ = {make}<{cpp_class}>({args});",
             "            return impl_ != nullptr;",
             "        } catch (...) {",
             "            return false;",
@@ -157,26 +232,7 @@ class WASMGenerator:
         # Check if we have uint8_t* parameter that needs special handling
         has_uint8_ptr = any(p.type == "uint8_t" and p.is_pointer for p in method.params)
         
-        # Check for callback parameters
-        callback_params = [(p, self._get_callback_def(p.type)) for p in method.params if self._is_callback_type(p.type)]
-        
-        # Build argument conversion
-        args = []
-        for p in method.params:
-            if p.type == "uint8_t" and p.is_pointer:
-                args.append(f"{p.name}Vec.data()")
-            elif self._is_callback_type(p.type):
-                args.append(f"{p.name}Wrapper")
-            elif self._is_struct_type(p.type) and p.is_pointer:
-                # Struct pointer - pass address of local copy
-                args.append(f"&{p.name}")
-            elif self._is_class_type(p.type) and p.is_pointer:
-                # Class pointer - pass address
-                args.append(f"&{p.name}")
-            else:
-                # References and values pass directly
-                args.append(p.name)
-        args_str = ", ".join(args)
+        args_str = ", ".join(self._wasm_call_arg(p, f"{p.name}Vec.data()") for p in method.params)
 
         lines = [f"    {ret} {method.name}({params}) {{"]
         
@@ -190,28 +246,11 @@ class WASMGenerator:
                     lines.append(f'        {p.name}MemView.call<void>("set", {p.name});')
         
         # Add callback wrappers
-        for param, cb_def in callback_params:
-            if cb_def:
-                cb_params = ", ".join(self._wasm_cb_param_type(cp) for cp in cb_def.params)
-                cb_args = ", ".join(cp.name for cp in cb_def.params)
-                cb_return = self._wasm_cb_return_type(cb_def.return_type)
-                
-                if cb_return == "void":
-                    lines.append(f"        auto {param.name}Wrapper = [{param.name}]({cb_params}) {{")
-                    lines.append(f'            {param.name}({cb_args});')
-                    lines.append("        };")
-                elif cb_return == "bool":
-                    lines.append(f"        auto {param.name}Wrapper = [{param.name}]({cb_params}) -> bool {{")
-                    lines.append(f'            return {param.name}({cb_args}).as<bool>();')
-                    lines.append("        };")
-                else:
-                    lines.append(f"        auto {param.name}Wrapper = [{param.name}]({cb_params}) -> {cb_return} {{")
-                    lines.append(f'            return {param.name}({cb_args}).as<{cb_return}>();')
-                    lines.append("        };")
+        lines.extend(self._wasm_callback_wrappers(method))
         
         if TypeMapper.is_vector(method.return_type):
             inner = TypeMapper.vector_inner(method.return_type)
-            struct_def = next((d for d in self.idl.structs if d.name == inner), None)
+            struct_def = self.idl.symbols.structs.get(inner)
             
             lines.append("        val result = val::array();")
             lines.append("        if (!impl_) return result;")
@@ -253,21 +292,734 @@ class WASMGenerator:
         lines.append("")
         return lines
 
+    def _async_support(self) -> list[str]:
+        """Promise plumbing for [async] methods. With -pthread the call runs on one worker
+        thread and is settled on the main thread; without threads it runs inline."""
+        return [
+            "#include <exception>",
+            "#include <functional>",
+            "#ifdef __EMSCRIPTEN_PTHREADS__",
+            "#include <emscripten/proxying.h>",
+            "#include <pthread.h>",
+            "#include <condition_variable>",
+            "#include <deque>",
+            "#include <mutex>",
+            "#include <thread>",
+            "#endif",
+            "",
+            "namespace {",
+            "",
+            "// A JS promise with its resolve/reject (Module.__idlDeferred); only touched on the main thread",
+            "class AsyncDeferred {",
+            "public:",
+            '    AsyncDeferred() : handle_(val::module_property("__idlDeferred")()) {}',
+            '    val promise() const { return handle_["promise"]; }',
+            '    void resolve() { handle_.call<void>("resolve"); }',
+            "    template <typename T>",
+            '    void resolve(const T& value) { handle_.call<void>("resolve", val(value)); }',
+            "    void reject(const std::string& message) {",
+            '        handle_.call<void>("reject", val::global("Error").new_(message));',
+            "    }",
+            "private:",
+            "    val handle_;",
+            "};",
+            "",
+            "#ifdef __EMSCRIPTEN_PTHREADS__",
+            "// Thread the first [async] call came from; JS values live there",
+            "pthread_t asyncMainThread() {",
+            "    static const pthread_t thread = pthread_self();",
+            "    return thread;",
+            "}",
+            "",
+            "// Runs the [async] calls one at a time, in order, on a single background thread",
+            "class AsyncWorker {",
+            "public:",
+            "    static AsyncWorker& instance() {",
+            "        static AsyncWorker* worker = new AsyncWorker();  // never joined: lives as long as the module",
+            "        return *worker;",
+            "    }",
+            "",
+            "    void post(std::function<void()> task) {",
+            "        {",
+            "            std::lock_guard<std::mutex> lock(mutex_);",
+            "            tasks_.push_back(std::move(task));",
+            "        }",
+            "        ready_.notify_one();",
+            "    }",
+            "",
+            "private:",
+            "    AsyncWorker() { std::thread([this] { run(); }).detach(); }",
+            "",
+            "    void run() {",
+            "        for (;;) {",
+            "            std::function<void()> task;",
+            "            {",
+            "                std::unique_lock<std::mutex> lock(mutex_);",
+            "                ready_.wait(lock, [this] { return !tasks_.empty(); });",
+            "                task = std::move(tasks_.front());",
+            "                tasks_.pop_front();",
+            "            }",
+            "            task();",
+            "        }",
+            "    }",
+            "",
+            "    std::mutex mutex_;",
+            "    std::condition_variable ready_;",
+            "    std::deque<std::function<void()>> tasks_;",
+            "};",
+            "#endif",
+            "",
+            "// Runs fn on the main thread and waits for it: JS callbacks of an [async] call run there",
+            "void onMainThread(const std::function<void()>& fn) {",
+            "#ifdef __EMSCRIPTEN_PTHREADS__",
+            "    if (pthread_equal(pthread_self(), asyncMainThread())) {",
+            "        fn();",
+            "        return;",
+            "    }",
+            "    emscripten_proxy_sync(emscripten_proxy_get_system_queue(), asyncMainThread(),",
+            "                          [](void* arg) { (*static_cast<const std::function<void()>*>(arg))(); },",
+            "                          const_cast<std::function<void()>*>(&fn));",
+            "#else",
+            "    fn();",
+            "#endif",
+            "}",
+            "",
+            "// work runs off the main thread, then settle runs on it. Neither may own a val:",
+            "// JS handles are per thread, so they stay in state that settle frees on the main thread.",
+            "void runAsync(std::function<void()> work, std::function<void()> settle) {",
+            "#ifdef __EMSCRIPTEN_PTHREADS__",
+            "    const pthread_t mainThread = asyncMainThread();",
+            "    AsyncWorker::instance().post([work = std::move(work), settle = std::move(settle), mainThread]() mutable {",
+            "        work();",
+            "        auto* task = new std::function<void()>(std::move(settle));",
+            "        emscripten_proxy_async(emscripten_proxy_get_system_queue(), mainThread, [](void* arg) {",
+            "            auto* settleTask = static_cast<std::function<void()>*>(arg);",
+            "            (*settleTask)();",
+            "            delete settleTask;",
+            "        }, task);",
+            "    });",
+            "#else",
+            "    work();",
+            "    settle();",
+            "#endif",
+            "}",
+            "",
+            "} // namespace",
+            "",
+        ]
+
+    def _wasm_cb_signature(self, cb) -> tuple[list[str], list[str], str]:
+        """(parameter declarations, argument names, return type) of a <param>Wrapper lambda"""
+        if cb.has_attribute("batch"):
+            arrays = [(p.name, p.type, True) for p in cb.params]
+            if cb.return_type != "void":
+                arrays.append(("result", cb.return_type, False))
+            params = [f"{'const ' if is_input else ''}{'int' if t == 'bool' else t}* {n}" for n, t, is_input in arrays]
+            return params + ["int count"], [n for n, _, _ in arrays] + ["count"], "void"
+        params = [self._wasm_cb_param_type(cp) for cp in cb.params]
+        return params, [cp.name for cp in cb.params], self._wasm_cb_return_type(cb.return_type)
+
+    def _wasm_async_method(self, cls: Class, method: Method) -> list[str]:
+        """<method>Async: returns a Promise; the C++ call runs on the async worker thread"""
+        where = f"{cls.name}.{method.name}"
+        params = ", ".join(f"{self._wasm_param_type(p)} {p.name}" for p in method.params)
+        ret = method.return_type
+        callbacks = [(p, self._get_callback_def(p.type)) for p in method.params if self._is_callback_type(p.type)]
+
+        lines = [
+            f"    val {method.name}Async({params}) {{",
+            "        struct Call {",
+            "            AsyncDeferred deferred;",
+        ]
+        for p, cb in callbacks:
+            cb_params, _, cb_ret = self._wasm_cb_signature(cb)
+            lines.append(f"            std::function<{cb_ret}({', '.join(cb_params)})> {p.name};")
+        if ret != "void":
+            lines.append(f"            {self._wasm_return_type(ret)} result{{}};")
+        lines.extend([
+            "            bool failed = false;",
+            "            std::string error;",
+            "        };",
+            "        auto* call = new Call();",
+            "        val promise = call->deferred.promise();",
+            "        if (!impl_) {",
+            f'            call->deferred.reject("{where}: object not created");',
+            "            delete call;",
+            "            return promise;",
+            "        }",
+        ])
+        lines.extend(self._wasm_callback_wrappers(method))
+        for p, _ in callbacks:
+            lines.append(f"        call->{p.name} = {p.name}Wrapper;")
+
+        # Worker-side arguments: values are copied into the task, callbacks hop to the main thread
+        captures = ["call", "impl = impl_"] + [p.name for p in method.params if not self._is_callback_type(p.type)]
+        lines.append(f"        runAsync([{', '.join(captures)}] {{")
+        lines.append("            try {")
+        args = []
+        for p in method.params:
+            if not self._is_callback_type(p.type):
+                args.append(p.name)
+                continue
+            cb = self._get_callback_def(p.type)
+            cb_params, cb_args, cb_ret = self._wasm_cb_signature(cb)
+            forward = f"call->{p.name}({', '.join(cb_args)})"
+            if cb_ret == "void":
+                lines.append(f"                auto {p.name}OnMain = [call]({', '.join(cb_params)}) {{")
+                lines.append(f"                    onMainThread([&] {{ {forward}; }});")
+            else:
+                lines.append(f"                auto {p.name}OnMain = [call]({', '.join(cb_params)}) -> {cb_ret} {{")
+                lines.append(f"                    {cb_ret} value{{}};")
+                lines.append(f"                    onMainThread([&] {{ value = {forward}; }});")
+                lines.append("                    return value;")
+            lines.append("                };")
+            args.append(f"{p.name}OnMain")
+        invoke = f"impl->{method.name}({', '.join(args)})"
+        lines.append(f"                {invoke};" if ret == "void" else f"                call->result = {invoke};")
+        lines.extend([
+            "            } catch (const std::exception& e) {",
+            "                call->failed = true;",
+            "                call->error = e.what();",
+            "            } catch (...) {",
+            "                call->failed = true;",
+            f'                call->error = "{where} failed";',
+            "            }",
+            "        }, [call] {",
+            "            if (call->failed) {",
+            "                call->deferred.reject(call->error);",
+            "            } else {",
+            "                call->deferred.resolve(" + ("" if ret == "void" else "call->result") + ");",
+            "            }",
+            "            delete call;",
+            "        });",
+            "        return promise;",
+            "    }",
+            "",
+        ])
+        return lines
+
+    def _wasm_callback_wrappers(self, method: Method) -> list[str]:
+        """<param>Wrapper lambdas adapting each JS function argument to its C++ callback type"""
+        lines = []
+        callback_params = [(p, self._get_callback_def(p.type)) for p in method.params if self._is_callback_type(p.type)]
+        for param, cb_def in callback_params:
+            if cb_def and cb_def.has_attribute("batch"):
+                lines.extend(self._wasm_batch_callback_wrapper(param, cb_def))
+            elif cb_def:
+                cb_params = ", ".join(self._wasm_cb_param_type(cp) for cp in cb_def.params)
+                cb_args = ", ".join(cp.name for cp in cb_def.params)
+                cb_return = self._wasm_cb_return_type(cb_def.return_type)
+                
+                if cb_return == "void":
+                    lines.append(f"        auto {param.name}Wrapper = [{param.name}]({cb_params}) {{")
+                    lines.append(f'            {param.name}({cb_args});')
+                    lines.append("        };")
+                elif cb_return == "bool":
+                    lines.append(f"        auto {param.name}Wrapper = [{param.name}]({cb_params}) -> bool {{")
+                    lines.append(f'            return {param.name}({cb_args}).as<bool>();')
+                    lines.append("        };")
+                else:
+                    lines.append(f"        auto {param.name}Wrapper = [{param.name}]({cb_params}) -> {cb_return} {{")
+                    lines.append(f'            return {param.name}({cb_args}).as<{cb_return}>();')
+                    lines.append("        };")
+        return lines
+
+    def _wasm_batch_callback_wrapper(self, param: Param, cb) -> list[str]:
+        """Hand the whole batch to JS as typed-array views over the native arrays"""
+        arrays = [(p.name, p.type, True) for p in cb.params]
+        if cb.return_type != "void":
+            arrays.append(("result", cb.return_type, False))
+        c_params = [f"{'const ' if is_input else ''}{'int' if t == 'bool' else t}* {n}" for n, t, is_input in arrays]
+        views = ", ".join(f"val(typed_memory_view(count, {n}))" for n, _, _ in arrays)
+        return [
+            f"        auto {param.name}Wrapper = [{param.name}]({', '.join(c_params + ['int count'])}) {{",
+            f'            val::module_property("__{cb.name}Batch")({param.name}, {views});',
+            "        };",
+        ]
+
+    def _js_batch_callback(self, cb) -> list[str]:
+        """Runs a per-element JS callback over one batch, unless it supplies invokeBatch"""
+        arrays = [p.name for p in cb.params] + (["result"] if cb.return_type != "void" else [])
+        call = f"fn({', '.join(f'{p.name}[i]' for p in cb.params)})"
+        if cb.return_type == "bool":
+            call = f"result[i] = {call} ? 1 : 0"
+        elif cb.return_type != "void":
+            call = f"result[i] = {call}"
+        return [
+            f"/** {cb.name} is [batch]: views over the native arrays, valid only during the call */",
+            f"Module['__{cb.name}Batch'] = function (fn, {', '.join(arrays)}) {{",
+            "    if (typeof fn.invokeBatch === 'function') {",
+            f"        fn.invokeBatch({', '.join(arrays)});",
+            "        return;",
+            "    }",
+            f"    for (let i = 0; i < {cb.params[0].name}.length; i++) {{",
+            f"        {call};",
+            "    }",
+            "};",
+            "",
+        ]
+
+    def _wasm_call_arg(self, p: Param, byte_arg: str) -> str:
+        """Argument expression passed to the C++ implementation"""
+        if self._is_byte_pointer(p):
+            return byte_arg
+        if self._is_callback_type(p.type):
+            return f"{p.name}Wrapper"
+        if (self._is_struct_type(p.type) or self._is_class_type(p.type)) and p.is_pointer:
+            # Struct/class pointer - pass address of local copy
+            return f"&{p.name}"
+        # References and values pass directly
+        return p.name
+
+    def _is_byte_pointer(self, p: Param) -> bool:
+        return p.type == "uint8_t" and p.is_pointer
+
+    def _has_ptr_variant(self, method: Method) -> bool:
+        return (any(self._is_byte_pointer(p) for p in method.params)
+                and not any(self._is_callback_type(p.type) for p in method.params))
+
+    def _wasm_ptr_method(self, method: Method) -> list[str]:
+        """Ptr variant: byte buffers are heap addresses from Module._malloc, no copy"""
+        ret = self._wasm_return_type(method.return_type)
+        params = ", ".join(
+            f"uintptr_t {p.name}" if self._is_byte_pointer(p) else f"{self._wasm_param_type(p)} {p.name}"
+            for p in method.params
+        )
+        args = ", ".join(
+            self._wasm_call_arg(p, f"reinterpret_cast<const uint8_t*>({p.name})") for p in method.params
+        )
+        return [
+            f"    {ret} {method.name}Ptr({params}) {{",
+            f"        if (!impl_) return {self._wasm_default(method.return_type)};",
+            f"        return impl_->{method.name}({args});",
+            "    }",
+            "",
+        ]
+
+    def _wasm_packed_method(self, method: Method) -> list[str]:
+        """Packed variant: a Uint8Array view over the result kept in the wrapper"""
+        params = ", ".join(f"{self._wasm_param_type(p)} {p.name}" for p in method.params)
+        args = ", ".join(self._wasm_call_arg(p, p.name) for p in method.params)
+        storage = f"{method.name}Packed_"
+        return [
+            f"    val {method.name}Packed({params}) {{",
+            f"        if (!impl_) {storage}.clear();",
+            f"        else {storage} = impl_->{method.name}({args});",
+            f"        return val(typed_memory_view({storage}.size() * sizeof({storage}[0]),",
+            f"                                     reinterpret_cast<const uint8_t*>({storage}.data())));",
+            "    }",
+            "",
+        ]
+
+    def _has_streams(self) -> bool:
+        return any(self.idl.symbols.stream_types.values())
+
+    def _stream_reader_name(self, cls: Class, inner: str) -> str:
+        return f"{cls.name}{inner}Stream"
+
+    def _stream_reader(self, cls: Class, inner: str) -> list[str]:
+        """Holds a stream<T> pull source for JS; Module.__idlStream drives it as an async iterator"""
+        reader = f"Wasm{self._stream_reader_name(cls, inner)}"
+        source = TypeMapper.to_cpp(f"stream<{inner}>")
+        lines = [
+            f"class {reader} {{",
+            "public:",
+            f"    explicit {reader}({source} source) : source_(std::move(source)) {{}}",
+            "",
+            "    // Copies up to max items into a new JS array (a typed array for numbers); empty at the end",
+            "    val next(int max) {",
+            "        if (!source_ || max <= 0) return val::array();",
+            f"        std::vector<{TypeMapper.to_cpp(inner)}> items(static_cast<size_t>(max));",
+            "        size_t n = std::min(source_(items.data(), items.size()), items.size());",
+            "        if (n == 0) source_ = nullptr;  // drop the source's captured state at the end",
+        ]
+        struct = self.idl.symbols.structs.get(inner)
+        if struct:
+            lines.append("        val chunk = val::array();")
+            lines.append("        for (size_t i = 0; i < n; ++i) {")
+            lines.append("            val obj = val::object();")
+            for m in struct.members:
+                lines.append(f'            obj.set("{m.name}", items[i].{m.name});')
+            lines.append('            chunk.call<void>("push", obj);')
+            lines.append("        }")
+            lines.append("        return chunk;")
+        else:
+            lines.append('        return val(typed_memory_view(n, items.data())).call<val>("slice");')
+        lines.append("    }")
+        start = lines.index("    val next(int max) {")
+        lines[start:] = self._guard_js(lines[start:] + [""], f"{cls.name}.{inner}Stream.next")
+        lines.extend([
+            "private:",
+            f"    {source} source_;",
+            "};",
+            "",
+        ])
+        return lines
+
+    def _wasm_stream_method(self, cls: Class, method: Method) -> list[str]:
+        """stream<T> method: an async iterator over a reader; nothing runs until it is first pulled"""
+        inner = TypeMapper.stream_inner(method.return_type)
+        reader = f"Wasm{self._stream_reader_name(cls, inner)}"
+        params = ", ".join(f"{self._wasm_param_type(p)} {p.name}" for p in method.params)
+        args = ", ".join(self._wasm_call_arg(p, p.name) for p in method.params)
+        return [
+            f"    val {method.name}({params}) {{",
+            f"        {reader} reader(impl_ ? impl_->{method.name}({args}) : nullptr);",
+            '        return val::module_property("__idlStream")(reader);',
+            "    }",
+            "",
+        ]
+
+    def _column_element(self, idl_type: str) -> str:
+        """Typed array element for a [soa] column: Int32Array, Uint8Array (bool), Float32/64Array"""
+        if idl_type == "bool":
+            return "uint8_t"
+        return "int" if self._is_enum_type(idl_type) else TypeMapper.to_cpp(idl_type)
+
+    def _wasm_soa_method(self, method: Method) -> list[str]:
+        """Columns variant: an object of typed-array views, one per member, over the wrapper's storage"""
+        inner = TypeMapper.vector_inner(method.return_type)
+        members = self.idl.symbols.structs[inner].members
+        params = ", ".join(f"{self._wasm_param_type(p)} {p.name}" for p in method.params)
+        args = ", ".join(self._wasm_call_arg(p, p.name) for p in method.params)
+        storage = f"{method.name}Columns_"
+        lines = [
+            f"    val {method.name}Columns({params}) {{",
+            f"        std::vector<{inner}> items;",
+            f"        if (impl_) items = impl_->{method.name}({args});",
+        ]
+        for m in members:
+            lines.append(f"        {storage}.{m.name}.resize(items.size());")
+        lines.append("        for (size_t i = 0; i < items.size(); ++i) {")
+        for m in members:
+            elem = self._column_element(m.type)
+            value = f"items[i].{m.name}"
+            if elem != TypeMapper.to_cpp(m.type):
+                value = f"static_cast<{elem}>({value})"
+            lines.append(f"            {storage}.{m.name}[i] = {value};")
+        lines.extend([
+            "        }",
+            "        val columns = val::object();",
+            '        columns.set("count", static_cast<int>(items.size()));',
+        ])
+        for m in members:
+            column = f"{storage}.{m.name}"
+            lines.append(f'        columns.set("{m.name}", val(typed_memory_view({column}.size(), {column}.data())));')
+        lines.extend([
+            "        return columns;",
+            "    }",
+            "",
+        ])
+        return lines
+
+    # Little-endian DataView readers for [packed] struct fields: (size, getter)
+    PACKED_FIELDS = {
+        "int": (4, "getInt32"),
+        "int32_t": (4, "getInt32"),
+        "bool": (1, "getUint8"),
+        "float": (4, "getFloat32"),
+        "double": (8, "getFloat64"),
+    }
+
+    def _packed_field(self, idl_type: str):
+        if self._is_enum_type(idl_type):
+            return self.PACKED_FIELDS["int"]
+        return self.PACKED_FIELDS.get(idl_type)
+
+    def _packed_layout(self, struct) -> tuple[list, int]:
+        """Natural-alignment C++ layout: ([(member, offset, field spec)], sizeof)"""
+        return self.idl.symbols.struct_layout(struct.name, self._packed_field, "[packed] struct")
+
+    def _packed_structs(self) -> list:
+        """Structs returned as vector<T> by a [packed] method, in IDL order"""
+        names = set()
+        for cls in self.idl.classes:
+            for method in cls.methods:
+                if not method.has_attribute("packed"):
+                    continue
+                inner = TypeMapper.vector_inner(method.return_type) if TypeMapper.is_vector(method.return_type) else None
+                if not inner or not self._is_struct_type(inner):
+                    raise ValueError(f"[packed] requires a vector<struct> return type ({cls.name}.{method.name})")
+                if any(self._is_callback_type(p.type) or self._is_byte_pointer(p) for p in method.params):
+                    raise ValueError(f"[packed] does not support callback or buffer parameters ({cls.name}.{method.name})")
+                names.add(inner)
+        return [s for s in self.idl.structs if s.name in names]
+
+    def _packed_layout_asserts(self) -> list[str]:
+        """Compile-time check that the generated JS views match the C++ layout"""
+        lines = []
+        for struct in self._packed_structs():
+            fields, size = self._packed_layout(struct)
+            view = f"{struct.name}View"
+            lines.append(f'static_assert(sizeof({struct.name}) == {size}, "{view} stride does not match {struct.name}");')
+            for m, offset, _ in fields:
+                lines.append(f'static_assert(offsetof({struct.name}, {m.name}) == {offset}, "{view} offset of {m.name} does not match");')
+        if lines:
+            lines.append("")
+        return lines
+
+    def generate_post_js(self) -> str:
+        """JS linked with --post-js: heap buffers for Ptr methods and [packed] struct views"""
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            "// Linked with --post-js; runs inside the module factory where Module is in scope.",
+            "",
+            "/**",
+            " * Current HEAPU8. With -pthread the heap is a SharedArrayBuffer that growth replaces",
+            " * rather than detaches; when another thread grew it, this thread's HEAPU8 still covers",
+            " * only the old size and is refreshed here.",
+            " */",
+            "function heapU8() {",
+            "    const memory = typeof wasmMemory !== 'undefined' ? wasmMemory : null;",
+            "    if (memory && Module['HEAPU8'].buffer !== memory.buffer) {",
+            "        if (typeof updateMemoryViews === 'function') updateMemoryViews();",
+            "        if (Module['HEAPU8'].buffer !== memory.buffer) Module['HEAPU8'] = new Uint8Array(memory.buffer);",
+            "    }",
+            "    return Module['HEAPU8'];",
+            "}",
+            "Module['heapU8'] = heapU8;",
+            "",
+            "/** Reusable _malloc-backed buffer; pass .ptr to the generated Ptr methods */",
+            "class HeapBuffer {",
+            "    constructor(size) {",
+            "        this.ptr = 0;",
+            "        this.size = 0;",
+            "        this.reserve(size || 0);",
+            "    }",
+            "",
+            "    /** Grow to at least size bytes; the address changes only when it grows */",
+            "    reserve(size) {",
+            "        if (size <= this.size) return this;",
+            "        if (this.ptr) Module['_free'](this.ptr);",
+            "        this.ptr = Module['_malloc'](size);",
+            "        if (!this.ptr) throw new RangeError('HeapBuffer: _malloc(' + size + ') failed');",
+            "        this.size = size;",
+            "        return this;",
+            "    }",
+            "",
+            "    /** Fresh view each call: heap growth detaches (or, when shared, outgrows) previous arrays */",
+            "    bytes(length) {",
+            "        const n = length === undefined ? this.size : length;",
+            "        return heapU8().subarray(this.ptr, this.ptr + n);",
+            "    }",
+            "",
+            "    set(src) {",
+            "        this.reserve(src.length);",
+            "        heapU8().set(src, this.ptr);",
+            "        return this;",
+            "    }",
+            "",
+            "    free() {",
+            "        if (this.ptr) Module['_free'](this.ptr);",
+            "        this.ptr = 0;",
+            "        this.size = 0;",
+            "    }",
+            "}",
+            "Module['HeapBuffer'] = HeapBuffer;",
+            "",
+        ]
+        if self._has_streams():
+            lines.extend([
+                "/** Items copied out of the module per step of a stream<T> iterator */",
+                "const IDL_STREAM_CHUNK = 1024;",
+                "",
+                "// Deletes the reader of an iterator that was dropped before it finished",
+                "const idlStreamRegistry = typeof FinalizationRegistry !== 'undefined'",
+                "    ? new FinalizationRegistry((reader) => reader.delete()) : null;",
+                "",
+                "/**",
+                " * Async iterator over the reader returned by a stream<T> method, for use with for await.",
+                " * The reader is deleted once the stream ends, on return() (leaving the loop early) or,",
+                " * where FinalizationRegistry exists, after an unfinished iterator is collected.",
+                " */",
+                "Module['__idlStream'] = function (reader) {",
+                "    let chunk = [];",
+                "    let pos = 0;",
+                "    let open = true;",
+                "    const close = () => {",
+                "        if (!open) return;",
+                "        open = false;",
+                "        chunk = [];",
+                "        if (idlStreamRegistry) idlStreamRegistry.unregister(iterator);",
+                "        reader.delete();",
+                "    };",
+                "    const iterator = {",
+                "        [Symbol.asyncIterator]() {",
+                "            return this;",
+                "        },",
+                "        async next() {",
+                "            if (pos === chunk.length && open) {",
+                "                try {",
+                "                    chunk = reader.next(IDL_STREAM_CHUNK);",
+                "                } catch (e) {",
+                "                    close();",
+                "                    throw e;",
+                "                }",
+                "                pos = 0;",
+                "                if (chunk.length === 0) close();",
+                "            }",
+                "            if (pos < chunk.length) return { value: chunk[pos++], done: false };",
+                "            return { value: undefined, done: true };",
+                "        },",
+                "        async return() {",
+                "            close();",
+                "            return { value: undefined, done: true };",
+                "        },",
+                "    };",
+                "    if (idlStreamRegistry) idlStreamRegistry.register(iterator, reader, iterator);",
+                "    return iterator;",
+                "};",
+                "",
+            ])
+        if self.idl.symbols.has_async:
+            lines.extend([
+                "/** Promise plus its resolve/reject, created by the generated <method>Async bindings */",
+                "Module['__idlDeferred'] = function () {",
+                "    const deferred = {};",
+                "    deferred.promise = new Promise((resolve, reject) => {",
+                "        deferred.resolve = resolve;",
+                "        deferred.reject = reject;",
+                "    });",
+                "    return deferred;",
+                "};",
+                "",
+            ])
+        for struct in self._packed_structs():
+            lines.extend(self._js_struct_view(struct))
+        for cb in self.idl.callbacks:
+            if cb.has_attribute("batch"):
+                lines.extend(self._js_batch_callback(cb))
+        return "\n".join(lines)
+
+    def _js_struct_view(self, struct) -> list[str]:
+        """Flyweight over the Uint8Array returned by a <method>Packed call"""
+        fields, size = self._packed_layout(struct)
+        view = f"{struct.name}View"
+        lines = [
+            f"/** Allocation-free reader over {struct.name} elements in native layout */",
+            f"class {view} {{",
+            "    constructor(bytes) {",
+            "        this.reset(bytes || null);",
+            "    }",
+            "",
+            "    reset(bytes) {",
+            "        this.bytes = bytes;",
+            "        this.view = bytes ? new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength) : null;",
+            f"        this.count = bytes ? Math.floor(bytes.byteLength / {view}.STRIDE) : 0;",
+            "        return this;",
+            "    }",
+            "",
+            "    size() {",
+            "        return this.count;",
+            "    }",
+            "",
+        ]
+        for m, offset, (_, getter) in fields:
+            lines.append(f"    {m.name}(i) {{")
+            if m.type == "bool":
+                lines.append(f"        return this.view.{getter}(i * {view}.STRIDE + {offset}) !== 0;")
+            else:
+                lines.append(f"        return this.view.{getter}(i * {view}.STRIDE + {offset}, true);")
+            lines.append("    }")
+            lines.append("")
+        fields_obj = ", ".join(f"{m.name}: this.{m.name}(i)" for m, _, _ in fields)
+        lines.extend([
+            "    /** Materialize element i as a plain object (allocates) */",
+            "    get(i) {",
+            f"        return {{ {fields_obj} }};",
+            "    }",
+            "}",
+            f"{view}.STRIDE = {size};",
+            f"Module['{view}'] = {view};",
+            "",
+        ])
+        return lines
+
+    # Numeric batch element types -> JS typed array returned to the caller
+    TYPED_ARRAYS = {
+        "int": ("int", "Int32Array"),
+        "bool": ("uint8_t", "Uint8Array"),
+        "float": ("float", "Float32Array"),
+        "double": ("double", "Float64Array"),
+    }
+
+    def _wasm_batch_method(self, method: Method) -> list[str]:
+        """Batch variant: JS arrays (or typed arrays) in, one typed array or array out"""
+        has_out = method.return_type != "void"
+        typed = self.TYPED_ARRAYS.get(method.return_type)
+        ret = "val" if has_out else "void"
+        params = ", ".join(f"val {p.name}" for p in method.params)
+
+        lines = [f"    {ret} {method.name}Batch({params}) {{"]
+        fail = "return val::array();" if has_out else "return;"
+        lines.append(f"        if (!impl_) {fail}")
+        for p in method.params:
+            if p.type in self.TYPED_ARRAYS and p.type != "bool":
+                lines.append(f"        auto cpp_{p.name} = convertJSArrayToNumberVector<{TypeMapper.to_cpp(p.type)}>({p.name});")
+            else:
+                lines.append(f"        auto cpp_{p.name} = vecFromJSArray<{TypeMapper.to_cpp(p.type)}>({p.name});")
+        if method.params:
+            lines.append(f"        const size_t batchSize = cpp_{method.params[0].name}.size();")
+            for p in method.params[1:]:
+                lines.append(f"        if (cpp_{p.name}.size() != batchSize) {fail}")
+        else:
+            lines.append("        const size_t batchSize = 0;")
+
+        call = f"impl_->{method.name}({', '.join(f'cpp_{p.name}[i]' for p in method.params)})"
+        if method.has_attribute("kernel"):
+            # <method>Batch takes C element arrays; std::vector<bool> has no data(), so bools become ints
+            kernel_args = []
+            for p in method.params:
+                if p.type == "bool":
+                    lines.append(f"        std::vector<int> kernel_{p.name}(cpp_{p.name}.begin(), cpp_{p.name}.end());")
+                    kernel_args.append(f"kernel_{p.name}.data()")
+                else:
+                    kernel_args.append(f"cpp_{p.name}.data()")
+            if has_out:
+                c_out = "int" if method.return_type == "bool" else TypeMapper.to_cpp(method.return_type)
+                lines.append(f"        std::vector<{c_out}> kernelOut(batchSize);")
+                kernel_args.append("kernelOut.data()")
+            kernel_args.append("static_cast<int>(batchSize)")
+            lines.append(f"        impl_->{method.name}Batch({', '.join(kernel_args)});")
+            call = "kernelOut[i]"
+        if not has_out:
+            if not method.has_attribute("kernel"):
+                lines.append("        for (size_t i = 0; i < batchSize; ++i) {")
+                lines.append(f"            {call};")
+                lines.append("        }")
+        else:
+            elem = typed[0] if typed else TypeMapper.to_cpp(method.return_type)
+            lines.append(f"        std::vector<{elem}> out(batchSize);")
+            lines.append("        for (size_t i = 0; i < batchSize; ++i) {")
+            lines.append(f"            out[i] = {call};")
+            lines.append("        }")
+            if typed:
+                lines.append(f'        return val::global("{typed[1]}").new_(typed_memory_view(out.size(), out.data()));')
+            else:
+                lines.append("        return val::array(out);")
+        lines.append("    }")
+        lines.append("")
+        return lines
+
     def _is_callback_type(self, type_name: str) -> bool:
         """Check if type is a callback"""
-        return any(cb.name == type_name for cb in self.idl.callbacks)
+        return type_name in self.idl.symbols.callbacks
 
     def _is_struct_type(self, type_name: str) -> bool:
         """Check if type is a struct"""
-        return any(s.name == type_name for s in self.idl.structs)
+        return type_name in self.idl.symbols.structs
 
     def _is_class_type(self, type_name: str) -> bool:
         """Check if type is a class"""
-        return any(c.name == type_name for c in self.idl.classes)
+        return type_name in self.idl.symbols.classes
+
+    def _is_enum_type(self, type_name: str) -> bool:
+        """Check if type is an enum"""
+        return type_name in self.idl.symbols.enums
 
     def _get_callback_def(self, type_name: str):
         """Get callback definition by name"""
-        return next((cb for cb in self.idl.callbacks if cb.name == type_name), None)
+        return self.idl.symbols.callbacks.get(type_name)
 
     def _wasm_cb_param_type(self, param: Param) -> str:
         """Get C++ type for callback parameter"""
@@ -347,13 +1099,16 @@ class WASMGenerator:
 
     def _class_bindings(self, cls: Class) -> list[str]:
         wasm_class = f"Wasm{cls.name}"
-        lines = [
-            f"EMSCRIPTEN_BINDINGS({self.namespace}_{cls.name.lower()}) {{",
-            f'    class_<{wasm_class}>("{cls.name}")',
-            "        .constructor<>()",
-        ]
+        lines = [f"EMSCRIPTEN_BINDINGS({self.namespace}_{cls.name.lower()}) {{"]
+        for inner in self.idl.symbols.stream_types[cls.name]:
+            name = self._stream_reader_name(cls, inner)
+            lines.append(f'    class_<Wasm{name}>("{name}")')
+            lines.append(f'        .function("next", &Wasm{name}::next)')
+            lines.append("    ;")
+        lines.append(f'    class_<{wasm_class}>("{cls.name}")')
+        lines.append("        .constructor<>()")
 
-        ctor = next((m for m in cls.methods if m.is_constructor), None)
+        ctor = self.idl.symbols.constructors[cls.name]
         if ctor:
             lines.append(f'        .function("create", &{wasm_class}::create)')
 
@@ -371,6 +1126,16 @@ class WASMGenerator:
             if self._returns_class_pointer(method):
                 continue
             lines.append(f'        .function("{method.name}", &{wasm_class}::{method.name})')
+            if method.has_attribute("batch"):
+                lines.append(f'        .function("{method.name}Batch", &{wasm_class}::{method.name}Batch)')
+            if method.has_attribute("async"):
+                lines.append(f'        .function("{method.name}Async", &{wasm_class}::{method.name}Async)')
+            if self._has_ptr_variant(method):
+                lines.append(f'        .function("{method.name}Ptr", &{wasm_class}::{method.name}Ptr)')
+            if method.has_attribute("packed"):
+                lines.append(f'        .function("{method.name}Packed", &{wasm_class}::{method.name}Packed)')
+            if method.has_attribute("soa"):
+                lines.append(f'        .function("{method.name}Columns", &{wasm_class}::{method.name}Columns)')
 
         lines.append("    ;")
         lines.append("}")
@@ -0,0 +1,769 @@
+"""Wire Generator - generates fixed-layout little-endian codecs for IDL structs, enums and vectors"""
+
+from typing import Optional
+from .types import ParsedIDL, Struct, Enum, Member
+from .type_mapper import TypeMapper
+
+
+class WireGenerator:
+    """Generates matching encoders and decoders in C (header-only), Java, Python and JavaScript.
+
+    Wire format, identical in every language:
+      scalar  little-endian; bool is one byte, enums are int32
+      struct  members in IDL order with no padding, <Struct>_WIRE_SIZE bytes
+      array   uint32 count, then count records back to back
+      frame   uint32 payload size, then the payload (for streams carrying several messages)
+
+    Structs whose C layout already equals the wire layout are copied with one memcpy per
+    array on little-endian hosts, and decoded with one buffer copy in Python."""
+
+    # IDL scalar -> (wire size, kind): i signed, u unsigned, f floating point, b bool
+    SCALARS = {
+        "bool": (1, "b"),
+        "int8_t": (1, "i"),
+        "uint8_t": (1, "u"),
+        "int16_t": (2, "i"),
+        "uint16_t": (2, "u"),
+        "int": (4, "i"),
+        "int32_t": (4, "i"),
+        "uint32_t": (4, "u"),
+        "int64_t": (8, "i"),
+        "uint64_t": (8, "u"),
+        "float": (4, "f"),
+        "double": (8, "f"),
+    }
+
+    # IDL member type -> (Java field type, ByteBuffer put, ByteBuffer get); the types Types.java uses
+    JAVA_FIELDS = {
+        "int": ("int", "putInt", "getInt"),
+        "float": ("float", "putFloat", "getFloat"),
+        "double": ("double", "putDouble", "getDouble"),
+        "uint8_t": ("byte", "put", "get"),
+    }
+
+    PY_CTYPES = {
+        "bool": "c_bool", "int8_t": "c_int8", "uint8_t": "c_uint8", "int16_t": "c_int16",
+        "uint16_t": "c_uint16", "int": "c_int32", "int32_t": "c_int32", "uint32_t": "c_uint32",
+        "int64_t": "c_int64", "uint64_t": "c_uint64", "float": "c_float", "double": "c_double",
+    }
+
+    JS_VIEWS = {
+        "bool": "Uint8", "int8_t": "Int8", "uint8_t": "Uint8", "int16_t": "Int16", "uint16_t": "Uint16",
+        "int": "Int32", "int32_t": "Int32", "uint32_t": "Uint32", "int64_t": "BigInt64",
+        "uint64_t": "BigUint64", "float": "Float32", "double": "Float64",
+    }
+
+    def __init__(self, idl: ParsedIDL, namespace: str):
+        self.idl = idl
+        self.namespace = namespace
+        self._sizes: dict[str, Optional[int]] = {}
+
+    # ── Layout ──────────────────────────────────────────────────────
+
+    def wire_size(self, idl_type: str) -> Optional[int]:
+        """Encoded size of a scalar, enum or struct, or None when it has no fixed layout
+        (string, vector, class or callback members, or no members at all)"""
+        if idl_type in self.SCALARS:
+            return self.SCALARS[idl_type][0]
+        if idl_type in self.idl.symbols.enums:
+            return 4
+        struct = self.idl.symbols.structs.get(idl_type)
+        if struct is None:
+            return None
+        if idl_type not in self._sizes:
+            self._sizes[idl_type] = None  # a struct containing itself has no fixed size
+            sizes = [self.wire_size(m.type) for m in struct.members]
+            self._sizes[idl_type] = None if None in sizes or not sizes else sum(sizes)
+        return self._sizes[idl_type]
+
+    def structs(self) -> list[Struct]:
+        """Structs with a fixed wire layout, in IDL order"""
+        return [s for s in self.idl.structs if self.wire_size(s.name) is not None]
+
+    def skipped_structs(self) -> list[Struct]:
+        return [s for s in self.idl.structs if self.wire_size(s.name) is None]
+
+    def _fields(self, struct: Struct) -> list[tuple[Member, int]]:
+        """(member, wire offset) pairs"""
+        fields, offset = [], 0
+        for m in struct.members:
+            fields.append((m, offset))
+            offset += self.wire_size(m.type)
+        return fields
+
+    def _is_memcpy_layout(self, idl_type: str) -> bool:
+        """True when the C struct's natural layout is the wire layout: no padding and no bool
+        (a C API bool is an int, one byte on the wire). The generated code still checks sizeof."""
+        if idl_type in self.SCALARS:
+            return idl_type != "bool"
+        if idl_type in self.idl.symbols.enums:
+            return True
+        struct = self.idl.symbols.structs[idl_type]
+        offset, align = 0, 1
+        for m, wire_offset in self._fields(struct):
+            if not self._is_memcpy_layout(m.type):
+                return False
+            size = self.wire_size(m.type)
+            member_align = size if m.type in self.SCALARS or m.type in self.idl.symbols.enums \
+                else self._struct_align(m.type)
+            offset = (offset + member_align - 1) // member_align * member_align
+            if offset != wire_offset:
+                return False
+            offset += size
+            align = max(align, member_align)
+        return (offset + align - 1) // align * align == self.wire_size(idl_type)
+
+    def _struct_align(self, name: str) -> int:
+        struct = self.idl.symbols.structs[name]
+        return max((self.wire_size(m.type) if m.type in self.SCALARS or m.type in self.idl.symbols.enums
+                    else self._struct_align(m.type)) for m in struct.members) if struct.members else 1
+
+    def _vector_scalars(self) -> list[str]:
+        """Scalar element types of vector<T> parameters and returns, which get array codecs too"""
+        found = set()
+        for cls in self.idl.classes:
+            for method in cls.methods:
+                for t in [method.return_type, *(p.type for p in method.params)]:
+                    if TypeMapper.is_vector(t) and TypeMapper.vector_inner(t) in self.SCALARS:
+                        found.add(TypeMapper.vector_inner(t))
+        return sorted(found)
+
+    # ── C ───────────────────────────────────────────────────────────
+
+    def generate_c(self, types_header: str) -> str:
+        ns = self.namespace
+        NS = ns.upper()
+        guard = f"{NS}_WIRE_H"
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// Fixed-layout little-endian wire format for the {ns} structs and enums:",
+            "//   scalar  little-endian; bool is one byte, enums are int32",
+            "//   struct  members in IDL order, no padding: <Struct>_WIRE_SIZE bytes",
+            "//   array   uint32 count, then count records",
+            "//   frame   uint32 payload size, then the payload",
+            "// Header-only: every function is static inline and usable from C and C++.",
+            f"#ifndef {guard}",
+            f"#define {guard}",
+            "",
+            f'#include "{types_header}"',
+            "",
+            "#include <stdint.h>",
+            "#include <string.h>",
+            "",
+            "#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_WIN32)",
+            f"#define {NS}_WIRE_HOST_LE 1",
+            "#else",
+            f"#define {NS}_WIRE_HOST_LE 0",
+            "#endif",
+            "",
+            "#ifdef __cplusplus",
+            'extern "C" {',
+            "#endif",
+            "",
+            *self._c_primitives(),
+        ]
+        skipped = self.skipped_structs()
+        if skipped:
+            lines.append("// No fixed layout (string, vector or class members): "
+                         + ", ".join(s.name for s in skipped))
+            lines.append("")
+        for enum in self.idl.enums:
+            lines.extend(self._c_enum(enum))
+            lines.extend(self._c_array(enum.name, enum.name, enum.name))
+        for struct in self.structs():
+            lines.extend(self._c_struct(struct))
+            lines.extend(self._c_array(struct.name, struct.name, struct.name))
+        for scalar in self._vector_scalars():
+            lines.extend(self._c_array(f"{ns}_{scalar}", TypeMapper.to_c(scalar), scalar))
+        lines.extend(self._c_frames())
+        lines.extend([
+            "#ifdef __cplusplus",
+            "}",
+            "#endif",
+            "",
+            f"#endif // {guard}",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _c_primitives(self) -> list[str]:
+        ns = self.namespace
+        lines = []
+        for bits in (16, 32, 64):
+            n = bits // 8
+            put = " ".join(f"p[{i}] = (uint8_t)(v >> {8 * i});" if i else "p[0] = (uint8_t)v;"
+                           for i in range(n))
+            get = " | ".join(f"((uint{bits}_t)p[{i}] << {8 * i})" if i else f"(uint{bits}_t)p[0]"
+                             for i in range(n))
+            lines.extend([
+                f"static inline void {ns}_wire_put{bits}(uint8_t* p, uint{bits}_t v) {{ {put} }}",
+                f"static inline uint{bits}_t {ns}_wire_get{bits}(const uint8_t* p) {{ return {get}; }}",
+            ])
+        lines.extend([
+            f"static inline void {ns}_wire_putf32(uint8_t* p, float v) "
+            f"{{ uint32_t u; memcpy(&u, &v, 4); {ns}_wire_put32(p, u); }}",
+            f"static inline float {ns}_wire_getf32(const uint8_t* p) "
+            f"{{ uint32_t u = {ns}_wire_get32(p); float v; memcpy(&v, &u, 4); return v; }}",
+            f"static inline void {ns}_wire_putf64(uint8_t* p, double v) "
+            f"{{ uint64_t u; memcpy(&u, &v, 8); {ns}_wire_put64(p, u); }}",
+            f"static inline double {ns}_wire_getf64(const uint8_t* p) "
+            f"{{ uint64_t u = {ns}_wire_get64(p); double v; memcpy(&v, &u, 8); return v; }}",
+            "",
+        ])
+        return lines
+
+    def _c_put(self, idl_type: str, value: str, at: str) -> str:
+        """Statement writing one value of idl_type to the bytes at `at`"""
+        ns = self.namespace
+        if idl_type in self.idl.symbols.structs:
+            return f"{idl_type}_wireEncode(&{value}, {at});"
+        if idl_type in self.idl.symbols.enums:
+            return f"{ns}_wire_put32({at}, (uint32_t)(int32_t){value});"
+        size, kind = self.SCALARS[idl_type]
+        if kind == "b":
+            return f"*({at}) = (uint8_t)({value} != 0);"
+        if kind == "f":
+            return f"{ns}_wire_putf{size * 8}({at}, {value});"
+        if size == 1:
+            return f"*({at}) = (uint8_t){value};"
+        return f"{ns}_wire_put{size * 8}({at}, (uint{size * 8}_t){value});"
+
+    def _c_get(self, idl_type: str, target: str, at: str) -> str:
+        """Statement reading one value of idl_type from the bytes at `at` into target"""
+        ns = self.namespace
+        if idl_type in self.idl.symbols.structs:
+            return f"{idl_type}_wireDecode({at}, &{target});"
+        if idl_type in self.idl.symbols.enums:
+            return f"{target} = ({idl_type})(int32_t){ns}_wire_get32({at});"
+        size, kind = self.SCALARS[idl_type]
+        c_type = TypeMapper.to_c(idl_type)
+        if kind == "b":
+            return f"{target} = *({at}) != 0;"
+        if kind == "f":
+            return f"{target} = {ns}_wire_getf{size * 8}({at});"
+        if size == 1:
+            return f"{target} = ({c_type})*({at});"
+        signed = f"(int{size * 8}_t)" if kind == "i" else ""
+        return f"{target} = ({c_type}){signed}{ns}_wire_get{size * 8}({at});"
+
+    def _c_enum(self, enum: Enum) -> list[str]:
+        return [
+            f"#define {enum.name}_WIRE_SIZE 4",
+            f"static inline void {enum.name}_wireEncode(const {enum.name}* value, uint8_t* out) "
+            f"{{ {self._c_put(enum.name, '*value', 'out')} }}",
+            f"static inline void {enum.name}_wireDecode(const uint8_t* in, {enum.name}* value) "
+            f"{{ {self._c_get(enum.name, '*value', 'in')} }}",
+            "",
+        ]
+
+    def _c_struct(self, struct: Struct) -> list[str]:
+        name = struct.name
+        lines = [
+            f"#define {name}_WIRE_SIZE {self.wire_size(name)}",
+            "",
+            f"static inline void {name}_wireEncode(const {name}* value, uint8_t* out) {{",
+        ]
+        for m, offset in self._fields(struct):
+            lines.append(f"    {self._c_put(m.type, f'value->{m.name}', self._at('out', offset))}")
+        lines.append("}")
+        lines.append("")
+        lines.append(f"static inline void {name}_wireDecode(const uint8_t* in, {name}* value) {{")
+        for m, offset in self._fields(struct):
+            lines.append(f"    {self._c_get(m.type, f'value->{m.name}', self._at('in', offset))}")
+        lines.append("}")
+        lines.append("")
+        return lines
+
+    @staticmethod
+    def _at(base: str, offset: int) -> str:
+        return f"{base} + {offset}" if offset else base
+
+    def _c_array(self, prefix: str, c_type: str, idl_type: str) -> list[str]:
+        """<prefix>_wireEncodeArray / _wireDecodeArray, with a bulk memcpy when layouts match"""
+        ns = self.namespace
+        size = self.wire_size(idl_type)
+        size_expr = f"{prefix}_WIRE_SIZE" if idl_type not in self.SCALARS else str(size)
+        if idl_type in self.SCALARS:
+            put = self._c_put(idl_type, "items[i]", f"out + 4 + i * {size}")
+            get = self._c_get(idl_type, "out[i]", f"data + 4 + i * {size}")
+        else:
+            put = f"{prefix}_wireEncode(&items[i], out + 4 + i * {size_expr});"
+            get = f"{prefix}_wireDecode(data + 4 + i * {size_expr}, &out[i]);"
+        bulk = self._is_memcpy_layout(idl_type)
+        lines = [
+            "/* Writes count items as a wire array. Returns the bytes written, the bytes needed",
+            "   when out is NULL, or -1 when count is negative or capacity too small. */",
+            f"static inline int {prefix}_wireEncodeArray(const {c_type}* items, int count, uint8_t* out, int capacity) {{",
+            f"    if (count < 0 || count > (INT32_MAX - 4) / {size_expr}) return -1;",
+            f"    const int needed = 4 + count * {size_expr};",
+            "    if (!out) return needed;",
+            "    if (capacity < needed) return -1;",
+            f"    {ns}_wire_put32(out, (uint32_t)count);",
+        ]
+        if bulk:
+            lines.extend([
+                f"    if ({ns.upper()}_WIRE_HOST_LE && sizeof({c_type}) == {size_expr}) {{",
+                f"        if (count) memcpy(out + 4, items, (size_t)count * {size_expr});",
+                "        return needed;",
+                "    }",
+            ])
+        lines.extend([
+            f"    for (int i = 0; i < count; ++i) {put}",
+            "    return needed;",
+            "}",
+            "",
+            "/* Reads a wire array into out. Returns the item count, the count alone when out is",
+            "   NULL, or -1 when data is truncated or capacity too small. */",
+            f"static inline int {prefix}_wireDecodeArray(const uint8_t* data, int size, {c_type}* out, int capacity) {{",
+            "    if (!data || size < 4) return -1;",
+            f"    const uint32_t count = {ns}_wire_get32(data);",
+            f"    if (count > (uint32_t)(size - 4) / {size_expr}) return -1;",
+            "    if (!out) return (int)count;",
+            "    if ((uint32_t)capacity < count || capacity < 0) return -1;",
+        ])
+        if bulk:
+            lines.extend([
+                f"    if ({ns.upper()}_WIRE_HOST_LE && sizeof({c_type}) == {size_expr}) {{",
+                f"        if (count) memcpy(out, data + 4, (size_t)count * {size_expr});",
+                "        return (int)count;",
+                "    }",
+            ])
+        lines.extend([
+            f"    for (int i = 0; i < (int)count; ++i) {get}",
+            "    return (int)count;",
+            "}",
+            "",
+        ])
+        return lines
+
+    def _c_frames(self) -> list[str]:
+        ns = self.namespace
+        return [
+            "/* Writes a size-prefixed frame. Returns the bytes written, the bytes needed when out",
+            "   is NULL, or -1 when size is negative or capacity too small. */",
+            f"static inline int {ns}_wireFrameWrite(const uint8_t* payload, int size, uint8_t* out, int capacity) {{",
+            "    if (size < 0 || size > INT32_MAX - 4) return -1;",
+            "    if (!out) return 4 + size;",
+            "    if (capacity < 4 + size) return -1;",
+            f"    {ns}_wire_put32(out, (uint32_t)size);",
+            "    if (size) memcpy(out + 4, payload, (size_t)size);",
+            "    return 4 + size;",
+            "}",
+            "",
+            "/* Finds the first frame in a stream buffer. Returns the bytes it occupies (consume them",
+            "   and call again), 0 when the frame is not complete yet, or -1 for a malformed stream.",
+            "   payload points into data. */",
+            f"static inline int {ns}_wireFrameNext(const uint8_t* data, int size, const uint8_t** payload, int* payload_size) {{",
+            "    if (!data || size < 0 || !payload || !payload_size) return -1;",
+            "    if (size < 4) return 0;",
+            f"    const uint32_t length = {ns}_wire_get32(data);",
+            "    if (length > (uint32_t)(INT32_MAX - 4)) return -1;",
+            "    if ((uint32_t)(size - 4) < length) return 0;",
+            "    *payload = data + 4;",
+            "    *payload_size = (int)length;",
+            "    return 4 + (int)length;",
+            "}",
+            "",
+        ]
+
+    # ── Java ────────────────────────────────────────────────────────
+
+    def _java_supported(self, struct: Struct) -> bool:
+        return all(m.type in self.JAVA_FIELDS or m.type == "bool" or m.type in self.idl.symbols.enums
+                   or (m.type in self.idl.symbols.structs and self._java_supported(self.idl.symbols.structs[m.type]))
+                   for m in struct.members)
+
+    def generate_java(self, java_package: str) -> str:
+        structs = [s for s in self.structs() if self._java_supported(s)]
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"package {java_package};",
+            "",
+            "import java.nio.ByteBuffer;",
+            "import java.nio.ByteOrder;",
+            "import java.util.ArrayList;",
+            "import java.util.List;",
+            "",
+            "/**",
+            f" * Little-endian codecs matching {self.namespace}_wire.h. Every method reads or writes at the",
+            " * buffer's position and advances it; the buffer's byte order is set to little-endian.",
+            " */",
+            "public final class Wire {",
+            "    private Wire() {}",
+            "",
+        ]
+        skipped = [s.name for s in self.idl.structs if s not in structs]
+        if skipped:
+            lines.append(f"    // Not representable: {', '.join(skipped)}")
+            lines.append("")
+        for enum in self.idl.enums:
+            lines.extend(self._java_codec(enum.name, self._java_enum_methods(enum)))
+        for struct in structs:
+            lines.extend(self._java_codec(struct.name, self._java_struct_methods(struct)))
+        lines.extend([
+            "    /** Writes payload (position to limit) as one size-prefixed frame */",
+            "    public static void writeFrame(ByteBuffer out, ByteBuffer payload) {",
+            "        out.order(ByteOrder.LITTLE_ENDIAN).putInt(payload.remaining());",
+            "        out.put(payload.duplicate());",
+            "    }",
+            "",
+            "    /** The next complete frame's payload as a slice, or null (position unchanged) until it has arrived */",
+            "    public static ByteBuffer nextFrame(ByteBuffer in) {",
+            "        in.order(ByteOrder.LITTLE_ENDIAN);",
+            "        if (in.remaining() < 4) return null;",
+            "        int length = in.getInt(in.position());",
+            "        if (length < 0) throw new IllegalArgumentException(\"Malformed frame length: \" + length);",
+            "        if (in.remaining() - 4 < length) return null;",
+            "        ByteBuffer payload = in.duplicate();",
+            "        payload.position(in.position() + 4).limit(in.position() + 4 + length);",
+            "        in.position(in.position() + 4 + length);",
+            "        return payload.slice().order(ByteOrder.LITTLE_ENDIAN);",
+            "    }",
+            "}",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _java_codec(self, name: str, methods: list[str]) -> list[str]:
+        size = self.wire_size(name)
+        const = self._upper_snake(name)
+        return [
+            f"    public static final int {const}_SIZE = {size};",
+            "",
+            *methods,
+            f"    public static void write{name}Array(ByteBuffer out, List<{name}> items) {{",
+            "        out.order(ByteOrder.LITTLE_ENDIAN).putInt(items.size());",
+            f"        for ({name} item : items) write{name}(out, item);",
+            "    }",
+            "",
+            f"    public static List<{name}> read{name}Array(ByteBuffer in) {{",
+            "        int count = in.order(ByteOrder.LITTLE_ENDIAN).getInt();",
+            f"        if (count < 0 || count > in.remaining() / {const}_SIZE) {{",
+            f"            throw new IllegalArgumentException(\"Truncated {name} array: \" + count);",
+            "        }",
+            f"        List<{name}> items = new ArrayList<>(count);",
+            f"        for (int i = 0; i < count; i++) items.add(read{name}(in));",
+            "        return items;",
+            "    }",
+            "",
+        ]
+
+    def _java_enum_methods(self, enum: Enum) -> list[str]:
+        return [
+            f"    public static void write{enum.name}(ByteBuffer out, {enum.name} value) {{",
+            "        out.order(ByteOrder.LITTLE_ENDIAN).putInt(value.getValue());",
+            "    }",
+            "",
+            f"    public static {enum.name} read{enum.name}(ByteBuffer in) {{",
+            f"        return {enum.name}.fromValue(in.order(ByteOrder.LITTLE_ENDIAN).getInt());",
+            "    }",
+            "",
+        ]
+
+    def _java_struct_methods(self, struct: Struct) -> list[str]:
+        name = struct.name
+        lines = [
+            f"    public static void write{name}(ByteBuffer out, {name} value) {{",
+            "        out.order(ByteOrder.LITTLE_ENDIAN);",
+        ]
+        for m in struct.members:
+            lines.append(f"        {self._java_put(m, f'value.{m.name}')}")
+        lines.extend([
+            "    }",
+            "",
+            f"    public static {name} read{name}(ByteBuffer in) {{",
+            "        in.order(ByteOrder.LITTLE_ENDIAN);",
+        ])
+        # Constructor arguments are evaluated left to right, i.e. in wire order
+        args = ", ".join(self._java_get(m) for m in struct.members)
+        lines.extend([
+            f"        return new {name}({args});",
+            "    }",
+            "",
+        ])
+        return lines
+
+    def _java_put(self, m: Member, value: str) -> str:
+        if m.type == "bool":
+            return f"out.put((byte) ({value} ? 1 : 0));"
+        if m.type in self.idl.symbols.enums or m.type in self.idl.symbols.structs:
+            return f"write{m.type}(out, {value});"
+        return f"out.{self.JAVA_FIELDS[m.type][1]}({value});"
+
+    def _java_get(self, m: Member) -> str:
+        if m.type == "bool":
+            return "in.get() != 0"
+        if m.type in self.idl.symbols.enums or m.type in self.idl.symbols.structs:
+            return f"read{m.type}(in)"
+        return f"in.{self.JAVA_FIELDS[m.type][2]}()"
+
+    @staticmethod
+    def _upper_snake(name: str) -> str:
+        out = ""
+        for i, ch in enumerate(name):
+            if ch.isupper() and i and not name[i - 1].isupper():
+                out += "_"
+            out += ch.upper()
+        return out
+
+    # ── Python ──────────────────────────────────────────────────────
+
+    def generate_python(self) -> str:
+        ns = self.namespace
+        lines = [
+            '"""',
+            "AUTO-GENERATED - DO NOT EDIT",
+            "",
+            f"Little-endian codecs matching {ns}_wire.h. Records are ctypes LittleEndianStructures packed",
+            "exactly like the wire, so decoding an array is one buffer copy and fields are read lazily.",
+            "Standalone: the native library is not loaded.",
+            '"""',
+            "",
+            "import ctypes",
+            "import struct",
+            "",
+            "_U32 = struct.Struct('<I')",
+            "_I32 = struct.Struct('<i')",
+            "",
+            "",
+            "class _Record(ctypes.LittleEndianStructure):",
+            "    _pack_ = 1",
+            "",
+            "    @classmethod",
+            "    def decode(cls, data, offset=0):",
+            '        """One record at data[offset:]"""',
+            "        return cls.from_buffer_copy(data, offset)",
+            "",
+            "    @classmethod",
+            "    def decode_array(cls, data, offset=0):",
+            '        """A wire array at data[offset:], as a ctypes array of records"""',
+            "        (count,) = _U32.unpack_from(data, offset)",
+            "        if count > (len(data) - offset - 4) // ctypes.sizeof(cls):",
+            "            raise ValueError(f'truncated {cls.__name__} array of {count}')",
+            "        return (cls * count).from_buffer_copy(data, offset + 4)",
+            "",
+            "    @classmethod",
+            "    def encode_array(cls, items) -> bytes:",
+            '        """Wire array of records, or of any objects with the same field names"""',
+            "        if not (isinstance(items, ctypes.Array) and items._type_ is cls):",
+            "            items = (cls * len(items))(*(item if isinstance(item, cls) else cls.convert(item)",
+            "                                         for item in items))",
+            "        return _U32.pack(len(items)) + bytes(items)",
+            "",
+            "    @classmethod",
+            "    def convert(cls, value):",
+            '        """Record with the fields of any object that has them, e.g. the bindings\' struct"""',
+            "        return cls(*(getattr(value, name) if not isinstance(kind, type) or not issubclass(kind, _Record)",
+            "                     else kind.convert(getattr(value, name)) for name, kind in cls._fields_))",
+            "",
+            "    def encode(self) -> bytes:",
+            "        return bytes(self)",
+            "",
+            "",
+        ]
+        for enum in self.idl.enums:
+            lines.extend([
+                f"def encode_{enum.name}(value) -> bytes:",
+                "    return _I32.pack(int(value))",
+                "",
+                "",
+                f"def decode_{enum.name}(data, offset=0) -> int:",
+                "    return _I32.unpack_from(data, offset)[0]",
+                "",
+                "",
+            ])
+        for struct in self.structs():
+            lines.append(f"class {struct.name}(_Record):")
+            lines.append(f'    """Wire record of {struct.name} ({self.wire_size(struct.name)} bytes)"""')
+            lines.append("    _fields_ = [")
+            for m in struct.members:
+                lines.append(f'        ("{m.name}", {self._py_type(m.type)}),')
+            lines.append("    ]")
+            lines.append(f"    WIRE_SIZE = {self.wire_size(struct.name)}")
+            lines.append("")
+            lines.append("")
+            lines.append(f"assert ctypes.sizeof({struct.name}) == {struct.name}.WIRE_SIZE")
+            lines.append("")
+            lines.append("")
+        lines.extend([
+            "def encode_frame(payload) -> bytes:",
+            '    """One size-prefixed frame"""',
+            "    return _U32.pack(len(payload)) + bytes(payload)",
+            "",
+            "",
+            "class FrameReader:",
+            '    """Splits a byte stream into frame payloads as data arrives"""',
+            "",
+            "    def __init__(self):",
+            "        self._buffer = bytearray()",
+            "",
+            "    def feed(self, data) -> list:",
+            '        """Appends data and returns the payloads of every frame now complete"""',
+            "        self._buffer += data",
+            "        frames, offset = [], 0",
+            "        while len(self._buffer) - offset >= 4:",
+            "            (length,) = _U32.unpack_from(self._buffer, offset)",
+            "            if len(self._buffer) - offset - 4 < length:",
+            "                break",
+            "            frames.append(bytes(self._buffer[offset + 4:offset + 4 + length]))",
+            "            offset += 4 + length",
+            "        del self._buffer[:offset]",
+            "        return frames",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _py_type(self, idl_type: str) -> str:
+        if idl_type in self.idl.symbols.enums:
+            return "ctypes.c_int32"
+        if idl_type in self.idl.symbols.structs:
+            return idl_type
+        return f"ctypes.{self.PY_CTYPES[idl_type]}"
+
+    # ── JavaScript ──────────────────────────────────────────────────
+
+    def generate_js(self) -> str:
+        ns = self.namespace
+        lines = [
+            "// AUTO-GENERATED - DO NOT EDIT",
+            f"// Little-endian codecs matching {ns}_wire.h. Standalone: works in Node and browsers",
+            "// without the WASM module. Records decode to plain objects; viewArray() reads fields",
+            "// straight from the bytes on access instead.",
+            "(function (root, factory) {",
+            "    if (typeof module === 'object' && module.exports) module.exports = factory();",
+            f"    else root.{ns}Wire = factory();",
+            "})(typeof self !== 'undefined' ? self : this, function () {",
+            "    'use strict';",
+            "",
+            "    function dataView(bytes) {",
+            "        return new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);",
+            "    }",
+            "",
+        ]
+        names = []
+        for enum in self.idl.enums:
+            names.append(enum.name)
+            lines.extend([
+                f"    const {enum.name} = {{",
+                "        WIRE_SIZE: 4,",
+                "        encode(view, offset, value) { view.setInt32(offset, value, true); },",
+                "        decode(view, offset) { return view.getInt32(offset, true); },",
+                "    };",
+                "",
+            ])
+        for struct in self.structs():
+            names.append(struct.name)
+            fields = self._fields(struct)
+            lines.append(f"    const {struct.name} = {{")
+            lines.append(f"        WIRE_SIZE: {self.wire_size(struct.name)},")
+            lines.append("        encode(view, offset, value) {")
+            for m, off in fields:
+                lines.append(f"            {self._js_put(m, off)}")
+            lines.append("        },")
+            lines.append("        decode(view, offset) {")
+            lines.append("            return {")
+            for m, off in fields:
+                lines.append(f"                {m.name}: {self._js_get(m.type, off)},")
+            lines.append("            };")
+            lines.append("        },")
+            lines.append("    };")
+            lines.append("")
+        lines.extend([
+            "    /** Wire array of items as a Uint8Array */",
+            "    function encodeArray(type, items) {",
+            "        const bytes = new Uint8Array(4 + items.length * type.WIRE_SIZE);",
+            "        const view = dataView(bytes);",
+            "        view.setUint32(0, items.length, true);",
+            "        for (let i = 0; i < items.length; i++) type.encode(view, 4 + i * type.WIRE_SIZE, items[i]);",
+            "        return bytes;",
+            "    }",
+            "",
+            "    function arrayCount(type, view) {",
+            "        const count = view.getUint32(0, true);",
+            "        if (count > (view.byteLength - 4) / type.WIRE_SIZE) {",
+            "            throw new RangeError('truncated wire array of ' + count);",
+            "        }",
+            "        return count;",
+            "    }",
+            "",
+            "    /** Every record of a wire array (Uint8Array) as plain objects */",
+            "    function decodeArray(type, bytes) {",
+            "        const view = dataView(bytes);",
+            "        const count = arrayCount(type, view);",
+            "        const items = new Array(count);",
+            "        for (let i = 0; i < count; i++) items[i] = type.decode(view, 4 + i * type.WIRE_SIZE);",
+            "        return items;",
+            "    }",
+            "",
+            "    /** Lazy view of a wire array: get(i) decodes one record; the bytes must outlive it */",
+            "    function viewArray(type, bytes) {",
+            "        const view = dataView(bytes);",
+            "        const count = arrayCount(type, view);",
+            "        return {",
+            "            length: count,",
+            "            get(i) {",
+            "                if (i < 0 || i >= count) throw new RangeError('index ' + i + ' out of ' + count);",
+            "                return type.decode(view, 4 + i * type.WIRE_SIZE);",
+            "            },",
+            "        };",
+            "    }",
+            "",
+            "    /** One size-prefixed frame around payload (Uint8Array) */",
+            "    function encodeFrame(payload) {",
+            "        const bytes = new Uint8Array(4 + payload.length);",
+            "        dataView(bytes).setUint32(0, payload.length, true);",
+            "        bytes.set(payload, 4);",
+            "        return bytes;",
+            "    }",
+            "",
+            "    /** Splits a byte stream into frame payloads as chunks arrive */",
+            "    class FrameReader {",
+            "        constructor() {",
+            "            this.buffer = new Uint8Array(0);",
+            "        }",
+            "",
+            "        /** Appends chunk and returns the payloads of every frame now complete */",
+            "        push(chunk) {",
+            "            const joined = new Uint8Array(this.buffer.length + chunk.length);",
+            "            joined.set(this.buffer);",
+            "            joined.set(chunk, this.buffer.length);",
+            "            const view = dataView(joined);",
+            "            const frames = [];",
+            "            let offset = 0;",
+            "            while (joined.length - offset >= 4) {",
+            "                const length = view.getUint32(offset, true);",
+            "                if (joined.length - offset - 4 < length) break;",
+            "                frames.push(joined.slice(offset + 4, offset + 4 + length));",
+            "                offset += 4 + length;",
+            "            }",
+            "            this.buffer = joined.slice(offset);",
+            "            return frames;",
+            "        }",
+            "    }",
+            "",
+            f"    return {{ {', '.join(names)}{', ' if names else ''}encodeArray, decodeArray, viewArray, encodeFrame, FrameReader }};",
+            "});",
+            "",
+        ])
+        return "\n".join(lines)
+
+    def _js_put(self, m: Member, offset: int) -> str:
+        at = f"offset + {offset}" if offset else "offset"
+        if m.type in self.idl.symbols.structs:
+            return f"{m.type}.encode(view, {at}, value.{m.name});"
+        if m.type in self.idl.symbols.enums:
+            return f"view.setInt32({at}, value.{m.name}, true);"
+        kind = self.JS_VIEWS[m.type]
+        value = f"value.{m.name} ? 1 : 0" if m.type == "bool" else f"value.{m.name}"
+        little = "" if self.SCALARS[m.type][0] == 1 else ", true"
+        return f"view.set{kind}({at}, {value}{little});"
+
+    def _js_get(self, idl_type: str, offset: int) -> str:
+        at = f"offset + {offset}" if offset else "offset"
+        if idl_type in self.idl.symbols.structs:
+            return f"{idl_type}.decode(view, {at})"
+        if idl_type in self.idl.symbols.enums:
+            return f"view.getInt32({at}, true)"
+        little = "" if self.SCALARS[idl_type][0] == 1 else ", true"
+        get = f"view.get{self.JS_VIEWS[idl_type]}({at}{little})"
+        return f"{get} !== 0" if idl_type == "bool" else get
@@ -1 +1,566 @@
 #include "samples.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #include <immintrin.h>
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define SAMPLES_KERNELS_SSE2 1
+        // AVX2 functions are compiled for that target only and called after a CPUID check
+        #if defined(__GNUC__) || defined(__clang__)
+            #define SAMPLES_KERNELS_AVX2 1
+            #define SAMPLES_TARGET_AVX2 __attribute__((target("avx2")))
+        #elif defined(_MSC_VER)
+            #include <intrin.h>
+            #define SAMPLES_KERNELS_AVX2 1
+            #define SAMPLES_TARGET_AVX2
+        #endif
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    // NEON is part of the AArch64 baseline (and has the float64 lanes boxAspectRatios needs)
+    #include <arm_neon.h>
+    #define SAMPLES_KERNELS_NEON 1
+#elif defined(__wasm_simd128__)
+    #include <wasm_simd128.h>
+    #define SAMPLES_KERNELS_SIMD128 1
+#endif
+
+namespace samples {
+namespace kernels {
+
+namespace {
+
+// ============================================================================
+// Scalar reference: every SIMD version must produce exactly these results
+
+uint64_t sumBytesScalar(const uint8_t* data, size_t size) noexcept {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+void boxAreasScalar(const BoundingBox* boxes, int* out, int count) noexcept {
+    for (int i = 0; i < count; ++i) {
+        out[i] = wrappingMul(boxes[i].width, boxes[i].height);
+    }
+}
+
+int containsScalar(const BoundingBox& box, const Point& point) noexcept {
+    return point.x >= box.x && point.x < wrappingAdd(box.x, box.width) &&
+           point.y >= box.y && point.y < wrappingAdd(box.y, box.height);
+}
+
+void boxesContainPointsScalar(const BoundingBox* boxes, const Point* points, int* out, int count) noexcept {
+    for (int i = 0; i < count; ++i) {
+        out[i] = containsScalar(boxes[i], points[i]);
+    }
+}
+
+double aspectRatioScalar(const BoundingBox& box) noexcept {
+    return box.height == 0 ? 0.0 : static_cast<double>(box.width) / box.height;
+}
+
+void boxAspectRatiosScalar(const BoundingBox* boxes, double* out, int count) noexcept {
+    for (int i = 0; i < count; ++i) {
+        out[i] = aspectRatioScalar(boxes[i]);
+    }
+}
+
+// The SIMD box kernels load x, y, width, height of a box as one 128-bit vector
+static_assert(offsetof(BoundingBox, x) == 0 && offsetof(BoundingBox, y) == 4 &&
+              offsetof(BoundingBox, width) == 8 && offsetof(BoundingBox, height) == 12,
+              "box kernels expect x, y, width, height as the first four ints");
+static_assert(sizeof(Point) == 8 && offsetof(Point, y) == 4, "point kernels expect packed x, y ints");
+
+// ============================================================================
+// SSE2 (x86-64 baseline): four boxes per iteration
+
+#ifdef SAMPLES_KERNELS_SSE2
+
+uint64_t sumBytesSSE2(const uint8_t* data, size_t size) noexcept {
+    // psadbw against zero sums each 8-byte half into a 64-bit lane
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + sumBytesScalar(data + i, size - i);
+}
+
+// Columns x, y, width, height of boxes[0..3]
+struct BoxColumns4 {
+    __m128i x, y, width, height;
+};
+
+BoxColumns4 loadBoxes4(const BoundingBox* boxes) noexcept {
+    const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes[0]));
+    const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes[1]));
+    const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes[2]));
+    const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes[3]));
+    const __m128i xy01 = _mm_unpacklo_epi32(b0, b1);  // x0 x1 y0 y1
+    const __m128i xy23 = _mm_unpacklo_epi32(b2, b3);
+    const __m128i wh01 = _mm_unpackhi_epi32(b0, b1);  // w0 w1 h0 h1
+    const __m128i wh23 = _mm_unpackhi_epi32(b2, b3);
+    return {_mm_unpacklo_epi64(xy01, xy23), _mm_unpackhi_epi64(xy01, xy23),
+            _mm_unpacklo_epi64(wh01, wh23), _mm_unpackhi_epi64(wh01, wh23)};
+}
+
+// Low 32 bits of a * b per lane; SSE2 has no pmulld
+__m128i mulloSSE2(__m128i a, __m128i b) noexcept {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+void boxAreasSSE2(const BoundingBox* boxes, int* out, int count) noexcept {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), mulloSSE2(c.width, c.height));
+    }
+    boxAreasScalar(boxes + i, out + i, count - i);
+}
+
+void boxesContainPointsSSE2(const BoundingBox* boxes, const Point* points, int* out, int count) noexcept {
+    const __m128i one = _mm_set1_epi32(1);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        const __m128i p01 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(points + i)),
+                                              _MM_SHUFFLE(3, 1, 2, 0));  // x0 x1 y0 y1
+        const __m128i p23 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(points + i + 2)),
+                                              _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i px = _mm_unpacklo_epi64(p01, p23);
+        const __m128i py = _mm_unpackhi_epi64(p01, p23);
+        // Inside when neither x > px nor y > py, and both px < x + width and py < y + height
+        const __m128i before = _mm_or_si128(_mm_cmpgt_epi32(c.x, px), _mm_cmpgt_epi32(c.y, py));
+        const __m128i within = _mm_and_si128(_mm_cmpgt_epi32(_mm_add_epi32(c.x, c.width), px),
+                                             _mm_cmpgt_epi32(_mm_add_epi32(c.y, c.height), py));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(_mm_andnot_si128(before, within), one));
+    }
+    boxesContainPointsScalar(boxes + i, points + i, out + i, count - i);
+}
+
+void boxAspectRatiosSSE2(const BoundingBox* boxes, double* out, int count) noexcept {
+    const __m128d zero = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        const __m128i widthHigh = _mm_shuffle_epi32(c.width, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128i heightHigh = _mm_shuffle_epi32(c.height, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128d h01 = _mm_cvtepi32_pd(c.height);
+        const __m128d h23 = _mm_cvtepi32_pd(heightHigh);
+        // Lanes with a zero height divide by zero and are then masked to 0.0
+        const __m128d r01 = _mm_div_pd(_mm_cvtepi32_pd(c.width), h01);
+        const __m128d r23 = _mm_div_pd(_mm_cvtepi32_pd(widthHigh), h23);
+        _mm_storeu_pd(out + i, _mm_andnot_pd(_mm_cmpeq_pd(h01, zero), r01));
+        _mm_storeu_pd(out + i + 2, _mm_andnot_pd(_mm_cmpeq_pd(h23, zero), r23));
+    }
+    boxAspectRatiosScalar(boxes + i, out + i, count - i);
+}
+
+#endif // SAMPLES_KERNELS_SSE2
+
+// ============================================================================
+// AVX2: eight boxes per iteration, boxes i..i+3 in the low lane and i+4..i+7 in the high one
+
+#ifdef SAMPLES_KERNELS_AVX2
+
+SAMPLES_TARGET_AVX2 uint64_t sumBytesAVX2(const uint8_t* data, size_t size) noexcept {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumBytesScalar(data + i, size - i);
+}
+
+struct BoxColumns8 {
+    __m256i x, y, width, height;
+};
+
+SAMPLES_TARGET_AVX2 __m256i loadBoxPair(const BoundingBox* boxes, int k) noexcept {
+    const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes[k]));
+    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes[k + 4]));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+SAMPLES_TARGET_AVX2 BoxColumns8 loadBoxes8(const BoundingBox* boxes) noexcept {
+    const __m256i b0 = loadBoxPair(boxes, 0);
+    const __m256i b1 = loadBoxPair(boxes, 1);
+    const __m256i b2 = loadBoxPair(boxes, 2);
+    const __m256i b3 = loadBoxPair(boxes, 3);
+    const __m256i xy01 = _mm256_unpacklo_epi32(b0, b1);
+    const __m256i xy23 = _mm256_unpacklo_epi32(b2, b3);
+    const __m256i wh01 = _mm256_unpackhi_epi32(b0, b1);
+    const __m256i wh23 = _mm256_unpackhi_epi32(b2, b3);
+    return {_mm256_unpacklo_epi64(xy01, xy23), _mm256_unpackhi_epi64(xy01, xy23),
+            _mm256_unpacklo_epi64(wh01, wh23), _mm256_unpackhi_epi64(wh01, wh23)};
+}
+
+SAMPLES_TARGET_AVX2 void boxAreasAVX2(const BoundingBox* boxes, int* out, int count) noexcept {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const BoxColumns8 c = loadBoxes8(boxes + i);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(c.width, c.height));
+    }
+    boxAreasScalar(boxes + i, out + i, count - i);
+}
+
+SAMPLES_TARGET_AVX2 void boxesContainPointsAVX2(const BoundingBox* boxes, const Point* points, int* out,
+                                                int count) noexcept {
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);  // x0..x3 | y0..y3
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const BoxColumns8 c = loadBoxes8(boxes + i);
+        const __m256i p0 = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points + i)), split);
+        const __m256i p1 = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points + i + 4)), split);
+        const __m256i px = _mm256_permute2x128_si256(p0, p1, 0x20);
+        const __m256i py = _mm256_permute2x128_si256(p0, p1, 0x31);
+        const __m256i before = _mm256_or_si256(_mm256_cmpgt_epi32(c.x, px), _mm256_cmpgt_epi32(c.y, py));
+        const __m256i within = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(c.x, c.width), px),
+                                                _mm256_cmpgt_epi32(_mm256_add_epi32(c.y, c.height), py));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_and_si256(_mm256_andnot_si256(before, within), one));
+    }
+    boxesContainPointsScalar(boxes + i, points + i, out + i, count - i);
+}
+
+SAMPLES_TARGET_AVX2 void boxAspectRatiosAVX2(const BoundingBox* boxes, double* out, int count) noexcept {
+    const __m256d zero = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const BoxColumns8 c = loadBoxes8(boxes + i);
+        for (int half = 0; half < 2; ++half) {
+            const __m128i w = half ? _mm256_extracti128_si256(c.width, 1) : _mm256_castsi256_si128(c.width);
+            const __m128i h = half ? _mm256_extracti128_si256(c.height, 1) : _mm256_castsi256_si128(c.height);
+            const __m256d hd = _mm256_cvtepi32_pd(h);
+            const __m256d ratio = _mm256_div_pd(_mm256_cvtepi32_pd(w), hd);
+            _mm256_storeu_pd(out + i + 4 * half, _mm256_andnot_pd(_mm256_cmp_pd(hd, zero, _CMP_EQ_OQ), ratio));
+        }
+    }
+    boxAspectRatiosScalar(boxes + i, out + i, count - i);
+}
+
+bool cpuHasAVX2() noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    // CPUID.7:EBX bit 5, plus OSXSAVE and XCR0 showing the OS saves the YMM registers
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27))) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#endif // SAMPLES_KERNELS_AVX2
+
+// ============================================================================
+// NEON (AArch64): four boxes per iteration
+
+#ifdef SAMPLES_KERNELS_NEON
+
+uint64_t sumBytesNEON(const uint8_t* data, size_t size) noexcept {
+    // 16-bit pairwise accumulators hold at most 128 * 2 * 255, then widen into 64 bits
+    uint64x2_t acc = vdupq_n_u64(0);
+    size_t i = 0;
+    while (i + 16 <= size) {
+        uint16x8_t acc16 = vdupq_n_u16(0);
+        for (int block = 0; block < 128 && i + 16 <= size; ++block, i += 16) {
+            acc16 = vpadalq_u8(acc16, vld1q_u8(data + i));
+        }
+        acc = vpadalq_u32(acc, vpaddlq_u16(acc16));
+    }
+    return vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1) + sumBytesScalar(data + i, size - i);
+}
+
+struct BoxColumns4 {
+    int32x4_t x, y, width, height;
+};
+
+BoxColumns4 loadBoxes4(const BoundingBox* boxes) noexcept {
+    const int32x4x2_t t01 = vtrnq_s32(vld1q_s32(&boxes[0].x), vld1q_s32(&boxes[1].x));  // x0 x1 w0 w1 | y0 y1 h0 h1
+    const int32x4x2_t t23 = vtrnq_s32(vld1q_s32(&boxes[2].x), vld1q_s32(&boxes[3].x));
+    return {vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0])),
+            vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1])),
+            vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0])),
+            vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]))};
+}
+
+void boxAreasNEON(const BoundingBox* boxes, int* out, int count) noexcept {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        vst1q_s32(out + i, vmulq_s32(c.width, c.height));
+    }
+    boxAreasScalar(boxes + i, out + i, count - i);
+}
+
+void boxesContainPointsNEON(const BoundingBox* boxes, const Point* points, int* out, int count) noexcept {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        const int32x4x2_t p = vld2q_s32(&points[i].x);  // deinterleaves x and y
+        const uint32x4_t inside = vandq_u32(
+            vandq_u32(vcgeq_s32(p.val[0], c.x), vcltq_s32(p.val[0], vaddq_s32(c.x, c.width))),
+            vandq_u32(vcgeq_s32(p.val[1], c.y), vcltq_s32(p.val[1], vaddq_s32(c.y, c.height))));
+        vst1q_s32(out + i, vreinterpretq_s32_u32(vshrq_n_u32(inside, 31)));
+    }
+    boxesContainPointsScalar(boxes + i, points + i, out + i, count - i);
+}
+
+void boxAspectRatiosNEON(const BoundingBox* boxes, double* out, int count) noexcept {
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        const float64x2_t h01 = vcvtq_f64_s64(vmovl_s32(vget_low_s32(c.height)));
+        const float64x2_t h23 = vcvtq_f64_s64(vmovl_s32(vget_high_s32(c.height)));
+        const float64x2_t r01 = vdivq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(c.width))), h01);
+        const float64x2_t r23 = vdivq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(c.width))), h23);
+        vst1q_f64(out + i, vbslq_f64(vceqq_f64(h01, zero), zero, r01));
+        vst1q_f64(out + i + 2, vbslq_f64(vceqq_f64(h23, zero), zero, r23));
+    }
+    boxAspectRatiosScalar(boxes + i, out + i, count - i);
+}
+
+#endif // SAMPLES_KERNELS_NEON
+
+// ============================================================================
+// WASM SIMD128 (built with -msimd128): four boxes per iteration
+
+#ifdef SAMPLES_KERNELS_SIMD128
+
+uint64_t sumBytesSIMD128(const uint8_t* data, size_t size) noexcept {
+    v128_t acc = wasm_i64x2_splat(0);
+    size_t i = 0;
+    while (i + 16 <= size) {
+        v128_t acc16 = wasm_i16x8_splat(0);
+        for (int block = 0; block < 128 && i + 16 <= size; ++block, i += 16) {
+            acc16 = wasm_i16x8_add(acc16, wasm_u16x8_extadd_pairwise_u8x16(wasm_v128_load(data + i)));
+        }
+        const v128_t acc32 = wasm_u32x4_extadd_pairwise_u16x8(acc16);
+        acc = wasm_i64x2_add(acc, wasm_i64x2_add(wasm_u64x2_extend_low_u32x4(acc32),
+                                                 wasm_u64x2_extend_high_u32x4(acc32)));
+    }
+    return static_cast<uint64_t>(wasm_i64x2_extract_lane(acc, 0)) +
+           static_cast<uint64_t>(wasm_i64x2_extract_lane(acc, 1)) + sumBytesScalar(data + i, size - i);
+}
+
+struct BoxColumns4 {
+    v128_t x, y, width, height;
+};
+
+BoxColumns4 loadBoxes4(const BoundingBox* boxes) noexcept {
+    const v128_t b0 = wasm_v128_load(&boxes[0]);
+    const v128_t b1 = wasm_v128_load(&boxes[1]);
+    const v128_t b2 = wasm_v128_load(&boxes[2]);
+    const v128_t b3 = wasm_v128_load(&boxes[3]);
+    const v128_t xy01 = wasm_i32x4_shuffle(b0, b1, 0, 4, 1, 5);  // x0 x1 y0 y1
+    const v128_t xy23 = wasm_i32x4_shuffle(b2, b3, 0, 4, 1, 5);
+    const v128_t wh01 = wasm_i32x4_shuffle(b0, b1, 2, 6, 3, 7);  // w0 w1 h0 h1
+    const v128_t wh23 = wasm_i32x4_shuffle(b2, b3, 2, 6, 3, 7);
+    return {wasm_i32x4_shuffle(xy01, xy23, 0, 1, 4, 5), wasm_i32x4_shuffle(xy01, xy23, 2, 3, 6, 7),
+            wasm_i32x4_shuffle(wh01, wh23, 0, 1, 4, 5), wasm_i32x4_shuffle(wh01, wh23, 2, 3, 6, 7)};
+}
+
+void boxAreasSIMD128(const BoundingBox* boxes, int* out, int count) noexcept {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        wasm_v128_store(out + i, wasm_i32x4_mul(c.width, c.height));
+    }
+    boxAreasScalar(boxes + i, out + i, count - i);
+}
+
+void boxesContainPointsSIMD128(const BoundingBox* boxes, const Point* points, int* out, int count) noexcept {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        const v128_t p01 = wasm_v128_load(points + i);
+        const v128_t p23 = wasm_v128_load(points + i + 2);
+        const v128_t px = wasm_i32x4_shuffle(p01, p23, 0, 2, 4, 6);
+        const v128_t py = wasm_i32x4_shuffle(p01, p23, 1, 3, 5, 7);
+        const v128_t inside = wasm_v128_and(
+            wasm_v128_and(wasm_i32x4_ge(px, c.x), wasm_i32x4_lt(px, wasm_i32x4_add(c.x, c.width))),
+            wasm_v128_and(wasm_i32x4_ge(py, c.y), wasm_i32x4_lt(py, wasm_i32x4_add(c.y, c.height))));
+        wasm_v128_store(out + i, wasm_u32x4_shr(inside, 31));
+    }
+    boxesContainPointsScalar(boxes + i, points + i, out + i, count - i);
+}
+
+void boxAspectRatiosSIMD128(const BoundingBox* boxes, double* out, int count) noexcept {
+    const v128_t zero = wasm_f64x2_splat(0.0);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const BoxColumns4 c = loadBoxes4(boxes + i);
+        const v128_t h01 = wasm_f64x2_convert_low_i32x4(c.height);
+        const v128_t h23 = wasm_f64x2_convert_low_i32x4(wasm_i32x4_shuffle(c.height, c.height, 2, 3, 0, 1));
+        const v128_t r01 = wasm_f64x2_div(wasm_f64x2_convert_low_i32x4(c.width), h01);
+        const v128_t r23 = wasm_f64x2_div(
+            wasm_f64x2_convert_low_i32x4(wasm_i32x4_shuffle(c.width, c.width, 2, 3, 0, 1)), h23);
+        wasm_v128_store(out + i, wasm_v128_andnot(r01, wasm_f64x2_eq(h01, zero)));
+        wasm_v128_store(out + i + 2, wasm_v128_andnot(r23, wasm_f64x2_eq(h23, zero)));
+    }
+    boxAspectRatiosScalar(boxes + i, out + i, count - i);
+}
+
+#endif // SAMPLES_KERNELS_SIMD128
+
+// ============================================================================
+// Dispatch
+
+struct KernelTable {
+    uint64_t (*sumBytes)(const uint8_t*, size_t) noexcept;
+    void (*boxAreas)(const BoundingBox*, int*, int) noexcept;
+    void (*boxesContainPoints)(const BoundingBox*, const Point*, int*, int) noexcept;
+    void (*boxAspectRatios)(const BoundingBox*, double*, int) noexcept;
+};
+
+constexpr KernelTable kScalar = {sumBytesScalar, boxAreasScalar, boxesContainPointsScalar, boxAspectRatiosScalar};
+#ifdef SAMPLES_KERNELS_SSE2
+constexpr KernelTable kSSE2 = {sumBytesSSE2, boxAreasSSE2, boxesContainPointsSSE2, boxAspectRatiosSSE2};
+#endif
+#ifdef SAMPLES_KERNELS_AVX2
+constexpr KernelTable kAVX2 = {sumBytesAVX2, boxAreasAVX2, boxesContainPointsAVX2, boxAspectRatiosAVX2};
+#endif
+#ifdef SAMPLES_KERNELS_NEON
+constexpr KernelTable kNEON = {sumBytesNEON, boxAreasNEON, boxesContainPointsNEON, boxAspectRatiosNEON};
+#endif
+#ifdef SAMPLES_KERNELS_SIMD128
+constexpr KernelTable kSIMD128 = {sumBytesSIMD128, boxAreasSIMD128, boxesContainPointsSIMD128,
+                                  boxAspectRatiosSIMD128};
+#endif
+
+const KernelTable& tableFor(SimdLevel level) noexcept {
+    if (!isSupported(level)) return kScalar;
+    switch (level) {
+#ifdef SAMPLES_KERNELS_SSE2
+    case SimdLevel::SSE2: return kSSE2;
+#endif
+#ifdef SAMPLES_KERNELS_AVX2
+    case SimdLevel::AVX2: return kAVX2;
+#endif
+#ifdef SAMPLES_KERNELS_NEON
+    case SimdLevel::NEON: return kNEON;
+#endif
+#ifdef SAMPLES_KERNELS_SIMD128
+    case SimdLevel::SIMD128: return kSIMD128;
+#endif
+    default: return kScalar;
+    }
+}
+
+SimdLevel detectLevel() noexcept {
+    constexpr SimdLevel all[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2,
+                                 SimdLevel::NEON, SimdLevel::SIMD128};
+    if (const char* forced = std::getenv("SAMPLES_SIMD")) {
+        for (SimdLevel level : all) {
+            if (std::strcmp(forced, levelName(level)) == 0 && isSupported(level)) return level;
+        }
+    }
+    SimdLevel best = SimdLevel::Scalar;
+    for (SimdLevel level : all) {
+        if (isSupported(level)) best = level;  // listed from narrowest to widest
+    }
+    return best;
+}
+
+const KernelTable& activeTable() noexcept {
+    static const KernelTable& table = tableFor(activeLevel());
+    return table;
+}
+
+} // namespace
+
+const char* levelName(SimdLevel level) noexcept {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE2: return "sse2";
+    case SimdLevel::AVX2: return "avx2";
+    case SimdLevel::NEON: return "neon";
+    case SimdLevel::SIMD128: return "simd128";
+    }
+    return "unknown";
+}
+
+bool isSupported(SimdLevel level) noexcept {
+    switch (level) {
+    case SimdLevel::Scalar: return true;
+#ifdef SAMPLES_KERNELS_SSE2
+    case SimdLevel::SSE2: return true;
+#endif
+#ifdef SAMPLES_KERNELS_AVX2
+    case SimdLevel::AVX2: {
+        static const bool supported = cpuHasAVX2();
+        return supported;
+    }
+#endif
+#ifdef SAMPLES_KERNELS_NEON
+    case SimdLevel::NEON: return true;
+#endif
+#ifdef SAMPLES_KERNELS_SIMD128
+    case SimdLevel::SIMD128: return true;
+#endif
+    default: return false;
+    }
+}
+
+SimdLevel activeLevel() noexcept {
+    static const SimdLevel level = detectLevel();
+    return level;
+}
+
+uint64_t sumBytes(const uint8_t* data, size_t size) noexcept {
+    return activeTable().sumBytes(data, size);
+}
+
+uint64_t sumBytes(const uint8_t* data, size_t size, SimdLevel level) noexcept {
+    return tableFor(level).sumBytes(data, size);
+}
+
+void boxAreas(const BoundingBox* boxes, int* out, int count) noexcept {
+    activeTable().boxAreas(boxes, out, count);
+}
+
+void boxAreas(const BoundingBox* boxes, int* out, int count, SimdLevel level) noexcept {
+    tableFor(level).boxAreas(boxes, out, count);
+}
+
+void boxesContainPoints(const BoundingBox* boxes, const Point* points, int* out, int count) noexcept {
+    activeTable().boxesContainPoints(boxes, points, out, count);
+}
+
+void boxesContainPoints(const BoundingBox* boxes, const Point* points, int* out, int count,
+                        SimdLevel level) noexcept {
+    tableFor(level).boxesContainPoints(boxes, points, out, count);
+}
+
+void boxAspectRatios(const BoundingBox* boxes, double* out, int count) noexcept {
+    activeTable().boxAspectRatios(boxes, out, count);
+}
+
+void boxAspectRatios(const BoundingBox* boxes, double* out, int count, SimdLevel level) noexcept {
+    tableFor(level).boxAspectRatios(boxes, out, count);
+}
+
+} // namespace kernels
+} // namespace samples
@@ -1,9 +1,16 @@
 #pragma once
 
-#include "samples_c_api.h"
+// Only the shared C types (structs, enums, callbacks); the per-class entry point
+// headers are left out so adding an entry point does not recompile the implementation
+#include "samples_c_api_types.h"
 
+#include <algorithm>
+#include <climits>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -11,10 +18,57 @@ namespace samples {
 
 // Callback type aliases for C++ usage
 using ProgressCallback = std::function<void(int current, int total)>;
-using FilterCallback = std::function<bool(int value)>;
-using TransformCallback = std::function<int(int value)>;
+// [batch] callbacks take parallel arrays and fill one result per element (bool results as int)
+using FilterCallback = std::function<void(const int* value, int* result, int count)>;
+using TransformCallback = std::function<void(const int* value, int* result, int count)>;
 using ImageCallback = std::function<bool(const ImageData&)>;
 
+/**
+ * @brief Array kernels behind ImageProcessor and ShapeProcessor (samples.cpp)
+ *
+ * Each kernel has a scalar reference and SSE2/AVX2, NEON or WASM SIMD128 versions.
+ * The overloads without a level use activeLevel(): the best level the CPU supports,
+ * checked once (CPUID for AVX2), or the one named by the SAMPLES_SIMD environment
+ * variable ("scalar", "sse2", ...) when that level is supported. An explicit level
+ * that is not supported runs the scalar version.
+ */
+namespace kernels {
+
+enum class SimdLevel { Scalar, SSE2, AVX2, NEON, SIMD128 };
+
+SAMPLES_API const char* levelName(SimdLevel level) noexcept;
+SAMPLES_API bool isSupported(SimdLevel level) noexcept;
+SAMPLES_API SimdLevel activeLevel() noexcept;
+
+// Sum of size bytes; 64-bit, so it cannot overflow for any addressable buffer
+SAMPLES_API uint64_t sumBytes(const uint8_t* data, size_t size) noexcept;
+SAMPLES_API uint64_t sumBytes(const uint8_t* data, size_t size, SimdLevel level) noexcept;
+
+// Box arithmetic of every kernel and of the per-box methods: 32-bit two's complement
+// wraparound, as in the SIMD lanes, rather than signed overflow
+inline int wrappingAdd(int a, int b) noexcept {
+    return static_cast<int>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+inline int wrappingMul(int a, int b) noexcept {
+    return static_cast<int>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b));
+}
+
+// out[i] = boxes[i].width * boxes[i].height, wrapped
+SAMPLES_API void boxAreas(const BoundingBox* boxes, int* out, int count) noexcept;
+SAMPLES_API void boxAreas(const BoundingBox* boxes, int* out, int count, SimdLevel level) noexcept;
+
+// out[i] = 1 when points[i] lies in boxes[i] (right and bottom edges excluded, at the
+// wrapped x + width and y + height), else 0
+SAMPLES_API void boxesContainPoints(const BoundingBox* boxes, const Point* points, int* out, int count) noexcept;
+SAMPLES_API void boxesContainPoints(const BoundingBox* boxes, const Point* points, int* out, int count,
+                                    SimdLevel level) noexcept;
+
+// out[i] = width / height, or 0.0 when the height is 0
+SAMPLES_API void boxAspectRatios(const BoundingBox* boxes, double* out, int count) noexcept;
+SAMPLES_API void boxAspectRatios(const BoundingBox* boxes, double* out, int count, SimdLevel level) noexcept;
+
+} // namespace kernels
+
 /**
  * @brief Simple calculator for testing numeric types
  */
@@ -23,14 +77,30 @@ public:
     Calculator() = default;
 
     [[nodiscard]] int add(int a, int b) const { return a + b; }
-    [[nodiscard]] int subtract(int a, int b) const { return a - b; }
-    [[nodiscard]] int multiply(int a, int b) const { return a * b; }
+    [[nodiscard]] int subtract(int a, int b) const noexcept { return a - b; }
+    [[nodiscard]] int multiply(int a, int b) const noexcept { return a * b; }
     [[nodiscard]] double divide(double a, double b) const { return b != 0.0 ? a / b : 0.0; }
 
+    [[nodiscard]] int quotient(int a, int b) const {
+        if (b == 0) throw std::invalid_argument("division by zero");
+        if (a == INT_MIN && b == -1) throw std::out_of_range("quotient overflows int");
+        return a / b;
+    }
+
     [[nodiscard]] int getTotal() const { return total_; }
 
-    [[nodiscard]] int getVersionMajor() const { return 1; }
-    [[nodiscard]] int getVersionMinor() const { return 0; }
+    // start, start + 1, ... (count values), computed as they are pulled
+    [[nodiscard]] std::function<size_t(int* out, size_t max)> range(int start, int count) const {
+        // 64-bit, so start + count cannot overflow
+        return [next = int64_t{start}, end = int64_t{start} + std::max(count, 0)](int* out, size_t max) mutable {
+            size_t n = 0;
+            for (; n < max && next < end; ++n) out[n] = static_cast<int>(next++);
+            return n;
+        };
+    }
+
+    [[nodiscard]] int getVersionMajor() const noexcept { return 1; }
+    [[nodiscard]] int getVersionMinor() const noexcept { return 0; }
 
 private:
     int total_ = 0;
@@ -44,50 +114,59 @@ public:
     Geometry() = default;
 
     [[nodiscard]] std::vector<Point> createLine(int x1, int y1, int x2, int y2, int numPoints) {
-        std::vector<Point> points;
-        if (numPoints <= 0) {
-            lastCount_ = 0;
-            return points;
-        }
-        
-        points.reserve(numPoints);
-        for (int i = 0; i < numPoints; ++i) {
+        std::vector<Point> points(numPoints > 0 ? numPoints : 0);
+        createLineFill(x1, y1, x2, y2, numPoints, points.data(), static_cast<int>(points.size()));
+        return points;
+    }
+
+    // [fill] form of createLine: writes the first capacity points to out and returns the total
+    int createLineFill(int x1, int y1, int x2, int y2, int numPoints, Point* out, int capacity) {
+        const int total = numPoints > 0 ? numPoints : 0;
+        for (int i = 0; i < total && i < capacity; ++i) {
             double t = (numPoints == 1) ? 0.0 : static_cast<double>(i) / (numPoints - 1);
-            Point p;
-            p.x = static_cast<int>(x1 + t * (x2 - x1));
-            p.y = static_cast<int>(y1 + t * (y2 - y1));
-            points.push_back(p);
+            out[i].x = static_cast<int>(x1 + t * (x2 - x1));
+            out[i].y = static_cast<int>(y1 + t * (y2 - y1));
         }
-        
-        lastCount_ = static_cast<int>(points.size());
-        return points;
+        lastCount_ = total;
+        return total;
     }
 
     [[nodiscard]] std::vector<BoundingBox> findBoundingBoxes(int count) {
-        std::vector<BoundingBox> boxes;
-        if (count <= 0) {
-            lastCount_ = 0;
-            return boxes;
-        }
-        
-        boxes.reserve(count);
-        for (int i = 0; i < count; ++i) {
-            BoundingBox box;
-            box.x = i * 10;
-            box.y = i * 10;
-            box.width = 50 + i;
-            box.height = 50 + i;
-            box.confidence = 0.9 - (i * 0.1);
-            boxes.push_back(box);
-        }
-        
-        lastCount_ = static_cast<int>(boxes.size());
+        std::vector<BoundingBox> boxes(count > 0 ? count : 0);
+        findBoundingBoxesFill(count, boxes.data(), static_cast<int>(boxes.size()));
         return boxes;
     }
 
+    // [fill] form of findBoundingBoxes
+    int findBoundingBoxesFill(int count, BoundingBox* out, int capacity) {
+        const int total = count > 0 ? count : 0;
+        for (int i = 0; i < total && i < capacity; ++i) out[i] = boxAt(i);
+        lastCount_ = total;
+        return total;
+    }
+
+    // findBoundingBoxes(count) without the vector: each pull computes only the boxes it returns
+    [[nodiscard]] std::function<size_t(BoundingBox* out, size_t max)> streamBoundingBoxes(int count) const {
+        return [next = 0, count](BoundingBox* out, size_t max) mutable {
+            size_t n = 0;
+            for (; n < max && next < count; ++n) out[n] = boxAt(next++);
+            return n;
+        };
+    }
+
     [[nodiscard]] int getLastCount() const { return lastCount_; }
 
 private:
+    static BoundingBox boxAt(int i) {
+        BoundingBox box;
+        box.x = i * 10;
+        box.y = i * 10;
+        box.width = 50 + i;
+        box.height = 50 + i;
+        box.confidence = 0.9 - (i * 0.1);
+        return box;
+    }
+
     int lastCount_ = 0;
 };
 
@@ -99,11 +178,11 @@ public:
     ShapeProcessor() = default;
 
     [[nodiscard]] int calculateArea(BoundingBox box) const {
-        return box.width * box.height;
+        return kernels::wrappingMul(box.width, box.height);
     }
 
     [[nodiscard]] double calculateDiagonal(const BoundingBox& box) const {
-        return std::sqrt(static_cast<double>(box.width * box.width + box.height * box.height));
+        return std::hypot(static_cast<double>(box.width), static_cast<double>(box.height));
     }
 
     [[nodiscard]] Point translate(Point p, int dx, int dy) const {
@@ -115,8 +194,17 @@ public:
     }
 
     [[nodiscard]] bool boxContainsPoint(const BoundingBox& box, const Point& point) const {
-        return point.x >= box.x && point.x < box.x + box.width &&
-               point.y >= box.y && point.y < box.y + box.height;
+        return point.x >= box.x && point.x < kernels::wrappingAdd(box.x, box.width) &&
+               point.y >= box.y && point.y < kernels::wrappingAdd(box.y, box.height);
+    }
+
+    // [kernel] forms of the [batch] methods: the generated batch entry points pass whole arrays
+    void calculateAreaBatch(const BoundingBox* box, int* out, int count) const {
+        kernels::boxAreas(box, out, count);
+    }
+
+    void boxContainsPointBatch(const BoundingBox* box, const Point* point, int* out, int count) const {
+        kernels::boxesContainPoints(box, point, out, count);
     }
 
     [[nodiscard]] BoundingBox createBox(int x, int y, int width, int height) const {
@@ -132,6 +220,7 @@ public:
     AsyncProcessor() = default;
 
     [[nodiscard]] int processWithProgress(int count, ProgressCallback onProgress) {
+        if (count < 0) throw std::invalid_argument("negative count");
         for (int i = 0; i < count; ++i) {
             onProgress(i, count);
         }
@@ -140,21 +229,37 @@ public:
 
     [[nodiscard]] int countFiltered(int start, int end, FilterCallback filter) {
         int count = 0;
-        for (int i = start; i <= end; ++i) {
-            if (filter(i)) {
-                ++count;
-            }
-        }
+        forEachBatch(start, end, filter, [&](int keep) { count += keep ? 1 : 0; });
         return count;
     }
 
     [[nodiscard]] int sumTransformed(int start, int end, TransformCallback transform) {
         int sum = 0;
-        for (int i = start; i <= end; ++i) {
-            sum += transform(i);
-        }
+        forEachBatch(start, end, transform, [&](int value) { sum += value; });
         return sum;
     }
+
+    // Values per [batch] callback invocation
+    static constexpr int kCallbackBatch = 256;
+
+private:
+    // Hands start..end to a batch callback kCallbackBatch values at a time
+    template <typename Callback, typename Consume>
+    static void forEachBatch(int start, int end, const Callback& callback, Consume consume) {
+        int values[kCallbackBatch];
+        int results[kCallbackBatch];
+        for (long long first = start; first <= end; first += kCallbackBatch) {
+            int count = static_cast<int>(std::min<long long>(kCallbackBatch, end - first + 1));
+            for (int i = 0; i < count; ++i) {
+                values[i] = static_cast<int>(first + i);
+                results[i] = 0;  // defined even if the callback fails part-way
+            }
+            callback(values, results, count);
+            for (int i = 0; i < count; ++i) {
+                consume(results[i]);
+            }
+        }
+    }
 };
 
 /**
@@ -164,14 +269,11 @@ class SAMPLES_API ImageProcessor {
 public:
     ImageProcessor() = default;
 
-    // Process raw data pointer (e.g., image bytes)
+    // Process raw data pointer (e.g., image bytes): their sum, saturated at INT_MAX
     [[nodiscard]] int processRawData(const uint8_t* data, int size) {
         if (!data || size <= 0) return 0;
-        int sum = 0;
-        for (int i = 0; i < size; ++i) {
-            sum += data[i];
-        }
-        return sum;
+        const uint64_t sum = kernels::sumBytes(data, static_cast<size_t>(size));
+        return sum > static_cast<uint64_t>(INT_MAX) ? INT_MAX : static_cast<int>(sum);
     }
 
     // Read pixel from raw data
@@ -196,6 +298,15 @@ public:
         return static_cast<double>(box->width) / box->height;
     }
 
+    // Aspect ratio by value, batched through boxAspectRatioBatch
+    [[nodiscard]] double boxAspectRatio(BoundingBox box) const {
+        return box.height == 0 ? 0.0 : static_cast<double>(box.width) / box.height;
+    }
+
+    void boxAspectRatioBatch(const BoundingBox* box, double* out, int count) const {
+        kernels::boxAspectRatios(box, out, count);
+    }
+
     // Clone box - caller owns returned memory
     [[nodiscard]] BoundingBox* cloneBox(const BoundingBox& source) {
         auto* copy = new BoundingBox();
@@ -0,0 +1,99 @@
+// Throughput of the samples kernels at every SIMD level the machine supports,
+// e.g. idl_samples_kernels_bench --benchmark_filter=BoxAreas
+#include "samples.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using samples::kernels::SimdLevel;
+
+constexpr SimdLevel kLevels[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2,
+                                 SimdLevel::NEON, SimdLevel::SIMD128};
+
+std::vector<BoundingBox> makeBoxes(int count) {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(-1000, 1000);
+    std::uniform_int_distribution<int> extent(0, 500);
+    std::vector<BoundingBox> boxes(count);
+    for (auto& box : boxes) box = {coord(rng), coord(rng), extent(rng), extent(rng), 1.0};
+    return boxes;
+}
+
+std::vector<Point> makePoints(int count) {
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> coord(-1200, 1200);
+    std::vector<Point> points(count);
+    for (auto& point : points) point = {coord(rng), coord(rng)};
+    return points;
+}
+
+void BM_SumBytes(benchmark::State& state, SimdLevel level) {
+    std::vector<uint8_t> data(static_cast<size_t>(state.range(0)));
+    std::mt19937 rng(3);
+    for (auto& byte : data) byte = static_cast<uint8_t>(rng());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(samples::kernels::sumBytes(data.data(), data.size(), level));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_BoxAreas(benchmark::State& state, SimdLevel level) {
+    const int count = static_cast<int>(state.range(0));
+    const auto boxes = makeBoxes(count);
+    std::vector<int> out(count);
+    for (auto _ : state) {
+        samples::kernels::boxAreas(boxes.data(), out.data(), count, level);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+void BM_BoxesContainPoints(benchmark::State& state, SimdLevel level) {
+    const int count = static_cast<int>(state.range(0));
+    const auto boxes = makeBoxes(count);
+    const auto points = makePoints(count);
+    std::vector<int> out(count);
+    for (auto _ : state) {
+        samples::kernels::boxesContainPoints(boxes.data(), points.data(), out.data(), count, level);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+void BM_BoxAspectRatios(benchmark::State& state, SimdLevel level) {
+    const int count = static_cast<int>(state.range(0));
+    const auto boxes = makeBoxes(count);
+    std::vector<double> out(count);
+    for (auto _ : state) {
+        samples::kernels::boxAspectRatios(boxes.data(), out.data(), count, level);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+// One benchmark per kernel and supported level, named e.g. BM_BoxAreas/avx2/4096
+const bool g_registered = [] {
+    for (SimdLevel level : kLevels) {
+        if (!samples::kernels::isSupported(level)) continue;
+        const std::string suffix = std::string("/") + samples::kernels::levelName(level);
+        benchmark::RegisterBenchmark(("BM_SumBytes" + suffix).c_str(), BM_SumBytes, level)
+            ->Arg(4096)->Arg(1 << 20);
+        benchmark::RegisterBenchmark(("BM_BoxAreas" + suffix).c_str(), BM_BoxAreas, level)
+            ->Arg(64)->Arg(4096);
+        benchmark::RegisterBenchmark(("BM_BoxesContainPoints" + suffix).c_str(), BM_BoxesContainPoints, level)
+            ->Arg(64)->Arg(4096);
+        benchmark::RegisterBenchmark(("BM_BoxAspectRatios" + suffix).c_str(), BM_BoxAspectRatios, level)
+            ->Arg(64)->Arg(4096);
+    }
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK_MAIN();
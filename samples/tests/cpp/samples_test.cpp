@@ -2,10 +2,39 @@
 
 #include "samples.hpp"
 #include "samples_c_api.h"
+#include "samples_client.hpp"
+#include "samples_reflect.hpp"
+#include "samples_wire.h"
+#ifdef SAMPLES_IPC_SERVER
+#include "samples_ipc.hpp"
+#endif
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
+#ifdef SAMPLES_IPC_SERVER
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
 namespace {
 
 // Smart pointer deleters for C API handles
@@ -63,6 +92,79 @@ TEST(CalculatorTest, CAPIBasicArithmetic) {
     EXPECT_DOUBLE_EQ(Calculator_divide(calc.get(), 15.0, 3.0), 5.0);
 }
 
+TEST(CalculatorTest, CAPIBatch) {
+    CalculatorPtr calc(Calculator_create());
+    ASSERT_NE(calc, nullptr);
+    
+    const int a[] = {1, 2, 3, 4};
+    const int b[] = {10, 20, 30, 40};
+    int out[4] = {};
+    EXPECT_EQ(Calculator_add_batch(calc.get(), a, b, out, 4), 4);
+    EXPECT_EQ(out[0], 11);
+    EXPECT_EQ(out[3], 44);
+    
+    // Invalid handle or missing arrays are rejected before the loop
+    EXPECT_EQ(Calculator_add_batch(nullptr, a, b, out, 4), -1);
+    EXPECT_EQ(Calculator_add_batch(calc.get(), a, nullptr, out, 4), -1);
+    EXPECT_EQ(Calculator_add_batch(calc.get(), nullptr, nullptr, nullptr, 0), 0);
+}
+
+TEST(CalculatorTest, CAPILastError) {
+    CalculatorPtr calc(Calculator_create());
+    ASSERT_NE(calc, nullptr);
+
+    // A thrown std::invalid_argument becomes the sentinel plus a code and message
+    EXPECT_EQ(Calculator_quotient(calc.get(), 7, 0), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_INVALID_ARGUMENT);
+    EXPECT_STREQ(samples_last_error_message(), "Calculator_quotient: division by zero");
+
+    // INT_MIN / -1 does not fit an int; std::out_of_range is a logic_error too
+    EXPECT_EQ(Calculator_quotient(calc.get(), INT_MIN, -1), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_INVALID_ARGUMENT);
+    EXPECT_STREQ(samples_last_error_message(), "Calculator_quotient: quotient overflows int");
+    EXPECT_EQ(Calculator_quotient(calc.get(), INT_MIN, 1), INT_MIN);
+
+    // A real -1 is told apart by the code, which every checked call resets
+    EXPECT_EQ(Calculator_quotient(calc.get(), -7, 7), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_OK);
+    EXPECT_STREQ(samples_last_error_message(), "");
+
+    EXPECT_EQ(Calculator_add(nullptr, 1, 2), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_NULL_ARGUMENT);
+    EXPECT_STREQ(samples_last_error_message(), "Calculator_add: null handle");
+    EXPECT_EQ(Calculator_add_batch(calc.get(), nullptr, nullptr, nullptr, -1), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_INVALID_ARGUMENT);
+
+    // [noexcept] entry points neither check nor touch the last error
+    EXPECT_EQ(Calculator_subtract(calc.get(), 10, 7), 3);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(Calculator_getVersionMajor(calc.get()), 1);
+
+    Calculator_int_CStream* stream = Calculator_range(calc.get(), 0, 3);
+    ASSERT_NE(stream, nullptr);
+    int items[4] = {};
+    EXPECT_EQ(Calculator_int_CStream_next(stream, items, 0), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(Calculator_int_CStream_next(stream, nullptr, 4), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_NULL_ARGUMENT);
+    EXPECT_EQ(Calculator_int_CStream_next(stream, items, 4), 3);
+    EXPECT_EQ(samples_last_error(), SAMPLES_OK);
+    Calculator_int_CStream_free(stream);
+}
+
+TEST(CalculatorTest, CAPILastErrorPerThread) {
+    CalculatorPtr calc(Calculator_create());
+    ASSERT_NE(calc, nullptr);
+    EXPECT_EQ(Calculator_quotient(calc.get(), 1, 0), -1);
+
+    samples_error_code other = SAMPLES_ERROR_EXCEPTION;
+    std::thread([&] {
+        other = samples_last_error();
+    }).join();
+    EXPECT_EQ(other, SAMPLES_OK);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_INVALID_ARGUMENT);
+}
+
 // ============================================================================
 // Geometry Tests
 // ============================================================================
@@ -112,6 +214,172 @@ TEST(GeometryTest, CAPICreateLine) {
     EXPECT_EQ(data[4].x, 100);
 }
 
+TEST(GeometryTest, CAPICreateLineInto) {
+    GeometryPtr geom(Geometry_create());
+    ASSERT_NE(geom, nullptr);
+
+    // Size query: no buffer, only the count comes back
+    EXPECT_EQ(Geometry_createLine_into(geom.get(), 0, 0, 100, 100, 5, nullptr, 0), 5);
+
+    // Short buffer: total count returned, only capacity elements written
+    Point small[2] = {};
+    EXPECT_EQ(Geometry_createLine_into(geom.get(), 0, 0, 100, 100, 5, small, 2), 5);
+    EXPECT_EQ(small[0].x, 0);
+    EXPECT_EQ(small[1].x, 25);
+
+    Point points[8] = {};
+    EXPECT_EQ(Geometry_createLine_into(geom.get(), 0, 0, 100, 100, 5, points, 8), 5);
+    EXPECT_EQ(points[4].x, 100);
+    EXPECT_EQ(points[4].y, 100);
+
+    BoundingBox boxes[3] = {};
+    EXPECT_EQ(Geometry_findBoundingBoxes_into(geom.get(), 3, boxes, 3), 3);
+    EXPECT_EQ(boxes[2].x, 20);
+
+    EXPECT_EQ(Geometry_createLine_into(nullptr, 0, 0, 1, 1, 2, points, 8), -1);
+}
+
+TEST(GeometryTest, CAPIColumns) {
+    GeometryPtr geom(Geometry_create());
+    ASSERT_NE(geom, nullptr);
+
+    // [soa]: each BoundingBox member is its own contiguous array
+    Geometry_BoundingBox_CColumns* columns = Geometry_findBoundingBoxes_soa(geom.get(), 3);
+    ASSERT_NE(columns, nullptr);
+    ASSERT_EQ(Geometry_BoundingBox_CColumns_getCount(columns), 3);
+    const int* x = Geometry_BoundingBox_CColumns_getXColumn(columns);
+    const int* width = Geometry_BoundingBox_CColumns_getWidthColumn(columns);
+    const double* confidence = Geometry_BoundingBox_CColumns_getConfidenceColumn(columns);
+    ASSERT_NE(x, nullptr);
+    EXPECT_EQ(x[2], 20);
+    EXPECT_EQ(width[1], 51);
+    EXPECT_NEAR(confidence[0], 0.9, 1e-9);
+    EXPECT_NEAR(confidence[2], 0.7, 1e-9);
+    Geometry_BoundingBox_CColumns_free(columns);
+
+    Geometry_BoundingBox_CColumns* empty = Geometry_findBoundingBoxes_soa(geom.get(), 0);
+    ASSERT_NE(empty, nullptr);
+    EXPECT_EQ(Geometry_BoundingBox_CColumns_getCount(empty), 0);
+    EXPECT_EQ(Geometry_BoundingBox_CColumns_getXColumn(empty), nullptr);
+    Geometry_BoundingBox_CColumns_free(empty);
+
+    EXPECT_EQ(Geometry_findBoundingBoxes_soa(nullptr, 3), nullptr);
+    EXPECT_EQ(Geometry_BoundingBox_CColumns_getCount(nullptr), -1);
+}
+
+TEST(GeometryTest, CAPIStream) {
+    GeometryPtr geom(Geometry_create());
+    ASSERT_NE(geom, nullptr);
+    samples_native_memory base = {};
+    samples_native_memory_usage(&base);
+
+    // stream<T>: nothing is materialized, each _next copies at most max items
+    Geometry_BoundingBox_CStream* stream = Geometry_streamBoundingBoxes(geom.get(), 5);
+    ASSERT_NE(stream, nullptr);
+    BoundingBox boxes[2] = {};
+    ASSERT_EQ(Geometry_BoundingBox_CStream_next(stream, boxes, 2), 2);
+    EXPECT_EQ(boxes[1].x, 10);
+    ASSERT_EQ(Geometry_BoundingBox_CStream_next(stream, boxes, 2), 2);
+    EXPECT_EQ(boxes[1].width, 53);
+    ASSERT_EQ(Geometry_BoundingBox_CStream_next(stream, boxes, 2), 1);
+    EXPECT_NEAR(boxes[0].confidence, 0.5, 1e-9);
+    EXPECT_EQ(Geometry_BoundingBox_CStream_next(stream, boxes, 2), 0);
+    EXPECT_EQ(Geometry_BoundingBox_CStream_next(stream, boxes, 2), 0);
+    EXPECT_EQ(Geometry_BoundingBox_CStream_next(stream, boxes, 0), -1);
+    EXPECT_EQ(Geometry_BoundingBox_CStream_next(stream, nullptr, 2), -1);
+    EXPECT_EQ(Geometry_BoundingBox_CStream_next(nullptr, boxes, 2), -1);
+    Geometry_BoundingBox_CStream_free(stream);
+    Geometry_BoundingBox_CStream_free(nullptr);
+
+    samples_native_memory after = {};
+    samples_native_memory_usage(&after);
+    EXPECT_EQ(after.objects, base.objects);
+    EXPECT_EQ(after.bytes, base.bytes);
+    EXPECT_EQ(Geometry_streamBoundingBoxes(nullptr, 5), nullptr);
+}
+
+TEST(GeometryTest, CAPIPooledObjects) {
+    // Samples are generated with --pool: freed objects are reused on this thread
+    GeometryHandle* geom = Geometry_create();
+    ASSERT_NE(geom, nullptr);
+    Geometry_Point_CResult* first = Geometry_createLine(geom, 0, 0, 100, 100, 5);
+    ASSERT_NE(first, nullptr);
+    Geometry_Point_CResult_free(first);
+
+    Geometry_Point_CResult* second = Geometry_createLine(geom, 0, 0, 10, 10, 2);
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(Geometry_Point_CResult_getCount(second), 2);
+    EXPECT_EQ(Geometry_Point_CResult_getData(second)[1].x, 10);
+    Geometry_Point_CResult_free(second);
+
+    Geometry_destroy(geom);
+    GeometryHandle* again = Geometry_create();
+    EXPECT_EQ(again, geom);
+    EXPECT_EQ(Geometry_getLastCount(again), 0);
+    Geometry_destroy(again);
+
+    samples_pool_trim();
+}
+
+namespace {
+// Bumped by the replacement operator new below; per thread, so other tests' threads do not count
+thread_local uint64_t tAllocations = 0;
+
+template <typename F>
+uint64_t allocationsIn(F&& f) {
+    const uint64_t start = tAllocations;
+    f();
+    return tAllocations - start;
+}
+} // namespace
+
+TEST(GeometryTest, CAPIPoolSteadyStateDoesNotAllocate) {
+    // Warm the free lists, then check that a steady-state create/destroy and a [fill]
+    // result allocate nothing: the impl lives in the handle, the vector keeps its capacity
+    GeometryHandle* geom = Geometry_create();
+    ASSERT_NE(geom, nullptr);
+    Geometry_destroy(Geometry_create());
+    Geometry_Point_CResult_free(Geometry_createLine(geom, 0, 0, 10, 10, 4));
+
+    EXPECT_EQ(allocationsIn([] { Geometry_destroy(Geometry_create()); }), 0u);
+    EXPECT_EQ(allocationsIn([&] {
+        Geometry_Point_CResult_free(Geometry_createLine(geom, 0, 0, 10, 10, 4));
+    }), 0u);
+
+    // A larger result grows the recycled buffer once and still comes back complete
+    Geometry_Point_CResult* line = nullptr;
+    EXPECT_EQ(allocationsIn([&] { line = Geometry_createLine(geom, 0, 0, 90, 90, 10); }), 1u);
+    ASSERT_NE(line, nullptr);
+    ASSERT_EQ(Geometry_Point_CResult_getCount(line), 10);
+    EXPECT_EQ(Geometry_Point_CResult_getData(line)[9].x, 90);
+    Geometry_Point_CResult_free(line);
+    EXPECT_EQ(allocationsIn([&] {
+        Geometry_Point_CResult_free(Geometry_createLine(geom, 0, 0, 10, 10, 4));
+    }), 0u);
+
+    Geometry_destroy(geom);
+    samples_pool_trim();
+    EXPECT_EQ(allocationsIn([] { Geometry_destroy(Geometry_create()); }), 1u);
+    samples_pool_trim();
+}
+
+TEST(GeometryTest, CAPIFillIntoDoesNotAllocate) {
+    // [fill]: _into hands the caller's buffer to createLineFill, with no vector in between
+    GeometryHandle* geom = Geometry_create();
+    ASSERT_NE(geom, nullptr);
+    Point points[8] = {};
+    BoundingBox boxes[4] = {};
+    int total = 0;
+    EXPECT_EQ(allocationsIn([&] { total = Geometry_createLine_into(geom, 0, 0, 70, 70, 8, points, 8); }), 0u);
+    EXPECT_EQ(total, 8);
+    EXPECT_EQ(points[7].x, 70);
+    EXPECT_EQ(allocationsIn([&] { total = Geometry_findBoundingBoxes_into(geom, 6, boxes, 4); }), 0u);
+    EXPECT_EQ(total, 6);
+    EXPECT_EQ(boxes[3].x, 30);
+    EXPECT_EQ(Geometry_getLastCount(geom), 6);
+    Geometry_destroy(geom);
+}
+
 // ============================================================================
 // ShapeProcessor Tests
 // ============================================================================
@@ -189,6 +457,177 @@ TEST(ShapeProcessorTest, CAPIStructParameters) {
     EXPECT_TRUE(ShapeProcessor_boxContainsPoint(processor.get(), testBox, testPoint));
 }
 
+TEST(ShapeProcessorTest, CAPIBatch) {
+    ShapeProcessorPtr processor(ShapeProcessor_create());
+    ASSERT_NE(processor, nullptr);
+    
+    const BoundingBox boxes[] = {{0, 0, 10, 20, 0.5}, {0, 0, 3, 4, 0.9}, {5, 5, 0, 7, 0.1}};
+    int areas[3] = {};
+    EXPECT_EQ(ShapeProcessor_calculateArea_batch(processor.get(), boxes, areas, 3), 3);
+    EXPECT_EQ(areas[0], 200);
+    EXPECT_EQ(areas[1], 12);
+    EXPECT_EQ(areas[2], 0);
+    
+    const Point points[] = {{5, 5}, {20, 20}, {6, 6}};
+    int contains[3] = {};
+    EXPECT_EQ(ShapeProcessor_boxContainsPoint_batch(processor.get(), boxes, points, contains, 3), 3);
+    EXPECT_EQ(contains[0], 1);
+    EXPECT_EQ(contains[1], 0);
+    EXPECT_EQ(contains[2], 0);
+    
+    const int dx[] = {1, 2, 3};
+    const int dy[] = {-1, -2, -3};
+    Point moved[3] = {};
+    EXPECT_EQ(ShapeProcessor_translate_batch(processor.get(), points, dx, dy, moved, 3), 3);
+    EXPECT_EQ(moved[1].x, 22);
+    EXPECT_EQ(moved[1].y, 18);
+}
+
+TEST(ShapeProcessorTest, CAPIBatchKernel) {
+    ShapeProcessorPtr processor(ShapeProcessor_create());
+    ASSERT_NE(processor, nullptr);
+
+    // 11 boxes: one full AVX2 block, then a tail for the scalar loop
+    std::vector<BoundingBox> boxes;
+    std::vector<Point> points;
+    for (int i = 0; i < 11; ++i) {
+        boxes.push_back({i, -i, i + 1, 2 * i, 1.0});
+        points.push_back({2 * i, i % 3 == 0 ? 0 : -i});
+    }
+    std::vector<int> areas(boxes.size());
+    std::vector<int> contains(boxes.size());
+    EXPECT_EQ(ShapeProcessor_calculateArea_batch(processor.get(), boxes.data(), areas.data(), 11), 11);
+    EXPECT_EQ(ShapeProcessor_boxContainsPoint_batch(processor.get(), boxes.data(), points.data(),
+                                                    contains.data(), 11), 11);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        EXPECT_EQ(areas[i], ShapeProcessor_calculateArea(processor.get(), boxes[i])) << i;
+        EXPECT_EQ(contains[i], ShapeProcessor_boxContainsPoint(processor.get(), boxes[i], points[i]) ? 1 : 0) << i;
+    }
+    EXPECT_EQ(ShapeProcessor_calculateArea_batch(processor.get(), nullptr, nullptr, 0), 0);
+    EXPECT_EQ(ShapeProcessor_calculateArea_batch(processor.get(), boxes.data(), nullptr, 11), -1);
+}
+
+// ============================================================================
+// Kernel Tests (scalar reference vs. SIMD levels)
+// ============================================================================
+
+namespace {
+
+using samples::kernels::SimdLevel;
+
+constexpr SimdLevel kAllLevels[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2,
+                                    SimdLevel::NEON, SimdLevel::SIMD128};
+
+std::vector<BoundingBox> randomBoxes(std::mt19937& rng, int count) {
+    std::uniform_int_distribution<int> coord(-1000, 1000);
+    std::uniform_int_distribution<int> extent(0, 500);
+    std::vector<BoundingBox> boxes(count);
+    for (auto& box : boxes) {
+        // Every fourth height is 0 so the aspect ratio masking is exercised
+        box = {coord(rng), coord(rng), extent(rng), rng() % 4 == 0 ? 0 : extent(rng), 0.5};
+    }
+    return boxes;
+}
+
+}  // namespace
+
+TEST(KernelsTest, LevelsAreReported) {
+    EXPECT_TRUE(samples::kernels::isSupported(SimdLevel::Scalar));
+    EXPECT_TRUE(samples::kernels::isSupported(samples::kernels::activeLevel()));
+    EXPECT_STREQ(samples::kernels::levelName(SimdLevel::Scalar), "scalar");
+    EXPECT_STREQ(samples::kernels::levelName(SimdLevel::AVX2), "avx2");
+}
+
+TEST(KernelsTest, EveryLevelMatchesScalar) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(-1200, 1200);
+    // Lengths around the 4- and 8-wide blocks, so every tail size runs
+    for (int count = 0; count <= 37; ++count) {
+        const auto boxes = randomBoxes(rng, count);
+        std::vector<Point> points(count);
+        for (auto& point : points) point = {coord(rng), coord(rng)};
+
+        std::vector<int> areas(count), contains(count);
+        std::vector<double> ratios(count);
+        samples::kernels::boxAreas(boxes.data(), areas.data(), count, SimdLevel::Scalar);
+        samples::kernels::boxesContainPoints(boxes.data(), points.data(), contains.data(), count, SimdLevel::Scalar);
+        samples::kernels::boxAspectRatios(boxes.data(), ratios.data(), count, SimdLevel::Scalar);
+
+        for (SimdLevel level : kAllLevels) {
+            if (!samples::kernels::isSupported(level)) continue;
+            SCOPED_TRACE(std::string(samples::kernels::levelName(level)) + " count " + std::to_string(count));
+            std::vector<int> levelAreas(count, -1), levelContains(count, -1);
+            std::vector<double> levelRatios(count, -1.0);
+            samples::kernels::boxAreas(boxes.data(), levelAreas.data(), count, level);
+            samples::kernels::boxesContainPoints(boxes.data(), points.data(), levelContains.data(), count, level);
+            samples::kernels::boxAspectRatios(boxes.data(), levelRatios.data(), count, level);
+            EXPECT_EQ(levelAreas, areas);
+            EXPECT_EQ(levelContains, contains);
+            EXPECT_EQ(levelRatios, ratios);
+        }
+    }
+}
+
+TEST(KernelsTest, ExtremeBoxesWrapLikeTheSimdLanes) {
+    // Products and edges past INT_MAX wrap at every level instead of overflowing
+    const std::vector<BoundingBox> boxes(8, BoundingBox{INT_MAX - 1, INT_MIN, 65536, INT_MAX, 0.5});
+    const std::vector<Point> points(8, Point{INT_MAX, INT_MIN});
+    samples::ShapeProcessor shapes;
+    for (SimdLevel level : kAllLevels) {
+        if (!samples::kernels::isSupported(level)) continue;
+        SCOPED_TRACE(samples::kernels::levelName(level));
+        std::vector<int> areas(8), contains(8, -1);
+        samples::kernels::boxAreas(boxes.data(), areas.data(), 8, level);
+        samples::kernels::boxesContainPoints(boxes.data(), points.data(), contains.data(), 8, level);
+        for (int i = 0; i < 8; ++i) {
+            EXPECT_EQ(areas[i], -65536);  // 65536 * (2^31 - 1) mod 2^32
+            EXPECT_EQ(areas[i], shapes.calculateArea(boxes[i]));
+            EXPECT_EQ(contains[i], 0);    // x + width wraps below point.x
+            EXPECT_EQ(contains[i], shapes.boxContainsPoint(boxes[i], points[i]) ? 1 : 0);
+        }
+    }
+}
+
+TEST(KernelsTest, SumBytesMatchesScalar) {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> data(70000);
+    for (auto& byte : data) byte = static_cast<uint8_t>(rng());
+    // All 255 too: the widest per-lane accumulation the narrow NEON/WASM counters must flush
+    std::vector<uint8_t> full(70000, 255);
+    for (size_t size : {size_t{0}, size_t{1}, size_t{15}, size_t{16}, size_t{33}, size_t{2049}, data.size()}) {
+        const uint64_t expected = samples::kernels::sumBytes(data.data(), size, SimdLevel::Scalar);
+        for (SimdLevel level : kAllLevels) {
+            if (!samples::kernels::isSupported(level)) continue;
+            SCOPED_TRACE(std::string(samples::kernels::levelName(level)) + " size " + std::to_string(size));
+            EXPECT_EQ(samples::kernels::sumBytes(data.data(), size, level), expected);
+            EXPECT_EQ(samples::kernels::sumBytes(full.data(), size, level), 255u * size);
+        }
+    }
+}
+
+TEST(KernelsTest, ProcessRawDataSaturates) {
+    samples::ImageProcessor processor;
+    const std::vector<uint8_t> data(INT_MAX / 255 + 1, 255);
+    EXPECT_EQ(processor.processRawData(data.data(), static_cast<int>(data.size())), INT_MAX);
+    EXPECT_EQ(processor.processRawData(data.data(), 4), 4 * 255);
+}
+
+TEST(KernelsTest, CAPIAspectRatioBatch) {
+    auto* processor = ImageProcessor_create();
+    ASSERT_NE(processor, nullptr);
+    std::mt19937 rng(3);
+    auto boxes = randomBoxes(rng, 13);
+    std::vector<double> ratios(boxes.size());
+    EXPECT_EQ(ImageProcessor_boxAspectRatio_batch(processor, boxes.data(), ratios.data(), 13), 13);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        EXPECT_EQ(ratios[i], ImageProcessor_boxAspectRatio(processor, boxes[i])) << i;
+        if (boxes[i].height == 0) {
+            EXPECT_EQ(ratios[i], 0.0);
+        }
+    }
+    ImageProcessor_destroy(processor);
+}
+
 // ============================================================================
 // AsyncProcessor Tests (Callbacks)
 // ============================================================================
@@ -212,8 +651,8 @@ TEST(AsyncProcessorTest, ProcessWithProgress) {
 TEST(AsyncProcessorTest, CountFiltered) {
     samples::AsyncProcessor processor;
     
-    int evenCount = processor.countFiltered(1, 10, [](int value) {
-        return value % 2 == 0;
+    int evenCount = processor.countFiltered(1, 10, [](const int* value, int* keep, int count) {
+        for (int i = 0; i < count; ++i) keep[i] = value[i] % 2 == 0;
     });
     EXPECT_EQ(evenCount, 5);
 }
@@ -221,37 +660,159 @@ TEST(AsyncProcessorTest, CountFiltered) {
 TEST(AsyncProcessorTest, SumTransformed) {
     samples::AsyncProcessor processor;
     
-    int sumSquares = processor.sumTransformed(1, 5, [](int value) {
-        return value * value;
+    int sumSquares = processor.sumTransformed(1, 5, [](const int* value, int* result, int count) {
+        for (int i = 0; i < count; ++i) result[i] = value[i] * value[i];
     });
     EXPECT_EQ(sumSquares, 55);
 }
 
+TEST(AsyncProcessorTest, BatchCallbackInvocations) {
+    samples::AsyncProcessor processor;
+    constexpr int batch = samples::AsyncProcessor::kCallbackBatch;
+
+    // [batch] callbacks see whole runs of values, at most kCallbackBatch at a time
+    std::vector<int> batchSizes;
+    int total = processor.sumTransformed(1, 2 * batch + 3, [&](const int* value, int* result, int count) {
+        batchSizes.push_back(count);
+        for (int i = 0; i < count; ++i) result[i] = value[i];
+    });
+    EXPECT_EQ(total, (2 * batch + 3) * (2 * batch + 4) / 2);
+    EXPECT_EQ(batchSizes, (std::vector<int>{batch, batch, 3}));
+
+    EXPECT_EQ(processor.countFiltered(5, 4, [](const int*, int*, int) { ADD_FAILURE(); }), 0);
+}
+
 TEST(AsyncProcessorTest, CAPICallbacks) {
     AsyncProcessorPtr processor(AsyncProcessor_create());
     ASSERT_NE(processor, nullptr);
     
-    static std::vector<std::pair<int, int>> s_progressCalls;
-    s_progressCalls.clear();
+    // State reaches the callback through user_data, no statics needed
+    std::vector<std::pair<int, int>> progressCalls;
     
-    int result = AsyncProcessor_processWithProgress(processor.get(), 3, [](int current, int total) {
-        s_progressCalls.push_back({current, total});
-    });
+    int result = AsyncProcessor_processWithProgress(processor.get(), 3, [](int current, int total, void* user_data) {
+        static_cast<std::vector<std::pair<int, int>>*>(user_data)->push_back({current, total});
+    }, &progressCalls);
     
     EXPECT_EQ(result, 3);
-    ASSERT_EQ(s_progressCalls.size(), 3u);
+    ASSERT_EQ(progressCalls.size(), 3u);
+    EXPECT_EQ(progressCalls[2], std::make_pair(2, 3));
     
-    int countGtFive = AsyncProcessor_countFiltered(processor.get(), 1, 10, [](int value) -> int {
-        return value > 5 ? 1 : 0;
-    });
+    // [batch] callbacks take the argument and result arrays plus their length
+    int threshold = 5;
+    int countGtFive = AsyncProcessor_countFiltered(processor.get(), 1, 10,
+        [](const int* value, int* keep, int count, void* user_data) {
+            for (int i = 0; i < count; ++i) keep[i] = value[i] > *static_cast<int*>(user_data) ? 1 : 0;
+        }, &threshold);
     EXPECT_EQ(countGtFive, 5);
     
-    int sumDoubled = AsyncProcessor_sumTransformed(processor.get(), 1, 3, [](int value) -> int {
-        return value * 2;
-    });
+    int sumDoubled = AsyncProcessor_sumTransformed(processor.get(), 1, 3,
+        [](const int* value, int* result, int count, void*) {
+            for (int i = 0; i < count; ++i) result[i] = value[i] * 2;
+        }, nullptr);
     EXPECT_EQ(sumDoubled, 12);
 }
 
+TEST(AsyncProcessorTest, CAPISubmit) {
+    AsyncProcessorPtr processor(AsyncProcessor_create());
+    ASSERT_NE(processor, nullptr);
+
+    // done runs on a pool thread: hand the result back through a mutex-guarded slot
+    struct Completion {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+        int result = 0;
+        int error = 0;
+        std::atomic<int> progressCalls{0};
+    } completion;
+
+    int rc = AsyncProcessor_processWithProgress_submit(processor.get(), 4,
+        [](int, int, void* user_data) {
+            ++static_cast<Completion*>(user_data)->progressCalls;
+        }, &completion,
+        [](int result, int error, void* user_data) {
+            auto* c = static_cast<Completion*>(user_data);
+            std::lock_guard<std::mutex> lock(c->mutex);
+            c->result = result;
+            c->error = error;
+            c->finished = true;
+            c->cv.notify_one();
+        }, &completion);
+    ASSERT_EQ(rc, 0);
+
+    std::unique_lock<std::mutex> lock(completion.mutex);
+    ASSERT_TRUE(completion.cv.wait_for(lock, std::chrono::seconds(10), [&] { return completion.finished; }));
+    EXPECT_EQ(completion.error, 0);
+    EXPECT_EQ(completion.result, 4);
+    EXPECT_EQ(completion.progressCalls.load(), 4);
+    lock.unlock();
+
+    // A throwing call reports -1, and done can read why from the worker's last error
+    struct Failure {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+        int error = 0;
+        int code = 0;
+        std::string message;
+    } failure;
+    ASSERT_EQ(AsyncProcessor_processWithProgress_submit(processor.get(), -1, [](int, int, void*) {}, nullptr,
+        [](int, int error, void* user_data) {
+            auto* f = static_cast<Failure*>(user_data);
+            std::lock_guard<std::mutex> guard(f->mutex);
+            f->error = error;
+            f->code = samples_last_error();
+            f->message = samples_last_error_message();
+            f->finished = true;
+            f->cv.notify_one();
+        }, &failure), 0);
+    std::unique_lock<std::mutex> failureLock(failure.mutex);
+    ASSERT_TRUE(failure.cv.wait_for(failureLock, std::chrono::seconds(10), [&] { return failure.finished; }));
+    EXPECT_EQ(failure.error, -1);
+    EXPECT_EQ(failure.code, SAMPLES_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(failure.message, "AsyncProcessor_processWithProgress_submit: negative count");
+
+    auto done = [](int, int, void*) {};
+    EXPECT_EQ(AsyncProcessor_processWithProgress_submit(nullptr, 1, nullptr, nullptr, done, nullptr), -1);
+    EXPECT_EQ(AsyncProcessor_processWithProgress_submit(processor.get(), 1, nullptr, nullptr, nullptr, nullptr), -1);
+    EXPECT_EQ(samples_run_async(nullptr, nullptr), -1);
+    EXPECT_EQ(samples_last_error(), SAMPLES_ERROR_NULL_ARGUMENT);
+    EXPECT_STREQ(samples_last_error_message(), "samples_run_async: null task");
+}
+
+TEST(AsyncProcessorTest, CAPIDestroyWhileQueued) {
+    // The queued task holds its own reference: destroying right after _submit is safe and
+    // the call still completes against the live object
+    struct Completion {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int finished = 0;
+        int sum = 0;
+    } completion;
+    auto done = [](int result, int error, void* user_data) {
+        auto* c = static_cast<Completion*>(user_data);
+        std::lock_guard<std::mutex> lock(c->mutex);
+        c->sum += error == 0 ? result : -1000;
+        ++c->finished;
+        c->cv.notify_one();
+    };
+    auto identity = [](const int* values, int* results, int count, void*) {
+        std::copy(values, values + count, results);
+    };
+
+    const int kCalls = 8;
+    for (int i = 0; i < kCalls; ++i) {
+        AsyncProcessorHandle* processor = AsyncProcessor_create();
+        ASSERT_NE(processor, nullptr);
+        ASSERT_EQ(AsyncProcessor_sumTransformed_submit(processor, 1, 4, identity, nullptr, done, &completion), 0);
+        AsyncProcessor_destroy(processor);
+    }
+
+    std::unique_lock<std::mutex> lock(completion.mutex);
+    ASSERT_TRUE(completion.cv.wait_for(lock, std::chrono::seconds(10), [&] { return completion.finished == kCalls; }));
+    EXPECT_EQ(completion.sum, kCalls * (1 + 2 + 3 + 4));
+}
+
 // ============================================================================
 // TaskProcessor Tests (Enum support)
 // ============================================================================
@@ -324,7 +885,530 @@ TEST(TaskProcessorTest, CAPIEnumMethods) {
     EXPECT_TRUE(TaskProcessor_isPrimaryColor(processor.get(), Color_Blue));
 }
 
+TEST(TaskProcessorTest, CAPIStringInto) {
+    TaskProcessorPtr processor(TaskProcessor_create());
+    ASSERT_NE(processor, nullptr);
+
+    // Size query, then an exact fit including the terminator
+    EXPECT_EQ(TaskProcessor_statusToString_into(processor.get(), Status_Completed, nullptr, 0), 9);
+    char buf[10];
+    EXPECT_EQ(TaskProcessor_statusToString_into(processor.get(), Status_Completed, buf, sizeof(buf)), 9);
+    EXPECT_STREQ(buf, "Completed");
+
+    // Truncated output is still terminated
+    char small[4];
+    EXPECT_EQ(TaskProcessor_statusToString_into(processor.get(), Status_Completed, small, sizeof(small)), 9);
+    EXPECT_STREQ(small, "Com");
+
+    EXPECT_EQ(TaskProcessor_statusToString_into(nullptr, Status_Active, buf, sizeof(buf)), -1);
+}
+
+TEST(TaskProcessorTest, CAPIStringReturnPerThread) {
+    TaskProcessorPtr processor(TaskProcessor_create());
+    ASSERT_NE(processor, nullptr);
+
+    // Each thread owns its result storage, so one handle can be shared
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            const Status status = (t % 2) ? Status_Active : Status_Failed;
+            const char* expected = (t % 2) ? "Active" : "Failed";
+            for (int i = 0; i < 1000; ++i) {
+                const char* text = TaskProcessor_statusToString(processor.get(), status);
+                if (std::strcmp(text, expected) != 0) ++mismatches;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST(CAPITest, ApiTable) {
+    const samples_api* api = samples_get_api();
+    ASSERT_NE(api, nullptr);
+    EXPECT_EQ(api->size, sizeof(samples_api));
+    EXPECT_EQ(api->Calculator_add, &Calculator_add);
+    EXPECT_EQ(api->TaskProcessor_statusToString_into, &TaskProcessor_statusToString_into);
+
+    // One lookup is enough to drive the whole API
+    CalculatorPtr calc(api->Calculator_create());
+    ASSERT_NE(calc, nullptr);
+    EXPECT_EQ(api->Calculator_add(calc.get(), 20, 22), 42);
+}
+
+TEST(CAPITest, StatsSnapshot) {
+    samples_stats_reset();
+
+    CalculatorPtr calc(Calculator_create());
+    for (int i = 0; i < 3; ++i) Calculator_add(calc.get(), i, 1);
+    auto* processor = ImageProcessor_create();
+    uint8_t data[16] = {};
+    ImageProcessor_processRawData(processor, data, 16);
+    ImageProcessor_processRawData(processor, data, 16);
+    ImageProcessor_destroy(processor);
+
+    const int count = samples_stats_snapshot(nullptr, 0);
+    ASSERT_GT(count, 0);
+    EXPECT_EQ(samples_stats_snapshot(nullptr, -1), -1);
+    std::vector<samples_method_stats> stats(count);
+    ASSERT_EQ(samples_stats_snapshot(stats.data(), count), count);
+
+    auto find = [&](const char* name) -> const samples_method_stats& {
+        for (const auto& s : stats) {
+            if (std::strcmp(s.name, name) == 0) return s;
+        }
+        ADD_FAILURE() << "no stats for " << name;
+        return stats.front();
+    };
+    EXPECT_EQ(find("Calculator_add").calls, 3u);
+    EXPECT_EQ(find("Calculator_add").bytes, 0u);  // scalars are not counted
+    EXPECT_EQ(find("Calculator_subtract").calls, 0u);
+    EXPECT_EQ(find("ImageProcessor_processRawData").calls, 2u);
+    EXPECT_EQ(find("ImageProcessor_processRawData").bytes, 32u);
+    EXPECT_EQ(find("ImageProcessor_create").calls, 1u);
+
+    samples_stats_reset();
+    ASSERT_EQ(samples_stats_snapshot(stats.data(), count), count);
+    EXPECT_EQ(find("Calculator_add").calls, 0u);
+    EXPECT_EQ(find("Calculator_add").total_ns, 0u);
+}
+
+TEST(CAPITest, NativeMemoryUsage) {
+    samples_native_memory base = {};
+    samples_native_memory_usage(&base);
+
+    GeometryPtr geom(Geometry_create());
+    ASSERT_NE(geom, nullptr);
+    Geometry_Point_CResult* line = Geometry_createLine(geom.get(), 0, 0, 100, 100, 100);
+    Geometry_BoundingBox_CColumns* columns = Geometry_findBoundingBoxes_soa(geom.get(), 50);
+    samples_native_memory live = {};
+    samples_native_memory_usage(&live);
+    EXPECT_EQ(live.objects, base.objects + 3);
+    EXPECT_GE(live.bytes, base.bytes + 100 * sizeof(Point) + 50 * sizeof(BoundingBox));
+
+    // Freeing returns exactly what was counted, pooled or not
+    Geometry_Point_CResult_free(line);
+    Geometry_BoundingBox_CColumns_free(columns);
+    Geometry_Point_CResult_free(nullptr);
+    geom.reset();
+    samples_native_memory after = {};
+    samples_native_memory_usage(&after);
+    EXPECT_EQ(after.objects, base.objects);
+    EXPECT_EQ(after.bytes, base.bytes);
+
+    samples_native_memory_usage(nullptr);
+}
+
+// The client is compiled with SAMPLES_CLIENT_STATIC_LINK, so these calls go straight to the C API
+TEST(ClientTest, StaticLinkCalls) {
+    ASSERT_TRUE(samples_client::initialize(""));
+    EXPECT_TRUE(samples_client::isInitialized());
+
+    samples_client::Calculator calc;
+    EXPECT_EQ(calc.add(2, 3), 5);
+    EXPECT_EQ(calc.addBatch({1, 2}, {10, 20}), (std::vector<int>{11, 22}));
+
+    samples_client::Geometry geom;
+    auto line = geom.createLine(0, 0, 10, 10, 3).toVector();
+    ASSERT_EQ(line.size(), 3u);
+    EXPECT_EQ(line[2].x, 10);
+
+    std::vector<Point> reused;
+    EXPECT_EQ(geom.createLineInto(0, 0, 10, 10, 3, reused), 3);
+    EXPECT_EQ(reused.size(), 3u);
+
+    auto columns = geom.findBoundingBoxesColumns(4);
+    ASSERT_EQ(columns.count(), 4);
+    EXPECT_EQ(columns.y()[3], 30);
+    EXPECT_NEAR(columns.confidence()[1], 0.8, 1e-9);
+
+    samples_client::TaskProcessor tasks;
+    std::string text;
+    EXPECT_EQ(tasks.statusToStringInto(Status_Completed, text), 9);
+    EXPECT_EQ(text, "Completed");
+    EXPECT_EQ(tasks.statusToString(Status_Active), "Active");
+}
+
+TEST(ClientTest, FailuresThrowTheLastError) {
+    samples_client::Calculator calc;
+    try {
+        (void)calc.quotient(1, 0);
+        FAIL() << "quotient(1, 0) did not throw";
+    } catch (const samples_client::Error& e) {
+        EXPECT_EQ(e.code(), SAMPLES_ERROR_INVALID_ARGUMENT);
+        EXPECT_STREQ(e.what(), "Calculator_quotient: division by zero");
+    }
+    // -1 is also an ordinary result: the sentinel alone does not throw
+    EXPECT_EQ(calc.quotient(-7, 7), -1);
+}
+
+TEST(ClientTest, ClassHandlesAcrossCalls) {
+    samples_client::ObjectManager manager;
+
+    // createCalculator hands back an owning client object around the new handle
+    samples_client::Calculator created = manager.createCalculator();
+    ASSERT_NE(created.handle(), nullptr);
+    EXPECT_EQ(manager.useCalculator(&created, 4, 5), 9);
+    EXPECT_EQ(manager.getCalculatorVersion(created), 100);
+    EXPECT_EQ(manager.useCalculator(nullptr, 4, 5), 0);
+
+    // Deleters are stateless, so the smart pointers stay pointer-sized
+    static_assert(sizeof(samples_client::Calculator) == sizeof(void*), "handle_ must not carry a deleter");
+    static_assert(sizeof(samples_client::GeometryPointResult) == sizeof(void*), "result_ must not carry a deleter");
+}
+
+TEST(ClientTest, BatchCallbacks) {
+    samples_client::AsyncProcessor processor;
+
+    // The client keeps per-element std::function callbacks and unpacks each batch
+    EXPECT_EQ(processor.countFiltered(1, 600, [](int value) { return value % 3 == 0; }), 200);
+    EXPECT_EQ(processor.sumTransformed(1, 1000, [](int value) { return value; }), 500500);
+}
+
+TEST(ClientTest, AsyncFutures) {
+    samples_client::AsyncProcessor processor;
+
+    // Many calls in flight at once; each future owns a copy of its callback
+    std::vector<std::future<int>> sums;
+    for (int i = 1; i <= 8; ++i) {
+        sums.push_back(processor.sumTransformedAsync(1, i, [i](int value) { return value * i; }));
+    }
+    for (int i = 1; i <= 8; ++i) {
+        EXPECT_EQ(sums[i - 1].get(), i * i * (i + 1) / 2);
+    }
+
+    std::atomic<int> progressCalls{0};
+    EXPECT_EQ(processor.processWithProgressAsync(5, [&](int, int) { ++progressCalls; }).get(), 5);
+    EXPECT_EQ(progressCalls.load(), 5);
+
+    samples_client::TaskProcessor tasks;
+    EXPECT_EQ(tasks.statusToStringAsync(Status_Failed).get(), "Failed");
+
+    // A moved-from object has no handle: the future fails instead of the call
+    samples_client::TaskProcessor moved(std::move(tasks));
+    EXPECT_THROW(tasks.statusToStringAsync(Status_Active).get(), samples_client::Error);
+
+    // A call that throws on the worker fails its future with the typed error it left
+    std::future<int> failing = processor.processWithProgressAsync(-1, [](int, int) {});
+    try {
+        failing.get();
+        ADD_FAILURE() << "processWithProgressAsync(-1) did not throw";
+    } catch (const samples_client::Error& e) {
+        EXPECT_EQ(e.code(), SAMPLES_ERROR_INVALID_ARGUMENT);
+        EXPECT_STREQ(e.what(), "AsyncProcessor_processWithProgress_submit: negative count");
+    }
+}
+
+TEST(ClientTest, StreamRanges) {
+    samples_client::Geometry geom;
+    auto expected = geom.findBoundingBoxes(600).toVector();
+    std::vector<BoundingBox> streamed;
+    for (const BoundingBox& box : geom.streamBoundingBoxes(600)) {
+        streamed.push_back(box);
+    }
+    ASSERT_EQ(streamed.size(), expected.size());
+    EXPECT_EQ(streamed[599].y, expected[599].y);
+    EXPECT_NEAR(streamed[599].confidence, expected[599].confidence, 1e-9);
+
+    // Breaking out does not consume the current item: the next loop starts with it
+    samples_client::Calculator calc;
+    auto range = calc.range(1, 1000);
+    int64_t sum = 0;
+    for (int value : range) {
+        if (value > 10) break;
+        sum += value;
+    }
+    EXPECT_EQ(sum, 55);
+    EXPECT_EQ(*range.begin(), 11);
+
+    // next() pulls past the chunk the loop buffered
+    int chunk[4] = {};
+    ASSERT_EQ(range.next(chunk, 4), 4);
+    EXPECT_EQ(chunk[0], 1 + samples_client::CalculatorintStream::kChunk);
+    int left = 0;
+    for (int value : range) left += value > 0;
+    EXPECT_EQ(left, 1000 - 4 - 10);
+    EXPECT_EQ(range.begin(), range.end());
+}
+
+// Everything below is resolved at compile time
+namespace reflect = samples::reflect;
+static_assert(reflect::TypeInfo<BoundingBox>::field_count == 5);
+static_assert(reflect::field_index<BoundingBox>("confidence") == 4);
+static_assert(reflect::field_index<BoundingBox>("missing") == 5);
+static_assert(std::get<4>(reflect::TypeInfo<BoundingBox>::fields).offset == offsetof(BoundingBox, confidence));
+static_assert(reflect::enum_name(Status_Completed) == "Completed");
+static_assert(reflect::is_reflected_v<samples::Calculator> && !reflect::is_reflected_v<int>);
+static_assert(reflect::is_reflected_enum_v<Color>);
+
+TEST(ReflectTest, StructFields) {
+    BoundingBox box{1, 2, 30, 40, 0.5};
+    std::vector<std::string> names;
+    double sum = 0;
+    reflect::for_each_field(box, [&](std::string_view name, auto& value) {
+        names.emplace_back(name);
+        sum += static_cast<double>(value);
+    });
+    EXPECT_EQ(names, (std::vector<std::string>{"x", "y", "width", "height", "confidence"}));
+    EXPECT_DOUBLE_EQ(sum, 73.5);
+
+    // Writes through the member pointer
+    std::get<0>(reflect::TypeInfo<BoundingBox>::fields).get(box) = 7;
+    EXPECT_EQ(box.x, 7);
+}
+
+TEST(ReflectTest, MethodsCallTheImplementation) {
+    samples::Calculator calc;
+    const auto& add = std::get<0>(reflect::TypeInfo<samples::Calculator>::methods);
+    EXPECT_EQ(add.name, "add");
+    EXPECT_EQ(add(calc, 2, 3), 5);
+
+    std::vector<std::string> names;
+    reflect::for_each_method<samples::TaskProcessor>([&](const auto& method) { names.emplace_back(method.name); });
+    EXPECT_EQ(names.front(), "getStatus");
+    EXPECT_EQ(names.size(), reflect::TypeInfo<samples::TaskProcessor>::method_count);
+}
+
+TEST(ReflectTest, EnumNames) {
+    Status status = Status_Unknown;
+    EXPECT_TRUE(reflect::enum_from_name("Failed", status));
+    EXPECT_EQ(status, Status_Failed);
+    EXPECT_FALSE(reflect::enum_from_name("Bogus", status));
+    EXPECT_EQ(status, Status_Failed);
+    EXPECT_EQ(reflect::enum_name(static_cast<Status>(42)), "");
+    EXPECT_EQ(reflect::EnumInfo<Color>::values.size(), 3u);
+}
+
+// ============================================================================
+// Wire format tests
+// ============================================================================
+
+TEST(WireTest, StructBytesAreLittleEndian) {
+    const Point p{1, -2};
+    uint8_t bytes[Point_WIRE_SIZE];
+    Point_wireEncode(&p, bytes);
+    const uint8_t expected[] = {0x01, 0x00, 0x00, 0x00, 0xfe, 0xff, 0xff, 0xff};
+    EXPECT_EQ(std::memcmp(bytes, expected, sizeof(expected)), 0);
+
+    Point decoded{};
+    Point_wireDecode(bytes, &decoded);
+    EXPECT_EQ(decoded.x, 1);
+    EXPECT_EQ(decoded.y, -2);
+
+    uint8_t status[Status_WIRE_SIZE];
+    const Status failed = Status_Failed;
+    Status_wireEncode(&failed, status);
+    EXPECT_EQ(status[0], 100);
+    EXPECT_EQ(status[3], 0);
+}
+
+TEST(WireTest, ArrayRoundTrip) {
+    const std::vector<BoundingBox> boxes = {{1, 2, 3, 4, 0.5}, {-5, 6, 7, 8, 0.25}};
+    const int count = static_cast<int>(boxes.size());
+
+    const int needed = BoundingBox_wireEncodeArray(boxes.data(), count, nullptr, 0);
+    ASSERT_EQ(needed, 4 + count * BoundingBox_WIRE_SIZE);
+    std::vector<uint8_t> bytes(needed);
+    EXPECT_EQ(BoundingBox_wireEncodeArray(boxes.data(), count, bytes.data(), needed - 1), -1);
+    ASSERT_EQ(BoundingBox_wireEncodeArray(boxes.data(), count, bytes.data(), needed), needed);
+    EXPECT_EQ(bytes[0], 2);
+
+    ASSERT_EQ(BoundingBox_wireDecodeArray(bytes.data(), needed, nullptr, 0), count);
+    std::vector<BoundingBox> decoded(count);
+    ASSERT_EQ(BoundingBox_wireDecodeArray(bytes.data(), needed, decoded.data(), count), count);
+    EXPECT_EQ(decoded[1].x, -5);
+    EXPECT_EQ(decoded[1].height, 8);
+    EXPECT_DOUBLE_EQ(decoded[1].confidence, 0.25);
+
+    // A truncated buffer is rejected instead of read past
+    EXPECT_EQ(BoundingBox_wireDecodeArray(bytes.data(), needed - 1, decoded.data(), count), -1);
+}
+
+TEST(WireTest, FramesSplitAStream) {
+    const uint8_t first[] = {1, 2, 3};
+    std::vector<uint8_t> stream(samples_wireFrameWrite(first, 3, nullptr, 0) + 4);
+    const int written = samples_wireFrameWrite(first, 3, stream.data(), static_cast<int>(stream.size()));
+    ASSERT_EQ(written, 7);
+    ASSERT_EQ(samples_wireFrameWrite(nullptr, 0, stream.data() + written, 4), 4);
+
+    const uint8_t* payload = nullptr;
+    int payload_size = 0;
+    EXPECT_EQ(samples_wireFrameNext(stream.data(), 6, &payload, &payload_size), 0);
+    ASSERT_EQ(samples_wireFrameNext(stream.data(), 11, &payload, &payload_size), 7);
+    EXPECT_EQ(payload_size, 3);
+    EXPECT_EQ(payload[2], 3);
+    ASSERT_EQ(samples_wireFrameNext(stream.data() + 7, 4, &payload, &payload_size), 4);
+    EXPECT_EQ(payload_size, 0);
+}
+
+#ifdef SAMPLES_IPC_SERVER
+// ============================================================================
+// Out-of-process client tests
+// ============================================================================
+
+namespace {
+
+// Runs samples_ipc_server on a private channel for one test
+class IPCTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        channel_ = "/samples_ipc_test_" + std::to_string(::getpid());
+        const std::string server = SAMPLES_IPC_SERVER;
+        char* argv[] = {const_cast<char*>(server.c_str()), const_cast<char*>(channel_.c_str()), nullptr};
+        ASSERT_EQ(::posix_spawn(&server_, server.c_str(), nullptr, nullptr, argv, environ), 0);
+        connection_ = samples_ipc::Connection::open(channel_);
+    }
+
+    void TearDown() override {
+        connection_.reset();
+        if (server_ > 0) {
+            int status = 0;
+            ::waitpid(server_, &status, 0);
+        }
+    }
+
+    std::string channel_;
+    pid_t server_ = 0;
+    std::shared_ptr<samples_ipc::Connection> connection_;
+};
+
+}  // namespace
+
+TEST_F(IPCTest, CallsRunInTheServer) {
+    samples_ipc::Calculator calc(connection_);
+    EXPECT_EQ(calc.add(2, 3), 5);
+    EXPECT_DOUBLE_EQ(calc.divide(7.0, 2.0), 3.5);
+    EXPECT_EQ(calc.addBatch({1, 2, 3}, {10, 20, 30}), (std::vector<int>{11, 22, 33}));
+
+    samples_ipc::TaskProcessor tasks(connection_);
+    EXPECT_TRUE(tasks.setStatus(Status_Active));
+    EXPECT_EQ(tasks.getStatus(), Status_Active);
+    EXPECT_EQ(tasks.statusToString(Status_Failed), "Failed");
+    EXPECT_EQ(tasks.statusToStringAsync(Status_Pending).get(), "Pending");
+
+    samples_ipc::ShapeProcessor shapes(connection_);
+    const BoundingBox box{0, 0, 3, 4, 1.0};
+    EXPECT_EQ(shapes.calculateArea(box), 12);
+    EXPECT_DOUBLE_EQ(shapes.calculateDiagonal(box), 5.0);
+    const auto moved = shapes.translateBatch({{1, 1}, {2, 2}}, {1, 1}, {0, 5});
+    ASSERT_EQ(moved.size(), 2u);
+    EXPECT_EQ(moved[1].x, 3);
+    EXPECT_EQ(moved[1].y, 7);
+}
+
+TEST_F(IPCTest, VectorResults) {
+    samples_ipc::Geometry geometry(connection_);
+    const auto line = geometry.createLine(0, 0, 10, 0, 5);
+    ASSERT_EQ(line.count(), 5);
+    EXPECT_EQ(line.data()[4].x, 10);
+
+    std::vector<Point> reused;
+    EXPECT_EQ(geometry.createLineInto(0, 0, 4, 4, 3, reused), 3);
+    EXPECT_EQ(reused[1].y, 2);
+
+    // A too-small caller buffer receives what fits and learns the full count
+    Point two[2];
+    EXPECT_EQ(geometry.createLineInto(0, 0, 4, 4, 3, two, 2), 3);
+    EXPECT_EQ(two[1].x, 2);
+
+    // Into a shared buffer the server writes the result in place
+    auto shared = connection_->allocate(8 * sizeof(Point));
+    EXPECT_EQ(geometry.createLineInto(0, 0, 7, 0, 8, shared.as<Point>(), 8), 8);
+    EXPECT_EQ(shared.as<Point>()[7].x, 7);
+}
+
+TEST_F(IPCTest, PointerArguments) {
+    samples_ipc::ImageProcessor images(connection_);
+    const uint8_t bytes[] = {1, 2, 3, 4};
+    EXPECT_EQ(images.processRawData(bytes, 4), 10);
+
+    // Without a length the pointer must already be in shared memory
+    EXPECT_THROW((void)images.readPixel(bytes, 2, 1, 1), std::invalid_argument);
+    auto pixels = connection_->allocate(4);
+    std::memcpy(pixels.data(), bytes, 4);
+    EXPECT_TRUE(connection_->isShared(pixels.data(), 4));
+    EXPECT_EQ(images.readPixel(pixels.data(), 2, 1, 1), 4);
+
+    BoundingBox box{-5, 2, 20, 20, 1.0};
+    EXPECT_TRUE(images.normalizeBox(&box, 10, 10));
+    EXPECT_EQ(box.x, 0);
+    EXPECT_EQ(box.height, 8);
+}
+
+TEST_F(IPCTest, ObjectsCrossByIdentity) {
+    samples_ipc::ObjectManager manager(connection_);
+    samples_ipc::Calculator calc(connection_);
+    EXPECT_EQ(manager.useCalculator(&calc, 4, 5), 9);
+    EXPECT_DOUBLE_EQ(manager.inspectCalculator(nullptr), 0.0);
+
+    samples_ipc::Calculator created = manager.createCalculator();
+    ASSERT_NE(created.id(), 0u);
+    EXPECT_EQ(created.multiply(6, 7), 42);
+    EXPECT_DOUBLE_EQ(manager.inspectCalculator(&created), 1.0);
+}
+
+TEST_F(IPCTest, FailuresCarryTheServersLastError) {
+    samples_ipc::Calculator calc(connection_);
+    try {
+        (void)calc.quotient(1, 0);
+        FAIL() << "quotient(1, 0) did not throw";
+    } catch (const samples_ipc::Error& e) {
+        EXPECT_EQ(e.code(), SAMPLES_ERROR_INVALID_ARGUMENT);
+        EXPECT_STREQ(e.what(), "Calculator_quotient: division by zero");
+    }
+    // The connection stays usable, and unchecked calls do not see the stale error
+    EXPECT_EQ(calc.quotient(-7, 7), -1);
+    EXPECT_EQ(calc.getVersionMajor(), 1);
+}
+
+TEST_F(IPCTest, ChannelInUseIsNotTakenOver) {
+    samples_ipc::Calculator calc(connection_);
+    ASSERT_EQ(calc.add(1, 1), 2);
+    try {
+        (void)samples_ipc::detail::Region::create(channel_, {});
+        FAIL() << "a second server took over a live channel";
+    } catch (const samples_ipc::TransportError& e) {
+        EXPECT_NE(std::string(e.what()).find("in use"), std::string::npos) << e.what();
+    }
+    EXPECT_EQ(calc.add(2, 2), 4);
+}
+
+TEST_F(IPCTest, ServerCrashSurfacesAsTransportError) {
+    samples_ipc::Calculator calc(connection_);
+    ASSERT_EQ(calc.add(1, 1), 2);
+
+    ::kill(server_, SIGKILL);
+    ::waitpid(server_, nullptr, 0);
+    server_ = 0;
+    EXPECT_THROW((void)calc.add(1, 1), samples_ipc::TransportError);
+    EXPECT_THROW((void)calc.add(1, 1), samples_ipc::TransportError);
+    // The dead server's channel is replaced, and the new region unlinks it on destruction
+    EXPECT_NE(samples_ipc::detail::Region::create(channel_, {}), nullptr);
+}
+#endif
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
+
+// Counting replacements for the global allocation functions (CAPIPoolSteadyStateDoesNotAllocate).
+// The array and nothrow forms are replaced too so every new/delete pair goes through malloc/free.
+void* operator new(std::size_t size) {
+    ++tAllocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++tAllocations;
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
@@ -1,6 +1,13 @@
 package idl.samples;
 
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Collections;
 import java.util.List;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.stream.Stream;
 
 /**
  * Sample application that tests all generated Java bindings.
@@ -26,6 +33,10 @@ public class SamplesTest {
         allPassed &= testGeometry();
         allPassed &= testShapeProcessor();
         allPassed &= testAsyncProcessor();
+        allPassed &= testImageProcessor();
+        allPassed &= testWire();
+        allPassed &= testNativeMemory();
+        allPassed &= testStreams();
         
         System.out.println("\n=== Summary ===");
         if (allPassed) {
@@ -48,6 +59,17 @@ public class SamplesTest {
             passed &= assertEquals("getVersionMajor()", 1, calc.getVersionMajor());
             passed &= assertEquals("getVersionMinor()", 0, calc.getVersionMinor());
             
+            int[] sums = calc.addBatch(new int[] {1, 2, 3}, new int[] {10, 20, 30});
+            passed &= assertEquals("addBatch length", 3, sums.length);
+            passed &= assertEquals("addBatch[2]", 33, sums[2]);
+            boolean threw = false;
+            try {
+                calc.addBatch(new int[] {1, 2, 3}, new int[] {10, 20});
+            } catch (IllegalArgumentException e) {
+                threw = e.getMessage().contains("b has 2 elements but a has 3");
+            }
+            passed &= assertEquals("addBatch length mismatch rejected", true, threw);
+            
             System.out.println("  Calculator: " + (passed ? "PASSED" : "FAILED"));
             return passed;
         }
@@ -63,11 +85,32 @@ public class SamplesTest {
             passed &= assertEquals("createLine[0].x", 0, line.get(0).x);
             passed &= assertEquals("createLine[4].x", 100, line.get(4).x);
             
+            Point[] buf = new Point[8];
+            passed &= assertEquals("createLineInto count", 5, geom.createLineInto(0, 0, 100, 100, 5, buf));
+            passed &= assertEquals("createLineInto[4].x", 100, buf[4].x);
+            
             List<BoundingBox> boxes = geom.findBoundingBoxes(3);
             passed &= assertEquals("findBoundingBoxes length", 3, boxes.size());
             passed &= assertEquals("boxes[0].x", 0, boxes.get(0).x);
             passed &= assertEquals("boxes[1].x", 10, boxes.get(1).x);
             
+            // Packed view: one direct buffer, no per-element objects
+            BoundingBoxView view = geom.findBoundingBoxesPacked(3);
+            passed &= assertEquals("packed size", 3, view.size());
+            passed &= assertEquals("packed x(1)", 10, view.x(1));
+            passed &= assertEquals("packed width(2)", 52, view.width(2));
+            passed &= assertEquals("packed confidence(0)", 0.9, view.confidence(0));
+            BoundingBoxView reused = geom.findBoundingBoxesPacked(2, view);
+            passed &= assertEquals("packed reuse", true, reused == view);
+            passed &= assertEquals("packed reuse size", 2, reused.size());
+            
+            // Columns: one primitive array per member
+            BoundingBoxColumns columns = geom.findBoundingBoxesColumns(3);
+            passed &= assertEquals("columns size", 3, columns.size());
+            passed &= assertEquals("columns x[2]", 20, columns.x[2]);
+            passed &= assertEquals("columns confidence[0]", 0.9, columns.confidence[0]);
+            passed &= assertEquals("columns get(1).height", 51, columns.get(1).height);
+            
             passed &= assertEquals("getLastCount()", 3, geom.getLastCount());
             
             System.out.println("  Geometry: " + (passed ? "PASSED" : "FAILED"));
@@ -103,6 +146,14 @@ public class SamplesTest {
             passed &= assertEquals("boxContainsPoint(inside)", true, processor.boxContainsPoint(testBox, inside));
             passed &= assertEquals("boxContainsPoint(outside)", false, processor.boxContainsPoint(testBox, outside));
             
+            int[] areas = processor.calculateAreaBatch(new BoundingBox[] {box, box2});
+            passed &= assertEquals("calculateAreaBatch[0]", 5000, areas[0]);
+            passed &= assertEquals("calculateAreaBatch[1]", 12, areas[1]);
+            boolean[] hits = processor.boxContainsPointBatch(
+                new BoundingBox[] {testBox, testBox}, new Point[] {inside, outside});
+            passed &= assertEquals("boxContainsPointBatch[0]", true, hits[0]);
+            passed &= assertEquals("boxContainsPointBatch[1]", false, hits[1]);
+            
             System.out.println("  ShapeProcessor: " + (passed ? "PASSED" : "FAILED"));
             return passed;
         }
@@ -130,11 +181,196 @@ public class SamplesTest {
             int sumSquares = processor.sumTransformed(1, 5, value -> value * value);
             passed &= assertEquals("sumTransformed (squares)", 55, sumSquares);
             
+            // [batch] callbacks: one invokeBatch call per native batch of values
+            final int[] batches = {0};
+            int batchedCount = processor.countFiltered(1, 600, new FilterCallback() {
+                @Override
+                public boolean invoke(int value) {
+                    return value % 2 == 0;
+                }
+
+                @Override
+                public void invokeBatch(int[] value, boolean[] result) {
+                    batches[0]++;
+                    for (int i = 0; i < value.length; i++) {
+                        result[i] = invoke(value[i]);
+                    }
+                }
+            });
+            passed &= assertEquals("countFiltered (batched)", 300, batchedCount);
+            passed &= assertEquals("countFiltered batch calls", 3, batches[0]);
+            passed &= assertEquals("sumTransformed (1..1000)", 500500, processor.sumTransformed(1, 1000, value -> value));
+            
+            // Async variants complete a CompletableFuture from a native pool thread
+            AtomicInteger asyncProgress = new AtomicInteger();
+            int asyncResult = processor.processWithProgressAsync(4, (current, total) -> asyncProgress.incrementAndGet()).join();
+            passed &= assertEquals("processWithProgressAsync result", 4, asyncResult);
+            passed &= assertEquals("async progress callback count", 4, asyncProgress.get());
+            passed &= assertEquals("sumTransformedAsync (cubes)", 36,
+                                   processor.sumTransformedAsync(1, 3, value -> value * value * value).join());
+            try (TaskProcessor tasks = new TaskProcessor()) {
+                String text = tasks.statusToStringAsync(Status.Failed.getValue()).join();
+                passed &= assertEquals("statusToStringAsync", true, "Failed".equals(text));
+            }
+
+            // close() while a call runs on the pool: the object lives until the call finishes
+            long live = NativeMemory.liveObjects();
+            AsyncProcessor closing = new AsyncProcessor();
+            CountDownLatch closed = new CountDownLatch(1);
+            CompletableFuture<Integer> running = closing.processWithProgressAsync(2, (current, total) -> {
+                try {
+                    closed.await();
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                }
+            });
+            closing.close();
+            closed.countDown();
+            passed &= assertEquals("async call across close()", 2, running.join());
+            for (int i = 0; i < 100 && NativeMemory.liveObjects() != live; ++i) {
+                try {
+                    Thread.sleep(10);
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                }
+            }
+            passed &= assertEquals("destroyed after the last call", 0, (int) (NativeMemory.liveObjects() - live));
+            
             System.out.println("  AsyncProcessor: " + (passed ? "PASSED" : "FAILED"));
             return passed;
         }
     }
     
+    static boolean testImageProcessor() {
+        System.out.println("Testing ImageProcessor...");
+        try (ImageProcessor processor = new ImageProcessor()) {
+            boolean passed = true;
+            byte[] pixels = {1, 2, 3, 4, 5, 6};
+            
+            passed &= assertEquals("processRawData(byte[])", 21, processor.processRawData(pixels, pixels.length));
+            passed &= assertEquals("processRawDataCritical", 21, processor.processRawDataCritical(pixels, pixels.length));
+            
+            // Direct buffers are read in place
+            ByteBuffer direct = ByteBuffer.allocateDirect(pixels.length);
+            direct.put(pixels).flip();
+            passed &= assertEquals("processRawData(ByteBuffer)", 21, processor.processRawData(direct, pixels.length));
+            passed &= assertEquals("readPixel(ByteBuffer)", 5, processor.readPixel(direct, 3, 1, 1));
+            
+            boolean threw = false;
+            try {
+                processor.processRawData(ByteBuffer.wrap(pixels), pixels.length);
+            } catch (IllegalArgumentException e) {
+                threw = true;
+            }
+            passed &= assertEquals("heap ByteBuffer rejected", true, threw);
+
+            // A count beyond the buffer or array is rejected before any byte is read
+            threw = false;
+            try {
+                processor.processRawData(direct, pixels.length + 1);
+            } catch (IllegalArgumentException e) {
+                threw = true;
+            }
+            passed &= assertEquals("oversized ByteBuffer count rejected", true, threw);
+            threw = false;
+            try {
+                processor.processRawDataCritical(pixels, pixels.length + 1);
+            } catch (IllegalArgumentException e) {
+                threw = true;
+            }
+            passed &= assertEquals("oversized critical count rejected", true, threw);
+            
+            System.out.println("  ImageProcessor: " + (passed ? "PASSED" : "FAILED"));
+            return passed;
+        }
+    }
+    
+    static boolean testNativeMemory() {
+        System.out.println("Testing NativeMemory...");
+        boolean passed = true;
+        
+        long objects = NativeMemory.liveObjects();
+        long bytes = NativeMemory.liveBytes();
+        Calculator calc = new Calculator();
+        passed &= assertEquals("live objects after create", 1, (int) (NativeMemory.liveObjects() - objects));
+        passed &= assertEquals("live bytes grow", true, NativeMemory.liveBytes() > bytes);
+        
+        calc.close();
+        calc.close();
+        passed &= assertEquals("live objects after close", 0, (int) (NativeMemory.liveObjects() - objects));
+        passed &= assertEquals("live bytes after close", 0, (int) (NativeMemory.liveBytes() - bytes));
+        
+        System.out.println("  NativeMemory: " + (passed ? "PASSED" : "FAILED"));
+        return passed;
+    }
+    
+    static boolean testStreams() {
+        System.out.println("Testing Streams...");
+        boolean passed = true;
+
+        try (Calculator calc = new Calculator(); Geometry geom = new Geometry()) {
+            // More items than one chunk, pulled lazily
+            long sum = 0;
+            int items = 0;
+            try (NativeStream<Integer> range = calc.range(1, 3000)) {
+                while (range.hasNext()) {
+                    sum += range.next();
+                    items++;
+                }
+            }
+            passed &= assertEquals("range count", 3000, items);
+            passed &= assertEquals("range sum", true, sum == 3000L * 3001 / 2);
+
+            List<BoundingBox> expected = geom.findBoundingBoxes(5);
+            List<BoundingBox> streamed = new ArrayList<>();
+            try (NativeStream<BoundingBox> boxes = geom.streamBoundingBoxes(5)) {
+                boxes.forEachRemaining(streamed::add);
+            }
+            passed &= assertEquals("streamed box count", expected.size(), streamed.size());
+            passed &= assertEquals("streamed box[4].width", expected.get(4).width, streamed.get(4).width);
+
+            // Closing early releases the native stream
+            long objects = NativeMemory.liveObjects();
+            try (Stream<Integer> first = calc.range(0, 1000000).stream()) {
+                passed &= assertEquals("stream limit", 10, (int) first.limit(10).count());
+            }
+            passed &= assertEquals("stream released", 0, (int) (NativeMemory.liveObjects() - objects));
+        }
+
+        System.out.println("  Streams: " + (passed ? "PASSED" : "FAILED"));
+        return passed;
+    }
+
+    static boolean testWire() {
+        System.out.println("Testing Wire...");
+        boolean passed = true;
+        
+        ByteBuffer buffer = ByteBuffer.allocate(64);
+        Wire.writePoint(buffer, new Point(1, -2));
+        passed &= assertEquals("Point bytes", Wire.POINT_SIZE, buffer.position());
+        passed &= assertEquals("Point byte 0", 1, buffer.get(0));
+        passed &= assertEquals("Point byte 4", -2, buffer.get(4));
+        
+        // Records round trip through frames, in the same bytes samples_wire.h reads
+        ByteBuffer payload = ByteBuffer.allocate(64);
+        Wire.writeBoundingBoxArray(payload, Collections.singletonList(new BoundingBox(1, 2, 3, 4, 0.5)));
+        payload.flip();
+        ByteBuffer stream = ByteBuffer.allocate(128);
+        Wire.writeFrame(stream, payload);
+        stream.flip();
+        ByteBuffer frame = Wire.nextFrame(stream);
+        passed &= assertEquals("frame found", true, frame != null);
+        passed &= assertEquals("stream consumed", 0, stream.remaining());
+        passed &= assertEquals("no second frame", true, Wire.nextFrame(stream) == null);
+        List<BoundingBox> boxes = Wire.readBoundingBoxArray(frame);
+        passed &= assertEquals("boxes length", 1, boxes.size());
+        passed &= assertEquals("boxes[0].height", 4, boxes.get(0).height);
+        passed &= assertEquals("boxes[0].confidence", 0.5, boxes.get(0).confidence);
+        
+        System.out.println("  Wire: " + (passed ? "PASSED" : "FAILED"));
+        return passed;
+    }
+    
     // Assertion helpers
     static boolean assertEquals(String name, int expected, int actual) {
         if (expected == actual) {
@@ -10,13 +10,19 @@ Run:
     python samples/tests/python/samples_test.py
 """
 
+import array
+import ctypes
 import sys
 import os
+import threading
 
 # Add generated directory to path
 sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'generated'))
 
-from samples import Calculator, Geometry, ShapeProcessor, AsyncProcessor, Point, BoundingBox
+import samples
+import samples_wire
+from samples import (Calculator, Geometry, ShapeProcessor, ImageProcessor, AsyncProcessor, TaskProcessor,
+                     Point, BoundingBox, Status)
 
 
 def test_calculator():
@@ -54,6 +60,14 @@ def test_calculator():
         else:
             print(f"  PASS: divide(10.0, 4.0) = {result}")
         
+        # Batch entry point
+        sums = calc.addBatch([1, 2, 3], [10, 20, 30])
+        if sums != [11, 22, 33]:
+            print(f"  FAIL: addBatch = {sums}, expected [11, 22, 33]")
+            passed = False
+        else:
+            print(f"  PASS: addBatch = {sums}")
+        
         # Version info
         major = calc.getVersionMajor()
         minor = calc.getVersionMinor()
@@ -87,6 +101,36 @@ def test_geometry():
             print(f"  PASS: findBoundingBoxes returned {len(boxes)} boxes")
             for i, box in enumerate(boxes):
                 print(f"    Box[{i}]: ({box.x}, {box.y}, {box.width}x{box.height}) conf={box.confidence:.2f}")
+        
+        # Fill a reusable caller-owned buffer instead of allocating a list
+        buf = (Point * 8)()
+        n = geom.createLineInto(0, 0, 10, 10, 5, buf)
+        if n != 5 or buf[4].x != 10:
+            print(f"  FAIL: createLineInto returned {n}, last x={buf[4].x}")
+            passed = False
+        else:
+            print(f"  PASS: createLineInto filled {n} points")
+        
+        # Borrow the native result buffer; it is freed with the array
+        view = geom.createLineArray(0, 0, 10, 10, 5)
+        mv = memoryview(view)
+        if len(view) != 5 or view[4].y != 10 or mv.nbytes != 5 * ctypes.sizeof(Point):
+            print(f"  FAIL: createLineArray returned {len(view)} points, {mv.nbytes} bytes")
+            passed = False
+        else:
+            print(f"  PASS: createLineArray wraps {mv.nbytes} native bytes")
+        del mv, view
+
+        # [soa]: one native array per BoundingBox member, valid while referenced
+        columns = geom.findBoundingBoxesColumns(3)
+        confidence = columns.confidence
+        del columns
+        if len(confidence) != 3 or abs(confidence[2] - 0.7) > 1e-9 or memoryview(confidence).format != "<d":
+            print(f"  FAIL: findBoundingBoxesColumns confidence={list(confidence)}")
+            passed = False
+        else:
+            print(f"  PASS: findBoundingBoxesColumns maps {len(confidence)} confidences")
+        del confidence
     
     return passed
 
@@ -144,6 +188,24 @@ def test_shape_processor():
         else:
             print(f"  PASS: boxContainsPoint = {bool(contains)}")
         
+        # Batch over several boxes in one native call
+        small = BoundingBox()
+        small.width = 3
+        small.height = 4
+        areas = proc.calculateAreaBatch([box, small])
+        if areas != [5000, 12]:
+            print(f"  FAIL: calculateAreaBatch = {areas}, expected [5000, 12]")
+            passed = False
+        else:
+            print(f"  PASS: calculateAreaBatch = {areas}")
+        
+        hits = proc.boxContainsPointBatch([box, small], [point_inside, point_inside])
+        if hits != [True, False]:
+            print(f"  FAIL: boxContainsPointBatch = {hits}, expected [True, False]")
+            passed = False
+        else:
+            print(f"  PASS: boxContainsPointBatch = {hits}")
+        
         # Create box
         new_box = proc.createBox(1, 2, 30, 40)
         if new_box.x != 1 or new_box.y != 2 or new_box.width != 30 or new_box.height != 40:
@@ -155,6 +217,43 @@ def test_shape_processor():
     return passed
 
 
+def test_image_processor():
+    """Test ImageProcessor with buffer-protocol pointer arguments"""
+    print("\nTesting ImageProcessor...")
+    passed = True
+    
+    with ImageProcessor() as proc:
+        # Any contiguous buffer is passed by address, without a copy
+        pixels = bytes([1, 2, 3, 4, 5, 6])
+        for label, data in [("bytes", pixels),
+                            ("bytearray", bytearray(pixels)),
+                            ("memoryview", memoryview(pixels)),
+                            ("array", array.array('B', pixels))]:
+            total = proc.processRawData(data, len(pixels))
+            if total != 21:
+                print(f"  FAIL: processRawData({label}) = {total}, expected 21")
+                passed = False
+            else:
+                print(f"  PASS: processRawData({label}) = {total}")
+        
+        pixel = proc.readPixel(bytearray(pixels), 3, 2, 1)
+        if pixel != 6:
+            print(f"  FAIL: readPixel = {pixel}, expected 6")
+            passed = False
+        else:
+            print(f"  PASS: readPixel = {pixel}")
+        
+        # Struct pointers are modified in place
+        box = BoundingBox(x=-5, y=10, width=200, height=50, confidence=0.5)
+        if not proc.normalizeBox(box, 100, 100) or box.x != 0 or box.width > 100:
+            print(f"  FAIL: normalizeBox -> {box}")
+            passed = False
+        else:
+            print(f"  PASS: normalizeBox -> {box}")
+    
+    return passed
+
+
 def test_async_processor():
     """Test AsyncProcessor interface with callbacks"""
     print("\nTesting AsyncProcessor...")
@@ -195,10 +294,290 @@ def test_async_processor():
             passed = False
         else:
             print(f"  PASS: sumTransformed(double) = {total}")
+
+        # [batch] callbacks: per-element callables still work across batch boundaries,
+        # and invokeBatch receives each native batch as ctypes arrays
+        total = proc.sumTransformed(1, 1000, lambda v: v)
+        if total != 500500:
+            print(f"  FAIL: sumTransformed(1..1000) = {total}, expected 500500")
+            passed = False
+        else:
+            print(f"  PASS: sumTransformed(1..1000) = {total}")
+
+        class Evens:
+            def __init__(self):
+                self.batches = []
+
+            def __call__(self, value):
+                return value % 2 == 0
+
+            def invokeBatch(self, value, result):
+                self.batches.append(len(value))
+                for i, v in enumerate(value):
+                    result[i] = v % 2 == 0
+
+        evens = Evens()
+        count = proc.countFiltered(1, 600, evens)
+        if count != 300 or evens.batches != [256, 256, 88]:
+            print(f"  FAIL: countFiltered(invokeBatch) = {count}, batches {evens.batches}")
+            passed = False
+        else:
+            print(f"  PASS: countFiltered(invokeBatch) = {count} in batches {evens.batches}")
+
+        # Async variants run on the native worker pool and complete a Future
+        futures = [proc.sumTransformedAsync(1, n, lambda v, n=n: v * n) for n in range(1, 9)]
+        results = [f.result(timeout=10) for f in futures]
+        expected = [n * n * (n + 1) // 2 for n in range(1, 9)]
+        if results != expected:
+            print(f"  FAIL: sumTransformedAsync = {results}, expected {expected}")
+            passed = False
+        else:
+            print(f"  PASS: sumTransformedAsync x{len(futures)} = {results}")
+
+        async_progress = []
+        result = proc.processWithProgressAsync(3, lambda c, t: async_progress.append(c)).result(timeout=10)
+        if result != 3 or sorted(async_progress) != [0, 1, 2]:
+            print(f"  FAIL: processWithProgressAsync = {result}, progress {async_progress}")
+            passed = False
+        else:
+            print(f"  PASS: processWithProgressAsync = {result}")
+
+    with TaskProcessor() as tasks:
+        text = tasks.statusToStringAsync(Status.Failed).result(timeout=10)
+        if text != "Failed":
+            print(f"  FAIL: statusToStringAsync = {text!r}, expected 'Failed'")
+            passed = False
+        else:
+            print(f"  PASS: statusToStringAsync = {text!r}")
     
     return passed
 
 
+def test_extension():
+    """Test the compiled _samples_ext backend, when it was built"""
+    print("\nTesting Python extension...")
+    if samples._ext is None:
+        print("  SKIP: _samples_ext not loaded, using ctypes")
+        return True
+    passed = True
+
+    # Callbacks are called directly, and their exceptions propagate
+    def failing(value):
+        raise KeyError(value)
+
+    with AsyncProcessor() as proc:
+        try:
+            proc.countFiltered(1, 10, failing)
+            print("  FAIL: callback exception was swallowed")
+            passed = False
+        except KeyError as e:
+            print(f"  PASS: callback exception propagated ({e!r})")
+
+    with ShapeProcessor() as shapes:
+        try:
+            shapes.calculateArea(Point(x=1, y=2))
+            print("  FAIL: calculateArea accepted a Point")
+            passed = False
+        except ValueError:
+            print("  PASS: struct argument size is checked")
+
+    # [nogil] calls run concurrently with other Python threads
+    data = bytes(range(256)) * 256
+    results = []
+    with ImageProcessor() as proc:
+        threads = [threading.Thread(target=lambda: results.append(proc.processRawData(data, len(data))))
+                   for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    expected = sum(range(256)) * 256
+    if results != [expected] * 4:
+        print(f"  FAIL: processRawData from threads = {results}, expected {expected}")
+        passed = False
+    else:
+        print(f"  PASS: processRawData from {len(threads)} threads = {expected}")
+
+    return passed
+
+
+def test_wire():
+    """Test the standalone wire codecs against the bindings' structs"""
+    print("\nTesting wire format...")
+    passed = True
+
+    point = samples_wire.Point(x=1, y=-2)
+    if bytes(point) != bytes.fromhex("01000000feffffff"):
+        print(f"  FAIL: Point encodes to {bytes(point).hex()}")
+        passed = False
+    else:
+        print("  PASS: Point encodes little-endian")
+
+    # Arrays of the bindings' structs convert field by field and decode with one copy
+    with Geometry() as geom:
+        line = geom.createLine(0, 0, 4, 8, 5)
+    data = samples_wire.Point.encode_array(line)
+    decoded = samples_wire.Point.decode_array(data)
+    if len(data) != 4 + 5 * samples_wire.Point.WIRE_SIZE or [(p.x, p.y) for p in decoded] != \
+            [(p.x, p.y) for p in line]:
+        print(f"  FAIL: Point array round trip = {[(p.x, p.y) for p in decoded]}")
+        passed = False
+    else:
+        print(f"  PASS: Point array round trip ({len(data)} bytes)")
+
+    boxes = samples_wire.BoundingBox.decode_array(samples_wire.BoundingBox.encode_array(
+        [BoundingBox(x=1, y=2, width=3, height=4, confidence=0.5)]))
+    if boxes[0].height != 4 or boxes[0].confidence != 0.5:
+        print("  FAIL: BoundingBox array round trip")
+        passed = False
+    else:
+        print("  PASS: BoundingBox array round trip")
+
+    try:
+        samples_wire.Point.decode_array(data[:-1])
+        print("  FAIL: truncated array was accepted")
+        passed = False
+    except ValueError:
+        print("  PASS: truncated array is rejected")
+
+    stream = samples_wire.encode_frame(data) + samples_wire.encode_frame(bytes(point))
+    reader = samples_wire.FrameReader()
+    frames = reader.feed(stream[:10]) + reader.feed(stream[10:])
+    if frames != [data, bytes(point)]:
+        print(f"  FAIL: frames = {frames}")
+        passed = False
+    else:
+        print("  PASS: FrameReader splits the stream")
+
+    return passed
+
+
+def test_native_memory():
+    """Test deterministic release and the live native memory counters"""
+    print("\nTesting native memory...")
+    passed = True
+
+    base = samples.native_memory()
+    calc = Calculator()
+    geom = Geometry()
+    columns = geom.findBoundingBoxesColumns(100)
+    usage = samples.native_memory()
+    if usage.objects != base.objects + 3 or usage.bytes < base.bytes + 100 * ctypes.sizeof(BoundingBox):
+        print(f"  FAIL: usage with 3 live objects = {usage}, base {base}")
+        passed = False
+    else:
+        print(f"  PASS: 3 live objects hold {usage.bytes - base.bytes} bytes")
+
+    calc.close()
+    calc.close()
+    if samples.native_memory().objects != base.objects + 2:
+        print("  FAIL: close() did not release the Calculator exactly once")
+        passed = False
+    else:
+        print("  PASS: close() releases once")
+
+    # Unclosed wrappers are released when collected; callbacks are not retained past the call
+    with AsyncProcessor() as proc:
+        proc.countFiltered(1, 10, lambda v: v % 2 == 0)
+        if hasattr(proc, "_callbacks"):
+            print("  FAIL: the wrapper keeps callback references")
+            passed = False
+    del columns, geom
+    usage = samples.native_memory()
+    if (usage.objects, usage.bytes) != (base.objects, base.bytes):
+        print(f"  FAIL: usage after release = {usage}, base {base}")
+        passed = False
+    else:
+        print("  PASS: collected wrappers release their native memory")
+
+    return passed
+
+
+def test_streams():
+    """Test stream<T> methods: generators pulling chunks from the C API"""
+    print("\nTesting streams...")
+    passed = True
+
+    with Calculator() as calc, Geometry() as geom:
+        values = list(calc.range(1, 3000, chunk=256))
+        if len(values) != 3000 or sum(values) != 3000 * 3001 // 2:
+            print(f"  FAIL: range(1, 3000) gave {len(values)} values")
+            passed = False
+        else:
+            print("  PASS: range(1, 3000) over several chunks")
+
+        expected = geom.findBoundingBoxes(5)
+        streamed = list(geom.streamBoundingBoxes(5))
+        if [(b.x, b.width) for b in streamed] != [(b.x, b.width) for b in expected]:
+            print("  FAIL: streamBoundingBoxes differs from findBoundingBoxes")
+            passed = False
+        else:
+            print("  PASS: streamBoundingBoxes matches findBoundingBoxes")
+
+        # Closing a generator early frees its native stream
+        base = samples.native_memory()
+        stream = calc.range(0, 1000000)
+        first = next(stream)
+        live = samples.native_memory().objects - base.objects
+        stream.close()
+        if first != 0 or live != 1 or samples.native_memory().objects != base.objects:
+            print(f"  FAIL: early close (first {first}, live {live})")
+            passed = False
+        else:
+            print("  PASS: closing early frees the stream")
+
+    return passed
+
+
+def test_errors():
+    """Test C API failures surfacing as samples.Error"""
+    print("\nTesting errors...")
+    passed = True
+
+    calc = Calculator()
+    try:
+        calc.quotient(1, 0)
+        print("  FAIL: quotient(1, 0) did not raise")
+        passed = False
+    except samples.Error as e:
+        if e.code != samples.ErrorCode.INVALID_ARGUMENT or "division by zero" not in e.message:
+            print(f"  FAIL: quotient(1, 0) raised {e.code!r}: {e.message}")
+            passed = False
+        else:
+            print(f"  PASS: quotient(1, 0) raised {e.code.name}")
+
+    # -1 is also a real result: the last error tells them apart
+    if calc.quotient(-7, 7) != -1 or samples.last_error() is not None:
+        print("  FAIL: quotient(-7, 7) should return -1 without an error")
+        passed = False
+    else:
+        print("  PASS: quotient(-7, 7) = -1 without an error")
+
+    # An [async] call that throws on the worker fails its future with the same typed error
+    with AsyncProcessor() as proc:
+        try:
+            proc.processWithProgressAsync(-1, lambda c, t: None).result(timeout=10)
+            print("  FAIL: processWithProgressAsync(-1) did not raise")
+            passed = False
+        except samples.Error as e:
+            if e.code != samples.ErrorCode.INVALID_ARGUMENT or "negative count" not in e.message:
+                print(f"  FAIL: processWithProgressAsync(-1) raised {e.code!r}: {e.message}")
+                passed = False
+            else:
+                print(f"  PASS: processWithProgressAsync(-1) raised {e.code.name}")
+
+    # [noexcept] methods skip the native null check, so the wrapper checks instead
+    calc.close()
+    try:
+        calc.subtract(2, 1)
+        print("  FAIL: subtract on a closed Calculator did not raise")
+        passed = False
+    except ValueError:
+        print("  PASS: subtract on a closed Calculator raised ValueError")
+
+    return passed
+
+
 def main():
     print("=== IDL Samples Python Test ===\n")
     
@@ -207,7 +586,13 @@ def main():
     all_passed &= test_calculator()
     all_passed &= test_geometry()
     all_passed &= test_shape_processor()
+    all_passed &= test_image_processor()
     all_passed &= test_async_processor()
+    all_passed &= test_extension()
+    all_passed &= test_wire()
+    all_passed &= test_native_memory()
+    all_passed &= test_streams()
+    all_passed &= test_errors()
     
     print("\n=== Summary ===")
     if all_passed:
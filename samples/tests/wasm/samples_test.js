@@ -28,7 +28,7 @@ try {
 }
 
 // Initialize module and run tests
-SamplesModule().then(function(Module) {
+SamplesModule().then(async function(Module) {
     console.log('=== IDL Samples JavaScript/WASM Test ===\n');
     
     let allPassed = true;
@@ -37,6 +37,9 @@ SamplesModule().then(function(Module) {
     allPassed &= testGeometry(Module);
     allPassed &= testShapeProcessor(Module);
     allPassed &= testAsyncProcessor(Module);
+    allPassed &= testImageProcessor(Module);
+    allPassed &= await testAsyncMethods(Module);
+    allPassed &= await testStreams(Module);
     
     console.log('\n=== Summary ===');
     if (allPassed) {
@@ -85,6 +88,20 @@ function testCalculator(Module) {
         passed &= assertEquals('getVersionMajor()', 1, calc.getVersionMajor());
         passed &= assertEquals('getVersionMinor()', 0, calc.getVersionMinor());
         
+        const sums = calc.addBatch(new Int32Array([1, 2, 3]), [10, 20, 30]);
+        passed &= assertEquals('addBatch length', 3, sums.length);
+        passed &= assertEquals('addBatch[2]', 33, sums[2]);
+
+        // A C++ exception surfaces as a JS Error instead of aborting the module
+        let error = null;
+        try {
+            calc.quotient(1, 0);
+        } catch (e) {
+            error = e;
+        }
+        passed &= assertEquals('quotient(1, 0) throws Error', true, error instanceof Error);
+        passed &= assertEquals('quotient(7, 2) after the error', 3, calc.quotient(7, 2));
+
         calc.delete();
         
         console.log('  Calculator: ' + (passed ? 'PASSED' : 'FAILED'));
@@ -119,6 +136,17 @@ function testGeometry(Module) {
         
         passed &= assertEquals('getLastCount()', 3, geom.getLastCount());
         
+        const points = new Module.PointView(geom.createLinePacked(0, 0, 100, 100, 5));
+        passed &= assertEquals('createLinePacked size', 5, points.size());
+        passed &= assertEquals('PointView.x(4)', 100, points.x(4));
+        passed &= assertEquals('PointView.get(4).y', 100, points.get(4).y);
+        
+        const boxView = new Module.BoundingBoxView(geom.findBoundingBoxesPacked(3));
+        passed &= assertEquals('findBoundingBoxesPacked size', 3, boxView.size());
+        passed &= assertEquals('BoundingBoxView.x(1)', 10, boxView.x(1));
+        passed &= assertEquals('BoundingBoxView.width(2)', 52, boxView.width(2));
+        passed &= assertClose('BoundingBoxView.confidence(0)', 0.9, boxView.confidence(0));
+        
         geom.delete();
         
         console.log('  Geometry: ' + (passed ? 'PASSED' : 'FAILED'));
@@ -164,6 +192,13 @@ function testShapeProcessor(Module) {
         passed &= assertEquals('boxContainsPoint(inside)', true, processor.boxContainsPoint(testBox, inside));
         passed &= assertEquals('boxContainsPoint(outside)', false, processor.boxContainsPoint(testBox, outside));
         
+        const areas = processor.calculateAreaBatch([box, box2]);
+        passed &= assertEquals('calculateAreaBatch[0]', 5000, areas[0]);
+        passed &= assertEquals('calculateAreaBatch[1]', 12, areas[1]);
+        const hits = processor.boxContainsPointBatch([testBox, testBox], [inside, outside]);
+        passed &= assertEquals('boxContainsPointBatch[0]', 1, hits[0]);
+        passed &= assertEquals('boxContainsPointBatch[1]', 0, hits[1]);
+        
         processor.delete();
         
         console.log('  ShapeProcessor: ' + (passed ? 'PASSED' : 'FAILED'));
@@ -207,6 +242,17 @@ function testAsyncProcessor(Module) {
         });
         passed &= assertEquals('sumTransformed (squares)', 55, sumSquares);
         
+        // [batch] callbacks: invokeBatch receives typed-array views of each native batch
+        const evens = (value) => value % 2 === 0;
+        let batches = 0;
+        evens.invokeBatch = (value, result) => {
+            batches++;
+            for (let i = 0; i < value.length; i++) result[i] = evens(value[i]) ? 1 : 0;
+        };
+        passed &= assertEquals('countFiltered (batched)', 300, processor.countFiltered(1, 600, evens));
+        passed &= assertEquals('countFiltered batch calls', 3, batches);
+        passed &= assertEquals('sumTransformed (1..1000)', 500500, processor.sumTransformed(1, 1000, (v) => v));
+        
         processor.delete();
         
         console.log('  AsyncProcessor: ' + (passed ? 'PASSED' : 'FAILED'));
@@ -217,3 +263,125 @@ function testAsyncProcessor(Module) {
     
     return passed;
 }
+
+function testImageProcessor(Module) {
+    console.log('Testing ImageProcessor...');
+    let passed = true;
+    
+    try {
+        const processor = new Module.ImageProcessor();
+        if (!processor.create()) {
+            console.log('  FAIL: Could not create ImageProcessor');
+            return false;
+        }
+        
+        const pixels = new Uint8Array([1, 2, 3, 4, 5, 6]);
+        passed &= assertEquals('processRawData', 21, processor.processRawData(pixels, pixels.length));
+        
+        // Zero-copy path: bytes live in the WASM heap, only the address crosses
+        const buf = new Module.HeapBuffer(pixels.length).set(pixels);
+        passed &= assertEquals('processRawDataPtr', 21, processor.processRawDataPtr(buf.ptr, pixels.length));
+        passed &= assertEquals('readPixelPtr', 6, processor.readPixelPtr(buf.ptr, 3, 2, 1));
+        buf.bytes()[0] = 10;
+        passed &= assertEquals('processRawDataPtr (in-place edit)', 30, processor.processRawDataPtr(buf.ptr, pixels.length));
+        buf.free();
+        
+        processor.delete();
+        
+        console.log('  ImageProcessor: ' + (passed ? 'PASSED' : 'FAILED'));
+    } catch (e) {
+        console.log('  ImageProcessor: FAILED with exception:', e.message);
+        return false;
+    }
+    
+    return passed;
+}
+
+async function testAsyncMethods(Module) {
+    console.log('Testing [async] methods...');
+    let passed = true;
+    
+    try {
+        const processor = new Module.AsyncProcessor();
+        if (!processor.create()) {
+            console.log('  FAIL: Could not create AsyncProcessor');
+            return false;
+        }
+        
+        // Runs on the worker thread in the wasm-mt build; callbacks still run here
+        const progress = [];
+        const pending = processor.processWithProgressAsync(4, (current) => progress.push(current));
+        passed &= assertEquals('processWithProgressAsync is a Promise', true, pending instanceof Promise);
+        passed &= assertEquals('processWithProgressAsync', 4, await pending);
+        passed &= assertEquals('async progress calls', 4, progress.length);
+        passed &= assertEquals('sumTransformedAsync (squares)', 55,
+            await processor.sumTransformedAsync(1, 5, (v) => v * v));
+        processor.delete();
+        
+        const tasks = new Module.TaskProcessor();
+        tasks.create();
+        passed &= assertEquals('statusToStringAsync', 'Pending', await tasks.statusToStringAsync(Module.Status.Pending));
+        tasks.delete();
+        
+        // A large buffer grows the heap; views taken afterwards must cover it
+        const size = 64 << 20;
+        const big = new Module.HeapBuffer(size);
+        passed &= assertEquals('HeapBuffer after growth', size, big.bytes().length);
+        big.bytes()[size - 1] = 7;
+        passed &= assertEquals('HeapBuffer last byte', 7, Module.heapU8()[big.ptr + size - 1]);
+        big.free();
+        
+        console.log('  [async] methods: ' + (passed ? 'PASSED' : 'FAILED'));
+    } catch (e) {
+        console.log('  [async] methods: FAILED with exception:', e.message);
+        return false;
+    }
+    
+    return passed;
+}
+
+async function testStreams(Module) {
+    console.log('Testing stream<T> methods...');
+    let passed = true;
+    
+    try {
+        const calc = new Module.Calculator();
+        calc.create();
+        // More items than one chunk, pulled as the loop runs
+        let sum = 0;
+        let count = 0;
+        for await (const value of calc.range(1, 3000)) {
+            sum += value;
+            count++;
+        }
+        passed &= assertEquals('range count', 3000, count);
+        passed &= assertEquals('range sum', 3000 * 3001 / 2, sum);
+        
+        // Leaving the loop early deletes the reader through return()
+        let first = -1;
+        for await (const value of calc.range(7, 1000000)) {
+            first = value;
+            break;
+        }
+        passed &= assertEquals('range early exit', 7, first);
+        calc.delete();
+        
+        const geom = new Module.Geometry();
+        geom.create();
+        const expected = geom.findBoundingBoxes(5);
+        const streamed = [];
+        for await (const box of geom.streamBoundingBoxes(5)) {
+            streamed.push(box);
+        }
+        passed &= assertEquals('streamBoundingBoxes length', expected.length, streamed.length);
+        passed &= assertEquals('streamBoundingBoxes[4].width', expected[4].width, streamed[4].width);
+        geom.delete();
+        
+        console.log('  stream<T> methods: ' + (passed ? 'PASSED' : 'FAILED'));
+    } catch (e) {
+        console.log('  stream<T> methods: FAILED with exception:', e.message);
+        return false;
+    }
+    
+    return passed;
+}